@@ -0,0 +1,22 @@
+# The battle AI scripts are translated into C by aiscr2c. The ROM runs them
+# through the interpreter in battle_ai_script_commands.c; PORTABLE builds call
+# the generated functions instead.
+
+AI_SCRIPTS_ASM := ../ruby_sapphire_emerald/battle_ai_scripts.s
+AI_SCRIPTS_MACROS := $(ASM_SUBDIR)/macros/battle_ai_script.inc
+AI_SCRIPTS_HANDLERS := $(C_SUBDIR)/battle_ai_script_commands.c
+AI_SCRIPTS_CHECK := $(DATA_SRC_SUBDIR)/battle_ai_scripts_check.inc
+
+AUTO_GEN_TARGETS += $(DATA_SRC_SUBDIR)/battle_ai_scripts.h $(AI_SCRIPTS_CHECK)
+$(DATA_SRC_SUBDIR)/battle_ai_scripts.h: $(AI_SCRIPTS_MACROS) $(AI_SCRIPTS_HANDLERS) $(AI_SCRIPTS_ASM)
+	$(CPP) $(INCLUDE_SCANINC_ARGS) -x assembler-with-cpp $(AI_SCRIPTS_ASM) | $(AISCR2C) $(AI_SCRIPTS_MACROS) $(AI_SCRIPTS_HANDLERS) - $@ $(AI_SCRIPTS_CHECK)
+$(AI_SCRIPTS_CHECK): $(DATA_SRC_SUBDIR)/battle_ai_scripts.h ;
+
+# The scripts assembled again with aiscr2c's layout checks after them, so the
+# build stops if the offsets in the generated code don't match the data.
+$(DATA_ASM_BUILDDIR)/battle_ai_scripts_check.o: $(AI_SCRIPTS_ASM) $(AI_SCRIPTS_CHECK)
+	@mkdir -p $(@D)
+	{ $(PREPROC) $< charmap.txt | $(CPP) $(INCLUDE_SCANINC_ARGS) - | $(PREPROC) -ie $< charmap.txt; cat $(AI_SCRIPTS_CHECK); } | $(AS) $(ASFLAGS) -o $@
+
+$(C_BUILDDIR)/battle_ai_script_commands.o: c_dep += $(DATA_SRC_SUBDIR)/battle_ai_scripts.h
+$(C_BUILDDIR)/battle_ai_script_commands.o: $(DATA_ASM_BUILDDIR)/battle_ai_scripts_check.o
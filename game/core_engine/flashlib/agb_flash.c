@@ -1,6 +1,9 @@
 #include "gba/gba.h"
 #include "gba/flash_internal.h"
 
+// The PORTABLE build uses the file-backed flash in agb_flash_file.c instead.
+#ifndef PORTABLE
+
 static u8 sTimerNum;
 static u16 sTimerCount;
 static vu16 *sTimerReg;
@@ -294,3 +297,5 @@ u32 ProgramFlashSectorAndVerifyNBytes(u16 sectorNum, u8 *src, u32 n)
 
     return result;
 }
+
+#endif // PORTABLE
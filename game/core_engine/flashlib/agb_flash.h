@@ -11,4 +11,14 @@ u16 SetFlashTimerIntr(u8 timerNum, void (**intrFunc)(void));
 u16 IdentifyFlash(void);
 u32 ProgramFlashSectorAndVerify(u16 sectorNum, u8 *src);
 
+#ifdef PORTABLE
+// File-backed flash (agb_flash_file.c)
+void FlashFile_SetPath(const char *path);
+void FlashFile_InitFromEnv(void);
+u32 FlashFile_Flush(void);
+void FlashFile_BeginBatch(void);
+u32 FlashFile_EndBatch(void);
+const u8 *FlashFile_GetSector(u16 sectorNum);
+#endif // PORTABLE
+
 #endif //GUARD_AGB_FLASH_H
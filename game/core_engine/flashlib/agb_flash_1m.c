@@ -1,6 +1,8 @@
 #include "gba/gba.h"
 #include "gba/flash_internal.h"
 
+#ifndef PORTABLE
+
 static const char AgbLibFlashVersion[] = "FLASH1M_V103";
 
 static const struct FlashSetupInfo * const sSetupInfos[] =
@@ -84,3 +86,5 @@ u16 WaitForFlashWrite_Common(u8 phase, u8 *addr, u8 lastData)
 
     return result;
 }
+
+#endif // PORTABLE
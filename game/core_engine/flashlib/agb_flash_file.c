@@ -0,0 +1,377 @@
+#ifdef PORTABLE
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "gba/gba.h"
+#include "gba/flash_internal.h"
+#include "agb_flash.h"
+
+#ifdef PORTABLE
+
+// Flash chip emulated by a save file on the host. The file is mapped into
+// memory when the flash is identified and all reads, programs and erases
+// operate on that in-memory image, marking the sectors they touch as dirty.
+// FlashFile_Flush writes just the dirty sectors back into the file and fsyncs
+// it. A crash part way through a flush can leave a sector half written, as a
+// power cut can on the real chip; the save format's two slots and per-sector
+// checksums already deal with that.
+//
+// Outside of a batch every program/erase is flushed immediately, like the
+// real chip. Between FlashFile_BeginBatch and FlashFile_EndBatch writes are
+// only staged in the image, which turns a full save into a single flush.
+
+#define FLASH_FILE_SIZE     131072
+#define FLASH_SECTOR_SHIFT  12
+#define FLASH_SECTOR_SIZE   (1 << FLASH_SECTOR_SHIFT)
+#define FLASH_SECTOR_COUNT  (FLASH_FILE_SIZE / FLASH_SECTOR_SIZE)
+#define FLASH_ERASED_BYTE   0xFF
+
+#define FLASH_FILE_DEFAULT_PATH "pokeemerald.sav"
+
+#define SECTOR_BIT(sectorNum) (1u << (sectorNum))
+#define ALL_SECTOR_BITS       (0xFFFFFFFFu >> (32 - FLASH_SECTOR_COUNT))
+
+COMMON_DATA u8 gFlashTimeoutFlag = 0;
+COMMON_DATA u8 (*PollFlashStatus)(u8 *) = NULL;
+COMMON_DATA u16 (*WaitForFlashWrite)(u8 phase, u8 *addr, u8 lastData) = NULL;
+COMMON_DATA u16 (*ProgramFlashSector)(u16 sectorNum, u8 *src) = NULL;
+COMMON_DATA const struct FlashType *gFlash = NULL;
+COMMON_DATA u16 (*ProgramFlashByte)(u16 sectorNum, u32 offset, u8 data) = NULL;
+COMMON_DATA u16 gFlashNumRemainingBytes = 0;
+COMMON_DATA u16 (*EraseFlashChip)() = NULL;
+COMMON_DATA u16 (*EraseFlashSector)(u16 sectorNum) = 0;
+COMMON_DATA const u16 *gFlashMaxTime = NULL;
+
+static char sFlashFilePath[512] = FLASH_FILE_DEFAULT_PATH;
+static u8 *sFlashImage;
+static u32 sDirtySectors;
+static u8 sBatchDepth;
+static u32 sBatchSectors;
+
+static u16 EraseFlashChip_File(void);
+static u16 EraseFlashSector_File(u16 sectorNum);
+static u16 ProgramFlashByte_File(u16 sectorNum, u32 offset, u8 data);
+static u16 ProgramFlashSector_File(u16 sectorNum, u8 *src);
+static u16 WaitForFlashWrite_File(u8 phase, u8 *addr, u8 lastData);
+
+static const u16 sFileMaxTime[] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
+
+static const struct FlashSetupInfo sFileFlash =
+{
+    ProgramFlashByte_File,
+    ProgramFlashSector_File,
+    EraseFlashChip_File,
+    EraseFlashSector_File,
+    WaitForFlashWrite_File,
+    sFileMaxTime,
+    {
+        FLASH_FILE_SIZE, // ROM size
+        {
+            FLASH_SECTOR_SIZE, // sector size
+            FLASH_SECTOR_SHIFT, // bit shift to multiply by sector size
+            FLASH_SECTOR_COUNT, // number of sectors
+            0
+        },
+        { 3, 1 }, // wait state setup data
+        { { 0xC2, 0x09 } } // Same ID as MX29L010
+    }
+};
+
+// Sets the save file used by IdentifyFlash. Must be called before it.
+void FlashFile_SetPath(const char *path)
+{
+    snprintf(sFlashFilePath, sizeof(sFlashFilePath), "%s", path);
+}
+
+// EMERALD_SAVE_FILE overrides the default save file in the working directory.
+void FlashFile_InitFromEnv(void)
+{
+    const char *path = getenv("EMERALD_SAVE_FILE");
+
+    if (path != NULL && path[0] != '\0')
+        FlashFile_SetPath(path);
+}
+
+// Reads up to size bytes from fd, retrying short reads. Returns the number of
+// bytes read, or -1 on error.
+static ssize_t ReadFully(int fd, u8 *dest, size_t size)
+{
+    size_t total = 0;
+
+    while (total < size)
+    {
+        ssize_t n = read(fd, dest + total, size - total);
+        if (n < 0)
+            return -1;
+        if (n == 0)
+            break;
+        total += n;
+    }
+    return total;
+}
+
+// Maps the save file into memory. A missing or short file reads as erased
+// flash and is written out in full by the first flush. A file larger than the
+// flash chip is not a save file and is rejected.
+static bool8 FlashFile_Open(void)
+{
+    struct stat st;
+    int fd;
+
+    if (sFlashImage != NULL)
+        return TRUE;
+
+    fd = open(sFlashFilePath, O_RDONLY);
+    if (fd >= 0 && fstat(fd, &st) != 0)
+    {
+        close(fd);
+        fd = -1;
+    }
+
+    if (fd >= 0 && st.st_size > FLASH_FILE_SIZE)
+    {
+        close(fd);
+        return FALSE;
+    }
+
+    if (fd >= 0 && st.st_size == FLASH_FILE_SIZE)
+    {
+        // A private mapping keeps the file itself untouched until the next flush.
+        sFlashImage = mmap(NULL, FLASH_FILE_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        if (sFlashImage == MAP_FAILED)
+            sFlashImage = NULL;
+    }
+
+    if (sFlashImage == NULL)
+    {
+        sFlashImage = malloc(FLASH_FILE_SIZE);
+        if (sFlashImage == NULL)
+        {
+            if (fd >= 0)
+                close(fd);
+            return FALSE;
+        }
+        memset(sFlashImage, FLASH_ERASED_BYTE, FLASH_FILE_SIZE);
+        if (fd >= 0 && ReadFully(fd, sFlashImage, st.st_size) < 0)
+            memset(sFlashImage, FLASH_ERASED_BYTE, FLASH_FILE_SIZE);
+        sDirtySectors = ALL_SECTOR_BITS;
+    }
+
+    if (fd >= 0)
+        close(fd);
+    return TRUE;
+}
+
+// Writes len bytes to fd at offset, retrying short writes.
+static bool8 WriteFully(int fd, const u8 *src, size_t len, off_t offset)
+{
+    size_t total = 0;
+
+    while (total < len)
+    {
+        ssize_t n = pwrite(fd, src + total, len - total, offset + total);
+        if (n <= 0)
+            return FALSE;
+        total += n;
+    }
+    return TRUE;
+}
+
+// Writes the dirty sectors of the image to the save file. Returns a mask of
+// the sectors that did not reach the file, 0 if all of them did.
+u32 FlashFile_Flush(void)
+{
+    u32 failed = 0;
+    u16 i;
+    int fd;
+
+    if (sFlashImage == NULL)
+        return ALL_SECTOR_BITS;
+    if (sDirtySectors == 0)
+        return 0;
+
+    fd = open(sFlashFilePath, O_WRONLY | O_CREAT, 0644);
+    if (fd < 0)
+        return sDirtySectors;
+
+    for (i = 0; i < FLASH_SECTOR_COUNT; i++)
+    {
+        if ((sDirtySectors & SECTOR_BIT(i))
+         && !WriteFully(fd, sFlashImage + (i << FLASH_SECTOR_SHIFT), FLASH_SECTOR_SIZE, i << FLASH_SECTOR_SHIFT))
+            failed |= SECTOR_BIT(i);
+    }
+
+    if (fsync(fd) != 0)
+        failed = sDirtySectors;
+    close(fd);
+
+    // Failed sectors stay dirty so a later flush can retry them.
+    sDirtySectors = failed;
+    return failed;
+}
+
+void FlashFile_BeginBatch(void)
+{
+    if (sBatchDepth++ == 0)
+        sBatchSectors = 0;
+}
+
+// Flushes everything written since the matching FlashFile_BeginBatch.
+// Returns a mask of the batch's sectors that could not be written to the
+// save file.
+u32 FlashFile_EndBatch(void)
+{
+    if (sBatchDepth == 0 || --sBatchDepth != 0)
+        return 0;
+
+    return FlashFile_Flush() & sBatchSectors;
+}
+
+// Direct read-only access to a sector of the flash image.
+const u8 *FlashFile_GetSector(u16 sectorNum)
+{
+    if (sFlashImage == NULL || sectorNum >= FLASH_SECTOR_COUNT)
+        return NULL;
+
+    return sFlashImage + (sectorNum << FLASH_SECTOR_SHIFT);
+}
+
+static u16 CommitWrite(u32 sectorBits)
+{
+    sDirtySectors |= sectorBits;
+    if (sBatchDepth != 0)
+    {
+        sBatchSectors |= sectorBits;
+        return 0;
+    }
+
+    return (FlashFile_Flush() & sectorBits) ? 0x8000 : 0;
+}
+
+static u16 EraseFlashChip_File(void)
+{
+    if (sFlashImage == NULL)
+        return 0x8000;
+
+    memset(sFlashImage, FLASH_ERASED_BYTE, FLASH_FILE_SIZE);
+    return CommitWrite(ALL_SECTOR_BITS);
+}
+
+static u16 EraseFlashSector_File(u16 sectorNum)
+{
+    if (sFlashImage == NULL || sectorNum >= FLASH_SECTOR_COUNT)
+        return 0x80FF;
+
+    memset(sFlashImage + (sectorNum << FLASH_SECTOR_SHIFT), FLASH_ERASED_BYTE, FLASH_SECTOR_SIZE);
+    return CommitWrite(SECTOR_BIT(sectorNum));
+}
+
+static u16 ProgramFlashByte_File(u16 sectorNum, u32 offset, u8 data)
+{
+    if (sFlashImage == NULL || sectorNum >= FLASH_SECTOR_COUNT || offset >= FLASH_SECTOR_SIZE)
+        return 0x80FF;
+
+    // Like the real chip, programming can only clear bits of an erased byte.
+    sFlashImage[(sectorNum << FLASH_SECTOR_SHIFT) + offset] &= data;
+    return CommitWrite(SECTOR_BIT(sectorNum));
+}
+
+static u16 ProgramFlashSector_File(u16 sectorNum, u8 *src)
+{
+    if (sFlashImage == NULL || sectorNum >= FLASH_SECTOR_COUNT)
+        return 0x80FF;
+
+    // Programming a whole sector erases it first, so this is a plain copy.
+    memcpy(sFlashImage + (sectorNum << FLASH_SECTOR_SHIFT), src, FLASH_SECTOR_SIZE);
+    gFlashNumRemainingBytes = 0;
+    return CommitWrite(SECTOR_BIT(sectorNum));
+}
+
+static u16 WaitForFlashWrite_File(u8 phase, u8 *addr, u8 lastData)
+{
+    return 0;
+}
+
+u16 IdentifyFlash(void)
+{
+    if (!FlashFile_Open())
+        return 1;
+
+    ProgramFlashByte = sFileFlash.programFlashByte;
+    ProgramFlashSector = sFileFlash.programFlashSector;
+    EraseFlashChip = sFileFlash.eraseFlashChip;
+    EraseFlashSector = sFileFlash.eraseFlashSector;
+    WaitForFlashWrite = sFileFlash.WaitForFlashWrite;
+    gFlashMaxTime = sFileFlash.maxTime;
+    gFlash = &sFileFlash.type;
+
+    return 0;
+}
+
+static void FlashTimerIntr(void)
+{
+}
+
+u16 SetFlashTimerIntr(u8 timerNum, void (**intrFunc)(void))
+{
+    if (timerNum >= 4)
+        return 1;
+
+    *intrFunc = FlashTimerIntr;
+    return 0;
+}
+
+void ReadFlash(u16 sectorNum, u32 offset, u8 *dest, u32 size)
+{
+    const u8 *sector = FlashFile_GetSector(sectorNum);
+
+    if (sector == NULL)
+    {
+        memset(dest, FLASH_ERASED_BYTE, size);
+        return;
+    }
+
+    memcpy(dest, sector + offset, size);
+}
+
+u32 VerifyFlashSectorNBytes(u16 sectorNum, u8 *src, u32 n)
+{
+    const u8 *sector = FlashFile_GetSector(sectorNum);
+
+    if (sector == NULL)
+        return 1;
+
+    return memcmp(src, sector, n) != 0;
+}
+
+u32 VerifyFlashSector(u16 sectorNum, u8 *src)
+{
+    return VerifyFlashSectorNBytes(sectorNum, src, FLASH_SECTOR_SIZE);
+}
+
+// The image can't fail to take a write, so there is nothing to retry here.
+u32 ProgramFlashSectorAndVerify(u16 sectorNum, u8 *src)
+{
+    u32 result = ProgramFlashSector(sectorNum, src);
+
+    if (result == 0)
+        result = VerifyFlashSector(sectorNum, src);
+    return result;
+}
+
+u32 ProgramFlashSectorAndVerifyNBytes(u16 sectorNum, u8 *src, u32 n)
+{
+    u32 result = ProgramFlashSector(sectorNum, src);
+
+    if (result == 0)
+        result = VerifyFlashSectorNBytes(sectorNum, src, n);
+    return result;
+}
+
+#endif // PORTABLE
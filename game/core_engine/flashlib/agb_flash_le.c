@@ -1,6 +1,8 @@
 #include "gba/gba.h"
 #include "gba/flash_internal.h"
 
+#ifndef PORTABLE
+
 const u16 leMaxTime[] =
 {
       10, 65469, TIMER_ENABLE | TIMER_INTR_ENABLE | TIMER_256CLK,
@@ -29,3 +31,5 @@ const struct FlashSetupInfo LE26FV10N1TS =
         { { 0x62, 0x13 } } // ID
     }
 };
+
+#endif // PORTABLE
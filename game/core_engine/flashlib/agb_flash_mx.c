@@ -1,6 +1,8 @@
 #include "gba/gba.h"
 #include "gba/flash_internal.h"
 
+#ifndef PORTABLE
+
 const u16 mxMaxTime[] =
 {
       10, 65469, TIMER_ENABLE | TIMER_INTR_ENABLE | TIMER_256CLK,
@@ -191,3 +193,5 @@ u16 ProgramFlashSector_MX(u16 sectorNum, u8 *src)
 
     return result;
 }
+
+#endif // PORTABLE
@@ -726,4 +726,122 @@ extern u8 gMultiUsePlayerCursor;
 extern u8 gNumberOfMovesToChoose;
 extern u8 gBattleControllerData[MAX_BATTLERS_COUNT];
 
+#ifdef PORTABLE
+// A snapshot of a battle in progress: the battle type and opponents, the
+// battle globals above including the controllers' state and buffers, the
+// structs that gBattleStruct, gBattleResources and gBattleSpritesDataPtr point
+// to, both parties and the battle RNG. It is a copy, not a view: the battle
+// engine always runs on the globals. BattleContext_Save copies the live
+// battle out and BattleContext_Load copies a snapshot back, so several
+// battles can be held in memory and run in turn on the same engine.
+// Graphics (sprites, BGs, palettes) aren't part of it.
+struct BattleContext
+{
+    u32 battleTypeFlags;
+    u8 battleTerrain;
+    u16 trainerBattleOpponentA;
+    u16 trainerBattleOpponentB;
+    u8 battleBufferA[MAX_BATTLERS_COUNT][0x200];
+    u8 battleBufferB[MAX_BATTLERS_COUNT][0x200];
+    u8 activeBattler;
+    u32 battleControllerExecFlags;
+    u8 battlersCount;
+    u16 battlerPartyIndexes[MAX_BATTLERS_COUNT];
+    u8 battlerPositions[MAX_BATTLERS_COUNT];
+    u8 actionsByTurnOrder[MAX_BATTLERS_COUNT];
+    u8 battlerByTurnOrder[MAX_BATTLERS_COUNT];
+    u8 currentTurnActionNumber;
+    u8 currentActionFuncId;
+    struct BattlePokemon battleMons[MAX_BATTLERS_COUNT];
+    u8 currMovePos;
+    u8 chosenMovePos;
+    u16 currentMove;
+    u16 chosenMove;
+    u16 calledMove;
+    s32 battleMoveDamage;
+    s32 hpDealt;
+    s32 bideDmg[MAX_BATTLERS_COUNT];
+    u16 lastUsedItem;
+    u8 lastUsedAbility;
+    u8 battlerAttacker;
+    u8 battlerTarget;
+    u8 battlerFainted;
+    u8 effectBattler;
+    u8 potentialItemEffectBattler;
+    u8 absentBattlerFlags;
+    u8 critMultiplier;
+    u8 multiHitCounter;
+    const u8 *battlescriptCurrInstr;
+    u8 chosenActionByBattler[MAX_BATTLERS_COUNT];
+    const u8 *selectionBattleScripts[MAX_BATTLERS_COUNT];
+    const u8 *palaceSelectionBattleScripts[MAX_BATTLERS_COUNT];
+    u16 lastPrintedMoves[MAX_BATTLERS_COUNT];
+    u16 lastMoves[MAX_BATTLERS_COUNT];
+    u16 lastLandedMoves[MAX_BATTLERS_COUNT];
+    u16 lastHitByType[MAX_BATTLERS_COUNT];
+    u16 lastResultingMoves[MAX_BATTLERS_COUNT];
+    u16 lockedMoves[MAX_BATTLERS_COUNT];
+    u8 lastHitBy[MAX_BATTLERS_COUNT];
+    u16 chosenMoveByBattler[MAX_BATTLERS_COUNT];
+    u8 moveResultFlags;
+    u32 hitMarker;
+    u8 bideTarget[MAX_BATTLERS_COUNT];
+    u16 sideStatuses[NUM_BATTLE_SIDES];
+    struct SideTimer sideTimers[NUM_BATTLE_SIDES];
+    u32 statuses3[MAX_BATTLERS_COUNT];
+    struct DisableStruct disableStructs[MAX_BATTLERS_COUNT];
+    u16 pauseCounterBattle;
+    u16 paydayMoney;
+    u16 randomTurnNumber;
+    u8 battleCommunication[BATTLE_COMMUNICATION_ENTRIES_COUNT];
+    u8 battleOutcome;
+    struct ProtectStruct protectStructs[MAX_BATTLERS_COUNT];
+    struct SpecialStatus specialStatuses[MAX_BATTLERS_COUNT];
+    u16 battleWeather;
+    struct WishFutureKnock wishFutureKnock;
+    u8 sentPokesToOpponent[2];
+    u16 dynamicBasePower;
+    u16 expShareExp;
+    struct BattleEnigmaBerry enigmaBerries[MAX_BATTLERS_COUNT];
+    struct BattleScripting battleScripting;
+    u8 actionSelectionCursor[MAX_BATTLERS_COUNT];
+    u8 moveSelectionCursor[MAX_BATTLERS_COUNT];
+    u32 transformedPersonalities[MAX_BATTLERS_COUNT];
+    u16 battleMovePower;
+    u16 moveToLearn;
+    u8 battleMonForms[MAX_BATTLERS_COUNT];
+    void (*battleMainFunc)(void);
+    struct BattleResults battleResults;
+    u8 leveledUpInBattle;
+    void (*battlerControllerFuncs[MAX_BATTLERS_COUNT])(void);
+    u8 battleControllerData[MAX_BATTLERS_COUNT];
+    u8 battlerInMenuId;
+    bool8 doingBattleAnim;
+    u8 multiUsePlayerCursor;
+    u8 numberOfMovesToChoose;
+    u8 battleTextBuff1[TEXT_BUFF_ARRAY_COUNT];
+    u8 battleTextBuff2[TEXT_BUFF_ARRAY_COUNT];
+    u8 battleTextBuff3[TEXT_BUFF_ARRAY_COUNT];
+
+    struct BattleStruct battleStruct;
+    struct ResourceFlags resourceFlags;
+    struct BattleScriptsStack battleScriptsStack;
+    struct BattleCallbacksStack battleCallbackStack;
+    struct StatsArray beforeLvlUp;
+    struct AI_ThinkingStruct ai;
+    struct BattleHistory battleHistory;
+    struct BattleScriptsStack aiScriptsStack;
+    struct BattleSpriteInfo battlerData[MAX_BATTLERS_COUNT];
+    struct BattleHealthboxInfo healthBoxesData[MAX_BATTLERS_COUNT];
+    struct BattleAnimationInfo animationData;
+
+    struct Pokemon playerParty[PARTY_SIZE];
+    struct Pokemon enemyParty[PARTY_SIZE];
+    u32 rngValue;
+};
+
+void BattleContext_Save(struct BattleContext *context);
+void BattleContext_Load(const struct BattleContext *context);
+#endif // PORTABLE
+
 #endif // GUARD_BATTLE_H
@@ -0,0 +1,22 @@
+#ifndef GUARD_BATTLE_AI_LOOKAHEAD_H
+#define GUARD_BATTLE_AI_LOOKAHEAD_H
+
+#ifdef PORTABLE
+
+struct BattleAILookaheadSettings
+{
+    bool8 inFrontier;           // give Battle Frontier opponents AI_SCRIPT_LOOKAHEAD
+    u8 turns;                   // turns played out after each candidate
+    u8 rolloutsPerCandidate;    // upper bound, fewer when the step budget runs out
+    u32 stepBudget;             // battle engine steps per decision, over all its rollouts
+};
+
+extern struct BattleAILookaheadSettings gBattleAILookahead;
+
+bool8 BattleAI_HasLookahead(void);
+void BattleAI_LookaheadChooseAction(void);
+u8 BattleAI_LookaheadChooseMove(const s8 *scores, u8 scriptChoice);
+
+#endif // PORTABLE
+
+#endif // GUARD_BATTLE_AI_LOOKAHEAD_H
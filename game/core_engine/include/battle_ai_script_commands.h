@@ -15,4 +15,21 @@ void ClearBattlerAbilityHistory(u8 battlerId);
 void RecordItemEffectBattle(u8 battlerId, u8 itemEffect);
 void ClearBattlerItemEffectHistory(u8 battlerId);
 
+#ifdef PORTABLE
+// How BattleAI_ChooseMoveOrAction runs the AI scripts. In the differential
+// mode every script runs both ways from the same state; the interpreter's
+// result is kept and each difference counts towards gBattleAIScriptMismatches.
+enum
+{
+    BATTLE_AI_SCRIPTS_COMPILED,
+    BATTLE_AI_SCRIPTS_INTERPRETED,
+    BATTLE_AI_SCRIPTS_DIFFERENTIAL,
+};
+
+extern u8 gBattleAIScriptMode;
+extern u32 gBattleAIScriptMismatches;
+
+void BattleAI_InitFromEnv(void);
+#endif
+
 #endif // GUARD_BATTLE_AI_SCRIPT_COMMANDS_H
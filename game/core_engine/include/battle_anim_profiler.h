@@ -0,0 +1,49 @@
+#ifndef GUARD_BATTLE_ANIM_PROFILER_H
+#define GUARD_BATTLE_ANIM_PROFILER_H
+
+#ifdef PORTABLE
+
+#include "constants/moves.h"
+
+// Which table an animation was launched from
+enum
+{
+    BATTLE_ANIM_TABLE_MOVES,
+    BATTLE_ANIM_TABLE_GENERAL,
+    BATTLE_ANIM_TABLE_SPECIAL,
+    BATTLE_ANIM_TABLE_STATUS,
+    BATTLE_ANIM_TABLE_COUNT,
+};
+
+#define BATTLE_ANIM_PROFILE_MAX_IDS MOVES_COUNT
+
+// Totals over every run of one animation script
+struct BattleAnimProfile
+{
+    u32 runs;
+    u32 totalFrames;
+    u32 maxFrames;
+    u16 peakSprites;
+    u16 peakTasks;
+    u32 tilesLoaded;
+    u32 palettesLoaded;
+    u64 callbackNs;       // in task funcs and sprite callbacks while it ran
+    u64 maxFrameNs;       // most callback time spent in a single frame
+    const void *worstCallback; // the callback with the longest single call
+    u64 worstCallbackNs;
+};
+
+void BattleAnimProfiler_Enable(bool8 enable);
+void BattleAnimProfiler_Reset(void);
+const struct BattleAnimProfile *BattleAnimProfiler_GetProfile(u8 table, u16 id);
+bool8 BattleAnimProfiler_WriteCsv(const char *animsPath, const char *callbacksPath);
+void BattleAnimProfiler_InitFromEnv(void);
+
+// Hooks for battle_anim.c
+void BattleAnimProfiler_Begin(const u8 *const animsTable[], u16 tableId);
+void BattleAnimProfiler_Frame(void);
+void BattleAnimProfiler_End(void);
+
+#endif // PORTABLE
+
+#endif // GUARD_BATTLE_ANIM_PROFILER_H
@@ -280,4 +280,14 @@ void SetControllerToLinkOpponent(void);
 // link partner
 void SetControllerToLinkPartner(void);
 
+#ifdef PORTABLE
+#include "constants/moves.h"
+
+// headless controller
+extern bool8 gHeadlessBattle;
+extern u32 gHeadlessMoveUses[NUM_BATTLE_SIDES][MOVES_COUNT]; // moves chosen by each side, reset by RunHeadlessBattle
+
+void SetControllerToHeadless(void);
+#endif
+
 #endif // GUARD_BATTLE_CONTROLLERS_H
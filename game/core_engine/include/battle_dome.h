@@ -6,4 +6,31 @@ extern u32 gPlayerPartyLostHP;
 int GetDomeTrainerSelectedMons(u16 tournamentTrainerId);
 int TrainerIdToDomeTournamentId(u16 trainerId);
 
+#ifdef PORTABLE
+
+#include "constants/battle_frontier_trainers.h"
+
+struct DomeTournamentSummary
+{
+    u32 tournaments;
+    u32 entries[FRONTIER_TRAINERS_COUNT];
+    u32 wins[FRONTIER_TRAINERS_COUNT];
+    u64 elapsedNs;
+};
+
+struct DomeEvalBenchmark
+{
+    u32 tournaments;
+    u64 scalarNs;
+    u64 batchedNs;
+    bool8 resultsMatch;
+};
+
+extern bool8 gDomeBatchedMatchups; // score NPC vs NPC rounds with the batched evaluator
+
+void DomeEval_RunTournaments(u32 baseSeed, u32 count, struct DomeTournamentSummary *summary);
+void DomeEval_Benchmark(u32 baseSeed, u32 count, struct DomeEvalBenchmark *result);
+
+#endif // PORTABLE
+
 #endif // GUARD_BATTLE_DOME_H
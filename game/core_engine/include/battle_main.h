@@ -77,6 +77,31 @@ void RunBattleScriptCommands(void);
 bool8 TryRunFromBattle(u8 battlerId);
 void SpecialStatusesClear(void);
 
+#ifdef PORTABLE
+struct HeadlessBattleSpec
+{
+    u32 battleTypeFlags;
+    u16 opponentA;
+    u16 opponentB;
+    u8 terrain;
+    bool8 createOpponentParty; // build gEnemyParty from the opponents' trainer data
+    u8 maxTurns; // 0 for no limit
+    u32 maxSteps; // battle engine steps (frames on hardware), 0 for no limit
+    u32 rngSeed;
+};
+
+struct HeadlessBattleResult
+{
+    u8 outcome; // B_OUTCOME_*, 0 if a limit was reached first
+    u8 turns;
+    u32 steps;
+    u32 aiScriptMismatches; // AI scripts whose compiled and interpreted runs differed, see gBattleAIScriptMode
+};
+
+u8 RunHeadlessBattle(const struct HeadlessBattleSpec *spec, struct HeadlessBattleResult *result);
+u32 ContinueBattleHeadless(u8 turnCount, u32 stepLimit);
+#endif
+
 extern struct MultiPartnerMenuPokemon gMultiPartnerParty[MULTI_PARTY_SIZE];
 
 extern const struct SpriteTemplate gUnusedBattleInitSprite;
@@ -0,0 +1,91 @@
+#ifndef GUARD_BATTLE_REPLAY_H
+#define GUARD_BATTLE_REPLAY_H
+
+#ifdef PORTABLE
+
+#include "battle_ai_lookahead.h"
+
+// Replays are the host's counterpart to recorded battles: no size limit, a
+// versioned file format, and playback through the headless battle runner so
+// a corpus of battles can be checked against engine changes. See
+// battle_replay.c for the file layout.
+
+#define BATTLE_REPLAY_VERSION 1
+
+// Results of BattleReplay_Verify
+enum
+{
+    BATTLE_REPLAY_MATCH,
+    BATTLE_REPLAY_BAD_FILE,         // unreadable, or recorded from a battle that didn't finish
+    BATTLE_REPLAY_DESYNC_RNG,       // RNG differed at the end of a turn
+    BATTLE_REPLAY_DESYNC_ACTIONS,   // a battler's actions differed
+    BATTLE_REPLAY_DESYNC_RESULT,    // same actions, different outcome or parties
+    BATTLE_REPLAY_OUT_OF_ACTIONS,   // a replayed battler needed more actions than were recorded
+    BATTLE_REPLAY_STEP_LIMIT,
+    BATTLE_REPLAY_AI_SCRIPT_MISMATCH, // matched, but the compiled AI scripts differed, see gBattleAIScriptMode
+    BATTLE_REPLAY_RESULT_COUNT,
+};
+
+struct BattleReplayTurn
+{
+    u32 rngValue;                           // when the turn ended
+    u32 actionCounts[MAX_BATTLERS_COUNT];   // actions recorded up to then
+};
+
+struct BattleReplay
+{
+    bool8 complete; // the battle ran to its end while being recorded
+    u8 inputBattlers; // bit per battler whose actions are played back; the others are rerun by their AI
+    u8 terrain;
+    u8 outcome;
+    u32 battleTypeFlags;
+    u16 opponentA;
+    u16 opponentB;
+    u16 partnerId;
+    u16 turnsTaken;
+    u32 rngSeed; // when the battle intro started
+    u32 partyChecksum; // of both parties when the battle ended
+    struct BattleAILookaheadSettings lookahead; // off in replays from before it was recorded
+    struct Pokemon playerParty[PARTY_SIZE];
+    struct Pokemon enemyParty[PARTY_SIZE];
+    // Same bytes as sBattleRecords in recorded_battle.c, plus the items used
+    u8 *actions[MAX_BATTLERS_COUNT];
+    u32 actionCounts[MAX_BATTLERS_COUNT];
+    u32 actionCapacities[MAX_BATTLERS_COUNT];
+    struct BattleReplayTurn *turns;
+    u32 turnCount;
+    u32 turnCapacity;
+};
+
+struct BattleReplayCheck
+{
+    u8 result; // BATTLE_REPLAY_*
+    u8 outcome;
+    u16 turn; // where the first difference was found
+};
+
+void BattleReplay_StartRecording(struct BattleReplay *replay);
+void BattleReplay_Free(struct BattleReplay *replay);
+bool8 BattleReplay_Read(struct BattleReplay *replay, const u8 *data, u32 size);
+u8 *BattleReplay_Write(const struct BattleReplay *replay, u32 *size);
+bool8 BattleReplay_Load(struct BattleReplay *replay, const char *path);
+bool8 BattleReplay_Save(const struct BattleReplay *replay, const char *path);
+u8 BattleReplay_Verify(const struct BattleReplay *replay, struct BattleReplayCheck *check);
+u32 BattleReplay_VerifyFiles(const char *const *paths, u32 count, u32 workerCount, u8 *results);
+void BattleReplay_InitFromEnv(void);
+
+// Hooks for the battle engine
+void BattleReplay_RecordBattle(void);
+void BattleReplay_StartBattle(void);
+void BattleReplay_TurnPassed(void);
+void BattleReplay_EndBattle(void);
+void BattleReplay_RecordAction(u8 battlerId, u8 action);
+void BattleReplay_ClearActions(u8 battlerId, u8 count);
+void BattleReplay_RecordItem(u8 battlerId, u16 itemId);
+bool8 BattleReplay_IsInputBattler(u8 battlerId);
+bool8 BattleReplay_ReadActions(u8 battlerId, u8 *dst, u8 count);
+void BattleReplay_SetPaused(bool8 paused);
+
+#endif // PORTABLE
+
+#endif // GUARD_BATTLE_REPLAY_H
@@ -0,0 +1,31 @@
+#ifndef GUARD_BATTLE_SIM_H
+#define GUARD_BATTLE_SIM_H
+
+#ifdef PORTABLE
+
+#include "constants/moves.h"
+
+// Runs many headless battles from the same starting state and aggregates
+// their results. Battle i is seeded from the spec's seed and i alone, so a
+// summary doesn't depend on how many workers produced it.
+
+#define BATTLE_SIM_MAX_TURNS 256
+
+struct BattleSimSummary
+{
+    u32 battles;
+    u32 outcomes[B_OUTCOME_MON_TELEPORTED + 1]; // indexed by B_OUTCOME_*, [0] counts battles that hit a limit
+    u64 totalTurns;
+    u32 turnCounts[BATTLE_SIM_MAX_TURNS]; // battles by number of turns taken
+    u32 moveUses[NUM_BATTLE_SIDES][MOVES_COUNT];
+    u32 aiScriptMismatches; // must stay 0 when run with BATTLE_AI_SCRIPTS_DIFFERENTIAL
+};
+
+void BattleSim_Run(const struct HeadlessBattleSpec *spec, u32 battleCount, u32 workerCount, struct BattleSimSummary *summary);
+u32 BattleSim_GetWinRate(const struct BattleSimSummary *summary); // per 10000
+bool8 BattleSim_CheckWorkers(const struct HeadlessBattleSpec *spec, u32 battleCount, u32 workerCount);
+void BattleSim_InitFromEnv(void);
+
+#endif // PORTABLE
+
+#endif // GUARD_BATTLE_SIM_H
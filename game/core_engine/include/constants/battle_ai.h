@@ -44,7 +44,8 @@
 #define AI_SCRIPT_DOUBLE_BATTLE         (1 << 7)
 #define AI_SCRIPT_HP_AWARE              (1 << 8)
 #define AI_SCRIPT_TRY_SUNNY_DAY_START   (1 << 9)
-// 10 - 28 are not used
+#define AI_SCRIPT_LOOKAHEAD             (1 << 10) // PORTABLE only, see battle_ai_lookahead.c
+// 11 - 28 are not used
 #define AI_SCRIPT_ROAMING               (1 << 29)
 #define AI_SCRIPT_SAFARI                (1 << 30)
 #define AI_SCRIPT_FIRST_BATTLE          (1 << 31)
@@ -0,0 +1,22 @@
+#ifndef GUARD_EVENT_OBJECT_INDEX_H
+#define GUARD_EVENT_OBJECT_INDEX_H
+
+#ifdef PORTABLE
+
+// Hash indexes over gObjectEvents, so that looking up object events by
+// position or by (localId, map) doesn't scan every slot. This keeps
+// per-step collision checks cheap when OBJECT_EVENTS_COUNT is raised.
+//
+// Code that changes an object event's coords, ids or active state should
+// call ObjectEventIndex_Update afterwards. ObjectEventIndex_Sync, which runs
+// once per overworld frame, picks up any change that was missed.
+
+void ObjectEventIndex_Reset(void);
+void ObjectEventIndex_Update(u8 objectEventId);
+void ObjectEventIndex_Sync(void);
+u8 ObjectEventIndex_GetIdsAtCoords(s16 x, s16 y, bool8 includePrevious, u8 *objectEventIds);
+u8 ObjectEventIndex_GetIdByLocalIdAndMap(u16 localId, u8 mapNum, u8 mapGroup);
+
+#endif // PORTABLE
+
+#endif // GUARD_EVENT_OBJECT_INDEX_H
@@ -28,5 +28,12 @@ void SetCameraPanning(s16 horizontal, s16 vertical);
 void InstallCameraPanAheadCallback(void);
 void UpdateCameraPanning(void);
 void FieldUpdateBgTilemapScroll(void);
+#ifdef PORTABLE
+void FieldMapView_SetEnabled(bool8 enabled);
+void FieldMapView_Free(void);
+void FieldMapView_InvalidateAll(void);
+void FieldMapView_InvalidateMetatileAt(int x, int y);
+void FieldMapView_SyncBgTilemaps(void);
+#endif
 
 #endif //GUARD_FIELD_CAMERA_H
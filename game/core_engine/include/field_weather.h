@@ -171,6 +171,20 @@ void SetWeatherPalStateIdle(void);
 void PreservePaletteInWeather(u8 preservedPalIndex);
 void ResetPreservedPalettesInWeather(void);
 
+#ifdef PORTABLE
+struct WeatherColorMapBenchmark
+{
+    u32 iterations;
+    u64 scalarNs[3]; // rain/shade fade and lightning ramp, drought fade, fog fade
+    u64 lutNs[3];
+    bool8 resultsMatch;
+};
+
+extern bool8 gWeatherColorMapLuts; // apply weather color maps through baked RGB555 tables
+
+void WeatherColorMap_Benchmark(u32 iterations, struct WeatherColorMapBenchmark *result);
+#endif // PORTABLE
+
 // field_weather_effect.c
 void Clouds_InitVars(void);
 void Clouds_Main(void);
@@ -0,0 +1,62 @@
+#ifndef GUARD_FRONTIER_PARTY_GEN_H
+#define GUARD_FRONTIER_PARTY_GEN_H
+
+#ifdef PORTABLE
+
+#include "battle_tower.h"
+#include "constants/battle_frontier.h"
+#include "constants/species.h"
+
+// Frontier parties may not repeat a species or a held item. Instead of
+// drawing facility mons at random and retrying on a clash, candidates are
+// kept in pools that already leave out what the level mode forbids, and what
+// a party has taken so far is tracked in bitsets, so each draw is a single
+// pass over the pool.
+
+#define FRONTIER_SPECIES_BITSET_WORDS ((NUM_SPECIES + 31) / 32)
+#define FRONTIER_ITEM_BITSET_WORDS    (256 / 32) // by itemTableId
+#define FRONTIER_POOL_NO_ITEM         0xFF
+
+struct FrontierMonPool
+{
+    u16 count;
+    u16 *monIds;
+    u16 *species;
+    u8 *itemTableIds; // FRONTIER_POOL_NO_ITEM for mons that hold nothing
+};
+
+struct FrontierPartyExclusions
+{
+    u32 species[FRONTIER_SPECIES_BITSET_WORDS];
+    u32 items[FRONTIER_ITEM_BITSET_WORDS];
+};
+
+// A party chosen ahead of time, turned into mons by CreateFrontierPartyFromSpec
+struct FrontierPartySpec
+{
+    u16 trainerId;
+    u8 fixedIV;
+    u8 monCount;
+    u32 otId;
+    u16 monIds[MAX_FRONTIER_PARTY_SIZE];
+};
+
+bool8 BuildFrontierMonPool(struct FrontierMonPool *pool, const u16 *monIds, u16 count, bool8 allowHighTier);
+bool8 BuildFrontierMonPoolFromRange(struct FrontierMonPool *pool, u16 firstMonId, u16 lastMonId, bool8 allowHighTier, u16 excludedSpecies);
+void FreeFrontierMonPool(struct FrontierMonPool *pool);
+const struct FrontierMonPool *GetFrontierTrainerMonPool(u16 trainerId, bool8 allowHighTier);
+void ExcludeFrontierSpecies(struct FrontierPartyExclusions *exclusions, u16 species);
+void ExcludeFrontierMon(struct FrontierPartyExclusions *exclusions, u16 monId);
+bool8 SampleFrontierMons(const struct FrontierMonPool *pool, struct FrontierPartyExclusions *exclusions, u16 *monIds, u8 count);
+void CreateFacilityMon(struct Pokemon *mon, u16 monId, u8 level, u8 fixedIV, u32 otId, bool8 isRental);
+
+// battle_tower.c
+u16 GenerateFrontierStreak(u8 challengeNum, bool8 allowHighTier, u8 monCount, struct FrontierPartySpec *parties, u16 battleCount);
+void CreateFrontierPartyFromSpec(const struct FrontierPartySpec *spec, struct Pokemon *party, u8 level);
+
+// battle_factory.c
+bool8 GenerateFactoryOpponentMonIds(u8 lvlMode, u8 challengeNum, const u16 *rentalMonIds, u8 rentalCount, u16 *monIds);
+
+#endif // PORTABLE
+
+#endif // GUARD_FRONTIER_PARTY_GEN_H
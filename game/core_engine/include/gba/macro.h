@@ -71,6 +71,7 @@
         _Static_assert(_Alignof(src) >= __builtin_choose_expr(__builtin_constant_p(control), ((control) & (DMA_32BIT << 16)) ? 4 : 2, 2), "source potentially unaligned"); \
         _Static_assert(_Alignof(dest) >= __builtin_choose_expr(__builtin_constant_p(control), ((control) & (DMA_32BIT << 16)) ? 4 : 2, 2), "destination potentially unaligned"); \
         DmaSetUnchecked(dmaNum, src, dest, control); \
+        MARK_VRAM_WRITTEN(dest, ((control) & 0xFFFF) * (((control) & (DMA_32BIT << 16)) ? 4 : 2)); \
     } while (0)
 #else
 #define DmaSet(dmaNum, src, dest, control) \
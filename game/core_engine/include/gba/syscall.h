@@ -21,6 +21,16 @@ u16 Sqrt(u32 num);
 
 u16 ArcTan2(s16 x, s16 y);
 
+#ifdef PORTABLE
+// The frame renderer only copies the VRAM written since it last captured a
+// frame, so copies, fills and decompressions report what they wrote. Code that
+// writes VRAM through a pointer marks it itself.
+void FrameRender_MarkVramWritten(uintptr_t dest, u32 size);
+#define MARK_VRAM_WRITTEN(dest, size) FrameRender_MarkVramWritten((uintptr_t)(dest), size)
+#else
+#define MARK_VRAM_WRITTEN(dest, size)
+#endif
+
 #define CPU_SET_SRC_FIXED 0x01000000
 #define CPU_SET_16BIT     0x00000000
 #define CPU_SET_32BIT     0x04000000
@@ -36,6 +46,7 @@ void CpuSet(const void *src, void *dest, u32 control);
         _Static_assert(_Alignof(src) >= __builtin_choose_expr(__builtin_constant_p(control), ((control) & CPU_SET_32BIT) ? 4 : 2, 2), "source potentially unaligned"); \
         _Static_assert(_Alignof(dest) >= __builtin_choose_expr(__builtin_constant_p(control), ((control) & CPU_SET_32BIT) ? 4 : 2, 2), "destination potentially unaligned"); \
         CpuSet(src, dest, control); \
+        MARK_VRAM_WRITTEN(dest, ((control) & 0x1FFFFF) * (((control) & CPU_SET_32BIT) ? 4 : 2)); \
     } while (0)
 #endif
 
@@ -50,6 +61,7 @@ void CpuFastSet(const void *src, void *dest, u32 control);
         _Static_assert(_Alignof(src) >= 4, "source potentially unaligned"); \
         _Static_assert(_Alignof(dest) >= 4, "destination potentially unaligned"); \
         CpuFastSet(src, dest, control); \
+        MARK_VRAM_WRITTEN(dest, ((control) & 0x1FFFFF) * 4); \
     } while (0)
 #endif
 
@@ -61,10 +73,29 @@ void LZ77UnCompWram(const u32 *src, void *dest);
 
 void LZ77UnCompVram(const u32 *src, void *dest);
 
+#ifdef PORTABLE
+// The decompressed size is in the data's header.
+#define LZ77UnCompVram(src, dest) \
+    do \
+    { \
+        LZ77UnCompVram(src, dest); \
+        MARK_VRAM_WRITTEN(dest, *(const u32 *)(src) >> 8); \
+    } while (0)
+#endif
+
 void RLUnCompWram(const void *src, void *dest);
 
 void RLUnCompVram(const void *src, void *dest);
 
+#ifdef PORTABLE
+#define RLUnCompVram(src, dest) \
+    do \
+    { \
+        RLUnCompVram(src, dest); \
+        MARK_VRAM_WRITTEN(dest, *(const u32 *)(src) >> 8); \
+    } while (0)
+#endif
+
 int MultiBoot(struct MultiBootParam *mp);
 
 s32 Div(s32 num, s32 denom);
@@ -126,5 +126,10 @@ u8 AddScrollIndicatorArrowPair(const struct ScrollArrowsTemplate *arrowInfo, u16
 u8 AddScrollIndicatorArrowPairParameterized(u32 arrowType, s32 commonPos, s32 firstPos, s32 secondPos, s32 fullyDownThreshold, s32 tileTag, s32 palTag, u16 *currItemPtr);
 void RemoveScrollIndicatorArrowPair(u8 taskId);
 void Task_ScrollIndicatorArrowPairOnMainMenu(u8 taskId);
+#ifdef PORTABLE
+extern bool8 gListMenuRowCache;
+// For lists whose itemPrintFunc output depends only on the item id.
+void ListMenuEnableRowCache(u8 listTaskId);
+#endif
 
 #endif //GUARD_LIST_MENU_H
@@ -231,6 +231,19 @@ struct Pokemon
     u16 spDefense;
 };
 
+// A BoxPokemon decrypted by OpenBoxMon, so that several of its encrypted
+// fields can be accessed without decrypting it again for each one.
+struct OpenBoxPokemon
+{
+    struct BoxPokemon *boxMon;
+    struct PokemonSubstruct0 *substruct0;
+    struct PokemonSubstruct1 *substruct1;
+    struct PokemonSubstruct2 *substruct2;
+    struct PokemonSubstruct3 *substruct3;
+    bool8 isBadEgg; // Checksum didn't match on open
+    bool8 modified; // An encrypted field was written, so the checksum is recomputed on close
+};
+
 struct MonSpritesGfxManager
 {
     u32 numSprites:4;
@@ -417,6 +430,7 @@ void CalculateMonStats(struct Pokemon *mon);
 void BoxMonToMon(const struct BoxPokemon *src, struct Pokemon *dest);
 u8 GetLevelFromMonExp(struct Pokemon *mon);
 u8 GetLevelFromBoxMonExp(struct BoxPokemon *boxMon);
+u8 GetLevelFromOpenBoxMonExp(struct OpenBoxPokemon *open);
 u16 GiveMoveToMon(struct Pokemon *mon, u16 move);
 u16 GiveMoveToBattleMon(struct BattlePokemon *mon, u16 move);
 void SetMonMoveSlot(struct Pokemon *mon, u16 move, u8 slot);
@@ -450,6 +464,10 @@ u32 GetBoxMonData2(struct BoxPokemon *boxMon, s32 field);
 
 void SetMonData(struct Pokemon *mon, s32 field, const void *dataArg);
 void SetBoxMonData(struct BoxPokemon *boxMon, s32 field, const void *dataArg);
+void OpenBoxMon(struct OpenBoxPokemon *open, struct BoxPokemon *boxMon);
+void CloseBoxMon(struct OpenBoxPokemon *open);
+u32 GetOpenBoxMonData(struct OpenBoxPokemon *open, s32 field, u8 *data);
+void SetOpenBoxMonData(struct OpenBoxPokemon *open, s32 field, const void *dataArg);
 void CopyMon(void *dest, void *src, size_t size);
 u8 GiveMonToPlayer(struct Pokemon *mon);
 u8 CalculatePlayerPartyCount(void);
@@ -39,5 +39,8 @@ u8 GetRecordedBattleRecordMixFriendLanguage(void);
 u8 GetRecordedBattleApprenticeLanguage(void);
 void RecordedBattle_SaveBattleOutcome(void);
 u16 *GetRecordedBattleEasyChatSpeech(void);
+#ifdef PORTABLE
+void RecordedBattle_SetPaused(bool8 paused);
+#endif
 
 #endif // GUARD_RECORDED_BATTLE_H
@@ -0,0 +1,55 @@
+#ifndef GUARD_SCRIPT_PROFILER_H
+#define GUARD_SCRIPT_PROFILER_H
+
+#ifdef PORTABLE
+
+#include "script.h"
+
+// What a script was waiting on
+enum
+{
+    SCRIPT_STALL_WAITSTATE,
+    SCRIPT_STALL_WAITMOVEMENT,
+    SCRIPT_STALL_KIND_COUNT,
+};
+
+#define SCRIPT_PROFILE_DEFAULT_STALL_FRAMES 60
+#define SCRIPT_PROFILE_DEFAULT_TOP          20
+
+void ScriptProfiler_Enable(bool8 enable);
+void ScriptProfiler_Reset(void);
+void ScriptProfiler_SetStallThreshold(u32 frames);
+bool8 ScriptProfiler_WriteReport(const char *path, u32 topCount);
+void ScriptProfiler_InitFromEnv(void);
+
+// Hooks for script.c
+void ScriptProfiler_BeginScript(const u8 *script);
+void ScriptProfiler_EndScript(void);
+void ScriptProfiler_BeginRun(void);
+void ScriptProfiler_EndRun(void);
+void ScriptProfiler_BeginImmediate(const u8 *script);
+void ScriptProfiler_EndImmediate(void);
+void ScriptProfiler_Command(struct ScriptContext *ctx, const u8 *pc, u8 opcode);
+
+// Hooks for scrcmd.c. BeginSpecial returns the index it is given, so that it
+// can wrap the index of the call it times.
+u16 ScriptProfiler_BeginSpecial(u16 index);
+void ScriptProfiler_EndSpecial(void);
+void ScriptProfiler_BeginStall(struct ScriptContext *ctx, u8 kind);
+
+#else
+
+#define ScriptProfiler_BeginScript(script)
+#define ScriptProfiler_EndScript()
+#define ScriptProfiler_BeginRun()
+#define ScriptProfiler_EndRun()
+#define ScriptProfiler_BeginImmediate(script)
+#define ScriptProfiler_EndImmediate()
+#define ScriptProfiler_Command(ctx, pc, opcode)
+#define ScriptProfiler_BeginSpecial(index) (index)
+#define ScriptProfiler_EndSpecial()
+#define ScriptProfiler_BeginStall(ctx, kind)
+
+#endif // PORTABLE
+
+#endif // GUARD_SCRIPT_PROFILER_H
@@ -0,0 +1,39 @@
+#ifndef GUARD_SCRIPT_VM_H
+#define GUARD_SCRIPT_VM_H
+
+#ifdef PORTABLE
+
+#include "script.h"
+
+// One pre-decoded event script command. next is the command that follows it
+// in the script, or NULL where decoding stopped (end, goto, return, ...).
+// target is where a goto, call or std script jump goes, read from its
+// operands, and branch the decoded command there once the jump is taken.
+struct ScriptInsn
+{
+    const u8 *pc;
+    ScrCmdFunc func;
+    const struct ScriptInsn *next;
+    const u8 *target;
+    const struct ScriptInsn *branch;
+    u8 opcode;
+};
+
+struct ScriptVMStats
+{
+    u32 decodedInsns;
+    u32 lookups;
+    u32 resolvedJumps; // taken jumps that went straight to their decoded target
+    u32 interpreted; // commands left to the byte interpreter (RAM scripts)
+};
+
+extern bool8 gScriptVM;
+
+const struct ScriptInsn *ScriptVM_Lookup(struct ScriptContext *ctx, const u8 *pc);
+const struct ScriptInsn *ScriptVM_Next(struct ScriptContext *ctx, const struct ScriptInsn *insn);
+void ScriptVM_Reset(void);
+void ScriptVM_GetStats(struct ScriptVMStats *stats);
+
+#endif // PORTABLE
+
+#endif // GUARD_SCRIPT_VM_H
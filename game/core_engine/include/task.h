@@ -22,6 +22,12 @@ struct Task
 
 extern struct Task gTasks[];
 
+#ifdef PORTABLE
+// For profilers. When set, RunTasks calls this in place of each task's
+// func, and it has to call the func itself.
+extern void (*gTaskFuncWrapper)(u8 taskId);
+#endif
+
 void ResetTasks(void);
 u8 CreateTask(TaskFunc func, u8 priority);
 void DestroyTask(u8 taskId);
@@ -5,6 +5,9 @@ void InitTilesetAnimations(void);
 void InitSecondaryTilesetAnimation(void);
 void UpdateTilesetAnimations(void);
 void TransferTilesetAnimsBuffer(void);
+#ifdef PORTABLE
+void TilesetAnims_SetZeroCopy(bool8 enabled);
+#endif
 
 void InitTilesetAnim_General(void);
 void InitTilesetAnim_Petalburg(void);
@@ -0,0 +1,14 @@
+#ifndef GUARD_FRAME_COMPOSE_H
+#define GUARD_FRAME_COMPOSE_H
+
+#ifdef PORTABLE
+
+// Exported ROM declarations
+
+// A FrameRenderLineFunc. pixels is a DISPLAY_WIDTH x DISPLAY_HEIGHT buffer of
+// 0xAARRGGBB colors, of which it writes the given line.
+void FrameCompose_DrawLine(const struct FrameSnapshot *snapshot, u32 line, void *pixels);
+
+#endif // PORTABLE
+
+#endif // GUARD_FRAME_COMPOSE_H
@@ -0,0 +1,88 @@
+#ifndef GUARD_FRAME_RENDER_H
+#define GUARD_FRAME_RENDER_H
+
+#ifdef PORTABLE
+
+// Exported type declarations
+
+#define FRAME_LINE_REGS_SIZE 0x60 // DISPCNT through BLDY, as in gpu_regs.c
+#define MAX_RENDER_WORKERS   32
+#define FRAME_BG_TILE_SOURCES 1024 // 4bpp tiles in char blocks 0 and 1
+#define FRAME_BG_VIEW_TILES   32   // width and height of a BG view's window
+
+// Per-line register values published by the game alongside HBlank DMA and
+// simple HBlank callbacks. Each table's value for a line is applied to its
+// register before that line is captured. Tables last for one frame and are
+// cleared at the start of every VBlank, so they have to be republished from
+// the VBlank callback the same way the DMA is rearmed there.
+#define FRAME_LINE_TABLE_HBLANK_DMA 0 // stands in for HBlank DMA channel 0
+#define FRAME_LINE_TABLE_COUNT      4
+
+struct FrameLineTable
+{
+    const void *values; // NULL if unused; values[0] is for firstLine
+    u16 regOffset;      // REG_OFFSET_* of the register written
+    u8 firstLine;       // lines before this keep the register's value
+    bool8 is32Bit;
+};
+
+// Everything a compositor needs to draw one frame, copied out of the
+// emulated hardware at VBlank so it can be drawn on other threads while the
+// game runs the next frame.
+struct FrameSnapshot
+{
+    u32 frameCount;
+    // The display registers as each line sees them, after the line tables
+    u16 lineRegs[DISPLAY_HEIGHT][FRAME_LINE_REGS_SIZE / 2];
+    u16 pltt[PLTT_SIZE / 2];
+    u8 oam[OAM_SIZE];
+    u8 vram[VRAM_SIZE];
+    // Tiles of char blocks 0-1 to read from resident tileset animation
+    // frames instead of vram, NULL where not redirected
+    const u16 *bgTileSources[FRAME_BG_TILE_SOURCES];
+    u32 bgTileSourcesVersion; // 0 when none are redirected
+    // Text BGs drawn from a window of a larger tilemap instead of their
+    // screen block, a bit each. The window wraps as a screen block does, and
+    // the offsets are added to the BG's scroll to line it up.
+    u8 bgViewMask;
+    u16 bgViewOffsets[NUM_BACKGROUNDS][2];
+    u16 bgViews[NUM_BACKGROUNDS][FRAME_BG_VIEW_TILES * FRAME_BG_VIEW_TILES];
+};
+
+// Draws one line of the snapshot. Lines are drawn concurrently, so it may
+// only write that line's output.
+typedef void (*FrameRenderLineFunc)(const struct FrameSnapshot *snapshot, u32 line, void *userData);
+// Shows a fully drawn frame. May block on vsync; the game keeps running.
+typedef void (*FrameRenderPresentFunc)(const struct FrameSnapshot *snapshot, void *userData);
+
+struct FrameRenderStats
+{
+    u32 framesSubmitted;
+    u32 framesPresented; // the rest were skipped because a newer frame was ready
+};
+
+// Exported ROM declarations
+
+// numWorkers threads besides the caller of FrameRender_DrawBands; bandHeight
+// of 0 picks a default.
+void FrameRender_Init(u32 numWorkers, u32 bandHeight);
+void FrameRender_InitFromEnv(void);
+void FrameRender_Shutdown(void);
+void FrameRender_SetLineTable(u8 slot, const void *values, volatile void *reg, u8 firstLine, bool8 is32Bit);
+void FrameRender_ClearLineTable(u8 slot);
+void FrameRender_ClearLineTables(void);
+void FrameRender_SetBgTileSources(const u16 *const *sources, u32 version);
+void FrameRender_SetBgView(u8 bg, const u16 *tilemap, u32 width, u32 height, s32 x, s32 y);
+void FrameRender_MarkVramWritten(uintptr_t dest, u32 size);
+void FrameRender_SubmitFrame(void);
+const struct FrameSnapshot *FrameRender_AcquireLatest(void);
+void FrameRender_DrawBands(const struct FrameSnapshot *snapshot, FrameRenderLineFunc func, void *userData);
+bool8 FrameRender_StartThread(FrameRenderLineFunc drawLine, FrameRenderPresentFunc present, void *userData);
+void FrameRender_StopThread(void);
+bool8 FrameRender_IsRunning(void);
+void FrameRender_GetStats(struct FrameRenderStats *stats);
+u32 FrameRender_CopyPresentedFrame(u32 *pixels);
+
+#endif // PORTABLE
+
+#endif // GUARD_FRAME_RENDER_H
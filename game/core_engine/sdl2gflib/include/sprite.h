@@ -269,6 +269,15 @@ extern s16 gSpriteCoordOffsetY;
 extern struct OamMatrix gOamMatrices[];
 extern bool8 gAffineAnimsDisabled;
 
+#ifdef PORTABLE
+// For profilers. When set, AnimateSprites calls this in place of each
+// sprite's callback, and it has to call the callback itself.
+extern void (*gSpriteCallbackWrapper)(struct Sprite *sprite);
+// Running totals of what LoadSpriteSheet and LoadSpritePalette loaded
+extern u32 gSpriteTilesLoaded;
+extern u32 gSpritePalettesLoaded;
+#endif
+
 void ResetSpriteData(void);
 void AnimateSprites(void);
 void BuildOamBuffer(void);
@@ -0,0 +1,480 @@
+#include "global.h"
+#include "frame_render.h"
+#include "frame_compose.h"
+#include "constants/rgb.h"
+
+#ifdef PORTABLE
+
+// Draws a frame snapshot line by line the way the GBA's PPU does: text,
+// affine and bitmap BGs, regular and affine sprites, the two windows and the
+// OBJ window, and color special effects, all from the registers the line
+// saw. Mosaic is not drawn.
+
+#define LAYER_OBJ      4
+#define LAYER_BACKDROP 5
+
+#define PIXEL_OPAQUE 0x8000 // set in a layer's line where it has a pixel
+#define NO_PRIORITY  4
+
+#define DISPCNT_FRAME_SELECT 0x0010 // second bitmap in modes 4 and 5
+
+#define OBJ_VRAM_OFFSET (OBJ_VRAM0 - VRAM)
+#define NUM_OAM_ENTRIES (OAM_SIZE / sizeof(struct OamData))
+
+#define LINE_REG(snapshot, line, offset) ((snapshot)->lineRegs[line][(offset) / 2])
+
+struct ObjLine
+{
+    u16 colors[DISPLAY_WIDTH];
+    u8 priorities[DISPLAY_WIDTH];
+    bool8 semiTransparent[DISPLAY_WIDTH];
+    bool8 inWindow[DISPLAY_WIDTH];
+};
+
+// Width and height of each sprite shape and size
+static const u8 sObjDimensions[3][4][2] =
+{
+    [ST_OAM_SQUARE]      = {{8, 8},  {16, 16}, {32, 32}, {64, 64}},
+    [ST_OAM_H_RECTANGLE] = {{16, 8}, {32, 8},  {32, 16}, {64, 32}},
+    [ST_OAM_V_RECTANGLE] = {{8, 16}, {8, 32},  {16, 32}, {32, 64}},
+};
+
+// The tile's pixels, from a resident tileset animation frame if the game
+// redirected it there.
+static const u8 *GetBgTile4Bpp(const struct FrameSnapshot *snapshot, u32 offset)
+{
+    u32 tile = offset / TILE_SIZE_4BPP;
+
+    if (tile < FRAME_BG_TILE_SOURCES && snapshot->bgTileSources[tile] != NULL)
+        return (const u8 *)snapshot->bgTileSources[tile];
+    return &snapshot->vram[offset];
+}
+
+static void DrawTextBgLine(const struct FrameSnapshot *snapshot, u32 line, u32 bg, u16 *colors)
+{
+    u16 bgcnt = LINE_REG(snapshot, line, REG_OFFSET_BG0CNT + bg * 2);
+    u32 hofs = LINE_REG(snapshot, line, REG_OFFSET_BG0HOFS + bg * 4);
+    u32 vofs = LINE_REG(snapshot, line, REG_OFFSET_BG0VOFS + bg * 4);
+    u32 charBase = ((bgcnt >> 2) & 3) * BG_CHAR_SIZE;
+    u32 screenBase = ((bgcnt >> 8) & 0x1F) * BG_SCREEN_SIZE;
+    u32 width = (bgcnt & BGCNT_TXT512x256) ? 512 : 256;
+    u32 height = (bgcnt & BGCNT_TXT256x512) ? 512 : 256;
+    const u16 *view = NULL;
+    u32 y, x, px, block, offset, tileX, tileY, colorIndex;
+    u16 entry;
+    const u16 *tilemap;
+
+    if (snapshot->bgViewMask & (1 << bg))
+    {
+        view = snapshot->bgViews[bg];
+        hofs += snapshot->bgViewOffsets[bg][0];
+        vofs += snapshot->bgViewOffsets[bg][1];
+        width = height = FRAME_BG_VIEW_TILES * 8;
+    }
+    y = (line + vofs) & (height - 1);
+
+    for (x = 0; x < DISPLAY_WIDTH; x++)
+    {
+        px = (x + hofs) & (width - 1);
+        block = px / 256 + (y / 256) * (width / 256);
+        tilemap = view != NULL ? view : (const u16 *)&snapshot->vram[screenBase + block * BG_SCREEN_SIZE];
+        entry = tilemap[(y % 256) / 8 * 32 + (px % 256) / 8];
+        tileX = (entry & 0x400) ? 7 - px % 8 : px % 8;
+        tileY = (entry & 0x800) ? 7 - y % 8 : y % 8;
+
+        colors[x] = 0;
+        if (bgcnt & BGCNT_256COLOR)
+        {
+            offset = charBase + (entry & 0x3FF) * TILE_SIZE_8BPP;
+            if (offset >= BG_VRAM_SIZE)
+                continue;
+            colorIndex = snapshot->vram[offset + tileY * 8 + tileX];
+        }
+        else
+        {
+            offset = charBase + (entry & 0x3FF) * TILE_SIZE_4BPP;
+            if (offset >= BG_VRAM_SIZE)
+                continue;
+            colorIndex = (GetBgTile4Bpp(snapshot, offset)[tileY * 4 + tileX / 2] >> ((tileX & 1) * 4)) & 0xF;
+            if (colorIndex != 0)
+                colorIndex += (entry >> 12) * 16;
+        }
+        if (colorIndex != 0)
+            colors[x] = snapshot->pltt[colorIndex] | PIXEL_OPAQUE;
+    }
+}
+
+static s32 GetRefPoint(const struct FrameSnapshot *snapshot, u32 line, u32 offset)
+{
+    u32 value = LINE_REG(snapshot, line, offset) | (LINE_REG(snapshot, line, offset + 2) << 16);
+
+    // 28-bit signed fixed point
+    return (s32)(value << 4) >> 4;
+}
+
+// The PPU reloads the reference point at VBlank and whenever it's written,
+// and otherwise moves it by PB (or PD) after each line.
+static s32 GetLineRefPoint(const struct FrameSnapshot *snapshot, u32 line, u32 refOffset, u32 stepOffset)
+{
+    u32 written = line;
+    s32 point;
+
+    while (written > 0 && GetRefPoint(snapshot, written, refOffset) == GetRefPoint(snapshot, written - 1, refOffset))
+        written--;
+    point = GetRefPoint(snapshot, written, refOffset);
+    for (; written < line; written++)
+        point += (s16)LINE_REG(snapshot, written, stepOffset);
+    return point;
+}
+
+static void DrawAffineBgLine(const struct FrameSnapshot *snapshot, u32 line, u32 bg, u16 *colors)
+{
+    u32 regs = (bg - 2) * (REG_OFFSET_BG3PA - REG_OFFSET_BG2PA);
+    u16 bgcnt = LINE_REG(snapshot, line, REG_OFFSET_BG0CNT + bg * 2);
+    s32 pa = (s16)LINE_REG(snapshot, line, REG_OFFSET_BG2PA + regs);
+    s32 pc = (s16)LINE_REG(snapshot, line, REG_OFFSET_BG2PC + regs);
+    s32 refX = GetLineRefPoint(snapshot, line, REG_OFFSET_BG2X + regs, REG_OFFSET_BG2PB + regs);
+    s32 refY = GetLineRefPoint(snapshot, line, REG_OFFSET_BG2Y + regs, REG_OFFSET_BG2PD + regs);
+    u32 charBase = ((bgcnt >> 2) & 3) * BG_CHAR_SIZE;
+    u32 screenBase = ((bgcnt >> 8) & 0x1F) * BG_SCREEN_SIZE;
+    s32 size = 128 << ((bgcnt >> 14) & 3);
+    s32 px, py;
+    u32 x, tile, offset, colorIndex;
+
+    for (x = 0; x < DISPLAY_WIDTH; x++)
+    {
+        px = (refX + pa * (s32)x) >> 8;
+        py = (refY + pc * (s32)x) >> 8;
+        colors[x] = 0;
+        if (bgcnt & BGCNT_WRAP)
+        {
+            px &= size - 1;
+            py &= size - 1;
+        }
+        else if (px < 0 || py < 0 || px >= size || py >= size)
+        {
+            continue;
+        }
+
+        tile = snapshot->vram[(screenBase + py / 8 * (size / 8) + px / 8) & (BG_VRAM_SIZE - 1)];
+        offset = charBase + tile * TILE_SIZE_8BPP + py % 8 * 8 + px % 8;
+        if (offset >= BG_VRAM_SIZE)
+            continue;
+        colorIndex = snapshot->vram[offset];
+        if (colorIndex != 0)
+            colors[x] = snapshot->pltt[colorIndex] | PIXEL_OPAQUE;
+    }
+}
+
+// Modes 3-5. The games don't transform bitmaps, so BG2's affine parameters
+// are ignored.
+static void DrawBitmapBgLine(const struct FrameSnapshot *snapshot, u32 line, u16 dispcnt, u16 *colors)
+{
+    u32 frame = (dispcnt & DISPCNT_FRAME_SELECT) ? 0xA000 : 0;
+    const u16 *pixels;
+    u32 x;
+
+    for (x = 0; x < DISPLAY_WIDTH; x++)
+    {
+        colors[x] = 0;
+        switch (dispcnt & 7)
+        {
+        case DISPCNT_MODE_3:
+            pixels = (const u16 *)snapshot->vram;
+            colors[x] = pixels[line * DISPLAY_WIDTH + x] | PIXEL_OPAQUE;
+            break;
+        case DISPCNT_MODE_4:
+            if (snapshot->vram[frame + line * DISPLAY_WIDTH + x] != 0)
+                colors[x] = snapshot->pltt[snapshot->vram[frame + line * DISPLAY_WIDTH + x]] | PIXEL_OPAQUE;
+            break;
+        case DISPCNT_MODE_5:
+            pixels = (const u16 *)&snapshot->vram[frame];
+            if (x < 160 && line < 128)
+                colors[x] = pixels[line * 160 + x] | PIXEL_OPAQUE;
+            break;
+        }
+    }
+}
+
+static u32 GetObjColorIndex(const struct FrameSnapshot *snapshot, const struct OamData *obj, u32 width, u32 tileX, u32 tileY, bool8 oneDimensional)
+{
+    u32 tileUnits = obj->bpp == ST_OAM_8BPP ? 2 : 1;
+    u32 tilesPerRow = oneDimensional ? width / 8 * tileUnits : 32;
+    u32 tile = obj->tileNum + tileY / 8 * tilesPerRow + tileX / 8 * tileUnits;
+    u32 offset;
+
+    if (obj->bpp == ST_OAM_8BPP)
+    {
+        offset = (tile * TILE_SIZE_4BPP + tileY % 8 * 8 + tileX % 8) & (OBJ_VRAM0_SIZE - 1);
+        return snapshot->vram[OBJ_VRAM_OFFSET + offset];
+    }
+
+    offset = (tile * TILE_SIZE_4BPP + tileY % 8 * 4 + tileX % 8 / 2) & (OBJ_VRAM0_SIZE - 1);
+    return (snapshot->vram[OBJ_VRAM_OFFSET + offset] >> ((tileX & 1) * 4)) & 0xF;
+}
+
+static void DrawObjLine(const struct FrameSnapshot *snapshot, u32 line, u16 dispcnt, struct ObjLine *objs)
+{
+    const struct OamData *oam = (const struct OamData *)snapshot->oam;
+    const s16 *params;
+    s32 pa = 0x100, pb = 0, pc = 0, pd = 0x100;
+    s32 objX, screenX, centerX, centerY;
+    u32 i, width, height, boundsWidth, boundsHeight, y, x, tileX, tileY, colorIndex;
+
+    memset(objs->colors, 0, sizeof(objs->colors));
+    memset(objs->priorities, NO_PRIORITY, sizeof(objs->priorities));
+    memset(objs->semiTransparent, FALSE, sizeof(objs->semiTransparent));
+    memset(objs->inWindow, FALSE, sizeof(objs->inWindow));
+
+    for (i = 0; i < NUM_OAM_ENTRIES; i++)
+    {
+        const struct OamData *obj = &oam[i];
+
+        if (obj->affineMode == ST_OAM_AFFINE_ERASE || obj->shape > ST_OAM_V_RECTANGLE)
+            continue;
+        if (obj->objMode == ST_OAM_OBJ_WINDOW ? !(dispcnt & DISPCNT_OBJWIN_ON) : !(dispcnt & DISPCNT_OBJ_ON))
+            continue;
+
+        width = sObjDimensions[obj->shape][obj->size][0];
+        height = sObjDimensions[obj->shape][obj->size][1];
+        boundsWidth = obj->affineMode == ST_OAM_AFFINE_DOUBLE ? width * 2 : width;
+        boundsHeight = obj->affineMode == ST_OAM_AFFINE_DOUBLE ? height * 2 : height;
+        y = (line - obj->y) & 0xFF;
+        if (y >= boundsHeight)
+            continue;
+
+        if (obj->affineMode & ST_OAM_AFFINE_ON_MASK)
+        {
+            params = (const s16 *)snapshot->oam + obj->matrixNum * 16;
+            pa = params[3];
+            pb = params[7];
+            pc = params[11];
+            pd = params[15];
+        }
+
+        objX = obj->x >= 256 ? (s32)obj->x - 512 : (s32)obj->x;
+        for (x = 0; x < boundsWidth; x++)
+        {
+            screenX = objX + (s32)x;
+            if (screenX < 0 || screenX >= DISPLAY_WIDTH)
+                continue;
+
+            if (obj->affineMode & ST_OAM_AFFINE_ON_MASK)
+            {
+                centerX = (s32)x - (s32)boundsWidth / 2;
+                centerY = (s32)y - (s32)boundsHeight / 2;
+                tileX = ((pa * centerX + pb * centerY) >> 8) + width / 2;
+                tileY = ((pc * centerX + pd * centerY) >> 8) + height / 2;
+                if (tileX >= width || tileY >= height)
+                    continue;
+            }
+            else
+            {
+                tileX = (obj->matrixNum & ST_OAM_HFLIP) ? width - 1 - x : x;
+                tileY = (obj->matrixNum & ST_OAM_VFLIP) ? height - 1 - y : y;
+            }
+
+            colorIndex = GetObjColorIndex(snapshot, obj, width, tileX, tileY, (dispcnt & DISPCNT_OBJ_1D_MAP) != 0);
+            if (colorIndex == 0)
+                continue;
+            if (obj->objMode == ST_OAM_OBJ_WINDOW)
+            {
+                objs->inWindow[screenX] = TRUE;
+                continue;
+            }
+            // Among sprites of the same priority, the first in OAM is drawn.
+            if (obj->priority >= objs->priorities[screenX])
+                continue;
+
+            if (obj->bpp == ST_OAM_4BPP)
+                colorIndex += obj->paletteNum * 16;
+            objs->colors[screenX] = snapshot->pltt[PLTT_SIZE / 4 + colorIndex] | PIXEL_OPAQUE;
+            objs->priorities[screenX] = obj->priority;
+            objs->semiTransparent[screenX] = (obj->objMode == ST_OAM_OBJ_BLEND);
+        }
+    }
+}
+
+static bool8 IsInWindowRange(u16 range, u32 pos, u32 limit)
+{
+    u32 start = range >> 8;
+    u32 end = range & 0xFF;
+
+    if (end > limit || start > end)
+        end = limit;
+    return pos >= start && pos < end;
+}
+
+// Which layers (bits 0-4) and whether color effects (bit 5) are enabled for
+// each pixel of the line.
+static void GetWindowMasks(const struct FrameSnapshot *snapshot, u32 line, u16 dispcnt, const struct ObjLine *objs, u8 *masks)
+{
+    u16 winIn = LINE_REG(snapshot, line, REG_OFFSET_WININ);
+    u16 winOut = LINE_REG(snapshot, line, REG_OFFSET_WINOUT);
+    bool8 win0 = (dispcnt & DISPCNT_WIN0_ON) && IsInWindowRange(LINE_REG(snapshot, line, REG_OFFSET_WIN0V), line, DISPLAY_HEIGHT);
+    bool8 win1 = (dispcnt & DISPCNT_WIN1_ON) && IsInWindowRange(LINE_REG(snapshot, line, REG_OFFSET_WIN1V), line, DISPLAY_HEIGHT);
+    u32 x;
+
+    if (!(dispcnt & (DISPCNT_WIN0_ON | DISPCNT_WIN1_ON | DISPCNT_OBJWIN_ON)))
+    {
+        memset(masks, 0x3F, DISPLAY_WIDTH);
+        return;
+    }
+
+    for (x = 0; x < DISPLAY_WIDTH; x++)
+    {
+        if (win0 && IsInWindowRange(LINE_REG(snapshot, line, REG_OFFSET_WIN0H), x, DISPLAY_WIDTH))
+            masks[x] = winIn & 0x3F;
+        else if (win1 && IsInWindowRange(LINE_REG(snapshot, line, REG_OFFSET_WIN1H), x, DISPLAY_WIDTH))
+            masks[x] = (winIn >> 8) & 0x3F;
+        else if ((dispcnt & DISPCNT_OBJWIN_ON) && objs->inWindow[x])
+            masks[x] = (winOut >> 8) & 0x3F;
+        else
+            masks[x] = winOut & 0x3F;
+    }
+}
+
+static u16 BlendAlpha(u16 top, u16 bottom, u32 eva, u32 evb)
+{
+    u32 r = min(31, ((top & 0x1F) * eva + (bottom & 0x1F) * evb) >> 4);
+    u32 g = min(31, (((top >> 5) & 0x1F) * eva + ((bottom >> 5) & 0x1F) * evb) >> 4);
+    u32 b = min(31, (((top >> 10) & 0x1F) * eva + ((bottom >> 10) & 0x1F) * evb) >> 4);
+
+    return RGB(r, g, b);
+}
+
+static u16 Brighten(u16 color, u32 evy)
+{
+    u32 r = color & 0x1F;
+    u32 g = (color >> 5) & 0x1F;
+    u32 b = (color >> 10) & 0x1F;
+
+    return RGB(r + (((31 - r) * evy) >> 4), g + (((31 - g) * evy) >> 4), b + (((31 - b) * evy) >> 4));
+}
+
+static u16 Darken(u16 color, u32 evy)
+{
+    u32 r = color & 0x1F;
+    u32 g = (color >> 5) & 0x1F;
+    u32 b = (color >> 10) & 0x1F;
+
+    return RGB(r - ((r * evy) >> 4), g - ((g * evy) >> 4), b - ((b * evy) >> 4));
+}
+
+static u32 ToArgb(u16 color)
+{
+    u32 r = color & 0x1F;
+    u32 g = (color >> 5) & 0x1F;
+    u32 b = (color >> 10) & 0x1F;
+
+    return 0xFF000000 | (((r << 3) | (r >> 2)) << 16) | (((g << 3) | (g >> 2)) << 8) | ((b << 3) | (b >> 2));
+}
+
+void FrameCompose_DrawLine(const struct FrameSnapshot *snapshot, u32 line, void *pixels)
+{
+    u32 *out = (u32 *)pixels + line * DISPLAY_WIDTH;
+    u16 dispcnt = LINE_REG(snapshot, line, REG_OFFSET_DISPCNT);
+    u16 bldcnt = LINE_REG(snapshot, line, REG_OFFSET_BLDCNT);
+    u16 bldalpha = LINE_REG(snapshot, line, REG_OFFSET_BLDALPHA);
+    u32 eva = min(bldalpha & 0x1F, 16);
+    u32 evb = min((bldalpha >> 8) & 0x1F, 16);
+    u32 evy = min(LINE_REG(snapshot, line, REG_OFFSET_BLDY) & 0x1F, 16);
+    u16 bgColors[NUM_BACKGROUNDS][DISPLAY_WIDTH];
+    u8 bgPriorities[NUM_BACKGROUNDS];
+    u8 masks[DISPLAY_WIDTH];
+    struct ObjLine objs;
+    u8 enabledBgs, layers[2], numLayers, priority;
+    u16 colors[2];
+    u32 x, bg, mode = dispcnt & 7;
+
+    if (dispcnt & DISPCNT_FORCED_BLANK)
+    {
+        for (x = 0; x < DISPLAY_WIDTH; x++)
+            out[x] = ToArgb(RGB_WHITE);
+        return;
+    }
+
+    switch (mode)
+    {
+    case DISPCNT_MODE_0:
+        enabledBgs = 0xF;
+        break;
+    case DISPCNT_MODE_1:
+        enabledBgs = 0x7;
+        break;
+    case DISPCNT_MODE_2:
+        enabledBgs = 0xC;
+        break;
+    default:
+        enabledBgs = 0x4;
+        break;
+    }
+    enabledBgs &= dispcnt >> 8;
+
+    for (bg = 0; bg < NUM_BACKGROUNDS; bg++)
+    {
+        bgPriorities[bg] = LINE_REG(snapshot, line, REG_OFFSET_BG0CNT + bg * 2) & 3;
+        if (!(enabledBgs & (1 << bg)))
+            continue;
+        if (mode >= DISPCNT_MODE_3)
+            DrawBitmapBgLine(snapshot, line, dispcnt, bgColors[bg]);
+        else if (bg >= 2 && mode != DISPCNT_MODE_0)
+            DrawAffineBgLine(snapshot, line, bg, bgColors[bg]);
+        else
+            DrawTextBgLine(snapshot, line, bg, bgColors[bg]);
+    }
+    DrawObjLine(snapshot, line, dispcnt, &objs);
+    GetWindowMasks(snapshot, line, dispcnt, &objs, masks);
+
+    for (x = 0; x < DISPLAY_WIDTH; x++)
+    {
+        // Find the two topmost layers, for blending.
+        numLayers = 0;
+        for (priority = 0; priority < NO_PRIORITY && numLayers < 2; priority++)
+        {
+            if (objs.priorities[x] == priority && (masks[x] & (1 << LAYER_OBJ)))
+            {
+                layers[numLayers] = LAYER_OBJ;
+                colors[numLayers++] = objs.colors[x];
+            }
+            for (bg = 0; bg < NUM_BACKGROUNDS && numLayers < 2; bg++)
+            {
+                if ((enabledBgs & masks[x] & (1 << bg)) && bgPriorities[bg] == priority && (bgColors[bg][x] & PIXEL_OPAQUE))
+                {
+                    layers[numLayers] = bg;
+                    colors[numLayers++] = bgColors[bg][x];
+                }
+            }
+        }
+        for (; numLayers < 2; numLayers++)
+        {
+            layers[numLayers] = LAYER_BACKDROP;
+            colors[numLayers] = snapshot->pltt[0];
+        }
+
+        // Semi-transparent sprites blend with what's under them whatever the effect.
+        if (layers[0] == LAYER_OBJ && objs.semiTransparent[x] && (bldcnt & (BLDCNT_TGT2_BG0 << layers[1])))
+        {
+            colors[0] = BlendAlpha(colors[0], colors[1], eva, evb);
+        }
+        else if ((masks[x] & WININ_WIN0_CLR) && (bldcnt & (BLDCNT_TGT1_BG0 << layers[0])))
+        {
+            switch (bldcnt & BLDCNT_EFFECT_DARKEN)
+            {
+            case BLDCNT_EFFECT_BLEND:
+                if (bldcnt & (BLDCNT_TGT2_BG0 << layers[1]))
+                    colors[0] = BlendAlpha(colors[0], colors[1], eva, evb);
+                break;
+            case BLDCNT_EFFECT_LIGHTEN:
+                colors[0] = Brighten(colors[0], evy);
+                break;
+            case BLDCNT_EFFECT_DARKEN:
+                colors[0] = Darken(colors[0], evy);
+                break;
+            }
+        }
+        out[x] = ToArgb(colors[0]);
+    }
+}
+
+#endif // PORTABLE
@@ -0,0 +1,544 @@
+#ifdef PORTABLE
+#include <pthread.h>
+#include <semaphore.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#endif
+
+#include "global.h"
+#include "frame_render.h"
+#include "frame_compose.h"
+
+#ifdef PORTABLE
+
+// Frames are handed from the game thread to the renderer through a lock-free
+// triple buffer: the game always has a slot to capture into, the renderer
+// always holds the slot it is drawing, and the third is the most recently
+// finished frame, swapped atomically with either side. The renderer then
+// splits the frame into bands of lines drawn by a persistent worker pool.
+// With FrameRender_StartThread the drawing and presenting happen on their
+// own thread, so a slow present or vsync wait never holds up the game; if
+// the renderer falls behind, it simply skips to the newest frame.
+//
+// The game publishes what it writes between lines, the tileset animation
+// frames it leaves resident and the tilemaps it draws BGs from instead of
+// VRAM through FrameRender_SetLineTable, FrameRender_SetBgTileSources and
+// FrameRender_SetBgView. All are only read on the game thread, when a frame
+// is captured.
+//
+// VRAM is copied as a delta: the copy, fill and decompression wrappers in
+// gba/syscall.h and gba/macro.h mark the blocks they write as dirty, as does
+// the code that writes VRAM through a pointer, so a capture only copies the
+// blocks that changed since the frame already in that slot.
+
+#define NUM_SNAPSHOTS      3
+#define SNAPSHOT_FRESH     0x4 // set in sLatestSnapshot when the renderer hasn't taken it
+#define DEFAULT_BAND_HEIGHT 8
+#define VRAM_BLOCK_SIZE    0x800 // one BG screen block
+#define NUM_VRAM_BLOCKS    (VRAM_SIZE / VRAM_BLOCK_SIZE)
+
+static struct FrameSnapshot *sSnapshots[NUM_SNAPSHOTS];
+static u8 sCaptureSnapshot; // game thread only
+static u8 sDrawSnapshot;    // render thread only
+static atomic_uint sLatestSnapshot;
+static u32 sFrameCount;
+
+static struct FrameLineTable sLineTables[FRAME_LINE_TABLE_COUNT];
+static const u16 *const *sBgTileSources;
+static u32 sBgTileSourcesVersion;
+
+struct BgView
+{
+    const u16 *tilemap;
+    u32 width;
+    u32 height;
+    s32 x;
+    s32 y;
+};
+
+static struct BgView sBgViews[NUM_BACKGROUNDS];
+static u8 sBgViewMask;
+
+// What FrameRender_InitFromEnv draws into: the render thread draws each
+// frame into sBackBuffer, then swaps it with sFrontBuffer for the platform
+// layer to copy out.
+static u32 *sBackBuffer;
+static u32 *sFrontBuffer;
+static u32 sFrontBufferFrame;
+static pthread_mutex_t sFrontBufferLock = PTHREAD_MUTEX_INITIALIZER;
+
+static atomic_bool sVramBlockDirty[NUM_VRAM_BLOCKS];
+static u32 sVramBlockChanged[NUM_VRAM_BLOCKS]; // the capture that first saw the block's current contents
+
+static pthread_t sRenderThread;
+static bool8 sRenderThreadRunning;
+static atomic_bool sStopRenderThread;
+static sem_t sFrameSubmitted;
+static FrameRenderLineFunc sRenderDrawLine;
+static FrameRenderPresentFunc sRenderPresent;
+static void *sRenderUserData;
+static atomic_uint sFramesPresented;
+
+static pthread_t sWorkers[MAX_RENDER_WORKERS];
+static u32 sNumWorkers;
+static u32 sBandHeight;
+static pthread_mutex_t sPoolLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t sJobReady = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t sJobDone = PTHREAD_COND_INITIALIZER;
+static u32 sJobGeneration;
+static u32 sBusyWorkers;
+static bool8 sShuttingDown;
+
+// The job being drawn. Only written under sPoolLock while no worker is busy.
+static const struct FrameSnapshot *sJobSnapshot;
+static FrameRenderLineFunc sJobFunc;
+static void *sJobUserData;
+static u32 sJobBands;
+static atomic_uint sNextBand;
+static atomic_uint sBandsDone;
+
+static void DrawBands(void)
+{
+    u32 band, line, end;
+
+    while ((band = atomic_fetch_add(&sNextBand, 1)) < sJobBands)
+    {
+        end = min((band + 1) * sBandHeight, DISPLAY_HEIGHT);
+        for (line = band * sBandHeight; line < end; line++)
+            sJobFunc(sJobSnapshot, line, sJobUserData);
+        atomic_fetch_add(&sBandsDone, 1);
+    }
+}
+
+static void *RenderWorker(void *arg)
+{
+    u32 seenGeneration = 0;
+
+    while (TRUE)
+    {
+        pthread_mutex_lock(&sPoolLock);
+        while (sJobGeneration == seenGeneration && !sShuttingDown)
+            pthread_cond_wait(&sJobReady, &sPoolLock);
+        if (sShuttingDown)
+        {
+            pthread_mutex_unlock(&sPoolLock);
+            return NULL;
+        }
+        seenGeneration = sJobGeneration;
+        sBusyWorkers++;
+        pthread_mutex_unlock(&sPoolLock);
+
+        DrawBands();
+
+        pthread_mutex_lock(&sPoolLock);
+        if (--sBusyWorkers == 0)
+            pthread_cond_signal(&sJobDone);
+        pthread_mutex_unlock(&sPoolLock);
+    }
+}
+
+// Called on whichever thread wrote the VRAM.
+// Writes outside VRAM are ignored.
+void FrameRender_MarkVramWritten(uintptr_t dest, u32 size)
+{
+    uintptr_t start = dest;
+    uintptr_t end = start + size;
+    u32 block;
+
+    if (size == 0 || end <= VRAM || start >= VRAM + VRAM_SIZE)
+        return;
+
+    start = max(start, VRAM) - VRAM;
+    end = min(end, VRAM + VRAM_SIZE) - VRAM;
+    for (block = start / VRAM_BLOCK_SIZE; block * VRAM_BLOCK_SIZE < end; block++)
+        atomic_store_explicit(&sVramBlockDirty[block], TRUE, memory_order_relaxed);
+}
+
+void FrameRender_Init(u32 numWorkers, u32 bandHeight)
+{
+    u32 i;
+
+    FrameRender_Shutdown();
+    for (i = 0; i < NUM_SNAPSHOTS; i++)
+        sSnapshots[i] = calloc(1, sizeof(struct FrameSnapshot));
+    sCaptureSnapshot = 0;
+    sDrawSnapshot = 1;
+    atomic_store(&sLatestSnapshot, 2);
+    sFrameCount = 0;
+    for (i = 0; i < NUM_VRAM_BLOCKS; i++)
+        sVramBlockChanged[i] = 1; // newer than any empty snapshot
+
+    sBandHeight = bandHeight != 0 ? bandHeight : DEFAULT_BAND_HEIGHT;
+    sShuttingDown = FALSE;
+    sNumWorkers = 0;
+    for (i = 0; i < min(numWorkers, MAX_RENDER_WORKERS); i++)
+    {
+        if (pthread_create(&sWorkers[i], NULL, RenderWorker, NULL) != 0)
+            break;
+        sNumWorkers++;
+    }
+}
+
+void FrameRender_Shutdown(void)
+{
+    u32 i;
+
+    FrameRender_StopThread();
+
+    pthread_mutex_lock(&sPoolLock);
+    sShuttingDown = TRUE;
+    pthread_cond_broadcast(&sJobReady);
+    pthread_mutex_unlock(&sPoolLock);
+    for (i = 0; i < sNumWorkers; i++)
+        pthread_join(sWorkers[i], NULL);
+    sNumWorkers = 0;
+
+    for (i = 0; i < NUM_SNAPSHOTS; i++)
+    {
+        free(sSnapshots[i]);
+        sSnapshots[i] = NULL;
+    }
+
+    pthread_mutex_lock(&sFrontBufferLock);
+    free(sBackBuffer);
+    free(sFrontBuffer);
+    sBackBuffer = NULL;
+    sFrontBuffer = NULL;
+    sFrontBufferFrame = 0;
+    pthread_mutex_unlock(&sFrontBufferLock);
+}
+
+void FrameRender_SetLineTable(u8 slot, const void *values, volatile void *reg, u8 firstLine, bool8 is32Bit)
+{
+    sLineTables[slot].values = values;
+    sLineTables[slot].regOffset = (uintptr_t)reg - REG_BASE;
+    sLineTables[slot].firstLine = firstLine;
+    sLineTables[slot].is32Bit = is32Bit;
+}
+
+void FrameRender_ClearLineTable(u8 slot)
+{
+    sLineTables[slot].values = NULL;
+}
+
+void FrameRender_ClearLineTables(void)
+{
+    u8 i;
+
+    for (i = 0; i < FRAME_LINE_TABLE_COUNT; i++)
+        sLineTables[i].values = NULL;
+}
+
+// Redirects the 4bpp tiles of char blocks 0-1 with a non-NULL entry in
+// sources to read from there instead of VRAM, for the next captured frame
+// only. version has to change whenever the table does.
+void FrameRender_SetBgTileSources(const u16 *const *sources, u32 version)
+{
+    sBgTileSources = sources;
+    sBgTileSourcesVersion = version;
+}
+
+// Draws text BG bg from tilemap, width x height tiles, instead of its screen
+// block, for the next captured frame only. x and y are the tilemap's pixel
+// at the BG's scroll. The capture copies a window of 32x32 tiles from one
+// tile left and four tiles above that, so lines that scroll the BG a little
+// differently still find their tiles; outside the tilemap is transparent.
+void FrameRender_SetBgView(u8 bg, const u16 *tilemap, u32 width, u32 height, s32 x, s32 y)
+{
+    sBgViews[bg].tilemap = tilemap;
+    sBgViews[bg].width = width;
+    sBgViews[bg].height = height;
+    sBgViews[bg].x = x;
+    sBgViews[bg].y = y;
+    sBgViewMask |= 1 << bg;
+}
+
+static void ApplyLineTables(u16 *regs, u32 line)
+{
+    u32 i, index;
+
+    for (i = 0; i < FRAME_LINE_TABLE_COUNT; i++)
+    {
+        if (sLineTables[i].values == NULL || line < sLineTables[i].firstLine)
+            continue;
+
+        index = line - sLineTables[i].firstLine;
+        if (sLineTables[i].is32Bit)
+            memcpy(&regs[sLineTables[i].regOffset / 2], &((const u32 *)sLineTables[i].values)[index], sizeof(u32));
+        else
+            regs[sLineTables[i].regOffset / 2] = ((const u16 *)sLineTables[i].values)[index];
+    }
+}
+
+// Each line sees the registers as they are now, with the line tables'
+// values for it applied on top. A table's value stays in its register for
+// the lines after, as the HBlank DMA's does.
+static void CaptureLineRegs(struct FrameSnapshot *snapshot)
+{
+    u16 regs[FRAME_LINE_REGS_SIZE / 2];
+    u32 line;
+
+    memcpy(regs, (const void *)REG_BASE, FRAME_LINE_REGS_SIZE);
+    for (line = 0; line < DISPLAY_HEIGHT; line++)
+    {
+        ApplyLineTables(regs, line);
+        memcpy(snapshot->lineRegs[line], regs, FRAME_LINE_REGS_SIZE);
+    }
+}
+
+// Brings the snapshot's VRAM up to date. It still holds the frame it was
+// last captured for, so only blocks written since then need copying.
+static void CaptureVram(struct FrameSnapshot *snapshot)
+{
+    u32 i, offset;
+
+    for (i = 0; i < NUM_VRAM_BLOCKS; i++)
+    {
+        offset = i * VRAM_BLOCK_SIZE;
+        // Cleared before copying, so a write racing the copy is seen next frame.
+        if (atomic_exchange_explicit(&sVramBlockDirty[i], FALSE, memory_order_relaxed))
+            sVramBlockChanged[i] = sFrameCount;
+        if (sVramBlockChanged[i] > snapshot->frameCount)
+            memcpy(&snapshot->vram[offset], (const void *)(VRAM + offset), VRAM_BLOCK_SIZE);
+    }
+}
+
+// The table only changes when an animation advances, so it is only copied then.
+static void CaptureBgTileSources(struct FrameSnapshot *snapshot)
+{
+    if (sBgTileSources == NULL)
+    {
+        if (snapshot->bgTileSourcesVersion != 0)
+        {
+            memset(snapshot->bgTileSources, 0, sizeof(snapshot->bgTileSources));
+            snapshot->bgTileSourcesVersion = 0;
+        }
+    }
+    else if (snapshot->bgTileSourcesVersion != sBgTileSourcesVersion)
+    {
+        memcpy(snapshot->bgTileSources, sBgTileSources, sizeof(snapshot->bgTileSources));
+        snapshot->bgTileSourcesVersion = sBgTileSourcesVersion;
+    }
+}
+
+static void CaptureBgViews(struct FrameSnapshot *snapshot)
+{
+    const u16 *regs = (const u16 *)REG_BASE;
+    const struct BgView *view;
+    s32 left, top, tileX, tileY;
+    u32 bg, row, col;
+    u16 *dest;
+
+    snapshot->bgViewMask = sBgViewMask;
+    for (bg = 0; bg < NUM_BACKGROUNDS; bg++)
+    {
+        if (!(sBgViewMask & (1 << bg)))
+            continue;
+
+        view = &sBgViews[bg];
+        left = (view->x >> 3) - 1;
+        top = (view->y >> 3) - 4;
+        for (row = 0; row < FRAME_BG_VIEW_TILES; row++)
+        {
+            tileY = top + row;
+            dest = &snapshot->bgViews[bg][(tileY & (FRAME_BG_VIEW_TILES - 1)) * FRAME_BG_VIEW_TILES];
+            for (col = 0; col < FRAME_BG_VIEW_TILES; col++)
+            {
+                tileX = left + col;
+                if (tileX < 0 || tileY < 0 || tileX >= view->width || tileY >= view->height)
+                    dest[tileX & (FRAME_BG_VIEW_TILES - 1)] = 0;
+                else
+                    dest[tileX & (FRAME_BG_VIEW_TILES - 1)] = view->tilemap[tileY * view->width + tileX];
+            }
+        }
+        snapshot->bgViewOffsets[bg][0] = view->x - regs[(REG_OFFSET_BG0HOFS + bg * 4) / 2];
+        snapshot->bgViewOffsets[bg][1] = view->y - regs[(REG_OFFSET_BG0VOFS + bg * 4) / 2];
+    }
+    sBgViewMask = 0;
+}
+
+// Called on the game thread at the end of VBlank, once the buffered GPU
+// registers and DMA3 requests have been applied.
+void FrameRender_SubmitFrame(void)
+{
+    struct FrameSnapshot *snapshot = sSnapshots[sCaptureSnapshot];
+
+    if (snapshot == NULL)
+        return;
+
+    sFrameCount++;
+    CaptureLineRegs(snapshot);
+    memcpy(snapshot->pltt, (const void *)PLTT, PLTT_SIZE);
+    memcpy(snapshot->oam, (const void *)OAM, OAM_SIZE);
+    CaptureVram(snapshot);
+    CaptureBgTileSources(snapshot);
+    sBgTileSources = NULL;
+    CaptureBgViews(snapshot);
+    snapshot->frameCount = sFrameCount;
+
+    sCaptureSnapshot = atomic_exchange(&sLatestSnapshot, sCaptureSnapshot | SNAPSHOT_FRESH) & ~SNAPSHOT_FRESH;
+    if (sRenderThreadRunning)
+        sem_post(&sFrameSubmitted);
+}
+
+// Returns the newest frame for the render thread, or NULL if none has been
+// submitted since the last call. The snapshot stays valid until the next
+// call that returns a new one.
+const struct FrameSnapshot *FrameRender_AcquireLatest(void)
+{
+    if (sSnapshots[0] == NULL || !(atomic_load(&sLatestSnapshot) & SNAPSHOT_FRESH))
+        return NULL;
+
+    sDrawSnapshot = atomic_exchange(&sLatestSnapshot, sDrawSnapshot) & ~SNAPSHOT_FRESH;
+    return sSnapshots[sDrawSnapshot];
+}
+
+// Draws every line of the snapshot, split into bands shared between the
+// worker pool and the calling thread. Returns once all lines are drawn.
+void FrameRender_DrawBands(const struct FrameSnapshot *snapshot, FrameRenderLineFunc func, void *userData)
+{
+    pthread_mutex_lock(&sPoolLock);
+    // A worker that woke too late for the last job may still be looking at it.
+    while (sBusyWorkers != 0)
+        pthread_cond_wait(&sJobDone, &sPoolLock);
+    sJobSnapshot = snapshot;
+    sJobFunc = func;
+    sJobUserData = userData;
+    sJobBands = (DISPLAY_HEIGHT + sBandHeight - 1) / sBandHeight;
+    atomic_store(&sBandsDone, 0);
+    atomic_store(&sNextBand, 0);
+    sJobGeneration++;
+    pthread_cond_broadcast(&sJobReady);
+    pthread_mutex_unlock(&sPoolLock);
+
+    DrawBands();
+
+    pthread_mutex_lock(&sPoolLock);
+    while (sBusyWorkers != 0 || atomic_load(&sBandsDone) != sJobBands)
+        pthread_cond_wait(&sJobDone, &sPoolLock);
+    pthread_mutex_unlock(&sPoolLock);
+}
+
+static void *RenderThread(void *arg)
+{
+    const struct FrameSnapshot *snapshot;
+
+    while (TRUE)
+    {
+        sem_wait(&sFrameSubmitted);
+        if (atomic_load(&sStopRenderThread))
+            return NULL;
+
+        // NULL when several submissions were already folded into one frame
+        snapshot = FrameRender_AcquireLatest();
+        if (snapshot == NULL)
+            continue;
+        FrameRender_DrawBands(snapshot, sRenderDrawLine, sRenderUserData);
+        sRenderPresent(snapshot, sRenderUserData);
+        atomic_fetch_add(&sFramesPresented, 1);
+    }
+}
+
+// Draws and presents each submitted frame on a thread of its own. Call after
+// FrameRender_Init; from then on nothing else may call
+// FrameRender_AcquireLatest or FrameRender_DrawBands.
+bool8 FrameRender_StartThread(FrameRenderLineFunc drawLine, FrameRenderPresentFunc present, void *userData)
+{
+    if (sRenderThreadRunning || sSnapshots[0] == NULL)
+        return FALSE;
+
+    sRenderDrawLine = drawLine;
+    sRenderPresent = present;
+    sRenderUserData = userData;
+    atomic_store(&sStopRenderThread, FALSE);
+    atomic_store(&sFramesPresented, 0);
+    if (sem_init(&sFrameSubmitted, 0, 0) != 0)
+        return FALSE;
+    if (pthread_create(&sRenderThread, NULL, RenderThread, NULL) != 0)
+    {
+        sem_destroy(&sFrameSubmitted);
+        return FALSE;
+    }
+    sRenderThreadRunning = TRUE;
+    return TRUE;
+}
+
+void FrameRender_StopThread(void)
+{
+    if (!sRenderThreadRunning)
+        return;
+
+    sRenderThreadRunning = FALSE;
+    atomic_store(&sStopRenderThread, TRUE);
+    sem_post(&sFrameSubmitted);
+    pthread_join(sRenderThread, NULL);
+    sem_destroy(&sFrameSubmitted);
+}
+
+bool8 FrameRender_IsRunning(void)
+{
+    return sRenderThreadRunning;
+}
+
+void FrameRender_GetStats(struct FrameRenderStats *stats)
+{
+    stats->framesSubmitted = sFrameCount;
+    stats->framesPresented = atomic_load(&sFramesPresented);
+}
+
+static void PresentToFrontBuffer(const struct FrameSnapshot *snapshot, void *userData)
+{
+    u32 *drawn = sBackBuffer;
+
+    pthread_mutex_lock(&sFrontBufferLock);
+    sBackBuffer = sFrontBuffer;
+    sFrontBuffer = drawn;
+    sFrontBufferFrame = snapshot->frameCount;
+    pthread_mutex_unlock(&sFrontBufferLock);
+}
+
+static void DrawLineToBackBuffer(const struct FrameSnapshot *snapshot, u32 line, void *userData)
+{
+    FrameCompose_DrawLine(snapshot, line, sBackBuffer);
+}
+
+// Copies the newest presented frame, DISPLAY_WIDTH x DISPLAY_HEIGHT
+// 0xAARRGGBB colors, into pixels. Returns the frame's number, or 0 with
+// pixels untouched if nothing has been presented yet.
+u32 FrameRender_CopyPresentedFrame(u32 *pixels)
+{
+    u32 frame;
+
+    pthread_mutex_lock(&sFrontBufferLock);
+    frame = sFrontBufferFrame;
+    if (frame != 0)
+        memcpy(pixels, sFrontBuffer, DISPLAY_WIDTH * DISPLAY_HEIGHT * sizeof(u32));
+    pthread_mutex_unlock(&sFrontBufferLock);
+    return frame;
+}
+
+// Starts the threaded renderer when EMERALD_RENDER_WORKERS is set, with that
+// many workers besides the render thread, drawing each frame with
+// FrameCompose_DrawLine.
+void FrameRender_InitFromEnv(void)
+{
+    const char *workers = getenv("EMERALD_RENDER_WORKERS");
+
+    if (workers == NULL)
+        return;
+
+    FrameRender_Init(strtoul(workers, NULL, 10), 0);
+    sBackBuffer = calloc(DISPLAY_WIDTH * DISPLAY_HEIGHT, sizeof(u32));
+    sFrontBuffer = calloc(DISPLAY_WIDTH * DISPLAY_HEIGHT, sizeof(u32));
+    if (sSnapshots[0] == NULL || sBackBuffer == NULL || sFrontBuffer == NULL
+     || !FrameRender_StartThread(DrawLineToBackBuffer, PresentToFrontBuffer, NULL))
+    {
+        fprintf(stderr, "Failed to start the frame renderer\n");
+        FrameRender_Shutdown();
+        return;
+    }
+    atexit(FrameRender_Shutdown);
+}
+
+#endif // PORTABLE
@@ -290,6 +290,12 @@ EWRAM_DATA u16 gReservedSpriteTileCount = 0;
 EWRAM_DATA static u8 sSpriteTileAllocBitmap[128] = {0};
 EWRAM_DATA s16 gSpriteCoordOffsetX = 0;
 EWRAM_DATA s16 gSpriteCoordOffsetY = 0;
+
+#ifdef PORTABLE
+void (*gSpriteCallbackWrapper)(struct Sprite *sprite);
+u32 gSpriteTilesLoaded;
+u32 gSpritePalettesLoaded;
+#endif
 EWRAM_DATA struct OamMatrix gOamMatrices[OAM_MATRIX_COUNT] = {0};
 EWRAM_DATA bool8 gAffineAnimsDisabled = FALSE;
 
@@ -316,6 +322,11 @@ void AnimateSprites(void)
 
         if (sprite->inUse)
         {
+#ifdef PORTABLE
+            if (gSpriteCallbackWrapper != NULL)
+                gSpriteCallbackWrapper(sprite);
+            else
+#endif
             sprite->callback(sprite);
 
             if (sprite->inUse)
@@ -1493,6 +1504,9 @@ u16 LoadSpriteSheet(const struct SpriteSheet *sheet)
     {
         AllocSpriteTileRange(sheet->tag, (u16)tileStart, sheet->size / TILE_SIZE_4BPP);
         CpuCopy16(sheet->data, (u8 *)OBJ_VRAM0 + TILE_SIZE_4BPP * tileStart, sheet->size);
+#ifdef PORTABLE
+        gSpriteTilesLoaded += sheet->size / TILE_SIZE_4BPP;
+#endif
         return (u16)tileStart;
     }
 }
@@ -1601,6 +1615,9 @@ u8 LoadSpritePalette(const struct SpritePalette *palette)
     {
         sSpritePaletteTags[index] = palette->tag;
         DoLoadSpritePalette(palette->data, PLTT_ID(index));
+#ifdef PORTABLE
+        gSpritePalettesLoaded++;
+#endif
         return index;
     }
 }
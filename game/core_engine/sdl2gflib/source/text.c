@@ -1,3 +1,8 @@
+#ifdef PORTABLE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#endif
 #include "global.h"
 #include "battle.h"
 #include "main.h"
@@ -35,6 +40,11 @@ static u32 GetGlyphWidth_Short(u16, bool32);
 static u32 GetGlyphWidth_Narrow(u16, bool32);
 static u32 GetGlyphWidth_SmallNarrow(u16, bool32);
 
+#ifdef PORTABLE
+static s32 MeasureString(u8 fontId, const u8 *str, s16 letterSpacing);
+static void StringWidthCache_Invalidate(void);
+#endif
+
 static EWRAM_DATA struct TextPrinter sTempTextPrinter = {0};
 static EWRAM_DATA struct TextPrinter sTextPrinters[WINDOWS_MAX] = {0};
 
@@ -239,6 +249,10 @@ static const u16 sFontBoldJapaneseGlyphs[] = INCBIN_U16("graphics/fonts/bold.hwj
 static void SetFontsPointer(const struct FontInfo *fonts)
 {
     gFonts = fonts;
+#ifdef PORTABLE
+    // Letter spacing attributes come from the font table.
+    StringWidthCache_Invalidate();
+#endif
 }
 
 void DeactivateAllTextPrinters(void)
@@ -1325,7 +1339,154 @@ static u32 (*GetFontWidthFunc(u8 fontId))(u16, bool32)
     return NULL;
 }
 
+#ifdef PORTABLE
+// Widths are keyed on the string's bytes rather than its address, so text
+// rebuilt in place by StringExpandPlaceholders/StringCopy never matches a
+// stale entry. Strings that still contain placeholders depend on
+// gStringVar* and are measured directly.
+#define STRING_WIDTH_CACHE_SIZE    1024
+#define STRING_WIDTH_CACHE_MAX_LEN 64
+
+struct StringWidthCacheEntry
+{
+    u32 hash;
+    bool8 valid;
+    u8 fontId;
+    s16 letterSpacing;
+    u8 length;
+    u8 text[STRING_WIDTH_CACHE_MAX_LEN];
+    s32 width;
+};
+
+bool8 gStringWidthCache = TRUE;
+
+static struct StringWidthCacheEntry sStringWidthCache[STRING_WIDTH_CACHE_SIZE];
+static struct StringWidthCacheStats sStringWidthCacheStats;
+static const char *sStringWidthCacheReportPath;
+
+static void StringWidthCache_Invalidate(void)
+{
+    u32 i;
+
+    for (i = 0; i < STRING_WIDTH_CACHE_SIZE; i++)
+        sStringWidthCache[i].valid = FALSE;
+    sStringWidthCacheStats.invalidations++;
+}
+
+// FNV-1a over the font, the letter spacing and the string up to EOS.
+// Returns FALSE for strings that can't be cached: too long, or containing
+// placeholders whose expansion can change.
+static bool8 HashStringWidthKey(u8 fontId, s16 letterSpacing, const u8 *str, u32 *hash, u32 *length)
+{
+    u32 h = 2166136261u;
+    u32 i;
+
+    h = (h ^ fontId) * 16777619u;
+    h = (h ^ (u8)letterSpacing) * 16777619u;
+    h = (h ^ (u8)(letterSpacing >> 8)) * 16777619u;
+    for (i = 0; str[i] != EOS; i++)
+    {
+        if (i >= STRING_WIDTH_CACHE_MAX_LEN || str[i] == PLACEHOLDER_BEGIN || str[i] == CHAR_DYNAMIC)
+            return FALSE;
+        h = (h ^ str[i]) * 16777619u;
+    }
+
+    *hash = h;
+    *length = i;
+    return TRUE;
+}
+
+s32 GetStringWidth(u8 fontId, const u8 *str, s16 letterSpacing)
+{
+    struct StringWidthCacheEntry *entry;
+    u32 hash, length;
+    s32 width;
+
+    if (!gStringWidthCache || !HashStringWidthKey(fontId, letterSpacing, str, &hash, &length))
+    {
+        sStringWidthCacheStats.bypassed++;
+        return MeasureString(fontId, str, letterSpacing);
+    }
+
+    entry = &sStringWidthCache[hash & (STRING_WIDTH_CACHE_SIZE - 1)];
+    if (entry->valid
+     && entry->hash == hash
+     && entry->length == length
+     && entry->fontId == fontId
+     && entry->letterSpacing == letterSpacing
+     && memcmp(entry->text, str, length) == 0)
+    {
+        sStringWidthCacheStats.hits++;
+        return entry->width;
+    }
+
+    sStringWidthCacheStats.misses++;
+    width = MeasureString(fontId, str, letterSpacing);
+
+    if (entry->valid)
+        sStringWidthCacheStats.evictions++;
+    entry->valid = TRUE;
+    entry->hash = hash;
+    entry->fontId = fontId;
+    entry->letterSpacing = letterSpacing;
+    entry->length = length;
+    memcpy(entry->text, str, length);
+    entry->width = width;
+    return width;
+}
+
+void GetStringWidthCacheStats(struct StringWidthCacheStats *stats)
+{
+    *stats = sStringWidthCacheStats;
+}
+
+void ResetStringWidthCacheStats(void)
+{
+    memset(&sStringWidthCacheStats, 0, sizeof(sStringWidthCacheStats));
+}
+
+static void WriteStringWidthCacheReportAtExit(void)
+{
+    const struct StringWidthCacheStats *stats = &sStringWidthCacheStats;
+    u32 lookups = stats->hits + stats->misses;
+    FILE *file = fopen(sStringWidthCacheReportPath, "w");
+
+    if (file != NULL)
+    {
+        fprintf(file, "String width cache\n");
+        fprintf(file, "%-14s %10u\n", "hits", stats->hits);
+        fprintf(file, "%-14s %10u\n", "misses", stats->misses);
+        fprintf(file, "%-14s %10u\n", "bypassed", stats->bypassed);
+        fprintf(file, "%-14s %10u\n", "evictions", stats->evictions);
+        fprintf(file, "%-14s %10u\n", "invalidations", stats->invalidations);
+        fprintf(file, "%-14s %9.1f%%\n", "hit rate", lookups != 0 ? 100.0 * stats->hits / lookups : 0.0);
+    }
+    if (file == NULL || fclose(file) != 0)
+        fprintf(stderr, "Failed to write the string width cache report to %s\n", sStringWidthCacheReportPath);
+}
+
+// Called once at startup. EMERALD_TEXT_CACHE_PROFILE names the file the
+// cache's counters are written to when the game exits, and
+// EMERALD_TEXT_CACHE=0 measures every string for comparison.
+void StringWidthCache_InitFromEnv(void)
+{
+    const char *value = getenv("EMERALD_TEXT_CACHE");
+
+    if (value != NULL && strcmp(value, "0") == 0)
+        gStringWidthCache = FALSE;
+
+    sStringWidthCacheReportPath = getenv("EMERALD_TEXT_CACHE_PROFILE");
+    if (sStringWidthCacheReportPath == NULL || sStringWidthCacheReportPath[0] == '\0')
+        return;
+
+    ResetStringWidthCacheStats();
+    atexit(WriteStringWidthCacheReportAtExit);
+}
+
+static s32 MeasureString(u8 fontId, const u8 *str, s16 letterSpacing)
+#else
 s32 GetStringWidth(u8 fontId, const u8 *str, s16 letterSpacing)
+#endif
 {
     bool8 isJapanese;
     int minGlyphWidth;
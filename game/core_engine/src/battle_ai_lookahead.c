@@ -0,0 +1,338 @@
+#include "global.h"
+#include "battle.h"
+#include "battle_ai_lookahead.h"
+#include "battle_ai_script_commands.h"
+#include "battle_anim.h"
+#include "battle_controllers.h"
+#include "battle_main.h"
+#include "battle_replay.h"
+#include "battle_util.h"
+#include "load_save.h"
+#include "pokemon.h"
+#include "random.h"
+#include "recorded_battle.h"
+#include "util.h"
+#include "constants/abilities.h"
+
+#ifdef PORTABLE
+
+// AI_SCRIPT_LOOKAHEAD: a battler with it tries its options out by playing the
+// battle forward a few turns with the real battle engine. When choosing an
+// action the options are staying in and switching to each mon that can come
+// in; when choosing a move, every move the AI scripts left a score on.
+//
+// Every rollout starts from a copy of the battle (struct BattleContext), so
+// it runs in process on the same engine: the candidate is submitted, every
+// battler goes to the headless controller, so both sides keep choosing moves
+// and switches with their own AI, and the battle is scored once it ends or
+// the turns have passed. The copy is loaded back before the next rollout and
+// once the search is over, along with the save data a battle can touch, and
+// recording is paused meanwhile.
+//
+// A round rolls out every candidate once from the same seed, and rounds
+// repeat with new seeds, up to rolloutsPerCandidate, while there are battle
+// engine steps left of stepBudget, which covers the whole decision. Each
+// round's rollouts may take an even share of the steps left for the rollouts
+// still to come. The best total wins, the AI's own choice on ties. Nothing
+// here depends on the host, so the same battle makes the same choices every
+// time and can be replayed.
+
+#define LOOKAHEAD_WIN_SCORE  10000 // on top of the HP difference, which is at most 6000
+#define MAX_LOOKAHEAD_CANDIDATES PARTY_SIZE // staying in plus up to 5 switches
+
+struct BattleAILookaheadSettings gBattleAILookahead =
+{
+    .inFrontier = FALSE,
+    .turns = 3,
+    .rolloutsPerCandidate = 16,
+    .stepBudget = 20000,
+};
+
+// Everything a rollout can change, as it was when the search started.
+struct LookaheadRoot
+{
+    struct BattleContext battle;
+    struct SaveBlock1 saveBlock1;
+    struct SaveBlock2 saveBlock2;
+    u32 headlessMoveUses[NUM_BATTLE_SIDES][MOVES_COUNT];
+    u32 aiScriptMismatches;
+    bool8 headlessBattle;
+};
+
+static struct LookaheadRoot sRoot;
+static bool8 sInRollout;
+
+static void SaveRoot(void)
+{
+    BattleContext_Save(&sRoot.battle);
+    memcpy(&sRoot.saveBlock1, gSaveBlock1Ptr, sizeof(sRoot.saveBlock1));
+    memcpy(&sRoot.saveBlock2, gSaveBlock2Ptr, sizeof(sRoot.saveBlock2));
+    memcpy(sRoot.headlessMoveUses, gHeadlessMoveUses, sizeof(sRoot.headlessMoveUses));
+    sRoot.aiScriptMismatches = gBattleAIScriptMismatches;
+    sRoot.headlessBattle = gHeadlessBattle;
+}
+
+static void LoadRoot(void)
+{
+    BattleContext_Load(&sRoot.battle);
+    memcpy(gSaveBlock1Ptr, &sRoot.saveBlock1, sizeof(sRoot.saveBlock1));
+    memcpy(gSaveBlock2Ptr, &sRoot.saveBlock2, sizeof(sRoot.saveBlock2));
+    memcpy(gHeadlessMoveUses, sRoot.headlessMoveUses, sizeof(sRoot.headlessMoveUses));
+    gBattleAIScriptMismatches = sRoot.aiScriptMismatches;
+    gHeadlessBattle = sRoot.headlessBattle;
+}
+
+// Sum of the HP left in a side's party, each mon out of 1000.
+static s32 GetSideHPScore(u8 side)
+{
+    struct Pokemon *party = (side == B_SIDE_PLAYER) ? gPlayerParty : gEnemyParty;
+    s32 score = 0;
+    s32 i;
+
+    for (i = 0; i < PARTY_SIZE; i++)
+    {
+        u16 species = GetMonData(&party[i], MON_DATA_SPECIES_OR_EGG);
+        u16 maxHP = GetMonData(&party[i], MON_DATA_MAX_HP);
+
+        if (species != SPECIES_NONE && species != SPECIES_EGG && maxHP != 0)
+            score += GetMonData(&party[i], MON_DATA_HP) * 1000 / maxHP;
+    }
+    return score;
+}
+
+static s32 EvaluateBattle(u8 side)
+{
+    s32 score = GetSideHPScore(side) - GetSideHPScore(BATTLE_OPPOSITE(side));
+    u8 winner;
+
+    switch (gBattleOutcome & ~B_OUTCOME_LINK_BATTLE_RAN)
+    {
+    case B_OUTCOME_WON:
+        winner = B_SIDE_PLAYER;
+        break;
+    case B_OUTCOME_LOST:
+        winner = B_SIDE_OPPONENT;
+        break;
+    default:
+        return score;
+    }
+
+    return (winner == side) ? score + LOOKAHEAD_WIN_SCORE : score - LOOKAHEAD_WIN_SCORE;
+}
+
+// Answers the pending CONTROLLER_CHOOSEMOVE like the AI controllers do.
+static void EmitChosenMove(u8 moveId)
+{
+    u16 move = gBattleMons[gActiveBattler].moves[moveId];
+
+    if (gBattleMoves[move].target & (MOVE_TARGET_USER | MOVE_TARGET_USER_OR_SELECTED))
+        gBattlerTarget = gActiveBattler;
+    if (gBattleMoves[move].target & MOVE_TARGET_BOTH)
+        gBattlerTarget = BATTLE_OPPOSITE(gActiveBattler);
+
+    BtlController_EmitTwoReturnValues(BUFFER_B, B_ACTION_EXEC_SCRIPT, moveId | (gBattlerTarget << 8));
+}
+
+// Answers the pending CONTROLLER_CHOOSEACTION like AI_TrySwitchOrUseItem
+// does, with a switch to partyId or, for PARTY_SIZE, a move.
+static void EmitChosenAction(u8 partyId)
+{
+    *(gBattleStruct->AI_monToSwitchIntoId + gActiveBattler) = partyId;
+    *(gBattleStruct->monToSwitchIntoId + gActiveBattler) = partyId;
+
+    if (partyId == PARTY_SIZE)
+        BtlController_EmitTwoReturnValues(BUFFER_B, B_ACTION_USE_MOVE, BATTLE_OPPOSITE(gActiveBattler) << 8);
+    else
+        BtlController_EmitTwoReturnValues(BUFFER_B, B_ACTION_SWITCH, 0);
+}
+
+static u32 GetRolloutSeed(u32 baseSeed, u32 round)
+{
+    u32 seed = baseSeed ^ ((round + 1) * 0x9E3779B9);
+
+    seed ^= seed >> 16;
+    seed *= 0x85EBCA6B;
+    seed ^= seed >> 13;
+    return seed;
+}
+
+// Rolls every candidate out and returns the best one, or fallback on ties.
+// The battle is left as it was; the caller submits the choice.
+static u8 ChooseBestCandidate(const u8 *candidates, u8 numCandidates, u8 fallback, void (*emit)(u8 candidate))
+{
+    s32 totals[MAX_LOOKAHEAD_CANDIDATES] = {0};
+    u8 side = GetBattlerSide(gActiveBattler);
+    u32 seed = gRngValue;
+    u32 steps = 0;
+    u32 stepLimit;
+    u32 round;
+    u8 best;
+    s32 i;
+
+    SaveRoot();
+    sInRollout = TRUE;
+    RecordedBattle_SetPaused(TRUE);
+    BattleReplay_SetPaused(TRUE);
+
+    // A round that starts always finishes, and its rollouts all get the same
+    // step limit, so every candidate has the same number of rollouts and the
+    // totals compare like averages.
+    for (round = 0; round < gBattleAILookahead.rolloutsPerCandidate; round++)
+    {
+        stepLimit = (gBattleAILookahead.stepBudget - steps)
+                  / ((gBattleAILookahead.rolloutsPerCandidate - round) * numCandidates);
+        if (stepLimit == 0)
+            break;
+
+        for (i = 0; i < numCandidates; i++)
+        {
+            LoadRoot();
+            gRngValue = GetRolloutSeed(seed, round);
+            emit(candidates[i]);
+            gBattleControllerExecFlags &= ~gBitTable[gActiveBattler];
+            steps += ContinueBattleHeadless(gBattleAILookahead.turns, stepLimit);
+            totals[i] += EvaluateBattle(side);
+        }
+    }
+
+    LoadRoot();
+    BattleReplay_SetPaused(FALSE);
+    RecordedBattle_SetPaused(FALSE);
+    sInRollout = FALSE;
+
+    best = 0;
+    for (i = 1; i < numCandidates; i++)
+    {
+        if (totals[i] > totals[best])
+            best = i;
+    }
+    for (i = 0; i < numCandidates; i++)
+    {
+        if (candidates[i] == fallback && totals[i] == totals[best])
+            best = i;
+    }
+
+    return candidates[best];
+}
+
+static bool8 CanLookAhead(u8 controllerCmd)
+{
+    if (sInRollout || gBattleAILookahead.rolloutsPerCandidate == 0 || gBattleAILookahead.stepBudget == 0)
+        return FALSE;
+    if (gBattleTypeFlags & (BATTLE_TYPE_DOUBLE | BATTLE_TYPE_LINK | BATTLE_TYPE_RECORDED | BATTLE_TYPE_PALACE | BATTLE_TYPE_SAFARI))
+        return FALSE;
+
+    return gBattleBufferA[gActiveBattler][0] == controllerCmd;
+}
+
+// The same checks HandleTurnActionSelectionState makes before it lets a
+// battler pick a mon to switch to.
+static bool8 CanSwitchOut(void)
+{
+    s32 i;
+
+    if ((gBattleMons[gActiveBattler].status2 & (STATUS2_WRAPPED | STATUS2_ESCAPE_PREVENTION))
+     || (gBattleTypeFlags & BATTLE_TYPE_ARENA)
+     || (gStatuses3[gActiveBattler] & STATUS3_ROOTED))
+        return FALSE;
+
+    for (i = 0; i < gBattlersCount; i++)
+    {
+        if (i == gActiveBattler || gBattleMons[i].hp == 0 || (gAbsentBattlerFlags & gBitTable[i]))
+            continue;
+
+        switch (gBattleMons[i].ability)
+        {
+        case ABILITY_SHADOW_TAG:
+            if (GetBattlerSide(i) != GetBattlerSide(gActiveBattler))
+                return FALSE;
+            break;
+        case ABILITY_ARENA_TRAP:
+            if (GetBattlerSide(i) != GetBattlerSide(gActiveBattler)
+             && !IS_BATTLER_OF_TYPE(gActiveBattler, TYPE_FLYING)
+             && gBattleMons[gActiveBattler].ability != ABILITY_LEVITATE)
+                return FALSE;
+            break;
+        case ABILITY_MAGNET_PULL:
+            if (IS_BATTLER_OF_TYPE(gActiveBattler, TYPE_STEEL))
+                return FALSE;
+            break;
+        }
+    }
+    return TRUE;
+}
+
+bool8 BattleAI_HasLookahead(void)
+{
+    return (gBattleTypeFlags & BATTLE_TYPE_FRONTIER) && gBattleAILookahead.inFrontier;
+}
+
+// Called by the opponent controller after AI_TrySwitchOrUseItem has answered
+// CONTROLLER_CHOOSEACTION. Replaces the answer if staying in or switching to
+// another mon plays out better. Item use is left alone.
+void BattleAI_LookaheadChooseAction(void)
+{
+    struct Pokemon *party = (GetBattlerSide(gActiveBattler) == B_SIDE_PLAYER) ? gPlayerParty : gEnemyParty;
+    u8 candidates[MAX_LOOKAHEAD_CANDIDATES];
+    u8 numCandidates = 0;
+    u8 aiChoice, choice;
+    s32 i;
+
+    if (!BattleAI_HasLookahead() || !CanLookAhead(CONTROLLER_CHOOSEACTION))
+        return;
+
+    switch (gBattleBufferB[gActiveBattler][1])
+    {
+    case B_ACTION_USE_MOVE:
+        aiChoice = PARTY_SIZE;
+        break;
+    case B_ACTION_SWITCH:
+        aiChoice = *(gBattleStruct->monToSwitchIntoId + gActiveBattler);
+        break;
+    default:
+        return;
+    }
+    if (!CanSwitchOut())
+        return;
+
+    candidates[numCandidates++] = PARTY_SIZE;
+    for (i = 0; i < PARTY_SIZE; i++)
+    {
+        u16 species = GetMonData(&party[i], MON_DATA_SPECIES_OR_EGG);
+
+        if (species != SPECIES_NONE && species != SPECIES_EGG
+         && GetMonData(&party[i], MON_DATA_HP) != 0
+         && i != gBattlerPartyIndexes[gActiveBattler])
+            candidates[numCandidates++] = i;
+    }
+    if (numCandidates < 2)
+        return;
+
+    choice = ChooseBestCandidate(candidates, numCandidates, aiChoice, EmitChosenAction);
+    if (choice != aiChoice)
+        EmitChosenAction(choice);
+}
+
+// Called by BattleAI_ChooseMoveOrAction for battlers with AI_SCRIPT_LOOKAHEAD
+// once the scripts have filled scores and picked scriptChoice.
+u8 BattleAI_LookaheadChooseMove(const s8 *scores, u8 scriptChoice)
+{
+    u8 candidates[MAX_LOOKAHEAD_CANDIDATES];
+    u8 numCandidates = 0;
+    s32 i;
+
+    if (!CanLookAhead(CONTROLLER_CHOOSEMOVE))
+        return scriptChoice;
+
+    for (i = 0; i < MAX_MON_MOVES; i++)
+    {
+        if (gBattleMons[gActiveBattler].moves[i] != MOVE_NONE && scores[i] > 0)
+            candidates[numCandidates++] = i;
+    }
+    if (numCandidates < 2)
+        return scriptChoice;
+
+    return ChooseBestCandidate(candidates, numCandidates, scriptChoice, EmitChosenMove);
+}
+
+#endif // PORTABLE
@@ -1,7 +1,12 @@
+#ifdef PORTABLE
+#include <stdlib.h>
+#endif
+
 #include "global.h"
 #include "battle.h"
 #include "battle_anim.h"
 #include "battle_ai_script_commands.h"
+#include "battle_ai_lookahead.h"
 #include "battle_factory.h"
 #include "battle_setup.h"
 #include "data.h"
@@ -49,6 +54,13 @@ static void RecordLastUsedMoveByTarget(void);
 static void BattleAI_DoAIProcessing(void);
 static void AIStackPushVar(const u8 *);
 static bool8 AIStackPop(void);
+#ifdef PORTABLE
+static void ClearAIDamageCache(void);
+static void AI_CalcDmgAndTypeCached(u8 attacker, u8 defender);
+static void BattleAI_DoCompiledAIProcessing(void);
+static void BattleAI_RunCompiledForComparison(void);
+static void BattleAI_CompareWithCompiled(void);
+#endif
 
 static void Cmd_if_random_less_than(void);
 static void Cmd_if_random_greater_than(void);
@@ -154,6 +166,28 @@ static void Cmd_if_holds_item(void);
 EWRAM_DATA const u8 *gAIScriptPtr = NULL;
 EWRAM_DATA static u8 sBattler_AI = 0;
 
+#ifdef PORTABLE
+// Damage the AI worked out for a move during the current decision, before
+// the simulated random roll. Nothing the calculation reads changes while the
+// AI scripts run, but it is redone for every script and move that asks, so
+// results are kept until the next BattleAI_SetupAIData. Clearing per decision
+// rather than per turn keeps it correct if the battle state changes mid-turn.
+#define AI_DAMAGE_CACHE_SIZE (MAX_BATTLERS_COUNT * MAX_MON_MOVES)
+
+struct AIDamageCacheEntry
+{
+    u16 move;
+    u8 attacker;
+    u8 defender;
+    s32 damage;
+    u16 movePower;
+    u8 lastUsedAbility;
+};
+
+static struct AIDamageCacheEntry sAIDamageCache[AI_DAMAGE_CACHE_SIZE];
+static u8 sAIDamageCacheCount;
+#endif
+
 // const rom data
 typedef void (*BattleAICmdFunc)(void);
 
@@ -319,6 +353,10 @@ void BattleAI_SetupAIData(u8 defaultScoreMoves)
     for (i = 0; i < sizeof(struct AI_ThinkingStruct); i++)
         data[i] = 0;
 
+#ifdef PORTABLE
+    ClearAIDamageCache();
+#endif
+
     // Conditional score reset, unlike Ruby.
     for (i = 0; i < MAX_MON_MOVES; i++)
     {
@@ -375,6 +413,11 @@ void BattleAI_SetupAIData(u8 defaultScoreMoves)
     else
        AI_THINKING_STRUCT->aiFlags = gTrainers[gTrainerBattleOpponent_A].aiFlags;
 
+#ifdef PORTABLE
+    if (BattleAI_HasLookahead())
+        AI_THINKING_STRUCT->aiFlags |= AI_SCRIPT_LOOKAHEAD;
+#endif
+
     if (gBattleTypeFlags & BATTLE_TYPE_DOUBLE)
         AI_THINKING_STRUCT->aiFlags |= AI_SCRIPT_DOUBLE_BATTLE; // act smart in doubles and don't attack your partner
 }
@@ -383,6 +426,10 @@ u8 BattleAI_ChooseMoveOrAction(void)
 {
     u16 savedCurrentMove = gCurrentMove;
     u8 ret;
+#ifdef PORTABLE
+    // The script loop shifts aiFlags out as it goes.
+    u32 aiFlags = AI_THINKING_STRUCT->aiFlags;
+#endif
 
     if (!(gBattleTypeFlags & BATTLE_TYPE_DOUBLE))
         ret = ChooseMoveOrAction_Singles();
@@ -390,6 +437,10 @@ u8 BattleAI_ChooseMoveOrAction(void)
         ret = ChooseMoveOrAction_Doubles();
 
     gCurrentMove = savedCurrentMove;
+#ifdef PORTABLE
+    if ((aiFlags & AI_SCRIPT_LOOKAHEAD) && ret < MAX_MON_MOVES)
+        ret = BattleAI_LookaheadChooseMove(AI_THINKING_STRUCT->score, ret);
+#endif
     return ret;
 }
 
@@ -571,6 +622,16 @@ static u8 ChooseMoveOrAction_Doubles(void)
 
 static void BattleAI_DoAIProcessing(void)
 {
+#ifdef PORTABLE
+    if (gBattleAIScriptMode == BATTLE_AI_SCRIPTS_COMPILED)
+    {
+        BattleAI_DoCompiledAIProcessing();
+        return;
+    }
+    if (gBattleAIScriptMode == BATTLE_AI_SCRIPTS_DIFFERENTIAL)
+        BattleAI_RunCompiledForComparison();
+#endif
+
     while (AI_THINKING_STRUCT->aiState != AIState_FinishedProcessing)
     {
         switch (AI_THINKING_STRUCT->aiState)
@@ -613,6 +674,11 @@ static void BattleAI_DoAIProcessing(void)
                 break;
         }
     }
+
+#ifdef PORTABLE
+    if (gBattleAIScriptMode == BATTLE_AI_SCRIPTS_DIFFERENTIAL)
+        BattleAI_CompareWithCompiled();
+#endif
 }
 
 static void RecordLastUsedMoveByTarget(void)
@@ -632,6 +698,49 @@ static void RecordLastUsedMoveByTarget(void)
     }
 }
 
+#ifdef PORTABLE
+static void ClearAIDamageCache(void)
+{
+    sAIDamageCacheCount = 0;
+}
+
+// Same as AI_CalcDmg followed by TypeCalc for gCurrentMove, including the
+// globals they leave behind, for callers that have reset the damage
+// modifiers (gDynamicBasePower, gCritMultiplier, ...) to their defaults.
+static void AI_CalcDmgAndTypeCached(u8 attacker, u8 defender)
+{
+    struct AIDamageCacheEntry *entry;
+    s32 i;
+
+    for (i = 0; i < sAIDamageCacheCount; i++)
+    {
+        entry = &sAIDamageCache[i];
+        if (entry->move == gCurrentMove && entry->attacker == attacker && entry->defender == defender)
+        {
+            gBattleMoveDamage = entry->damage;
+            gBattleMovePower = entry->movePower;
+            gLastUsedAbility = entry->lastUsedAbility;
+            gDynamicBasePower = 0;
+            return;
+        }
+    }
+
+    AI_CalcDmg(attacker, defender);
+    TypeCalc(gCurrentMove, attacker, defender);
+
+    if (sAIDamageCacheCount < AI_DAMAGE_CACHE_SIZE)
+    {
+        entry = &sAIDamageCache[sAIDamageCacheCount++];
+        entry->move = gCurrentMove;
+        entry->attacker = attacker;
+        entry->defender = defender;
+        entry->damage = gBattleMoveDamage;
+        entry->movePower = gBattleMovePower;
+        entry->lastUsedAbility = gLastUsedAbility;
+    }
+}
+#endif // PORTABLE
+
 void ClearBattlerMoveHistory(u8 battlerId)
 {
     s32 i;
@@ -1206,8 +1315,12 @@ static void Cmd_get_how_powerful_move_is(void)
                 && gBattleMoves[gBattleMons[sBattler_AI].moves[checkedMove]].power > 1)
             {
                 gCurrentMove = gBattleMons[sBattler_AI].moves[checkedMove];
+#ifdef PORTABLE
+                AI_CalcDmgAndTypeCached(sBattler_AI, gBattlerTarget);
+#else
                 AI_CalcDmg(sBattler_AI, gBattlerTarget);
                 TypeCalc(gCurrentMove, sBattler_AI, gBattlerTarget);
+#endif
                 moveDmgs[checkedMove] = gBattleMoveDamage * AI_THINKING_STRUCT->simulatedRNG[checkedMove] / 100;
                 if (moveDmgs[checkedMove] == 0)
                     moveDmgs[checkedMove] = 1;
@@ -1745,8 +1858,12 @@ static void Cmd_if_can_faint(void)
     gMoveResultFlags = 0;
     gCritMultiplier = 1;
     gCurrentMove = AI_THINKING_STRUCT->moveConsidered;
+#ifdef PORTABLE
+    AI_CalcDmgAndTypeCached(sBattler_AI, gBattlerTarget);
+#else
     AI_CalcDmg(sBattler_AI, gBattlerTarget);
     TypeCalc(gCurrentMove, sBattler_AI, gBattlerTarget);
+#endif
 
     gBattleMoveDamage = gBattleMoveDamage * AI_THINKING_STRUCT->simulatedRNG[AI_THINKING_STRUCT->movesetIndex] / 100;
 
@@ -1774,8 +1891,12 @@ static void Cmd_if_cant_faint(void)
     gMoveResultFlags = 0;
     gCritMultiplier = 1;
     gCurrentMove = AI_THINKING_STRUCT->moveConsidered;
+#ifdef PORTABLE
+    AI_CalcDmgAndTypeCached(sBattler_AI, gBattlerTarget);
+#else
     AI_CalcDmg(sBattler_AI, gBattlerTarget);
     TypeCalc(gCurrentMove, sBattler_AI, gBattlerTarget);
+#endif
 
     gBattleMoveDamage = gBattleMoveDamage * AI_THINKING_STRUCT->simulatedRNG[AI_THINKING_STRUCT->movesetIndex] / 100;
 
@@ -2127,23 +2248,48 @@ static void Cmd_get_used_held_item(void)
     gAIScriptPtr += 2;
 }
 
+#ifdef PORTABLE
+// The result can be a last used move of MOVE_UNAVAILABLE, which the GBA looks
+// up past the end of gBattleMoves in ROM. Reading whatever the host has there
+// would make the AI's choices differ between builds, so it gets MOVE_NONE's.
+static const struct BattleMove *GetMoveFromResult(void)
+{
+    if (AI_THINKING_STRUCT->funcResult >= MOVES_COUNT)
+        return &gBattleMoves[MOVE_NONE];
+
+    return &gBattleMoves[AI_THINKING_STRUCT->funcResult];
+}
+#endif
+
 static void Cmd_get_move_type_from_result(void)
 {
+#ifdef PORTABLE
+    AI_THINKING_STRUCT->funcResult = GetMoveFromResult()->type;
+#else
     AI_THINKING_STRUCT->funcResult = gBattleMoves[AI_THINKING_STRUCT->funcResult].type;
+#endif
 
     gAIScriptPtr += 1;
 }
 
 static void Cmd_get_move_power_from_result(void)
 {
+#ifdef PORTABLE
+    AI_THINKING_STRUCT->funcResult = GetMoveFromResult()->power;
+#else
     AI_THINKING_STRUCT->funcResult = gBattleMoves[AI_THINKING_STRUCT->funcResult].power;
+#endif
 
     gAIScriptPtr += 1;
 }
 
 static void Cmd_get_move_effect_from_result(void)
 {
+#ifdef PORTABLE
+    AI_THINKING_STRUCT->funcResult = GetMoveFromResult()->effect;
+#else
     AI_THINKING_STRUCT->funcResult = gBattleMoves[AI_THINKING_STRUCT->funcResult].effect;
+#endif
 
     gAIScriptPtr += 1;
 }
@@ -2285,3 +2431,148 @@ static bool8 AIStackPop(void)
         return FALSE;
     }
 }
+
+#ifdef PORTABLE
+// The AI scripts translated by tools/aiscr2c. The translation only does the
+// dispatch: each command is a direct call to its Cmd_ handler above, with
+// gAIScriptPtr at the command in gBattleAI_ScriptsTable's data so the handler
+// reads its operands from there, and the compiled code then follows the jump
+// the handler took.
+
+u8 gBattleAIScriptMode = BATTLE_AI_SCRIPTS_COMPILED;
+u32 gBattleAIScriptMismatches;
+
+// Called once at startup. EMERALD_AI_SCRIPTS picks gBattleAIScriptMode:
+// "compiled", "interpreted" or "differential".
+void BattleAI_InitFromEnv(void)
+{
+    const char *mode = getenv("EMERALD_AI_SCRIPTS");
+
+    if (mode == NULL || mode[0] == '\0')
+        return;
+
+    if (strcmp(mode, "compiled") == 0)
+        gBattleAIScriptMode = BATTLE_AI_SCRIPTS_COMPILED;
+    else if (strcmp(mode, "interpreted") == 0)
+        gBattleAIScriptMode = BATTLE_AI_SCRIPTS_INTERPRETED;
+    else if (strcmp(mode, "differential") == 0)
+        gBattleAIScriptMode = BATTLE_AI_SCRIPTS_DIFFERENTIAL;
+    else
+        DebugPrintfLevel(MGBA_LOG_WARN, "EMERALD_AI_SCRIPTS: unknown mode %s", mode);
+}
+
+// Runs the rest of the current move's script in the interpreter, from where
+// a handler left gAIScriptPtr when the compiled code doesn't go there.
+static void BattleAI_ContinueInInterpreter(void)
+{
+    while (!(AI_THINKING_STRUCT->aiAction & AI_ACTION_DONE))
+        sBattleAICmdTable[*gAIScriptPtr]();
+}
+
+#include "data/battle_ai_scripts.h"
+
+// Runs the current script over the moveset like BattleAI_DoAIProcessing,
+// calling its translated function in place of the interpreter.
+static void BattleAI_DoCompiledAIProcessing(void)
+{
+    struct AI_ThinkingStruct *ai = AI_THINKING_STRUCT;
+
+    do
+    {
+        gAIScriptPtr = gBattleAI_ScriptsTable[ai->aiLogicId];
+        if (gBattleMons[sBattler_AI].pp[ai->movesetIndex] == 0)
+            ai->moveConsidered = 0;
+        else
+            ai->moveConsidered = gBattleMons[sBattler_AI].moves[ai->movesetIndex];
+
+        if (ai->moveConsidered != 0)
+        {
+            sCompiledBattleAIScripts[ai->aiLogicId]();
+            // An end with return addresses left on the AI stack carries on
+            // from the last one, as in the interpreter.
+            if (!(ai->aiAction & AI_ACTION_DONE))
+                BattleAI_ContinueInInterpreter();
+        }
+        else
+        {
+            ai->score[ai->movesetIndex] = 0;
+        }
+
+        ai->movesetIndex++;
+        ai->aiAction &= ~AI_ACTION_DONE;
+    } while (ai->movesetIndex < MAX_MON_MOVES && !(ai->aiAction & AI_ACTION_DO_NOT_ATTACK));
+
+    ai->aiState = AIState_FinishedProcessing;
+}
+
+// Everything a script can change that later decisions depend on.
+struct AIScriptResult
+{
+    struct AI_ThinkingStruct ai;
+    u32 rngValue;
+    s32 battleMoveDamage;
+    u16 currentMove;
+    u16 dynamicBasePower;
+    u16 battleMovePower;
+    u8 moveResultFlags;
+    u8 critMultiplier;
+    u8 dmgMultiplier;
+    u8 dynamicMoveType;
+    u8 lastUsedAbility;
+};
+
+static struct AIScriptResult sAIScriptStartState;
+static struct AIScriptResult sCompiledAIScriptResult;
+
+static void SaveAIScriptResult(struct AIScriptResult *result)
+{
+    memset(result, 0, sizeof(*result));
+    result->ai = *AI_THINKING_STRUCT;
+    result->rngValue = gRngValue;
+    result->battleMoveDamage = gBattleMoveDamage;
+    result->currentMove = gCurrentMove;
+    result->dynamicBasePower = gDynamicBasePower;
+    result->battleMovePower = gBattleMovePower;
+    result->moveResultFlags = gMoveResultFlags;
+    result->critMultiplier = gCritMultiplier;
+    result->dmgMultiplier = gBattleScripting.dmgMultiplier;
+    result->dynamicMoveType = gBattleStruct->dynamicMoveType;
+    result->lastUsedAbility = gLastUsedAbility;
+}
+
+static void LoadAIScriptResult(const struct AIScriptResult *result)
+{
+    *AI_THINKING_STRUCT = result->ai;
+    gRngValue = result->rngValue;
+    gBattleMoveDamage = result->battleMoveDamage;
+    gCurrentMove = result->currentMove;
+    gDynamicBasePower = result->dynamicBasePower;
+    gBattleMovePower = result->battleMovePower;
+    gMoveResultFlags = result->moveResultFlags;
+    gCritMultiplier = result->critMultiplier;
+    gBattleScripting.dmgMultiplier = result->dmgMultiplier;
+    gBattleStruct->dynamicMoveType = result->dynamicMoveType;
+    gLastUsedAbility = result->lastUsedAbility;
+}
+
+// Runs the compiled script and rewinds, so the interpreter starts from the same state.
+static void BattleAI_RunCompiledForComparison(void)
+{
+    SaveAIScriptResult(&sAIScriptStartState);
+    BattleAI_DoCompiledAIProcessing();
+    SaveAIScriptResult(&sCompiledAIScriptResult);
+    LoadAIScriptResult(&sAIScriptStartState);
+}
+
+static void BattleAI_CompareWithCompiled(void)
+{
+    struct AIScriptResult interpreted;
+
+    SaveAIScriptResult(&interpreted);
+    if (memcmp(&interpreted, &sCompiledAIScriptResult, sizeof(interpreted)) != 0)
+    {
+        gBattleAIScriptMismatches++;
+        DebugPrintfLevel(MGBA_LOG_WARN, "AI script %d differs between the interpreter and compiled code", interpreted.ai.aiLogicId);
+    }
+}
+#endif // PORTABLE
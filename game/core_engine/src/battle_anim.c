@@ -1,6 +1,7 @@
 #include "global.h"
 #include "battle.h"
 #include "battle_anim.h"
+#include "battle_anim_profiler.h"
 #include "battle_controllers.h"
 #include "battle_interface.h"
 #include "bg.h"
@@ -241,6 +242,9 @@ void LaunchBattleAnimation(const u8 *const animsTable[], u16 tableId, bool8 isMo
     gAnimScriptActive = TRUE;
     sAnimFramesToWait = 0;
     gAnimScriptCallback = RunAnimScriptCommand;
+#ifdef PORTABLE
+    BattleAnimProfiler_Begin(animsTable, tableId);
+#endif
 
     for (i = 0; i < ANIM_SPRITE_INDEX_COUNT; i++)
         sAnimSpriteIndexArray[i] = 0xFFFF;
@@ -312,6 +316,9 @@ static void ClearSpriteIndex(u16 index)
 
 static void WaitAnimFrameCount(void)
 {
+#ifdef PORTABLE
+    BattleAnimProfiler_Frame();
+#endif
     if (sAnimFramesToWait <= 0)
     {
         gAnimScriptCallback = RunAnimScriptCommand;
@@ -325,6 +332,9 @@ static void WaitAnimFrameCount(void)
 
 static void RunAnimScriptCommand(void)
 {
+#ifdef PORTABLE
+    BattleAnimProfiler_Frame();
+#endif
     do
     {
         sScriptCmdTable[sBattleAnimScriptPtr[0]]();
@@ -524,6 +534,9 @@ static void Cmd_end(void)
             UpdateOamPriorityInAllHealthboxes(1);
         }
         gAnimScriptActive = FALSE;
+#ifdef PORTABLE
+        BattleAnimProfiler_End();
+#endif
     }
 }
 
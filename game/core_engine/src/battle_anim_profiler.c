@@ -0,0 +1,365 @@
+#ifdef PORTABLE
+#define _GNU_SOURCE
+#include <dlfcn.h>
+#ifdef __linux__
+#include <link.h>
+#endif
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#endif
+
+#include "global.h"
+#include "battle_anim_profiler.h"
+#include "main.h"
+#include "sprite.h"
+#include "task.h"
+
+#ifdef PORTABLE
+
+// While enabled, every battle animation script is measured from
+// LaunchBattleAnimation to its end command: frames taken, the most sprites
+// and tasks alive at once, sprite tiles and palettes loaded, and the host
+// time spent in task funcs and sprite callbacks, which is where animations
+// do their work. Callbacks are timed through the gflib wrapper hooks and
+// also totalled per function across all animations. Callbacks of sprites
+// and tasks that aren't part of the animation (healthboxes and the like)
+// are counted too when they run during one.
+
+#define MAX_PROFILED_CALLBACKS 1024 // power of two
+
+struct CallbackProfile
+{
+    const void *func;
+    bool8 isSprite;
+    u32 calls;
+    u64 totalNs;
+    u64 maxNs;
+    u8 maxTable; // animation running during the longest call
+    u16 maxId;
+};
+
+extern const u8 *const gBattleAnims_Moves[];
+extern const u8 *const gBattleAnims_General[];
+extern const u8 *const gBattleAnims_Special[];
+extern const u8 *const gBattleAnims_StatusConditions[];
+
+static const char *const sTableNames[BATTLE_ANIM_TABLE_COUNT] =
+{
+    [BATTLE_ANIM_TABLE_MOVES]   = "move",
+    [BATTLE_ANIM_TABLE_GENERAL] = "general",
+    [BATTLE_ANIM_TABLE_SPECIAL] = "special",
+    [BATTLE_ANIM_TABLE_STATUS]  = "status",
+};
+
+static bool8 sEnabled;
+static const char *sReportDir;
+static struct BattleAnimProfile sProfiles[BATTLE_ANIM_TABLE_COUNT][BATTLE_ANIM_PROFILE_MAX_IDS];
+static struct CallbackProfile sCallbacks[MAX_PROFILED_CALLBACKS];
+
+// The animation being measured
+static struct BattleAnimProfile *sCurrent;
+static u8 sCurrentTable;
+static u16 sCurrentId;
+static u32 sStartFrame;
+static u32 sStartTiles;
+static u32 sStartPalettes;
+static u64 sFrameNs;
+
+static u64 GetTimeNs(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (u64)now.tv_sec * 1000000000 + now.tv_nsec;
+}
+
+static struct CallbackProfile *GetCallbackProfile(const void *func, bool8 isSprite)
+{
+    u32 hash = (u32)(((uintptr_t)func >> 2) * 0x9E3779B1);
+    u32 i, slot;
+
+    for (i = 0; i < MAX_PROFILED_CALLBACKS; i++)
+    {
+        slot = (hash + i) & (MAX_PROFILED_CALLBACKS - 1);
+        if (sCallbacks[slot].func == func)
+            return &sCallbacks[slot];
+        if (sCallbacks[slot].func == NULL)
+        {
+            sCallbacks[slot].func = func;
+            sCallbacks[slot].isSprite = isSprite;
+            return &sCallbacks[slot];
+        }
+    }
+    return NULL;
+}
+
+static void AddCallbackTime(const void *func, bool8 isSprite, u64 ns)
+{
+    struct CallbackProfile *callback = GetCallbackProfile(func, isSprite);
+
+    sFrameNs += ns;
+    sCurrent->callbackNs += ns;
+    if (ns > sCurrent->worstCallbackNs)
+    {
+        sCurrent->worstCallbackNs = ns;
+        sCurrent->worstCallback = func;
+    }
+
+    if (callback == NULL)
+        return;
+    callback->calls++;
+    callback->totalNs += ns;
+    if (ns > callback->maxNs)
+    {
+        callback->maxNs = ns;
+        callback->maxTable = sCurrentTable;
+        callback->maxId = sCurrentId;
+    }
+}
+
+static void ProfileTaskFunc(u8 taskId)
+{
+    TaskFunc func = gTasks[taskId].func;
+    u64 start;
+
+    if (sCurrent == NULL)
+    {
+        func(taskId);
+        return;
+    }
+
+    start = GetTimeNs();
+    func(taskId);
+    AddCallbackTime((const void *)func, FALSE, GetTimeNs() - start);
+}
+
+static void ProfileSpriteCallback(struct Sprite *sprite)
+{
+    SpriteCallback callback = sprite->callback;
+    u64 start;
+
+    if (sCurrent == NULL)
+    {
+        callback(sprite);
+        return;
+    }
+
+    start = GetTimeNs();
+    callback(sprite);
+    AddCallbackTime((const void *)callback, TRUE, GetTimeNs() - start);
+}
+
+void BattleAnimProfiler_Enable(bool8 enable)
+{
+    if (!enable)
+        BattleAnimProfiler_End();
+    sEnabled = enable;
+    gTaskFuncWrapper = enable ? ProfileTaskFunc : NULL;
+    gSpriteCallbackWrapper = enable ? ProfileSpriteCallback : NULL;
+}
+
+void BattleAnimProfiler_Reset(void)
+{
+    sCurrent = NULL;
+    memset(sProfiles, 0, sizeof(sProfiles));
+    memset(sCallbacks, 0, sizeof(sCallbacks));
+}
+
+const struct BattleAnimProfile *BattleAnimProfiler_GetProfile(u8 table, u16 id)
+{
+    if (table >= BATTLE_ANIM_TABLE_COUNT || id >= BATTLE_ANIM_PROFILE_MAX_IDS)
+        return NULL;
+    return &sProfiles[table][id];
+}
+
+static u8 GetTable(const u8 *const animsTable[])
+{
+    if (animsTable == gBattleAnims_Moves)
+        return BATTLE_ANIM_TABLE_MOVES;
+    if (animsTable == gBattleAnims_General)
+        return BATTLE_ANIM_TABLE_GENERAL;
+    if (animsTable == gBattleAnims_Special)
+        return BATTLE_ANIM_TABLE_SPECIAL;
+    if (animsTable == gBattleAnims_StatusConditions)
+        return BATTLE_ANIM_TABLE_STATUS;
+    return BATTLE_ANIM_TABLE_COUNT;
+}
+
+void BattleAnimProfiler_Begin(const u8 *const animsTable[], u16 tableId)
+{
+    u8 table;
+
+    if (!sEnabled)
+        return;
+
+    BattleAnimProfiler_End();
+    table = GetTable(animsTable);
+    if (table == BATTLE_ANIM_TABLE_COUNT || tableId >= BATTLE_ANIM_PROFILE_MAX_IDS)
+        return;
+
+    sCurrent = &sProfiles[table][tableId];
+    sCurrentTable = table;
+    sCurrentId = tableId;
+    sStartFrame = gMain.vblankCounter1;
+    sStartTiles = gSpriteTilesLoaded;
+    sStartPalettes = gSpritePalettesLoaded;
+    sFrameNs = 0;
+    sCurrent->runs++;
+}
+
+// Called once per frame while the script runs.
+void BattleAnimProfiler_Frame(void)
+{
+    u16 sprites = 0, tasks = 0;
+    s32 i;
+
+    if (sCurrent == NULL)
+        return;
+
+    for (i = 0; i < MAX_SPRITES; i++)
+    {
+        if (gSprites[i].inUse)
+            sprites++;
+    }
+    for (i = 0; i < NUM_TASKS; i++)
+    {
+        if (gTasks[i].isActive)
+            tasks++;
+    }
+
+    sCurrent->peakSprites = max(sCurrent->peakSprites, sprites);
+    sCurrent->peakTasks = max(sCurrent->peakTasks, tasks);
+    sCurrent->maxFrameNs = max(sCurrent->maxFrameNs, sFrameNs);
+    sFrameNs = 0;
+}
+
+void BattleAnimProfiler_End(void)
+{
+    u32 frames;
+
+    if (sCurrent == NULL)
+        return;
+
+    BattleAnimProfiler_Frame();
+    frames = gMain.vblankCounter1 - sStartFrame;
+    sCurrent->totalFrames += frames;
+    sCurrent->maxFrames = max(sCurrent->maxFrames, frames);
+    sCurrent->tilesLoaded += gSpriteTilesLoaded - sStartTiles;
+    sCurrent->palettesLoaded += gSpritePalettesLoaded - sStartPalettes;
+    sCurrent = NULL;
+}
+
+// Names a callback for the CSV. The dynamic linker only knows the symbols
+// the executable exports, so the host build has to be linked with -rdynamic
+// for the global callbacks to be named. Static ones never are and get
+// module+address instead, which `addr2line -f -e module address` resolves.
+static void GetCallbackName(const void *func, char *dst, size_t size)
+{
+#if defined(__linux__)
+    Dl_info info;
+    struct link_map *map;
+
+    // The link map's load bias, unlike dli_fbase, is 0 for a non-PIE
+    // executable, so the address is the one in the module's symbols.
+    if (dladdr1(func, &info, (void **)&map, RTLD_DL_LINKMAP) != 0)
+    {
+        if (info.dli_sname != NULL)
+            snprintf(dst, size, "%s", info.dli_sname);
+        else
+            snprintf(dst, size, "%s+0x%lx", info.dli_fname, (unsigned long)((uintptr_t)func - map->l_addr));
+        return;
+    }
+#elif defined(__APPLE__)
+    Dl_info info;
+
+    if (dladdr(func, &info) != 0)
+    {
+        if (info.dli_sname != NULL)
+            snprintf(dst, size, "%s", info.dli_sname);
+        else
+            snprintf(dst, size, "%s+0x%lx", info.dli_fname, (unsigned long)((uintptr_t)func - (uintptr_t)info.dli_fbase));
+        return;
+    }
+#endif
+    snprintf(dst, size, "%p", func);
+}
+
+bool8 BattleAnimProfiler_WriteCsv(const char *animsPath, const char *callbacksPath)
+{
+    FILE *file;
+    char name[256];
+    u32 table, id, i;
+
+    file = fopen(animsPath, "w");
+    if (file == NULL)
+        return FALSE;
+    fprintf(file, "table,id,runs,total_frames,max_frames,peak_sprites,peak_tasks,tiles_loaded,palettes_loaded,callback_ns,max_frame_ns,worst_callback,worst_callback_ns\n");
+    for (table = 0; table < BATTLE_ANIM_TABLE_COUNT; table++)
+    {
+        for (id = 0; id < BATTLE_ANIM_PROFILE_MAX_IDS; id++)
+        {
+            const struct BattleAnimProfile *profile = &sProfiles[table][id];
+
+            if (profile->runs == 0)
+                continue;
+            if (profile->worstCallback != NULL)
+                GetCallbackName(profile->worstCallback, name, sizeof(name));
+            else
+                name[0] = '\0';
+            fprintf(file, "%s,%u,%u,%u,%u,%u,%u,%u,%u,%llu,%llu,%s,%llu\n",
+                    sTableNames[table], id, profile->runs, profile->totalFrames, profile->maxFrames,
+                    profile->peakSprites, profile->peakTasks, profile->tilesLoaded, profile->palettesLoaded,
+                    (unsigned long long)profile->callbackNs, (unsigned long long)profile->maxFrameNs,
+                    name, (unsigned long long)profile->worstCallbackNs);
+        }
+    }
+    if (fclose(file) != 0)
+        return FALSE;
+
+    file = fopen(callbacksPath, "w");
+    if (file == NULL)
+        return FALSE;
+    fprintf(file, "callback,kind,calls,total_ns,max_ns,max_table,max_id\n");
+    for (i = 0; i < MAX_PROFILED_CALLBACKS; i++)
+    {
+        const struct CallbackProfile *callback = &sCallbacks[i];
+
+        if (callback->func == NULL)
+            continue;
+        GetCallbackName(callback->func, name, sizeof(name));
+        fprintf(file, "%s,%s,%u,%llu,%llu,%s,%u\n",
+                name, callback->isSprite ? "sprite" : "task", callback->calls,
+                (unsigned long long)callback->totalNs, (unsigned long long)callback->maxNs,
+                sTableNames[callback->maxTable], callback->maxId);
+    }
+    return fclose(file) == 0;
+}
+
+static void WriteCsvAtExit(void)
+{
+    char animsPath[4096], callbacksPath[4096];
+
+    BattleAnimProfiler_End();
+    snprintf(animsPath, sizeof(animsPath), "%s/battle_anims.csv", sReportDir);
+    snprintf(callbacksPath, sizeof(callbacksPath), "%s/battle_anim_callbacks.csv", sReportDir);
+    if (!BattleAnimProfiler_WriteCsv(animsPath, callbacksPath))
+        fprintf(stderr, "Failed to write the battle animation profile to %s\n", sReportDir);
+}
+
+// Called once at startup. EMERALD_ANIM_PROFILE_DIR turns the profiler on
+// for the whole run and names the directory battle_anims.csv and
+// battle_anim_callbacks.csv are written to when the game exits.
+void BattleAnimProfiler_InitFromEnv(void)
+{
+    sReportDir = getenv("EMERALD_ANIM_PROFILE_DIR");
+    if (sReportDir == NULL || sReportDir[0] == '\0')
+        return;
+
+    BattleAnimProfiler_Reset();
+    BattleAnimProfiler_Enable(TRUE);
+    atexit(WriteCsvAtExit);
+}
+
+#endif // PORTABLE
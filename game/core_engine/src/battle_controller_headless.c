@@ -0,0 +1,279 @@
+#include "global.h"
+#include "battle.h"
+#include "battle_ai_switch_items.h"
+#include "battle_anim.h"
+#include "battle_controllers.h"
+#include "battle_gfx_sfx_util.h"
+#include "battle_replay.h"
+#include "pokemon.h"
+#include "random.h"
+#include "recorded_battle.h"
+#include "util.h"
+
+#ifdef PORTABLE
+
+// Controller used for every battler while gHeadlessBattle is set. Decisions
+// and party data are handed to the AI controller of the battler's side (the
+// player partner controller for the player side, the opponent controller for
+// the other), and everything that only exists to be seen or heard completes
+// straight away, so a battle runs to its outcome without graphics or input.
+// While a replay is checked, the battlers it recorded input for choose from
+// the replay instead.
+
+static void HeadlessHandleDelegateToAI(void);
+static void HeadlessHandleSwitchInAnim(void);
+static void HeadlessHandleChooseAction(void);
+static void HeadlessHandleChooseMove(void);
+static void HeadlessHandleChooseItem(void);
+static void HeadlessHandleChoosePokemon(void);
+static void HeadlessHandleComplete(void);
+
+static void HeadlessBufferRunCommand(void);
+static void HeadlessBufferExecCompleted(void);
+
+bool8 gHeadlessBattle;
+u32 gHeadlessMoveUses[NUM_BATTLE_SIDES][MOVES_COUNT];
+
+static void (*const sHeadlessBufferCommands[CONTROLLER_CMDS_COUNT])(void) =
+{
+    [CONTROLLER_GETMONDATA]               = HeadlessHandleDelegateToAI,
+    [CONTROLLER_GETRAWMONDATA]            = HeadlessHandleDelegateToAI,
+    [CONTROLLER_SETMONDATA]               = HeadlessHandleDelegateToAI,
+    [CONTROLLER_SETRAWMONDATA]            = HeadlessHandleDelegateToAI,
+    [CONTROLLER_LOADMONSPRITE]            = HeadlessHandleComplete,
+    [CONTROLLER_SWITCHINANIM]             = HeadlessHandleSwitchInAnim,
+    [CONTROLLER_RETURNMONTOBALL]          = HeadlessHandleComplete,
+    [CONTROLLER_DRAWTRAINERPIC]           = HeadlessHandleComplete,
+    [CONTROLLER_TRAINERSLIDE]             = HeadlessHandleComplete,
+    [CONTROLLER_TRAINERSLIDEBACK]         = HeadlessHandleComplete,
+    [CONTROLLER_FAINTANIMATION]           = HeadlessHandleComplete,
+    [CONTROLLER_PALETTEFADE]              = HeadlessHandleComplete,
+    [CONTROLLER_SUCCESSBALLTHROWANIM]     = HeadlessHandleComplete,
+    [CONTROLLER_BALLTHROWANIM]            = HeadlessHandleComplete,
+    [CONTROLLER_PAUSE]                    = HeadlessHandleComplete,
+    [CONTROLLER_MOVEANIMATION]            = HeadlessHandleComplete,
+    [CONTROLLER_PRINTSTRING]              = HeadlessHandleComplete,
+    [CONTROLLER_PRINTSTRINGPLAYERONLY]    = HeadlessHandleComplete,
+    [CONTROLLER_CHOOSEACTION]             = HeadlessHandleChooseAction,
+    [CONTROLLER_YESNOBOX]                 = HeadlessHandleComplete,
+    [CONTROLLER_CHOOSEMOVE]               = HeadlessHandleChooseMove,
+    [CONTROLLER_OPENBAG]                  = HeadlessHandleChooseItem,
+    [CONTROLLER_CHOOSEPOKEMON]            = HeadlessHandleChoosePokemon,
+    [CONTROLLER_23]                       = HeadlessHandleComplete,
+    [CONTROLLER_HEALTHBARUPDATE]          = HeadlessHandleComplete,
+    [CONTROLLER_EXPUPDATE]                = HeadlessHandleComplete,
+    [CONTROLLER_STATUSICONUPDATE]         = HeadlessHandleComplete,
+    [CONTROLLER_STATUSANIMATION]          = HeadlessHandleComplete,
+    [CONTROLLER_STATUSXOR]                = HeadlessHandleDelegateToAI,
+    [CONTROLLER_DATATRANSFER]             = HeadlessHandleDelegateToAI,
+    [CONTROLLER_DMA3TRANSFER]             = HeadlessHandleDelegateToAI,
+    [CONTROLLER_PLAYBGM]                  = HeadlessHandleComplete,
+    [CONTROLLER_32]                       = HeadlessHandleComplete,
+    [CONTROLLER_TWORETURNVALUES]          = HeadlessHandleDelegateToAI,
+    [CONTROLLER_CHOSENMONRETURNVALUE]     = HeadlessHandleDelegateToAI,
+    [CONTROLLER_ONERETURNVALUE]           = HeadlessHandleDelegateToAI,
+    [CONTROLLER_ONERETURNVALUE_DUPLICATE] = HeadlessHandleDelegateToAI,
+    [CONTROLLER_CLEARUNKVAR]              = HeadlessHandleDelegateToAI,
+    [CONTROLLER_SETUNKVAR]                = HeadlessHandleDelegateToAI,
+    [CONTROLLER_CLEARUNKFLAG]             = HeadlessHandleDelegateToAI,
+    [CONTROLLER_TOGGLEUNKFLAG]            = HeadlessHandleDelegateToAI,
+    [CONTROLLER_HITANIMATION]             = HeadlessHandleComplete,
+    [CONTROLLER_CANTSWITCH]               = HeadlessHandleComplete,
+    [CONTROLLER_PLAYSE]                   = HeadlessHandleComplete,
+    [CONTROLLER_PLAYFANFAREORBGM]         = HeadlessHandleComplete,
+    [CONTROLLER_FAINTINGCRY]              = HeadlessHandleComplete,
+    [CONTROLLER_INTROSLIDE]               = HeadlessHandleComplete,
+    [CONTROLLER_INTROTRAINERBALLTHROW]    = HeadlessHandleComplete,
+    [CONTROLLER_DRAWPARTYSTATUSSUMMARY]   = HeadlessHandleComplete,
+    [CONTROLLER_HIDEPARTYSTATUSSUMMARY]   = HeadlessHandleComplete,
+    [CONTROLLER_ENDBOUNCE]                = HeadlessHandleComplete,
+    [CONTROLLER_SPRITEINVISIBILITY]       = HeadlessHandleComplete,
+    [CONTROLLER_BATTLEANIMATION]          = HeadlessHandleComplete,
+    [CONTROLLER_LINKSTANDBYMSG]           = HeadlessHandleComplete,
+    [CONTROLLER_RESETACTIONMOVESELECTION] = HeadlessHandleComplete,
+    [CONTROLLER_ENDLINKBATTLE]            = HeadlessHandleComplete,
+    [CONTROLLER_TERMINATOR_NOP]           = HeadlessHandleComplete
+};
+
+void SetControllerToHeadless(void)
+{
+    gBattlerControllerFuncs[gActiveBattler] = HeadlessBufferRunCommand;
+}
+
+static void HeadlessBufferRunCommand(void)
+{
+    if (gBattleControllerExecFlags & gBitTable[gActiveBattler])
+    {
+        if (gBattleBufferA[gActiveBattler][0] < ARRAY_COUNT(sHeadlessBufferCommands))
+            sHeadlessBufferCommands[gBattleBufferA[gActiveBattler][0]]();
+        else
+            HeadlessBufferExecCompleted();
+    }
+}
+
+static void HeadlessBufferExecCompleted(void)
+{
+    gBattlerControllerFuncs[gActiveBattler] = HeadlessBufferRunCommand;
+    gBattleControllerExecFlags &= ~gBitTable[gActiveBattler];
+}
+
+// The commands sent here all complete within one call of the AI controller,
+// which clears the exec flag itself, so it only has to be borrowed once.
+static void HeadlessHandleDelegateToAI(void)
+{
+    if (GetBattlerSide(gActiveBattler) == B_SIDE_PLAYER)
+        SetControllerToPlayerPartner();
+    else
+        SetControllerToOpponent();
+
+    gBattlerControllerFuncs[gActiveBattler]();
+    gBattlerControllerFuncs[gActiveBattler] = HeadlessBufferRunCommand;
+}
+
+static void HeadlessHandleSwitchInAnim(void)
+{
+    if (GetBattlerSide(gActiveBattler) == B_SIDE_OPPONENT)
+        *(gBattleStruct->monToSwitchIntoId + gActiveBattler) = PARTY_SIZE;
+    ClearTemporarySpeciesSpriteData(gActiveBattler, gBattleBufferA[gActiveBattler][2]);
+    gBattlerPartyIndexes[gActiveBattler] = gBattleBufferA[gActiveBattler][1];
+    HeadlessBufferExecCompleted();
+}
+
+// A replay that runs out of actions has already been stopped, but the
+// battle engine still reads this step's answer, so the AI gives one.
+static void HeadlessHandleChooseAction(void)
+{
+    u8 action;
+
+    if (!BattleReplay_IsInputBattler(gActiveBattler)
+     || !BattleReplay_ReadActions(gActiveBattler, &action, 1))
+    {
+        HeadlessHandleDelegateToAI();
+        return;
+    }
+
+    BtlController_EmitTwoReturnValues(BUFFER_B, action, 0);
+    HeadlessBufferExecCompleted();
+}
+
+// Counts the move in a move choice reply towards gHeadlessMoveUses. Only
+// replies of type 10 carry a move slot; the AI's other answers (15 for the
+// safari/wild AI, running, watching) don't.
+static void CountChosenMove(void)
+{
+    u8 moveSlot;
+    u16 move;
+
+    if (gBattleBufferB[gActiveBattler][0] != CONTROLLER_TWORETURNVALUES
+     || gBattleBufferB[gActiveBattler][1] != 10)
+        return;
+
+    moveSlot = gBattleBufferB[gActiveBattler][2];
+    if (moveSlot >= MAX_MON_MOVES)
+        return;
+
+    move = gBattleMons[gActiveBattler].moves[moveSlot];
+    if (move != MOVE_NONE && move < MOVES_COUNT)
+        gHeadlessMoveUses[GetBattlerSide(gActiveBattler)][move]++;
+}
+
+static void HeadlessHandleChooseMove(void)
+{
+    u8 choice[2];
+
+    if (!BattleReplay_IsInputBattler(gActiveBattler))
+    {
+        HeadlessHandleDelegateToAI();
+        CountChosenMove();
+    }
+    else if (gBattleTypeFlags & BATTLE_TYPE_PALACE)
+    {
+        // Palace moves aren't recorded, the player's mon picks them like in
+        // the recorded player controller
+        gBattlePalaceMoveSelectionRngValue = gRngValue;
+        BtlController_EmitTwoReturnValues(BUFFER_B, 10, ChooseMoveAndTargetInBattlePalace());
+        HeadlessBufferExecCompleted();
+        CountChosenMove();
+    }
+    else if (BattleReplay_ReadActions(gActiveBattler, choice, 2))
+    {
+        BtlController_EmitTwoReturnValues(BUFFER_B, 10, choice[0] | (choice[1] << 8));
+        HeadlessBufferExecCompleted();
+        CountChosenMove();
+    }
+    else
+    {
+        HeadlessHandleDelegateToAI();
+        CountChosenMove();
+    }
+}
+
+// Returns the item AI_TrySwitchOrUseItem picked, for either side.
+static void HeadlessHandleChooseItem(void)
+{
+    u8 item[2];
+
+    if (BattleReplay_IsInputBattler(gActiveBattler) && BattleReplay_ReadActions(gActiveBattler, item, 2))
+    {
+        BtlController_EmitOneReturnValue(BUFFER_B, item[0] | (item[1] << 8));
+        HeadlessBufferExecCompleted();
+        return;
+    }
+
+    BtlController_EmitOneReturnValue(BUFFER_B, *(gBattleStruct->chosenItem + (gActiveBattler / 2) * 2));
+    HeadlessBufferExecCompleted();
+}
+
+// The partner controller only ever picks from the second half of the party,
+// so the player side falls back to the first usable mon in the whole party.
+static void HeadlessHandleChoosePokemon(void)
+{
+    s32 chosenMonId;
+    u8 battlerIn1, battlerIn2;
+    u8 monId;
+
+    if (BattleReplay_IsInputBattler(gActiveBattler) && BattleReplay_ReadActions(gActiveBattler, &monId, 1))
+    {
+        *(gBattleStruct->monToSwitchIntoId + gActiveBattler) = monId;
+        BtlController_EmitChosenMonReturnValue(BUFFER_B, monId, NULL);
+        HeadlessBufferExecCompleted();
+        return;
+    }
+
+    if (GetBattlerSide(gActiveBattler) == B_SIDE_OPPONENT)
+    {
+        HeadlessHandleDelegateToAI();
+        return;
+    }
+
+    chosenMonId = GetMostSuitableMonToSwitchInto();
+    if (chosenMonId == PARTY_SIZE)
+    {
+        battlerIn1 = gActiveBattler;
+        if (gBattleTypeFlags & BATTLE_TYPE_DOUBLE)
+            battlerIn2 = GetBattlerAtPosition(BATTLE_PARTNER(GetBattlerPosition(gActiveBattler)));
+        else
+            battlerIn2 = gActiveBattler;
+
+        for (chosenMonId = 0; chosenMonId < PARTY_SIZE; chosenMonId++)
+        {
+            if (GetMonData(&gPlayerParty[chosenMonId], MON_DATA_HP) != 0
+             && GetMonData(&gPlayerParty[chosenMonId], MON_DATA_SPECIES_OR_EGG) != SPECIES_NONE
+             && GetMonData(&gPlayerParty[chosenMonId], MON_DATA_SPECIES_OR_EGG) != SPECIES_EGG
+             && chosenMonId != gBattlerPartyIndexes[battlerIn1]
+             && chosenMonId != gBattlerPartyIndexes[battlerIn2])
+                break;
+        }
+    }
+
+    *(gBattleStruct->monToSwitchIntoId + gActiveBattler) = chosenMonId;
+    BtlController_EmitChosenMonReturnValue(BUFFER_B, chosenMonId, NULL);
+    HeadlessBufferExecCompleted();
+}
+
+static void HeadlessHandleComplete(void)
+{
+    HeadlessBufferExecCompleted();
+}
+
+#endif // PORTABLE
@@ -1,5 +1,6 @@
 #include "global.h"
 #include "battle.h"
+#include "battle_ai_lookahead.h"
 #include "battle_ai_script_commands.h"
 #include "battle_anim.h"
 #include "battle_arena.h"
@@ -1532,6 +1533,9 @@ static void OpponentHandlePrintSelectionString(void)
 static void OpponentHandleChooseAction(void)
 {
     AI_TrySwitchOrUseItem();
+#ifdef PORTABLE
+    BattleAI_LookaheadChooseAction();
+#endif
     OpponentBufferExecCompleted();
 }
 
@@ -89,6 +89,14 @@ void InitBattleControllers(void)
     else
         InitSinglePlayerBtlControllers();
 
+#ifdef PORTABLE
+    if (gHeadlessBattle)
+    {
+        for (i = 0; i < gBattlersCount; i++)
+            gBattlerControllerFuncs[i] = SetControllerToHeadless;
+    }
+#endif
+
     SetBattlePartyIds();
 
     if (!(gBattleTypeFlags & BATTLE_TYPE_MULTI))
@@ -1315,8 +1323,14 @@ void BtlController_EmitChosenMonReturnValue(u8 bufferId, u8 partyId, u8 *battleP
 
     sBattleBuffersTransferData[0] = CONTROLLER_CHOSENMONRETURNVALUE;
     sBattleBuffersTransferData[1] = partyId;
+#ifdef PORTABLE
+    // The AI passes no order. On the GBA that reads the BIOS at address 0.
+    for (i = 0; i < (int)ARRAY_COUNT(gBattlePartyCurrentOrder); i++)
+        sBattleBuffersTransferData[2 + i] = battlePartyOrder != NULL ? battlePartyOrder[i] : 0;
+#else
     for (i = 0; i < (int)ARRAY_COUNT(gBattlePartyCurrentOrder); i++)
         sBattleBuffersTransferData[2 + i] = battlePartyOrder[i];
+#endif
     PrepareBufferDataTransfer(bufferId, sBattleBuffersTransferData, 5);
 }
 
@@ -1,3 +1,7 @@
+#ifdef PORTABLE
+#include <time.h>
+#endif
+
 #include "global.h"
 #include "battle_dome.h"
 #include "battle.h"
@@ -6016,6 +6020,313 @@ static u8 GetOpposingNPCTournamentIdByRound(u8 tournamentId, u8 round)
         return tournamentIds[0];
 }
 
+#ifdef PORTABLE
+// Batched matchup scoring for NPC vs NPC rounds. DecideRoundWinners scores a
+// match by running every move of one party against every mon of the other
+// through GetTypeEffectivenessPoints, which walks the whole type chart per
+// call. Here the AI vs AI points are tabulated once per (move type, defender
+// ability, defender types), the tournament parties are copied into
+// struct-of-arrays form, and the points of all pairings are filled in one
+// pass. The table is rebuilt only when the tournament's parties change.
+
+#define DOME_MONS_COUNT           (DOME_TOURNAMENT_TRAINERS_COUNT * FRONTIER_PARTY_SIZE)
+#define DOME_MOVE_TYPE_NO_DAMAGE  NUMBER_OF_MON_TYPES // status moves score 0 against anything
+
+// Only the abilities GetTypeEffectivenessPoints looks at
+enum
+{
+    DOME_DEF_ABILITY_OTHER,
+    DOME_DEF_ABILITY_LEVITATE,
+    DOME_DEF_ABILITY_WONDER_GUARD,
+    DOME_DEF_ABILITY_COUNT,
+};
+
+#define DOME_DEF_KEYS_COUNT (DOME_DEF_ABILITY_COUNT * NUMBER_OF_MON_TYPES * NUMBER_OF_MON_TYPES)
+
+struct DomeMatchups
+{
+    bool8 valid;
+    u16 trainerIds[DOME_TOURNAMENT_TRAINERS_COUNT];
+    u16 monIds[DOME_TOURNAMENT_TRAINERS_COUNT][FRONTIER_PARTY_SIZE];
+    // One entry per tournament mon, indexed by tournamentId * FRONTIER_PARTY_SIZE + monId
+    u8 moveTypes[MAX_MON_MOVES][DOME_MONS_COUNT];
+    u16 defKeys[DOME_MONS_COUNT];
+    u16 baseStatPoints[DOME_MONS_COUNT];
+    s16 monPoints[DOME_MONS_COUNT][DOME_MONS_COUNT];
+    // Points the first trainer scores against the second, without the random part
+    s16 points[DOME_TOURNAMENT_TRAINERS_COUNT][DOME_TOURNAMENT_TRAINERS_COUNT];
+};
+
+bool8 gDomeBatchedMatchups = TRUE;
+
+static bool8 sDomeTypePointsInitialized;
+static s8 sDomeTypePoints[DOME_MOVE_TYPE_NO_DAMAGE + 1][DOME_DEF_KEYS_COUNT];
+static struct DomeMatchups sDomeMatchups;
+
+// GetTypeEffectivenessPoints in EFFECTIVENESS_MODE_AI_VS_AI, by type.
+static s8 CalcDomeTypePoints(u8 moveType, u8 defType1, u8 defType2, u8 defAbility)
+{
+    int i = 0;
+    int typePower = TYPE_x1;
+
+    if (!(defAbility == DOME_DEF_ABILITY_LEVITATE && moveType == TYPE_GROUND))
+    {
+        while (TYPE_EFFECT_ATK_TYPE(i) != TYPE_ENDTABLE)
+        {
+            if (TYPE_EFFECT_ATK_TYPE(i) == TYPE_FORESIGHT)
+            {
+                i += 3;
+                continue;
+            }
+            if (TYPE_EFFECT_ATK_TYPE(i) == moveType)
+            {
+                if (TYPE_EFFECT_DEF_TYPE(i) == defType1)
+                    if ((defAbility == DOME_DEF_ABILITY_WONDER_GUARD && TYPE_EFFECT_MULTIPLIER(i) == WONDER_GUARD_EFFECTIVENESS) || defAbility != DOME_DEF_ABILITY_WONDER_GUARD)
+                        typePower = (typePower * TYPE_EFFECT_MULTIPLIER(i)) / 10;
+                if (TYPE_EFFECT_DEF_TYPE(i) == defType2 && defType1 != defType2)
+                    if ((defAbility == DOME_DEF_ABILITY_WONDER_GUARD && TYPE_EFFECT_MULTIPLIER(i) == WONDER_GUARD_EFFECTIVENESS) || defAbility != DOME_DEF_ABILITY_WONDER_GUARD)
+                        typePower = (typePower * TYPE_EFFECT_MULTIPLIER(i)) / 10;
+            }
+            i += 3;
+        }
+    }
+
+    switch (typePower)
+    {
+    case TYPE_x0:
+        return -16;
+    case TYPE_x0_25:
+        return -8;
+    case TYPE_x0_50:
+    default:
+        return 0;
+    case TYPE_x1:
+        return 4;
+    case TYPE_x2:
+        return 12;
+    case TYPE_x4:
+        return 20;
+    }
+}
+
+static void InitDomeTypePoints(void)
+{
+    u32 moveType, defAbility, defType1, defType2;
+    s8 *points;
+
+    if (sDomeTypePointsInitialized)
+        return;
+
+    for (moveType = 0; moveType < NUMBER_OF_MON_TYPES; moveType++)
+    {
+        points = sDomeTypePoints[moveType];
+        for (defAbility = 0; defAbility < DOME_DEF_ABILITY_COUNT; defAbility++)
+        {
+            for (defType1 = 0; defType1 < NUMBER_OF_MON_TYPES; defType1++)
+            {
+                for (defType2 = 0; defType2 < NUMBER_OF_MON_TYPES; defType2++)
+                    *points++ = CalcDomeTypePoints(moveType, defType1, defType2, defAbility);
+            }
+        }
+    }
+    // sDomeTypePoints[DOME_MOVE_TYPE_NO_DAMAGE] stays 0
+    sDomeTypePointsInitialized = TRUE;
+}
+
+static u8 GetDomeMoveType(u16 move)
+{
+    if (move == MOVE_NONE || move >= MOVES_COUNT || gBattleMoves[move].power == 0)
+        return DOME_MOVE_TYPE_NO_DAMAGE;
+    return gBattleMoves[move].type;
+}
+
+static u16 GetDomeDefKey(u16 species)
+{
+    u8 ability = DOME_DEF_ABILITY_OTHER;
+
+    if (gSpeciesInfo[species].abilities[0] == ABILITY_LEVITATE)
+        ability = DOME_DEF_ABILITY_LEVITATE;
+    else if (gSpeciesInfo[species].abilities[0] == ABILITY_WONDER_GUARD)
+        ability = DOME_DEF_ABILITY_WONDER_GUARD;
+
+    return (ability * NUMBER_OF_MON_TYPES + gSpeciesInfo[species].types[0]) * NUMBER_OF_MON_TYPES + gSpeciesInfo[species].types[1];
+}
+
+// The player's and the Frontier Brain's slots hold species rather than
+// facility mons, and their matches are never scored, so they're left empty.
+static bool8 IsScoredDomeTrainer(u16 trainerId)
+{
+    return trainerId != TRAINER_PLAYER && trainerId != TRAINER_FRONTIER_BRAIN;
+}
+
+static void BuildDomeMatchups(void)
+{
+    struct DomeMatchups *m = &sDomeMatchups;
+    int i, j, moveSlot, attacker, defender;
+    s32 points;
+
+    for (i = 0; i < DOME_TOURNAMENT_TRAINERS_COUNT; i++)
+    {
+        if (m->trainerIds[i] != DOME_TRAINERS[i].trainerId)
+            break;
+        for (j = 0; j < FRONTIER_PARTY_SIZE; j++)
+        {
+            if (m->monIds[i][j] != DOME_MONS[i][j])
+                break;
+        }
+        if (j != FRONTIER_PARTY_SIZE)
+            break;
+    }
+    if (m->valid && i == DOME_TOURNAMENT_TRAINERS_COUNT)
+        return;
+
+    InitDomeTypePoints();
+
+    for (i = 0; i < DOME_TOURNAMENT_TRAINERS_COUNT; i++)
+    {
+        m->trainerIds[i] = DOME_TRAINERS[i].trainerId;
+        for (j = 0; j < FRONTIER_PARTY_SIZE; j++)
+        {
+            const struct FacilityMon *mon = &gFacilityTrainerMons[DOME_MONS[i][j]];
+            u16 species = mon->species;
+
+            attacker = i * FRONTIER_PARTY_SIZE + j;
+            m->monIds[i][j] = DOME_MONS[i][j];
+            if (!IsScoredDomeTrainer(m->trainerIds[i]))
+            {
+                for (moveSlot = 0; moveSlot < MAX_MON_MOVES; moveSlot++)
+                    m->moveTypes[moveSlot][attacker] = DOME_MOVE_TYPE_NO_DAMAGE;
+                m->defKeys[attacker] = 0;
+                m->baseStatPoints[attacker] = 0;
+                continue;
+            }
+
+            for (moveSlot = 0; moveSlot < MAX_MON_MOVES; moveSlot++)
+                m->moveTypes[moveSlot][attacker] = GetDomeMoveType(mon->moves[moveSlot]);
+            m->defKeys[attacker] = GetDomeDefKey(species);
+            m->baseStatPoints[attacker] = ( gSpeciesInfo[species].baseHP
+                                          + gSpeciesInfo[species].baseAttack
+                                          + gSpeciesInfo[species].baseDefense
+                                          + gSpeciesInfo[species].baseSpeed
+                                          + gSpeciesInfo[species].baseSpAttack
+                                          + gSpeciesInfo[species].baseSpDefense) / 10;
+        }
+    }
+
+    // Every mon's moves against every mon, one move slot at a time so the
+    // inner loop runs straight down the defender arrays.
+    memset(m->monPoints, 0, sizeof(m->monPoints));
+    for (moveSlot = 0; moveSlot < MAX_MON_MOVES; moveSlot++)
+    {
+        for (attacker = 0; attacker < DOME_MONS_COUNT; attacker++)
+        {
+            const s8 *typePoints = sDomeTypePoints[m->moveTypes[moveSlot][attacker]];
+            s16 *row = m->monPoints[attacker];
+
+            for (defender = 0; defender < DOME_MONS_COUNT; defender++)
+                row[defender] += typePoints[m->defKeys[defender]];
+        }
+    }
+
+    for (i = 0; i < DOME_TOURNAMENT_TRAINERS_COUNT; i++)
+    {
+        for (j = 0; j < DOME_TOURNAMENT_TRAINERS_COUNT; j++)
+        {
+            points = 0;
+            for (attacker = i * FRONTIER_PARTY_SIZE; attacker < (i + 1) * FRONTIER_PARTY_SIZE; attacker++)
+            {
+                for (defender = j * FRONTIER_PARTY_SIZE; defender < (j + 1) * FRONTIER_PARTY_SIZE; defender++)
+                    points += m->monPoints[attacker][defender];
+                points += m->baseStatPoints[attacker];
+            }
+            m->points[i][j] = points;
+        }
+    }
+
+    m->valid = TRUE;
+}
+
+// Same hash as the headless battle runner uses for its seeds.
+static u32 GetDomeTournamentSeed(u32 baseSeed, u32 tournamentId)
+{
+    u32 seed = baseSeed ^ (tournamentId * 0x9E3779B9);
+
+    seed ^= seed >> 16;
+    seed *= 0x85EBCA6B;
+    seed ^= seed >> 13;
+    return seed;
+}
+
+static u64 GetDomeTimeNs(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (u64)now.tv_sec * 1000000000 + now.tv_nsec;
+}
+
+// Generates count NPC-only tournaments the way the Dome's results tree does
+// (trainers 0-39 at level 50) and tallies who entered and who won. The save's
+// frontier data and the RNG are left as they were.
+void DomeEval_RunTournaments(u32 baseSeed, u32 count, struct DomeTournamentSummary *summary)
+{
+    struct BattleFrontier *savedFrontier = Alloc(sizeof(struct BattleFrontier));
+    u32 savedRngValue = gRngValue;
+    u64 start;
+    u32 i;
+    int j;
+
+    memset(summary, 0, sizeof(*summary));
+    memcpy(savedFrontier, &gSaveBlock2Ptr->frontier, sizeof(struct BattleFrontier));
+    start = GetDomeTimeNs();
+
+    for (i = 0; i < count; i++)
+    {
+        gRngValue = GetDomeTournamentSeed(baseSeed, i);
+        gSaveBlock2Ptr->frontier.challengeStatus = CHALLENGE_STATUS_SAVING;
+        InitRandomTourneyTreeResults();
+
+        summary->tournaments++;
+        for (j = 0; j < DOME_TOURNAMENT_TRAINERS_COUNT; j++)
+        {
+            u16 trainerId = DOME_TRAINERS[j].trainerId;
+
+            if (trainerId >= FRONTIER_TRAINERS_COUNT)
+                continue;
+            summary->entries[trainerId]++;
+            if (!DOME_TRAINERS[j].isEliminated)
+                summary->wins[trainerId]++;
+        }
+    }
+
+    summary->elapsedNs = GetDomeTimeNs() - start;
+    memcpy(&gSaveBlock2Ptr->frontier, savedFrontier, sizeof(struct BattleFrontier));
+    Free(savedFrontier);
+    gRngValue = savedRngValue;
+}
+
+// Runs the same tournaments with the scalar and the batched scoring.
+void DomeEval_Benchmark(u32 baseSeed, u32 count, struct DomeEvalBenchmark *result)
+{
+    struct DomeTournamentSummary *summaries = Alloc(sizeof(struct DomeTournamentSummary) * 2);
+    bool8 savedBatched = gDomeBatchedMatchups;
+
+    gDomeBatchedMatchups = FALSE;
+    DomeEval_RunTournaments(baseSeed, count, &summaries[0]);
+    gDomeBatchedMatchups = TRUE;
+    DomeEval_RunTournaments(baseSeed, count, &summaries[1]);
+    gDomeBatchedMatchups = savedBatched;
+
+    result->tournaments = count;
+    result->scalarNs = summaries[0].elapsedNs;
+    result->batchedNs = summaries[1].elapsedNs;
+    result->resultsMatch = memcmp(summaries[0].entries, summaries[1].entries, sizeof(summaries[0].entries)) == 0
+                        && memcmp(summaries[0].wins, summaries[1].wins, sizeof(summaries[0].wins)) == 0;
+    Free(summaries);
+}
+
+#endif // PORTABLE
+
 // Determines which trainers won in the NPC vs NPC battles
 static void DecideRoundWinners(u8 roundId)
 {
@@ -6055,6 +6366,14 @@ static void DecideRoundWinners(u8 roundId)
             points2 = 0;
             #endif
 
+            #ifdef PORTABLE
+            if (gDomeBatchedMatchups)
+            {
+                BuildDomeMatchups();
+                points1 += sDomeMatchups.points[tournamentId1][tournamentId2];
+            }
+            else
+            #endif
             // Calculate points for both trainers.
             for (monId1 = 0; monId1 < FRONTIER_PARTY_SIZE; monId1++)
             {
@@ -6079,6 +6398,11 @@ static void DecideRoundWinners(u8 roundId)
             // Favor trainers with higher id;
             points1 += tournamentId1;
 
+            #ifdef PORTABLE
+            if (gDomeBatchedMatchups)
+                points2 += sDomeMatchups.points[tournamentId2][tournamentId1];
+            else
+            #endif
             for (monId1 = 0; monId1 < FRONTIER_PARTY_SIZE; monId1++)
             {
                 for (moveSlot = 0; moveSlot < MAX_MON_MOVES; moveSlot++)
@@ -5,6 +5,7 @@
 #include "event_data.h"
 #include "battle_setup.h"
 #include "overworld.h"
+#include "frontier_party_gen.h"
 #include "frontier_util.h"
 #include "battle_tower.h"
 #include "random.h"
@@ -865,6 +866,43 @@ static u16 GetFactoryMonId(u8 lvlMode, u8 challengeNum, bool8 useBetterRange)
     return monId;
 }
 
+#ifdef PORTABLE
+// Pools of the ranges GetFactoryMonId draws from, indexed like
+// sInitialRentalMonRanges and built on first use. Unown never appears on an
+// opponent's team, so it's left out of them.
+static struct FrontierMonPool sFactoryOpponentPools[ARRAY_COUNT(sInitialRentalMonRanges)];
+
+// Picks an opponent team with the rules of GenerateOpponentMons (no species
+// of the player's rentals, no repeated species or held items) in one pass
+// per mon, for preparing Factory opponents ahead of time.
+bool8 GenerateFactoryOpponentMonIds(u8 lvlMode, u8 challengeNum, const u16 *rentalMonIds, u8 rentalCount, u16 *monIds)
+{
+    struct FrontierMonPool *pool;
+    struct FrontierPartyExclusions exclusions;
+    const struct FacilityMon *savedMons = gFacilityTrainerMons;
+    u8 range = ((lvlMode == FRONTIER_LVL_50) ? 0 : 8) + min(challengeNum, 7);
+    bool8 ok;
+    u8 i;
+
+    gFacilityTrainerMons = gBattleFrontierMons;
+    pool = &sFactoryOpponentPools[range];
+    if (pool->monIds == NULL
+     && !BuildFrontierMonPoolFromRange(pool, sInitialRentalMonRanges[range][0], sInitialRentalMonRanges[range][1], lvlMode != FRONTIER_LVL_50, SPECIES_UNOWN))
+    {
+        gFacilityTrainerMons = savedMons;
+        return FALSE;
+    }
+
+    memset(&exclusions, 0, sizeof(exclusions));
+    for (i = 0; i < rentalCount; i++)
+        ExcludeFrontierSpecies(&exclusions, gFacilityTrainerMons[rentalMonIds[i]].species);
+
+    ok = SampleFrontierMons(pool, &exclusions, monIds, FRONTIER_PARTY_SIZE);
+    gFacilityTrainerMons = savedMons;
+    return ok;
+}
+#endif // PORTABLE
+
 u8 GetNumPastRentalsRank(u8 battleMode, u8 lvlMode)
 {
     u8 ret;
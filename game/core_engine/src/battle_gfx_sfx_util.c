@@ -1262,6 +1262,7 @@ void FillAroundBattleWindows(void)
             vramPtr++;
         }
     }
+    MARK_VRAM_WRITTEN(VRAM + 0x240, 9 * 16 * sizeof(u16));
 }
 
 void ClearTemporarySpeciesSpriteData(u8 battlerId, bool8 dontClearSubstitute)
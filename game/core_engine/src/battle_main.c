@@ -8,6 +8,7 @@
 #include "battle_main.h"
 #include "battle_message.h"
 #include "battle_pyramid.h"
+#include "battle_replay.h"
 #include "battle_scripts.h"
 #include "battle_setup.h"
 #include "battle_tower.h"
@@ -587,6 +588,9 @@ const u8 * const gStatusConditionStringsTable[][2] =
 
 void CB2_InitBattle(void)
 {
+#ifdef PORTABLE
+    BattleReplay_RecordBattle();
+#endif
     MoveSaveBlocks_ResetHeap();
     AllocateBattleResources();
     AllocateBattleSpritesData();
@@ -3016,6 +3020,9 @@ void BeginBattleIntroDummy(void)
 
 void BeginBattleIntro(void)
 {
+#ifdef PORTABLE
+    BattleReplay_StartBattle();
+#endif
     BattleStartClearSetData();
     gBattleCommunication[1] = 0;
     gBattleMainFunc = BattleIntroGetMonsData;
@@ -3027,8 +3034,244 @@ static void BattleMainCB1(void)
 
     for (gActiveBattler = 0; gActiveBattler < gBattlersCount; gActiveBattler++)
         gBattlerControllerFuncs[gActiveBattler]();
+
+#ifdef PORTABLE
+    if (gBattleOutcome != 0)
+        BattleReplay_EndBattle();
+#endif
+}
+
+#ifdef PORTABLE
+// Runs a whole non-link battle synchronously with every battler driven by the
+// headless controller, so the battle engine can be used for simulations. The
+// player's party is set up by the caller; the enemy party is either set up by
+// the caller too or built from spec->opponentA. The parties the caller set up
+// are restored afterwards.
+u8 RunHeadlessBattle(const struct HeadlessBattleSpec *spec, struct HeadlessBattleResult *result)
+{
+    struct Pokemon *savedParties;
+    u8 savedBattleStyle = gSaveBlock2Ptr->optionsBattleStyle;
+    u32 steps = 0;
+
+    savedParties = Alloc(sizeof(gPlayerParty) + sizeof(gEnemyParty));
+    if (savedParties == NULL)
+        return B_OUTCOME_DREW;
+    memcpy(&savedParties[0], gPlayerParty, sizeof(gPlayerParty));
+    memcpy(&savedParties[PARTY_SIZE], gEnemyParty, sizeof(gEnemyParty));
+
+    gBattleTypeFlags = spec->battleTypeFlags & ~(BATTLE_TYPE_LINK | BATTLE_TYPE_RECORDED);
+    gTrainerBattleOpponent_A = spec->opponentA;
+    gTrainerBattleOpponent_B = spec->opponentB;
+    gBattleTerrain = spec->terrain;
+    gRngValue = spec->rngSeed;
+    gBattleOutcome = 0;
+    // The turn limit is checked before the battle intro clears these.
+    memset(&gBattleResults, 0, sizeof(gBattleResults));
+
+    // Nothing can answer the "switch Pokémon?" prompt of the shift style.
+    gSaveBlock2Ptr->optionsBattleStyle = OPTIONS_BATTLE_STYLE_SET;
+    gHeadlessBattle = TRUE;
+    memset(gHeadlessMoveUses, 0, sizeof(gHeadlessMoveUses));
+    gBattleAIScriptMismatches = 0;
+
+    AllocateBattleResources();
+    AllocateBattleSpritesData();
+    AllocateMonSpritesGfx();
+    SetUpBattleVarsAndBirchZigzagoon();
+
+    if (spec->createOpponentParty)
+    {
+        CreateNPCTrainerParty(&gEnemyParty[0], gTrainerBattleOpponent_A, TRUE);
+        if (gBattleTypeFlags & BATTLE_TYPE_TWO_OPPONENTS)
+            CreateNPCTrainerParty(&gEnemyParty[PARTY_SIZE / 2], gTrainerBattleOpponent_B, FALSE);
+    }
+
+    gMain.inBattle = TRUE;
+    gBattleTypeFlags |= BATTLE_TYPE_IS_MASTER;
+    SetAllPlayersBerryData();
+    InitBattleControllers();
+
+    while (gBattleOutcome == 0
+        && (spec->maxTurns == 0 || gBattleResults.battleTurnCounter < spec->maxTurns)
+        && (spec->maxSteps == 0 || steps < spec->maxSteps))
+    {
+        BattleMainCB1();
+        steps++;
+    }
+
+    if (result != NULL)
+    {
+        result->outcome = gBattleOutcome;
+        result->turns = gBattleResults.battleTurnCounter;
+        result->steps = steps;
+        result->aiScriptMismatches = gBattleAIScriptMismatches;
+    }
+
+    FreeMonSpritesGfx();
+    FreeBattleSpritesData();
+    FreeBattleResources();
+    gMain.inBattle = FALSE;
+    gHeadlessBattle = FALSE;
+    gSaveBlock2Ptr->optionsBattleStyle = savedBattleStyle;
+    memcpy(gPlayerParty, &savedParties[0], sizeof(gPlayerParty));
+    if (!spec->createOpponentParty)
+        memcpy(gEnemyParty, &savedParties[PARTY_SIZE], sizeof(gEnemyParty));
+    Free(savedParties);
+
+    return gBattleOutcome;
+}
+
+// Hands the battle in progress over to the headless controller and runs it
+// until it ends, turnCount more turns have started or stepLimit steps have
+// run, and returns the steps taken. The headless controller leaves graphics
+// and input alone, so a battle saved with BattleContext_Save beforehand can
+// be loaded back afterwards and carry on as if this hadn't run.
+u32 ContinueBattleHeadless(u8 turnCount, u32 stepLimit)
+{
+    u8 lastTurn = min(gBattleResults.battleTurnCounter + turnCount, 0xFF);
+    u32 steps = 0;
+    s32 i;
+
+    gHeadlessBattle = TRUE;
+    for (i = 0; i < gBattlersCount; i++)
+        gBattlerControllerFuncs[i] = SetControllerToHeadless;
+
+    while (gBattleOutcome == 0 && gBattleResults.battleTurnCounter < lastTurn && steps < stepLimit)
+    {
+        BattleMainCB1();
+        steps++;
+    }
+
+    return steps;
 }
 
+// Copies every variable in struct BattleContext between the snapshot and the
+// live battle, in the given direction.
+static void CopyBattleContext(struct BattleContext *context, bool8 save)
+{
+#define COPY_BATTLE_VAR(field, var)                                         \
+    {                                                                       \
+        STATIC_ASSERT(sizeof(context->field) == sizeof(var), field##Size);  \
+        if (save)                                                           \
+            memcpy(&context->field, &(var), sizeof(context->field));        \
+        else                                                                \
+            memcpy(&(var), &context->field, sizeof(context->field));        \
+    }
+
+    COPY_BATTLE_VAR(battleTypeFlags, gBattleTypeFlags);
+    COPY_BATTLE_VAR(battleTerrain, gBattleTerrain);
+    COPY_BATTLE_VAR(trainerBattleOpponentA, gTrainerBattleOpponent_A);
+    COPY_BATTLE_VAR(trainerBattleOpponentB, gTrainerBattleOpponent_B);
+    COPY_BATTLE_VAR(battleBufferA, gBattleBufferA);
+    COPY_BATTLE_VAR(battleBufferB, gBattleBufferB);
+    COPY_BATTLE_VAR(activeBattler, gActiveBattler);
+    COPY_BATTLE_VAR(battleControllerExecFlags, gBattleControllerExecFlags);
+    COPY_BATTLE_VAR(battlersCount, gBattlersCount);
+    COPY_BATTLE_VAR(battlerPartyIndexes, gBattlerPartyIndexes);
+    COPY_BATTLE_VAR(battlerPositions, gBattlerPositions);
+    COPY_BATTLE_VAR(actionsByTurnOrder, gActionsByTurnOrder);
+    COPY_BATTLE_VAR(battlerByTurnOrder, gBattlerByTurnOrder);
+    COPY_BATTLE_VAR(currentTurnActionNumber, gCurrentTurnActionNumber);
+    COPY_BATTLE_VAR(currentActionFuncId, gCurrentActionFuncId);
+    COPY_BATTLE_VAR(battleMons, gBattleMons);
+    COPY_BATTLE_VAR(currMovePos, gCurrMovePos);
+    COPY_BATTLE_VAR(chosenMovePos, gChosenMovePos);
+    COPY_BATTLE_VAR(currentMove, gCurrentMove);
+    COPY_BATTLE_VAR(chosenMove, gChosenMove);
+    COPY_BATTLE_VAR(calledMove, gCalledMove);
+    COPY_BATTLE_VAR(battleMoveDamage, gBattleMoveDamage);
+    COPY_BATTLE_VAR(hpDealt, gHpDealt);
+    COPY_BATTLE_VAR(bideDmg, gBideDmg);
+    COPY_BATTLE_VAR(lastUsedItem, gLastUsedItem);
+    COPY_BATTLE_VAR(lastUsedAbility, gLastUsedAbility);
+    COPY_BATTLE_VAR(battlerAttacker, gBattlerAttacker);
+    COPY_BATTLE_VAR(battlerTarget, gBattlerTarget);
+    COPY_BATTLE_VAR(battlerFainted, gBattlerFainted);
+    COPY_BATTLE_VAR(effectBattler, gEffectBattler);
+    COPY_BATTLE_VAR(potentialItemEffectBattler, gPotentialItemEffectBattler);
+    COPY_BATTLE_VAR(absentBattlerFlags, gAbsentBattlerFlags);
+    COPY_BATTLE_VAR(critMultiplier, gCritMultiplier);
+    COPY_BATTLE_VAR(multiHitCounter, gMultiHitCounter);
+    COPY_BATTLE_VAR(battlescriptCurrInstr, gBattlescriptCurrInstr);
+    COPY_BATTLE_VAR(chosenActionByBattler, gChosenActionByBattler);
+    COPY_BATTLE_VAR(selectionBattleScripts, gSelectionBattleScripts);
+    COPY_BATTLE_VAR(palaceSelectionBattleScripts, gPalaceSelectionBattleScripts);
+    COPY_BATTLE_VAR(lastPrintedMoves, gLastPrintedMoves);
+    COPY_BATTLE_VAR(lastMoves, gLastMoves);
+    COPY_BATTLE_VAR(lastLandedMoves, gLastLandedMoves);
+    COPY_BATTLE_VAR(lastHitByType, gLastHitByType);
+    COPY_BATTLE_VAR(lastResultingMoves, gLastResultingMoves);
+    COPY_BATTLE_VAR(lockedMoves, gLockedMoves);
+    COPY_BATTLE_VAR(lastHitBy, gLastHitBy);
+    COPY_BATTLE_VAR(chosenMoveByBattler, gChosenMoveByBattler);
+    COPY_BATTLE_VAR(moveResultFlags, gMoveResultFlags);
+    COPY_BATTLE_VAR(hitMarker, gHitMarker);
+    COPY_BATTLE_VAR(bideTarget, gBideTarget);
+    COPY_BATTLE_VAR(sideStatuses, gSideStatuses);
+    COPY_BATTLE_VAR(sideTimers, gSideTimers);
+    COPY_BATTLE_VAR(statuses3, gStatuses3);
+    COPY_BATTLE_VAR(disableStructs, gDisableStructs);
+    COPY_BATTLE_VAR(pauseCounterBattle, gPauseCounterBattle);
+    COPY_BATTLE_VAR(paydayMoney, gPaydayMoney);
+    COPY_BATTLE_VAR(randomTurnNumber, gRandomTurnNumber);
+    COPY_BATTLE_VAR(battleCommunication, gBattleCommunication);
+    COPY_BATTLE_VAR(battleOutcome, gBattleOutcome);
+    COPY_BATTLE_VAR(protectStructs, gProtectStructs);
+    COPY_BATTLE_VAR(specialStatuses, gSpecialStatuses);
+    COPY_BATTLE_VAR(battleWeather, gBattleWeather);
+    COPY_BATTLE_VAR(wishFutureKnock, gWishFutureKnock);
+    COPY_BATTLE_VAR(sentPokesToOpponent, gSentPokesToOpponent);
+    COPY_BATTLE_VAR(dynamicBasePower, gDynamicBasePower);
+    COPY_BATTLE_VAR(expShareExp, gExpShareExp);
+    COPY_BATTLE_VAR(enigmaBerries, gEnigmaBerries);
+    COPY_BATTLE_VAR(battleScripting, gBattleScripting);
+    COPY_BATTLE_VAR(actionSelectionCursor, gActionSelectionCursor);
+    COPY_BATTLE_VAR(moveSelectionCursor, gMoveSelectionCursor);
+    COPY_BATTLE_VAR(transformedPersonalities, gTransformedPersonalities);
+    COPY_BATTLE_VAR(battleMovePower, gBattleMovePower);
+    COPY_BATTLE_VAR(moveToLearn, gMoveToLearn);
+    COPY_BATTLE_VAR(battleMonForms, gBattleMonForms);
+    COPY_BATTLE_VAR(battleMainFunc, gBattleMainFunc);
+    COPY_BATTLE_VAR(battleResults, gBattleResults);
+    COPY_BATTLE_VAR(leveledUpInBattle, gLeveledUpInBattle);
+    COPY_BATTLE_VAR(battlerControllerFuncs, gBattlerControllerFuncs);
+    COPY_BATTLE_VAR(battleControllerData, gBattleControllerData);
+    COPY_BATTLE_VAR(battlerInMenuId, gBattlerInMenuId);
+    COPY_BATTLE_VAR(doingBattleAnim, gDoingBattleAnim);
+    COPY_BATTLE_VAR(multiUsePlayerCursor, gMultiUsePlayerCursor);
+    COPY_BATTLE_VAR(numberOfMovesToChoose, gNumberOfMovesToChoose);
+    COPY_BATTLE_VAR(battleTextBuff1, gBattleTextBuff1);
+    COPY_BATTLE_VAR(battleTextBuff2, gBattleTextBuff2);
+    COPY_BATTLE_VAR(battleTextBuff3, gBattleTextBuff3);
+    COPY_BATTLE_VAR(battleStruct, *gBattleStruct);
+    COPY_BATTLE_VAR(resourceFlags, *gBattleResources->flags);
+    COPY_BATTLE_VAR(battleScriptsStack, *gBattleResources->battleScriptsStack);
+    COPY_BATTLE_VAR(battleCallbackStack, *gBattleResources->battleCallbackStack);
+    COPY_BATTLE_VAR(beforeLvlUp, *gBattleResources->beforeLvlUp);
+    COPY_BATTLE_VAR(ai, *gBattleResources->ai);
+    COPY_BATTLE_VAR(battleHistory, *gBattleResources->battleHistory);
+    COPY_BATTLE_VAR(aiScriptsStack, *gBattleResources->AI_ScriptsStack);
+    COPY_BATTLE_VAR(battlerData, *(struct BattleSpriteInfo (*)[MAX_BATTLERS_COUNT])gBattleSpritesDataPtr->battlerData);
+    COPY_BATTLE_VAR(healthBoxesData, *(struct BattleHealthboxInfo (*)[MAX_BATTLERS_COUNT])gBattleSpritesDataPtr->healthBoxesData);
+    COPY_BATTLE_VAR(animationData, *gBattleSpritesDataPtr->animationData);
+    COPY_BATTLE_VAR(playerParty, gPlayerParty);
+    COPY_BATTLE_VAR(enemyParty, gEnemyParty);
+    COPY_BATTLE_VAR(rngValue, gRngValue);
+
+#undef COPY_BATTLE_VAR
+}
+
+void BattleContext_Save(struct BattleContext *context)
+{
+    CopyBattleContext(context, TRUE);
+}
+
+void BattleContext_Load(const struct BattleContext *context)
+{
+    CopyBattleContext((struct BattleContext *)context, FALSE);
+}
+#endif // PORTABLE
+
 static void BattleStartClearSetData(void)
 {
     s32 i;
@@ -3970,6 +4213,10 @@ void BattleTurnPassed(void)
         gBattleStruct->arenaTurnCounter++;
     }
 
+#ifdef PORTABLE
+    BattleReplay_TurnPassed();
+#endif
+
     for (i = 0; i < gBattlersCount; i++)
     {
         gChosenActionByBattler[i] = B_ACTION_NONE;
@@ -4376,6 +4623,9 @@ static void HandleTurnActionSelectionState(void)
                     }
                     break;
                 case B_ACTION_USE_ITEM:
+#ifdef PORTABLE
+                    BattleReplay_RecordItem(gActiveBattler, gBattleBufferB[gActiveBattler][1] | (gBattleBufferB[gActiveBattler][2] << 8));
+#endif
                     if ((gBattleBufferB[gActiveBattler][1] | (gBattleBufferB[gActiveBattler][2] << 8)) == 0)
                     {
                         gBattleCommunication[gActiveBattler] = STATE_BEFORE_ACTION_CHOSEN;
@@ -0,0 +1,973 @@
+#ifdef PORTABLE
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+#include "global.h"
+#include "battle.h"
+#include "battle_ai_lookahead.h"
+#include "battle_anim.h"
+#include "battle_controllers.h"
+#include "battle_main.h"
+#include "battle_replay.h"
+#include "battle_setup.h"
+#include "load_save.h"
+#include "pokemon.h"
+#include "random.h"
+#include "util.h"
+
+#ifdef PORTABLE
+
+// A replay holds what a battle started from (its setup, both parties and the
+// RNG seed), every battler's actions, and the RNG and action counts at the
+// end of each turn. Recording piggybacks on the recorded battle hooks, so the
+// actions are the same bytes RecordedBattle_SetBattlerAction sees, without
+// BATTLER_RECORD_SIZE's limit and with the items used added.
+//
+// BattleReplay_Verify runs the battle again headless. The player's battlers
+// of a battle played in the game read their actions back from the replay;
+// every other battler is rerun by its AI, which from the same state and RNG
+// must choose the same actions. Turn by turn the new actions and RNG are
+// compared against the recorded ones, so a change to the engine shows up at
+// the first turn it makes a difference.
+//
+// Only battles that don't draw from the RNG every frame can be replayed
+// without their frame timing: headless ones, and the Battle Frontier's,
+// which are the ones the game records too. State outside the battle, such as
+// the save data the Battle Factory's AI reads, is whatever the process
+// verifying the replay has.
+//
+// File layout, all little-endian:
+//   "EBRP", u16 version, u16 0
+//   then chunks of u32 tag, u32 size and size bytes of data:
+//   SETU  u32 battleTypeFlags, u16 opponentA, u16 opponentB, u16 partnerId,
+//         u8 terrain, u8 inputBattlers, u32 rngSeed
+//   PRTY  u16 size of a struct Pokemon, u16 0, the player's and the enemy's party
+//   ACTS  u8 battler, u8[3] 0, then that battler's actions; one per battler
+//   TURN  per turn: u32 rngValue, u32 actionCounts[MAX_BATTLERS_COUNT]
+//   RSLT  u8 outcome, u8 0, u16 turnsTaken, u32 partyChecksum
+//   LOOK  u8 inFrontier, u8 turns, u8 rolloutsPerCandidate, u8 0,
+//         u32 stepBudget: gBattleAILookahead while recording
+// Readers skip chunks they don't know, so new data can go into new chunks
+// without a version bump; the version only changes when existing ones do.
+
+#define REPLAY_TAG(a, b, c, d) ((a) | ((b) << 8) | ((c) << 16) | ((u32)(d) << 24))
+
+#define REPLAY_TAG_SETUP   REPLAY_TAG('S', 'E', 'T', 'U')
+#define REPLAY_TAG_PARTIES REPLAY_TAG('P', 'R', 'T', 'Y')
+#define REPLAY_TAG_ACTIONS REPLAY_TAG('A', 'C', 'T', 'S')
+#define REPLAY_TAG_TURNS   REPLAY_TAG('T', 'U', 'R', 'N')
+#define REPLAY_TAG_RESULT  REPLAY_TAG('R', 'S', 'L', 'T')
+#define REPLAY_TAG_LOOKAHEAD REPLAY_TAG('L', 'O', 'O', 'K')
+
+#define REPLAY_TURN_SIZE (4 + 4 * MAX_BATTLERS_COUNT)
+
+#define REPLAY_STEP_LIMIT 1000000
+#define MAX_REPLAY_WORKERS 256
+
+struct ReplayWriter
+{
+    u8 *data;
+    u32 size;
+    u32 capacity;
+    bool8 failed;
+};
+
+struct ReplayReader
+{
+    const u8 *data;
+    u32 size;
+    u32 pos;
+    bool8 failed;
+};
+
+static struct BattleReplay *sRecording;
+static const struct BattleReplay *sPlayback;
+static struct BattleReplay *sPausedRecording;
+static const struct BattleReplay *sPausedPlayback;
+static struct BattleReplay sPlaybackActual; // what the battle being verified did
+static struct BattleReplayCheck sCheck;
+static u32 sCheckedActionCounts[MAX_BATTLERS_COUNT];
+static struct Pokemon sSavedPlayerParty[PARTY_SIZE];
+static struct BattleReplay sAutoReplay; // recorded into sReplayDir
+static const char *sReplayDir;
+
+static const char *const sResultNames[BATTLE_REPLAY_RESULT_COUNT] =
+{
+    [BATTLE_REPLAY_MATCH]              = "match",
+    [BATTLE_REPLAY_BAD_FILE]           = "bad file",
+    [BATTLE_REPLAY_DESYNC_RNG]         = "RNG desync",
+    [BATTLE_REPLAY_DESYNC_ACTIONS]     = "action desync",
+    [BATTLE_REPLAY_DESYNC_RESULT]      = "result desync",
+    [BATTLE_REPLAY_OUT_OF_ACTIONS]     = "out of actions",
+    [BATTLE_REPLAY_STEP_LIMIT]         = "step limit",
+    [BATTLE_REPLAY_AI_SCRIPT_MISMATCH] = "AI script mismatch",
+};
+
+static void SaveAutoReplay(void);
+
+static bool8 Reserve(void **buffer, u32 *capacity, u32 count, u32 elementSize)
+{
+    void *grown;
+    u32 newCapacity;
+
+    if (count <= *capacity)
+        return TRUE;
+
+    newCapacity = max(max(*capacity * 2, count), 64);
+    grown = realloc(*buffer, (size_t)newCapacity * elementSize);
+    if (grown == NULL)
+        return FALSE;
+
+    *buffer = grown;
+    *capacity = newCapacity;
+    return TRUE;
+}
+
+// Keeps the buffers for the next battle.
+static void ResetRecording(struct BattleReplay *replay)
+{
+    s32 i;
+
+    replay->complete = FALSE;
+    for (i = 0; i < MAX_BATTLERS_COUNT; i++)
+        replay->actionCounts[i] = 0;
+    replay->turnCount = 0;
+}
+
+void BattleReplay_Free(struct BattleReplay *replay)
+{
+    s32 i;
+
+    for (i = 0; i < MAX_BATTLERS_COUNT; i++)
+        free(replay->actions[i]);
+    free(replay->turns);
+    memset(replay, 0, sizeof(*replay));
+}
+
+// The next battle to start is recorded into replay, if it can be replayed.
+// replay->complete tells whether it was once the battle is over.
+void BattleReplay_StartRecording(struct BattleReplay *replay)
+{
+    ResetRecording(replay);
+    sRecording = replay;
+}
+
+static bool8 CanRecordBattle(void)
+{
+    if (gBattleTypeFlags & (BATTLE_TYPE_LINK | BATTLE_TYPE_RECORDED))
+        return FALSE;
+
+    return gHeadlessBattle || (gBattleTypeFlags & BATTLE_TYPE_FRONTIER);
+}
+
+static u32 GetPartyChecksum(void)
+{
+    return CalcCRC16WithTable((const u8 *)gPlayerParty, sizeof(gPlayerParty))
+         | (CalcCRC16WithTable((const u8 *)gEnemyParty, sizeof(gEnemyParty)) << 16);
+}
+
+// Ends the battle being verified the way running out of recorded actions
+// ends a recorded battle. Only the first difference is reported.
+static void StopPlayback(u8 result)
+{
+    if (sCheck.result == BATTLE_REPLAY_MATCH)
+    {
+        sCheck.result = result;
+        sCheck.turn = gBattleResults.battleTurnCounter;
+    }
+    if (gBattleOutcome == 0)
+        gBattleOutcome = B_OUTCOME_PLAYER_TELEPORTED;
+}
+
+// Checks the actions recorded since the last check against the replay's,
+// up to the given counts.
+static bool8 CheckActions(const u32 *actionCounts)
+{
+    u32 checked, count;
+    s32 i;
+
+    for (i = 0; i < MAX_BATTLERS_COUNT; i++)
+    {
+        checked = sCheckedActionCounts[i];
+        count = sPlaybackActual.actionCounts[i];
+        if (count != actionCounts[i] || count > sPlayback->actionCounts[i])
+            return FALSE;
+        if (count != checked && memcmp(&sPlaybackActual.actions[i][checked], &sPlayback->actions[i][checked], count - checked) != 0)
+            return FALSE;
+        sCheckedActionCounts[i] = count;
+    }
+    return TRUE;
+}
+
+void BattleReplay_StartBattle(void)
+{
+    s32 i;
+
+    if (sPlayback != NULL)
+        gRngValue = sPlayback->rngSeed;
+
+    if (sRecording == NULL)
+        return;
+    if (sPlayback == NULL && !CanRecordBattle())
+    {
+        sRecording = NULL;
+        return;
+    }
+
+    sRecording->battleTypeFlags = gBattleTypeFlags;
+    sRecording->opponentA = gTrainerBattleOpponent_A;
+    sRecording->opponentB = gTrainerBattleOpponent_B;
+    sRecording->partnerId = gPartnerTrainerId;
+    sRecording->terrain = gBattleTerrain;
+    sRecording->rngSeed = gRngValue;
+    sRecording->lookahead = gBattleAILookahead;
+    memcpy(sRecording->playerParty, gPlayerParty, sizeof(gPlayerParty));
+    memcpy(sRecording->enemyParty, gEnemyParty, sizeof(gEnemyParty));
+
+    // The opponents' AI controller is the one the headless controller uses.
+    // The player's battlers were played by hand, or by the partner's AI,
+    // which the headless controller doesn't use for switching.
+    sRecording->inputBattlers = 0;
+    if (!gHeadlessBattle)
+    {
+        for (i = 0; i < gBattlersCount; i++)
+        {
+            if (GetBattlerSide(i) == B_SIDE_PLAYER)
+                sRecording->inputBattlers |= gBitTable[i];
+        }
+    }
+}
+
+void BattleReplay_TurnPassed(void)
+{
+    struct BattleReplayTurn *turn;
+
+    if (sRecording == NULL)
+        return;
+    if (!Reserve((void **)&sRecording->turns, &sRecording->turnCapacity, sRecording->turnCount + 1, sizeof(*sRecording->turns)))
+    {
+        sRecording = NULL;
+        return;
+    }
+
+    turn = &sRecording->turns[sRecording->turnCount++];
+    turn->rngValue = gRngValue;
+    memcpy(turn->actionCounts, sRecording->actionCounts, sizeof(turn->actionCounts));
+
+    if (sPlayback != NULL)
+    {
+        const struct BattleReplayTurn *expected;
+
+        if (sRecording->turnCount > sPlayback->turnCount)
+        {
+            StopPlayback(BATTLE_REPLAY_DESYNC_RESULT);
+            return;
+        }
+        expected = &sPlayback->turns[sRecording->turnCount - 1];
+        if (!CheckActions(expected->actionCounts))
+            StopPlayback(BATTLE_REPLAY_DESYNC_ACTIONS);
+        else if (turn->rngValue != expected->rngValue)
+            StopPlayback(BATTLE_REPLAY_DESYNC_RNG);
+    }
+}
+
+// Called on every step of the battle engine once gBattleOutcome is set.
+void BattleReplay_EndBattle(void)
+{
+    if (sRecording == NULL)
+        return;
+
+    sRecording->outcome = gBattleOutcome;
+    sRecording->turnsTaken = gBattleResults.battleTurnCounter;
+    sRecording->partyChecksum = GetPartyChecksum();
+    sRecording->complete = TRUE;
+
+    if (sPlayback != NULL)
+    {
+        if (!CheckActions(sPlayback->actionCounts))
+            StopPlayback(BATTLE_REPLAY_DESYNC_ACTIONS);
+        else if (sRecording->turnCount != sPlayback->turnCount
+              || sRecording->outcome != sPlayback->outcome
+              || sRecording->partyChecksum != sPlayback->partyChecksum)
+            StopPlayback(BATTLE_REPLAY_DESYNC_RESULT);
+    }
+
+    if (sRecording == &sAutoReplay)
+        SaveAutoReplay();
+    sRecording = NULL;
+}
+
+void BattleReplay_RecordAction(u8 battlerId, u8 action)
+{
+    if (sRecording == NULL)
+        return;
+    if (!Reserve((void **)&sRecording->actions[battlerId], &sRecording->actionCapacities[battlerId], sRecording->actionCounts[battlerId] + 1, 1))
+    {
+        sRecording = NULL;
+        return;
+    }
+
+    sRecording->actions[battlerId][sRecording->actionCounts[battlerId]++] = action;
+}
+
+void BattleReplay_ClearActions(u8 battlerId, u8 count)
+{
+    if (sRecording != NULL)
+        sRecording->actionCounts[battlerId] -= min(count, sRecording->actionCounts[battlerId]);
+}
+
+// Recorded battles leave out the item an action uses, as no battle the game
+// records lets the player use one.
+void BattleReplay_RecordItem(u8 battlerId, u16 itemId)
+{
+    BattleReplay_RecordAction(battlerId, itemId);
+    BattleReplay_RecordAction(battlerId, itemId >> 8);
+}
+
+// While paused the hooks see no replay being recorded or played back, for
+// the battles the lookahead AI plays out on a copy of the battle.
+void BattleReplay_SetPaused(bool8 paused)
+{
+    if (paused)
+    {
+        sPausedRecording = sRecording;
+        sPausedPlayback = sPlayback;
+        sRecording = NULL;
+        sPlayback = NULL;
+    }
+    else
+    {
+        sRecording = sPausedRecording;
+        sPlayback = sPausedPlayback;
+        sPausedRecording = NULL;
+        sPausedPlayback = NULL;
+    }
+}
+
+bool8 BattleReplay_IsInputBattler(u8 battlerId)
+{
+    return sPlayback != NULL && (sPlayback->inputBattlers & gBitTable[battlerId]);
+}
+
+// Reads the next count actions of an input battler, which are the ones the
+// battle engine will record next.
+bool8 BattleReplay_ReadActions(u8 battlerId, u8 *dst, u8 count)
+{
+    u32 pos = sPlaybackActual.actionCounts[battlerId];
+
+    if (pos + count > sPlayback->actionCounts[battlerId])
+    {
+        StopPlayback(BATTLE_REPLAY_OUT_OF_ACTIONS);
+        return FALSE;
+    }
+
+    memcpy(dst, &sPlayback->actions[battlerId][pos], count);
+    return TRUE;
+}
+
+u8 BattleReplay_Verify(const struct BattleReplay *replay, struct BattleReplayCheck *check)
+{
+    struct HeadlessBattleSpec spec = {0};
+    struct HeadlessBattleResult result;
+    u16 savedPartnerId = gPartnerTrainerId;
+    struct BattleAILookaheadSettings savedLookahead = gBattleAILookahead;
+
+    memset(&sCheck, 0, sizeof(sCheck));
+    if (!replay->complete)
+    {
+        sCheck.result = BATTLE_REPLAY_BAD_FILE;
+    }
+    else
+    {
+        memcpy(sSavedPlayerParty, gPlayerParty, sizeof(gPlayerParty));
+        memcpy(gPlayerParty, replay->playerParty, sizeof(gPlayerParty));
+        memcpy(gEnemyParty, replay->enemyParty, sizeof(gEnemyParty));
+        gPartnerTrainerId = replay->partnerId;
+        gBattleAILookahead = replay->lookahead;
+
+        spec.battleTypeFlags = replay->battleTypeFlags;
+        spec.opponentA = replay->opponentA;
+        spec.opponentB = replay->opponentB;
+        spec.terrain = replay->terrain;
+        spec.maxSteps = REPLAY_STEP_LIMIT;
+        spec.rngSeed = replay->rngSeed;
+
+        memset(sCheckedActionCounts, 0, sizeof(sCheckedActionCounts));
+        ResetRecording(&sPlaybackActual);
+        sPlayback = replay;
+        sRecording = &sPlaybackActual;
+
+        RunHeadlessBattle(&spec, &result);
+
+        if (sCheck.result == BATTLE_REPLAY_MATCH && !sPlaybackActual.complete)
+            sCheck.result = (result.outcome == 0) ? BATTLE_REPLAY_STEP_LIMIT : BATTLE_REPLAY_DESYNC_RESULT;
+        if (sCheck.result == BATTLE_REPLAY_MATCH && result.aiScriptMismatches != 0)
+            sCheck.result = BATTLE_REPLAY_AI_SCRIPT_MISMATCH;
+        sCheck.outcome = result.outcome;
+
+        sPlayback = NULL;
+        sRecording = NULL;
+        gPartnerTrainerId = savedPartnerId;
+        gBattleAILookahead = savedLookahead;
+        memcpy(gPlayerParty, sSavedPlayerParty, sizeof(gPlayerParty));
+    }
+
+    if (check != NULL)
+        *check = sCheck;
+    return sCheck.result;
+}
+
+static void WriteBytes(struct ReplayWriter *writer, const void *src, u32 size)
+{
+    if (writer->failed)
+        return;
+    if (!Reserve((void **)&writer->data, &writer->capacity, writer->size + size, 1))
+    {
+        writer->failed = TRUE;
+        return;
+    }
+
+    memcpy(&writer->data[writer->size], src, size);
+    writer->size += size;
+}
+
+static void WriteU8(struct ReplayWriter *writer, u8 value)
+{
+    WriteBytes(writer, &value, 1);
+}
+
+static void WriteU16(struct ReplayWriter *writer, u16 value)
+{
+    u8 bytes[2] = {value, value >> 8};
+
+    WriteBytes(writer, bytes, sizeof(bytes));
+}
+
+static void WriteU32(struct ReplayWriter *writer, u32 value)
+{
+    u8 bytes[4] = {value, value >> 8, value >> 16, value >> 24};
+
+    WriteBytes(writer, bytes, sizeof(bytes));
+}
+
+// Returns where the chunk's size goes once EndChunk knows it.
+static u32 BeginChunk(struct ReplayWriter *writer, u32 tag)
+{
+    u32 sizePos;
+
+    WriteU32(writer, tag);
+    sizePos = writer->size;
+    WriteU32(writer, 0);
+    return sizePos;
+}
+
+static void EndChunk(struct ReplayWriter *writer, u32 sizePos)
+{
+    u32 size = writer->size - sizePos - 4;
+
+    if (writer->failed)
+        return;
+
+    writer->data[sizePos + 0] = size;
+    writer->data[sizePos + 1] = size >> 8;
+    writer->data[sizePos + 2] = size >> 16;
+    writer->data[sizePos + 3] = size >> 24;
+}
+
+// Returns the replay in the file format, in a buffer the caller frees.
+u8 *BattleReplay_Write(const struct BattleReplay *replay, u32 *size)
+{
+    struct ReplayWriter writer = {0};
+    u32 chunk;
+    s32 i, j;
+
+    WriteBytes(&writer, "EBRP", 4);
+    WriteU16(&writer, BATTLE_REPLAY_VERSION);
+    WriteU16(&writer, 0);
+
+    chunk = BeginChunk(&writer, REPLAY_TAG_SETUP);
+    WriteU32(&writer, replay->battleTypeFlags);
+    WriteU16(&writer, replay->opponentA);
+    WriteU16(&writer, replay->opponentB);
+    WriteU16(&writer, replay->partnerId);
+    WriteU8(&writer, replay->terrain);
+    WriteU8(&writer, replay->inputBattlers);
+    WriteU32(&writer, replay->rngSeed);
+    EndChunk(&writer, chunk);
+
+    chunk = BeginChunk(&writer, REPLAY_TAG_PARTIES);
+    WriteU16(&writer, sizeof(struct Pokemon));
+    WriteU16(&writer, 0);
+    WriteBytes(&writer, replay->playerParty, sizeof(replay->playerParty));
+    WriteBytes(&writer, replay->enemyParty, sizeof(replay->enemyParty));
+    EndChunk(&writer, chunk);
+
+    for (i = 0; i < MAX_BATTLERS_COUNT; i++)
+    {
+        if (replay->actionCounts[i] == 0)
+            continue;
+
+        chunk = BeginChunk(&writer, REPLAY_TAG_ACTIONS);
+        WriteU8(&writer, i);
+        WriteU8(&writer, 0);
+        WriteU16(&writer, 0);
+        WriteBytes(&writer, replay->actions[i], replay->actionCounts[i]);
+        EndChunk(&writer, chunk);
+    }
+
+    chunk = BeginChunk(&writer, REPLAY_TAG_TURNS);
+    for (i = 0; i < replay->turnCount; i++)
+    {
+        WriteU32(&writer, replay->turns[i].rngValue);
+        for (j = 0; j < MAX_BATTLERS_COUNT; j++)
+            WriteU32(&writer, replay->turns[i].actionCounts[j]);
+    }
+    EndChunk(&writer, chunk);
+
+    chunk = BeginChunk(&writer, REPLAY_TAG_LOOKAHEAD);
+    WriteU8(&writer, replay->lookahead.inFrontier);
+    WriteU8(&writer, replay->lookahead.turns);
+    WriteU8(&writer, replay->lookahead.rolloutsPerCandidate);
+    WriteU8(&writer, 0);
+    WriteU32(&writer, replay->lookahead.stepBudget);
+    EndChunk(&writer, chunk);
+
+    if (replay->complete)
+    {
+        chunk = BeginChunk(&writer, REPLAY_TAG_RESULT);
+        WriteU8(&writer, replay->outcome);
+        WriteU8(&writer, 0);
+        WriteU16(&writer, replay->turnsTaken);
+        WriteU32(&writer, replay->partyChecksum);
+        EndChunk(&writer, chunk);
+    }
+
+    if (writer.failed)
+    {
+        free(writer.data);
+        return NULL;
+    }
+
+    *size = writer.size;
+    return writer.data;
+}
+
+static void ReadBytes(struct ReplayReader *reader, void *dst, u32 size)
+{
+    if (reader->failed || size > reader->size - reader->pos)
+    {
+        reader->failed = TRUE;
+        memset(dst, 0, size);
+        return;
+    }
+
+    memcpy(dst, &reader->data[reader->pos], size);
+    reader->pos += size;
+}
+
+static u8 ReadU8(struct ReplayReader *reader)
+{
+    u8 value;
+
+    ReadBytes(reader, &value, 1);
+    return value;
+}
+
+static u16 ReadU16(struct ReplayReader *reader)
+{
+    u8 bytes[2];
+
+    ReadBytes(reader, bytes, sizeof(bytes));
+    return bytes[0] | (bytes[1] << 8);
+}
+
+static u32 ReadU32(struct ReplayReader *reader)
+{
+    u8 bytes[4];
+
+    ReadBytes(reader, bytes, sizeof(bytes));
+    return bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | ((u32)bytes[3] << 24);
+}
+
+static bool8 ReadChunk(struct BattleReplay *replay, u32 tag, struct ReplayReader *chunk)
+{
+    u8 battlerId;
+    u32 count;
+    s32 i, j;
+
+    switch (tag)
+    {
+    case REPLAY_TAG_SETUP:
+        replay->battleTypeFlags = ReadU32(chunk);
+        replay->opponentA = ReadU16(chunk);
+        replay->opponentB = ReadU16(chunk);
+        replay->partnerId = ReadU16(chunk);
+        replay->terrain = ReadU8(chunk);
+        replay->inputBattlers = ReadU8(chunk);
+        replay->rngSeed = ReadU32(chunk);
+        break;
+    case REPLAY_TAG_PARTIES:
+        if (ReadU16(chunk) != sizeof(struct Pokemon))
+            return FALSE;
+        ReadU16(chunk);
+        ReadBytes(chunk, replay->playerParty, sizeof(replay->playerParty));
+        ReadBytes(chunk, replay->enemyParty, sizeof(replay->enemyParty));
+        break;
+    case REPLAY_TAG_ACTIONS:
+        battlerId = ReadU8(chunk);
+        ReadU8(chunk);
+        ReadU16(chunk);
+        if (chunk->failed || battlerId >= MAX_BATTLERS_COUNT)
+            return FALSE;
+
+        count = chunk->size - chunk->pos;
+        replay->actionCounts[battlerId] = 0;
+        if (!Reserve((void **)&replay->actions[battlerId], &replay->actionCapacities[battlerId], count, 1))
+            return FALSE;
+        ReadBytes(chunk, replay->actions[battlerId], count);
+        replay->actionCounts[battlerId] = count;
+        break;
+    case REPLAY_TAG_TURNS:
+        if (chunk->size % REPLAY_TURN_SIZE != 0)
+            return FALSE;
+
+        count = chunk->size / REPLAY_TURN_SIZE;
+        replay->turnCount = 0;
+        if (!Reserve((void **)&replay->turns, &replay->turnCapacity, count, sizeof(*replay->turns)))
+            return FALSE;
+        for (i = 0; i < count; i++)
+        {
+            replay->turns[i].rngValue = ReadU32(chunk);
+            for (j = 0; j < MAX_BATTLERS_COUNT; j++)
+                replay->turns[i].actionCounts[j] = ReadU32(chunk);
+        }
+        replay->turnCount = count;
+        break;
+    case REPLAY_TAG_RESULT:
+        replay->outcome = ReadU8(chunk);
+        ReadU8(chunk);
+        replay->turnsTaken = ReadU16(chunk);
+        replay->partyChecksum = ReadU32(chunk);
+        replay->complete = TRUE;
+        break;
+    case REPLAY_TAG_LOOKAHEAD:
+        replay->lookahead.inFrontier = ReadU8(chunk);
+        replay->lookahead.turns = ReadU8(chunk);
+        replay->lookahead.rolloutsPerCandidate = ReadU8(chunk);
+        ReadU8(chunk);
+        replay->lookahead.stepBudget = ReadU32(chunk);
+        break;
+    }
+
+    return !chunk->failed;
+}
+
+// Fills replay, which must be zeroed or hold a replay, from data in the file
+// format. On failure replay is left empty.
+bool8 BattleReplay_Read(struct BattleReplay *replay, const u8 *data, u32 size)
+{
+    struct ReplayReader reader = {data, size, 0, FALSE};
+    struct ReplayReader chunk;
+    bool8 hasSetup = FALSE, hasParties = FALSE;
+    u8 magic[4];
+    u32 tag;
+
+    BattleReplay_Free(replay);
+
+    ReadBytes(&reader, magic, sizeof(magic));
+    if (memcmp(magic, "EBRP", sizeof(magic)) != 0 || ReadU16(&reader) > BATTLE_REPLAY_VERSION)
+        return FALSE;
+    ReadU16(&reader);
+
+    while (!reader.failed && reader.pos < reader.size)
+    {
+        tag = ReadU32(&reader);
+        chunk.size = ReadU32(&reader);
+        if (reader.failed || chunk.size > reader.size - reader.pos)
+            break;
+
+        chunk.data = &reader.data[reader.pos];
+        chunk.pos = 0;
+        chunk.failed = FALSE;
+        reader.pos += chunk.size;
+
+        if (!ReadChunk(replay, tag, &chunk))
+        {
+            reader.failed = TRUE;
+            break;
+        }
+        if (tag == REPLAY_TAG_SETUP)
+            hasSetup = TRUE;
+        else if (tag == REPLAY_TAG_PARTIES)
+            hasParties = TRUE;
+    }
+
+    if (reader.failed || reader.pos != reader.size || !hasSetup || !hasParties)
+    {
+        BattleReplay_Free(replay);
+        return FALSE;
+    }
+    return TRUE;
+}
+
+bool8 BattleReplay_Load(struct BattleReplay *replay, const char *path)
+{
+    FILE *file = fopen(path, "rb");
+    u8 *data = NULL;
+    long size;
+    bool8 ret = FALSE;
+
+    if (file == NULL)
+        return FALSE;
+
+    if (fseek(file, 0, SEEK_END) == 0 && (size = ftell(file)) >= 0 && fseek(file, 0, SEEK_SET) == 0)
+    {
+        data = malloc(size + 1);
+        if (data != NULL && fread(data, 1, size, file) == (size_t)size)
+            ret = BattleReplay_Read(replay, data, size);
+    }
+
+    free(data);
+    fclose(file);
+    return ret;
+}
+
+bool8 BattleReplay_Save(const struct BattleReplay *replay, const char *path)
+{
+    FILE *file;
+    u8 *data;
+    u32 size;
+    bool8 ret;
+
+    data = BattleReplay_Write(replay, &size);
+    if (data == NULL)
+        return FALSE;
+
+    file = fopen(path, "wb");
+    ret = (file != NULL && fwrite(data, 1, size, file) == size);
+    if (file != NULL && fclose(file) != 0)
+        ret = FALSE;
+
+    free(data);
+    return ret;
+}
+
+static u8 VerifyFile(const char *path)
+{
+    struct BattleReplay replay = {0};
+    u8 result = BATTLE_REPLAY_BAD_FILE;
+
+    if (BattleReplay_Load(&replay, path))
+        result = BattleReplay_Verify(&replay, NULL);
+
+    BattleReplay_Free(&replay);
+    return result;
+}
+
+// Verifies replays first, first + stride, ... below count into results.
+static void VerifyWorkerFiles(const char *const *paths, u32 first, u32 stride, u32 count, u8 *results)
+{
+    u32 i, n;
+
+    for (i = first, n = 0; i < count; i += stride, n++)
+        results[n] = VerifyFile(paths[i]);
+}
+
+static bool8 WriteAll(int fd, const void *data, size_t size)
+{
+    const u8 *ptr = data;
+
+    while (size != 0)
+    {
+        ssize_t n = write(fd, ptr, size);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return FALSE;
+        ptr += n;
+        size -= n;
+    }
+    return TRUE;
+}
+
+static bool8 ReadAll(int fd, void *data, size_t size)
+{
+    u8 *ptr = data;
+
+    while (size != 0)
+    {
+        ssize_t n = read(fd, ptr, size);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return FALSE;
+        ptr += n;
+        size -= n;
+    }
+    return TRUE;
+}
+
+// Verifies every replay file across workerCount processes (0 for one per
+// online CPU), like BattleSim_Run, and returns how many matched. results, if
+// not NULL, gets each file's BATTLE_REPLAY_* result.
+u32 BattleReplay_VerifyFiles(const char *const *paths, u32 count, u32 workerCount, u8 *results)
+{
+    pid_t pids[MAX_REPLAY_WORKERS];
+    int fds[MAX_REPLAY_WORKERS];
+    int pipeFds[2];
+    u8 *workerResults;
+    u8 *allResults = results;
+    u32 i, j, n, matches;
+
+    if (allResults == NULL)
+        allResults = malloc(max(count, 1));
+    workerResults = malloc(max(count, 1));
+    if (allResults == NULL || workerResults == NULL)
+    {
+        if (allResults != results)
+            free(allResults);
+        free(workerResults);
+        return 0;
+    }
+
+    if (workerCount == 0)
+    {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        workerCount = cpus > 0 ? cpus : 1;
+    }
+    workerCount = min(workerCount, MAX_REPLAY_WORKERS);
+    workerCount = max(min(workerCount, count), 1);
+
+    if (workerCount == 1)
+    {
+        VerifyWorkerFiles(paths, 0, 1, count, allResults);
+    }
+    else
+    {
+        for (i = 0; i < workerCount; i++)
+        {
+            pids[i] = -1;
+            fds[i] = -1;
+            if (pipe(pipeFds) != 0)
+                continue;
+
+            pids[i] = fork();
+            if (pids[i] == 0)
+            {
+                close(pipeFds[0]);
+                n = (count - i + workerCount - 1) / workerCount;
+                VerifyWorkerFiles(paths, i, workerCount, count, workerResults);
+                _exit(WriteAll(pipeFds[1], workerResults, n) ? 0 : 1);
+            }
+
+            close(pipeFds[1]);
+            if (pids[i] < 0)
+                close(pipeFds[0]);
+            else
+                fds[i] = pipeFds[0];
+        }
+
+        for (i = 0; i < workerCount; i++)
+        {
+            n = (count - i + workerCount - 1) / workerCount;
+            if (fds[i] < 0 || !ReadAll(fds[i], workerResults, n))
+                VerifyWorkerFiles(paths, i, workerCount, count, workerResults);
+            for (j = 0; j < n; j++)
+                allResults[i + j * workerCount] = workerResults[j];
+
+            if (fds[i] >= 0)
+                close(fds[i]);
+            if (pids[i] > 0)
+                waitpid(pids[i], NULL, 0);
+        }
+    }
+
+    for (i = 0, matches = 0; i < count; i++)
+    {
+        if (allResults[i] == BATTLE_REPLAY_MATCH)
+            matches++;
+    }
+
+    if (allResults != results)
+        free(allResults);
+    free(workerResults);
+    return matches;
+}
+
+static u64 GetTimeNs(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (u64)now.tv_sec * 1000000000 + now.tv_nsec;
+}
+
+static void SaveAutoReplay(void)
+{
+    char path[4096];
+
+    snprintf(path, sizeof(path), "%s/%08X_%04X.ebrp", sReplayDir, sAutoReplay.rngSeed, sAutoReplay.opponentA);
+    if (!BattleReplay_Save(&sAutoReplay, path))
+        fprintf(stderr, "Failed to save the battle replay %s\n", path);
+}
+
+// Called by CB2_InitBattle. With a replay directory set, every battle that
+// can be replayed is saved there when it ends, named by its RNG seed and
+// first opponent.
+void BattleReplay_RecordBattle(void)
+{
+    if (sReplayDir != NULL && sRecording == NULL && sPlayback == NULL)
+        BattleReplay_StartRecording(&sAutoReplay);
+}
+
+// Called once at startup. EMERALD_REPLAY_DIR names the directory battles are
+// recorded into. EMERALD_VERIFY_REPLAYS, a ':'-separated list of replay
+// files, verifies them instead of starting the game, reports how many
+// battles a second were replayed and exits with 0 if every one matched.
+void BattleReplay_InitFromEnv(void)
+{
+    const char *env;
+    char *list, *path;
+    const char **paths;
+    u8 *results;
+    u32 i, count, matches;
+    u64 startTime, elapsed;
+
+    sReplayDir = getenv("EMERALD_REPLAY_DIR");
+    if (sReplayDir != NULL && sReplayDir[0] == '\0')
+        sReplayDir = NULL;
+
+    env = getenv("EMERALD_VERIFY_REPLAYS");
+    if (env == NULL)
+        return;
+
+    list = malloc(strlen(env) + 1);
+    paths = malloc(sizeof(*paths) * (strlen(env) / 2 + 1));
+    results = malloc(strlen(env) / 2 + 1);
+    if (list == NULL || paths == NULL || results == NULL)
+        exit(1);
+    strcpy(list, env);
+    SetSaveBlocksPointers(0);
+
+    count = 0;
+    for (path = strtok(list, ":"); path != NULL; path = strtok(NULL, ":"))
+        paths[count++] = path;
+
+    startTime = GetTimeNs();
+    matches = BattleReplay_VerifyFiles(paths, count, 0, results);
+    elapsed = max(GetTimeNs() - startTime, 1);
+    for (i = 0; i < count; i++)
+        printf("%s: %s\n", paths[i], sResultNames[results[i]]);
+    printf("%u of %u replays matched in %llu ms, %llu battles/s\n", matches, count,
+           (unsigned long long)(elapsed / 1000000), (unsigned long long)((u64)count * 1000000000 / elapsed));
+    exit(matches == count ? 0 : 1);
+}
+
+#endif // PORTABLE
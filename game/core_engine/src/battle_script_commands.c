@@ -1318,6 +1318,85 @@ void AI_CalcDmg(u8 attacker, u8 defender)
         gBattleMoveDamage = gBattleMoveDamage * 15 / 10;
 }
 
+#ifdef PORTABLE
+// gTypeEffectiveness rearranged into an attacking x defending type matrix,
+// built on first use. Each matchup keeps its position in the table, because
+// the damage is rounded after each multiplier so a dual-type defender's two
+// multipliers have to be applied in table order to give the same result.
+#define TYPE_MATCHUP_NEUTRAL 0xFF
+
+static u8 sTypeMatchupOrder[NUMBER_OF_MON_TYPES][NUMBER_OF_MON_TYPES];
+static u8 sTypeMatchupMultiplier[NUMBER_OF_MON_TYPES][NUMBER_OF_MON_TYPES];
+static u8 sForesightMatchupOrder;
+static bool8 sTypeMatchupsBuilt;
+
+static void BuildTypeMatchups(void)
+{
+    s32 i;
+
+    memset(sTypeMatchupOrder, TYPE_MATCHUP_NEUTRAL, sizeof(sTypeMatchupOrder));
+    sForesightMatchupOrder = TYPE_MATCHUP_NEUTRAL;
+
+    for (i = 0; TYPE_EFFECT_ATK_TYPE(i) != TYPE_ENDTABLE; i += 3)
+    {
+        u8 atkType = TYPE_EFFECT_ATK_TYPE(i);
+        u8 defType = TYPE_EFFECT_DEF_TYPE(i);
+
+        if (atkType == TYPE_FORESIGHT)
+        {
+            sForesightMatchupOrder = i / 3;
+            continue;
+        }
+        if (atkType < NUMBER_OF_MON_TYPES && defType < NUMBER_OF_MON_TYPES
+         && sTypeMatchupOrder[atkType][defType] == TYPE_MATCHUP_NEUTRAL)
+        {
+            sTypeMatchupOrder[atkType][defType] = i / 3;
+            sTypeMatchupMultiplier[atkType][defType] = TYPE_EFFECT_MULTIPLIER(i);
+        }
+    }
+    sTypeMatchupsBuilt = TRUE;
+}
+
+// Fills multipliers with the non-neutral multipliers of moveType against
+// type1/type2, in the order the gTypeEffectiveness walk would apply them,
+// and returns how many there are. Foresight drops the matchups listed after
+// the TYPE_FORESIGHT marker, like the walk does.
+static u8 GetTypeMatchupMultipliers(u8 moveType, u8 type1, u8 type2, bool8 foresight, u8 *multipliers)
+{
+    u8 order1 = TYPE_MATCHUP_NEUTRAL, order2 = TYPE_MATCHUP_NEUTRAL;
+    u8 count = 0;
+
+    if (!sTypeMatchupsBuilt)
+        BuildTypeMatchups();
+
+    if (moveType >= NUMBER_OF_MON_TYPES)
+        return 0;
+    if (type1 < NUMBER_OF_MON_TYPES)
+        order1 = sTypeMatchupOrder[moveType][type1];
+    if (type2 < NUMBER_OF_MON_TYPES && type2 != type1)
+        order2 = sTypeMatchupOrder[moveType][type2];
+    if (foresight)
+    {
+        if (order1 != TYPE_MATCHUP_NEUTRAL && order1 > sForesightMatchupOrder)
+            order1 = TYPE_MATCHUP_NEUTRAL;
+        if (order2 != TYPE_MATCHUP_NEUTRAL && order2 > sForesightMatchupOrder)
+            order2 = TYPE_MATCHUP_NEUTRAL;
+    }
+
+    if (order2 < order1)
+    {
+        multipliers[count++] = sTypeMatchupMultiplier[moveType][type2];
+        order2 = TYPE_MATCHUP_NEUTRAL;
+    }
+    if (order1 != TYPE_MATCHUP_NEUTRAL)
+        multipliers[count++] = sTypeMatchupMultiplier[moveType][type1];
+    if (order2 != TYPE_MATCHUP_NEUTRAL)
+        multipliers[count++] = sTypeMatchupMultiplier[moveType][type2];
+
+    return count;
+}
+#endif // PORTABLE
+
 static void ModulateDmgByType(u8 multiplier)
 {
     gBattleMoveDamage = gBattleMoveDamage * multiplier / 10;
@@ -1383,6 +1462,14 @@ static void Cmd_typecalc(void)
     }
     else
     {
+#ifdef PORTABLE
+        u8 multipliers[2];
+        u8 count = GetTypeMatchupMultipliers(moveType, gBattleMons[gBattlerTarget].types[0], gBattleMons[gBattlerTarget].types[1],
+                                             gBattleMons[gBattlerTarget].status2 & STATUS2_FORESIGHT, multipliers);
+
+        for (i = 0; i < count; i++)
+            ModulateDmgByType(multipliers[i]);
+#else
         while (TYPE_EFFECT_ATK_TYPE(i) != TYPE_ENDTABLE)
         {
             if (TYPE_EFFECT_ATK_TYPE(i) == TYPE_FORESIGHT)
@@ -1404,6 +1491,7 @@ static void Cmd_typecalc(void)
             }
             i += 3;
         }
+#endif
     }
 
     if (gBattleMons[gBattlerTarget].ability == ABILITY_WONDER_GUARD && AttacksThisTurn(gBattlerAttacker, gCurrentMove) == 2
@@ -1557,6 +1645,14 @@ u8 TypeCalc(u16 move, u8 attacker, u8 defender)
     }
     else
     {
+#ifdef PORTABLE
+        u8 multipliers[2];
+        u8 count = GetTypeMatchupMultipliers(moveType, gBattleMons[defender].types[0], gBattleMons[defender].types[1],
+                                             gBattleMons[defender].status2 & STATUS2_FORESIGHT, multipliers);
+
+        for (i = 0; i < count; i++)
+            ModulateDmgByType2(multipliers[i], move, &flags);
+#else
         while (TYPE_EFFECT_ATK_TYPE(i) != TYPE_ENDTABLE)
         {
             if (TYPE_EFFECT_ATK_TYPE(i) == TYPE_FORESIGHT)
@@ -1579,6 +1675,7 @@ u8 TypeCalc(u16 move, u8 attacker, u8 defender)
             }
             i += 3;
         }
+#endif
     }
 
     if (gBattleMons[defender].ability == ABILITY_WONDER_GUARD && !(flags & MOVE_RESULT_MISSED)
@@ -1609,6 +1706,13 @@ u8 AI_TypeCalc(u16 move, u16 targetSpecies, u8 targetAbility)
     }
     else
     {
+#ifdef PORTABLE
+        u8 multipliers[2];
+        u8 count = GetTypeMatchupMultipliers(moveType, type1, type2, FALSE, multipliers);
+
+        for (i = 0; i < count; i++)
+            ModulateDmgByType2(multipliers[i], move, &flags);
+#else
         while (TYPE_EFFECT_ATK_TYPE(i) != TYPE_ENDTABLE)
         {
             if (TYPE_EFFECT_ATK_TYPE(i) == TYPE_FORESIGHT)
@@ -1627,6 +1731,7 @@ u8 AI_TypeCalc(u16 move, u16 targetSpecies, u8 targetAbility)
             }
             i += 3;
         }
+#endif
     }
     if (targetAbility == ABILITY_WONDER_GUARD
      && (!(flags & MOVE_RESULT_SUPER_EFFECTIVE) || ((flags & (MOVE_RESULT_SUPER_EFFECTIVE | MOVE_RESULT_NOT_VERY_EFFECTIVE)) == (MOVE_RESULT_SUPER_EFFECTIVE | MOVE_RESULT_NOT_VERY_EFFECTIVE)))
@@ -3990,12 +4095,21 @@ static void Cmd_endselectionscript(void)
     *(gBattlerAttacker + gBattleStruct->selectionScriptFinished) = TRUE;
 }
 
+#ifdef PORTABLE
+static const u16 sNoAnimationArgument = 0;
+#endif
+
 static void Cmd_playanimation(void)
 {
     const u16 *argumentPtr;
 
     gActiveBattler = GetBattlerForBattleScript(gBattlescriptCurrInstr[1]);
     argumentPtr = T2_READ_PTR(gBattlescriptCurrInstr + 3);
+#ifdef PORTABLE
+    // Most scripts pass NULL, which the GBA reads from the BIOS.
+    if (argumentPtr == NULL)
+        argumentPtr = &sNoAnimationArgument;
+#endif
 
     if (gBattlescriptCurrInstr[2] == B_ANIM_STATS_CHANGE
      || gBattlescriptCurrInstr[2] == B_ANIM_SNATCH_MOVE
@@ -4040,6 +4154,11 @@ static void Cmd_playanimation_var(void)
     gActiveBattler = GetBattlerForBattleScript(gBattlescriptCurrInstr[1]);
     animationIdPtr = T2_READ_PTR(gBattlescriptCurrInstr + 2);
     argumentPtr = T2_READ_PTR(gBattlescriptCurrInstr + 6);
+#ifdef PORTABLE
+    // Most scripts pass NULL, which the GBA reads from the BIOS.
+    if (argumentPtr == NULL)
+        argumentPtr = &sNoAnimationArgument;
+#endif
 
     if (*animationIdPtr == B_ANIM_STATS_CHANGE
      || *animationIdPtr == B_ANIM_SNATCH_MOVE
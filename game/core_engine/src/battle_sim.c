@@ -0,0 +1,288 @@
+#ifdef PORTABLE
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#include "global.h"
+#include "battle.h"
+#include "battle_controllers.h"
+#include "battle_main.h"
+#include "battle_replay.h"
+#include "battle_setup.h"
+#include "battle_sim.h"
+#include "load_save.h"
+#include "pokemon.h"
+
+#ifdef PORTABLE
+
+// The battle engine keeps all of its state in globals, so battles can't share
+// a process. Each worker is a forked copy of this process instead: it starts
+// from the caller's parties and save data, owns its own copy of every battle
+// global and RNG, and sends its partial summary back through a pipe. Every
+// battle, in a worker or not, starts from the state the caller left, so it
+// plays out the same whichever worker runs it and whatever ran before it.
+
+#define MAX_SIM_WORKERS 256
+#define SIM_CHECK_BATTLES 64
+#define SIM_CHECK_WORKERS 4
+#define SIM_CHECK_STEP_LIMIT 1000000
+
+// What BattleSim_Run was called with that a battle can change.
+struct SimStart
+{
+    struct Pokemon playerParty[PARTY_SIZE];
+    struct Pokemon enemyParty[PARTY_SIZE];
+    struct SaveBlock1 saveBlock1;
+    struct SaveBlock2 saveBlock2;
+};
+
+static struct SimStart sStart;
+
+static void SaveStart(void)
+{
+    memcpy(sStart.playerParty, gPlayerParty, sizeof(sStart.playerParty));
+    memcpy(sStart.enemyParty, gEnemyParty, sizeof(sStart.enemyParty));
+    memcpy(&sStart.saveBlock1, gSaveBlock1Ptr, sizeof(sStart.saveBlock1));
+    memcpy(&sStart.saveBlock2, gSaveBlock2Ptr, sizeof(sStart.saveBlock2));
+}
+
+static void LoadStart(void)
+{
+    memcpy(gPlayerParty, sStart.playerParty, sizeof(sStart.playerParty));
+    memcpy(gEnemyParty, sStart.enemyParty, sizeof(sStart.enemyParty));
+    memcpy(gSaveBlock1Ptr, &sStart.saveBlock1, sizeof(sStart.saveBlock1));
+    memcpy(gSaveBlock2Ptr, &sStart.saveBlock2, sizeof(sStart.saveBlock2));
+}
+
+// Spreads consecutive battle indices across the whole seed space.
+static u32 GetBattleSeed(u32 baseSeed, u32 battleId)
+{
+    u32 seed = baseSeed ^ (battleId * 0x9E3779B9);
+
+    seed ^= seed >> 16;
+    seed *= 0x85EBCA6B;
+    seed ^= seed >> 13;
+    return seed;
+}
+
+static void AddBattleToSummary(struct BattleSimSummary *summary, const struct HeadlessBattleResult *result)
+{
+    u32 side, move;
+    u8 outcome = result->outcome & ~B_OUTCOME_LINK_BATTLE_RAN;
+
+    summary->battles++;
+    if (outcome < ARRAY_COUNT(summary->outcomes))
+        summary->outcomes[outcome]++;
+    summary->totalTurns += result->turns;
+    summary->turnCounts[result->turns]++;
+    summary->aiScriptMismatches += result->aiScriptMismatches;
+
+    for (side = 0; side < NUM_BATTLE_SIDES; side++)
+    {
+        for (move = 0; move < MOVES_COUNT; move++)
+            summary->moveUses[side][move] += gHeadlessMoveUses[side][move];
+    }
+}
+
+static void AddSummaries(struct BattleSimSummary *dst, const struct BattleSimSummary *src)
+{
+    u32 i, side;
+
+    dst->battles += src->battles;
+    for (i = 0; i < ARRAY_COUNT(dst->outcomes); i++)
+        dst->outcomes[i] += src->outcomes[i];
+    dst->totalTurns += src->totalTurns;
+    dst->aiScriptMismatches += src->aiScriptMismatches;
+    for (i = 0; i < BATTLE_SIM_MAX_TURNS; i++)
+        dst->turnCounts[i] += src->turnCounts[i];
+    for (side = 0; side < NUM_BATTLE_SIDES; side++)
+    {
+        for (i = 0; i < MOVES_COUNT; i++)
+            dst->moveUses[side][i] += src->moveUses[side][i];
+    }
+}
+
+// Runs battles firstBattle, firstBattle + stride, ... below battleCount.
+static void RunWorkerBattles(const struct HeadlessBattleSpec *spec, u32 firstBattle, u32 stride, u32 battleCount, struct BattleSimSummary *summary)
+{
+    struct HeadlessBattleSpec battleSpec = *spec;
+    struct HeadlessBattleResult result;
+    u32 i;
+
+    for (i = firstBattle; i < battleCount; i += stride)
+    {
+        LoadStart();
+        battleSpec.rngSeed = GetBattleSeed(spec->rngSeed, i);
+        RunHeadlessBattle(&battleSpec, &result);
+        AddBattleToSummary(summary, &result);
+    }
+}
+
+static bool8 WriteAll(int fd, const void *data, size_t size)
+{
+    const u8 *ptr = data;
+
+    while (size != 0)
+    {
+        ssize_t n = write(fd, ptr, size);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return FALSE;
+        ptr += n;
+        size -= n;
+    }
+    return TRUE;
+}
+
+static bool8 ReadAll(int fd, void *data, size_t size)
+{
+    u8 *ptr = data;
+
+    while (size != 0)
+    {
+        ssize_t n = read(fd, ptr, size);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return FALSE;
+        ptr += n;
+        size -= n;
+    }
+    return TRUE;
+}
+
+// Runs battleCount battles of spec across workerCount processes (0 for one
+// per online CPU) and fills summary. Worker slices that fail to start or to
+// report back are rerun in this process, so every battle is always counted.
+// The parties and save data are left as they were.
+void BattleSim_Run(const struct HeadlessBattleSpec *spec, u32 battleCount, u32 workerCount, struct BattleSimSummary *summary)
+{
+    static struct BattleSimSummary sWorkerSummary;
+    pid_t pids[MAX_SIM_WORKERS];
+    int fds[MAX_SIM_WORKERS];
+    int pipeFds[2];
+    u32 i;
+
+    memset(summary, 0, sizeof(*summary));
+    SaveStart();
+
+    if (workerCount == 0)
+    {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        workerCount = cpus > 0 ? cpus : 1;
+    }
+    workerCount = min(workerCount, MAX_SIM_WORKERS);
+    workerCount = min(workerCount, battleCount);
+
+    if (workerCount <= 1)
+    {
+        RunWorkerBattles(spec, 0, 1, battleCount, summary);
+        LoadStart();
+        return;
+    }
+
+    for (i = 0; i < workerCount; i++)
+    {
+        pids[i] = -1;
+        fds[i] = -1;
+        if (pipe(pipeFds) != 0)
+            continue;
+
+        pids[i] = fork();
+        if (pids[i] == 0)
+        {
+            close(pipeFds[0]);
+            memset(&sWorkerSummary, 0, sizeof(sWorkerSummary));
+            RunWorkerBattles(spec, i, workerCount, battleCount, &sWorkerSummary);
+            _exit(WriteAll(pipeFds[1], &sWorkerSummary, sizeof(sWorkerSummary)) ? 0 : 1);
+        }
+
+        close(pipeFds[1]);
+        if (pids[i] < 0)
+            close(pipeFds[0]);
+        else
+            fds[i] = pipeFds[0];
+    }
+
+    for (i = 0; i < workerCount; i++)
+    {
+        memset(&sWorkerSummary, 0, sizeof(sWorkerSummary));
+        if (fds[i] < 0 || !ReadAll(fds[i], &sWorkerSummary, sizeof(sWorkerSummary)))
+        {
+            memset(&sWorkerSummary, 0, sizeof(sWorkerSummary));
+            RunWorkerBattles(spec, i, workerCount, battleCount, &sWorkerSummary);
+        }
+        AddSummaries(summary, &sWorkerSummary);
+
+        if (fds[i] >= 0)
+            close(fds[i]);
+        if (pids[i] > 0)
+            waitpid(pids[i], NULL, 0);
+    }
+    LoadStart();
+}
+
+u32 BattleSim_GetWinRate(const struct BattleSimSummary *summary)
+{
+    if (summary->battles == 0)
+        return 0;
+
+    return (u64)summary->outcomes[B_OUTCOME_WON] * 10000 / summary->battles;
+}
+
+// Runs battleCount battles of spec in this process and across workerCount
+// workers, and returns whether both summaries are the same.
+bool8 BattleSim_CheckWorkers(const struct HeadlessBattleSpec *spec, u32 battleCount, u32 workerCount)
+{
+    static struct BattleSimSummary sSingleSummary, sWorkersSummary;
+
+    BattleSim_Run(spec, battleCount, 1, &sSingleSummary);
+    BattleSim_Run(spec, battleCount, workerCount, &sWorkersSummary);
+    return memcmp(&sSingleSummary, &sWorkersSummary, sizeof(sSingleSummary)) == 0;
+}
+
+// Called once at startup. EMERALD_CHECK_BATTLE_SIM names a replay file whose
+// battle is run from SIM_CHECK_BATTLES seeds, once in this process and once
+// across SIM_CHECK_WORKERS workers, instead of starting the game. The game
+// exits with 0 if both summaries match.
+void BattleSim_InitFromEnv(void)
+{
+    static struct BattleReplay sReplay;
+    struct HeadlessBattleSpec spec = {0};
+    const char *path = getenv("EMERALD_CHECK_BATTLE_SIM");
+    bool8 matched;
+
+    if (path == NULL)
+        return;
+
+    SetSaveBlocksPointers(0);
+    if (!BattleReplay_Load(&sReplay, path) || !sReplay.complete)
+    {
+        fprintf(stderr, "Failed to load the battle replay %s\n", path);
+        exit(1);
+    }
+
+    memcpy(gPlayerParty, sReplay.playerParty, sizeof(gPlayerParty));
+    memcpy(gEnemyParty, sReplay.enemyParty, sizeof(gEnemyParty));
+    gPartnerTrainerId = sReplay.partnerId;
+    gBattleAILookahead = sReplay.lookahead;
+
+    spec.battleTypeFlags = sReplay.battleTypeFlags;
+    spec.opponentA = sReplay.opponentA;
+    spec.opponentB = sReplay.opponentB;
+    spec.terrain = sReplay.terrain;
+    spec.maxSteps = SIM_CHECK_STEP_LIMIT;
+    spec.rngSeed = sReplay.rngSeed;
+
+    matched = BattleSim_CheckWorkers(&spec, SIM_CHECK_BATTLES, SIM_CHECK_WORKERS);
+    printf("%s: %u battles %s across 1 and %u workers\n", path, SIM_CHECK_BATTLES,
+           matched ? "matched" : "differed", SIM_CHECK_WORKERS);
+    exit(matched ? 0 : 1);
+}
+
+#endif // PORTABLE
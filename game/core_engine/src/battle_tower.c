@@ -23,6 +23,7 @@
 #include "field_message_box.h"
 #include "tv.h"
 #include "battle_factory.h"
+#include "frontier_party_gen.h"
 #include "constants/apprentice.h"
 #include "constants/battle_dome.h"
 #include "constants/battle_frontier.h"
@@ -1634,7 +1635,9 @@ static void FillTrainerParty(u16 trainerId, u8 firstMonId, u8 monCount)
 {
     s32 i, j;
     u16 chosenMonIndices[MAX_FRONTIER_PARTY_SIZE];
+#ifndef PORTABLE
     u8 friendship = MAX_FRIENDSHIP;
+#endif
     u8 level = SetFacilityPtrsGetLevel();
     u8 fixedIV = 0;
     u8 bfMonCount;
@@ -1727,6 +1730,9 @@ static void FillTrainerParty(u16 trainerId, u8 firstMonId, u8 monCount)
 
         chosenMonIndices[i] = monId;
 
+#ifdef PORTABLE
+        CreateFacilityMon(&gEnemyParty[i + firstMonId], monId, level, fixedIV, otID, FALSE);
+#else
         // Place the chosen Pokémon into the trainer's party.
         CreateMonWithEVSpreadNatureOTID(&gEnemyParty[i + firstMonId],
                                              gFacilityTrainerMons[monId].species,
@@ -1747,6 +1753,7 @@ static void FillTrainerParty(u16 trainerId, u8 firstMonId, u8 monCount)
 
         SetMonData(&gEnemyParty[i + firstMonId], MON_DATA_FRIENDSHIP, &friendship);
         SetMonData(&gEnemyParty[i + firstMonId], MON_DATA_HELD_ITEM, &gBattleFrontierHeldItems[gFacilityTrainerMons[monId].itemTableId]);
+#endif
 
         // The Pokémon was successfully added to the trainer's party, so it's safe to move on to
         // the next party slot.
@@ -1754,6 +1761,69 @@ static void FillTrainerParty(u16 trainerId, u8 firstMonId, u8 monCount)
     }
 }
 
+#ifdef PORTABLE
+// Picks the trainers and parties of battleCount consecutive battles against
+// the Tower's regular trainers, starting with the first battle of
+// challengeNum, so that a whole streak can be prepared ahead of time.
+// Trainers don't repeat within a challenge, as in SetNextFacilityOpponent,
+// and parties follow the rules of FillTrainerParty, but each mon is drawn in
+// one pass over the trainer's pool, so the RNG isn't used the way the game
+// uses it. Returns how many battles were generated.
+u16 GenerateFrontierStreak(u8 challengeNum, bool8 allowHighTier, u8 monCount, struct FrontierPartySpec *parties, u16 battleCount)
+{
+    const struct BattleFrontierTrainer *savedTrainers = gFacilityTrainers;
+    const struct FacilityMon *savedMons = gFacilityTrainerMons;
+    const struct FrontierMonPool *pool;
+    struct FrontierPartyExclusions exclusions;
+    u16 battle, battleNum, trainerId;
+    s32 i;
+
+    monCount = min(monCount, MAX_FRONTIER_PARTY_SIZE);
+    gFacilityTrainers = gBattleFrontierTrainers;
+    gFacilityTrainerMons = gBattleFrontierMons;
+
+    for (battle = 0; battle < battleCount; battle++)
+    {
+        battleNum = battle % FRONTIER_STAGES_PER_CHALLENGE;
+        do
+        {
+            trainerId = GetRandomScaledFrontierTrainerId(min(challengeNum + battle / FRONTIER_STAGES_PER_CHALLENGE, 0xFF), battleNum);
+            for (i = 0; i < battleNum; i++)
+            {
+                if (parties[battle - battleNum + i].trainerId == trainerId)
+                    break;
+            }
+        } while (i != battleNum);
+
+        parties[battle].trainerId = trainerId;
+        parties[battle].fixedIV = GetFrontierTrainerFixedIvs(trainerId);
+        parties[battle].monCount = monCount;
+        parties[battle].otId = Random32();
+
+        memset(&exclusions, 0, sizeof(exclusions));
+        pool = GetFrontierTrainerMonPool(trainerId, allowHighTier);
+        if (pool == NULL || !SampleFrontierMons(pool, &exclusions, parties[battle].monIds, monCount))
+            break;
+    }
+
+    gFacilityTrainers = savedTrainers;
+    gFacilityTrainerMons = savedMons;
+    return battle;
+}
+
+// Creates the mons of a party from GenerateFrontierStreak.
+void CreateFrontierPartyFromSpec(const struct FrontierPartySpec *spec, struct Pokemon *party, u8 level)
+{
+    const struct FacilityMon *savedMons = gFacilityTrainerMons;
+    u8 i;
+
+    gFacilityTrainerMons = gBattleFrontierMons;
+    for (i = 0; i < spec->monCount; i++)
+        CreateFacilityMon(&party[i], spec->monIds[i], level, spec->fixedIV, spec->otId, FALSE);
+    gFacilityTrainerMons = savedMons;
+}
+#endif // PORTABLE
+
 // Probably an early draft before the 'CreateApprenticeMon' was written.
 static void UNUSED Unused_CreateApprenticeMons(u16 trainerId, u8 firstMonId)
 {
@@ -1823,8 +1893,12 @@ static void FillFactoryTrainerParty(void)
 
 static void FillFactoryFrontierTrainerParty(u16 trainerId, u8 firstMonId)
 {
+#ifdef PORTABLE
+    u8 i;
+#else
     u8 i, j;
     u8 friendship;
+#endif
     u8 level;
     u8 fixedIV;
     u32 otID;
@@ -1867,6 +1941,9 @@ static void FillFactoryFrontierTrainerParty(u16 trainerId, u8 firstMonId)
     for (i = 0; i < FRONTIER_PARTY_SIZE; i++)
     {
         u16 monId = gFrontierTempParty[i];
+#ifdef PORTABLE
+        CreateFacilityMon(&gEnemyParty[firstMonId + i], monId, level, fixedIV, otID, TRUE);
+#else
         CreateMonWithEVSpreadNatureOTID(&gEnemyParty[firstMonId + i],
                                              gFacilityTrainerMons[monId].species,
                                              level,
@@ -1881,6 +1958,7 @@ static void FillFactoryFrontierTrainerParty(u16 trainerId, u8 firstMonId)
 
         SetMonData(&gEnemyParty[firstMonId + i], MON_DATA_FRIENDSHIP, &friendship);
         SetMonData(&gEnemyParty[firstMonId + i], MON_DATA_HELD_ITEM, &gBattleFrontierHeldItems[gFacilityTrainerMons[monId].itemTableId]);
+#endif
     }
 }
 
@@ -8,6 +8,7 @@
 #include "field_camera.h"
 #include "field_effect.h"
 #include "field_weather.h"
+#include "frame_render.h"
 #include "gpu_regs.h"
 #include "main.h"
 #include "malloc.h"
@@ -29,6 +30,18 @@
 
 #define B_TRANS_DMA_FLAGS (1 | ((DMA_SRC_INC | DMA_DEST_FIXED | DMA_REPEAT | DMA_16BIT | DMA_START_HBLANK | DMA_ENABLE) << 16))
 
+#ifdef PORTABLE
+// The renderer also reads the per-line values straight from the buffer.
+#define B_TRANS_HBLANK_DMA(src, dest)                                              \
+    do                                                                             \
+    {                                                                              \
+        DmaSet(0, src, dest, B_TRANS_DMA_FLAGS);                                   \
+        FrameRender_SetLineTable(FRAME_LINE_TABLE_HBLANK_DMA, src, dest, 1, FALSE); \
+    } while (0)
+#else
+#define B_TRANS_HBLANK_DMA(src, dest) DmaSet(0, src, dest, B_TRANS_DMA_FLAGS)
+#endif
+
 // Used by each transition task to determine which of its functions to call
 #define tState          data[0]
 
@@ -73,6 +86,13 @@ struct TransitionData
     s16 counter;
     s16 unused4;
     s16 data[11];
+#ifdef PORTABLE
+    // What the transition's HBlank callback writes each line, for the
+    // renderer to read as line tables.
+    const u16 *hblankLineValues;
+    vu16 *hblankLineRegs[FRAME_LINE_TABLE_COUNT - 1];
+    u16 mugshotsBG0HOFS[DISPLAY_HEIGHT];
+#endif
 };
 
 struct RectangularSpiralLine
@@ -265,6 +285,10 @@ static void VBlankCB_Mugshots(void);
 static void VBlankCB_MugshotsFadeOut(void);
 static void HBlankCB_Mugshots(void);
 static void InitTransitionData(void);
+#ifdef PORTABLE
+static void SetHBlankLineTables(const u16 *, vu16 *, vu16 *, vu16 *);
+static void UpdateMugshotsLineTable(void);
+#endif
 static void FadeScreenBlack(void);
 static void CreateIntroTask(s16, s16, s16, s16, s16);
 static void SetCircularMask(u16 *, s16, s16, s16);
@@ -1200,6 +1224,9 @@ static bool8 Swirl_Init(struct Task *task)
 
     SetVBlankCallback(VBlankCB_Swirl);
     SetHBlankCallback(HBlankCB_Swirl);
+#ifdef PORTABLE
+    SetHBlankLineTables(gScanlineEffectRegBuffers[1], &REG_BG1HOFS, &REG_BG2HOFS, &REG_BG3HOFS);
+#endif
 
     EnableInterrupts(INTR_FLAG_VBLANK | INTR_FLAG_HBLANK);
 
@@ -1265,6 +1292,9 @@ static bool8 Shuffle_Init(struct Task *task)
 
     SetVBlankCallback(VBlankCB_Shuffle);
     SetHBlankCallback(HBlankCB_Shuffle);
+#ifdef PORTABLE
+    SetHBlankLineTables(gScanlineEffectRegBuffers[1], &REG_BG1VOFS, &REG_BG2VOFS, &REG_BG3VOFS);
+#endif
 
     EnableInterrupts(INTR_FLAG_VBLANK | INTR_FLAG_HBLANK);
 
@@ -1738,13 +1768,13 @@ static void VBlankCB_SetWinAndBlend(void)
 static void VBlankCB_PatternWeave(void)
 {
     VBlankCB_SetWinAndBlend();
-    DmaSet(0, gScanlineEffectRegBuffers[1], &REG_BG0HOFS, B_TRANS_DMA_FLAGS);
+    B_TRANS_HBLANK_DMA(gScanlineEffectRegBuffers[1], &REG_BG0HOFS);
 }
 
 static void VBlankCB_CircularMask(void)
 {
     VBlankCB_SetWinAndBlend();
-    DmaSet(0, gScanlineEffectRegBuffers[1], &REG_WIN0H, B_TRANS_DMA_FLAGS);
+    B_TRANS_HBLANK_DMA(gScanlineEffectRegBuffers[1], &REG_WIN0H);
 }
 
 #undef tAmplitude
@@ -1860,6 +1890,7 @@ static void SpriteCB_FldEffPokeballTrail(struct Sprite *sprite)
                 SET_TILE(ptr, posY - 1, posX, 1);
                 SET_TILE(ptr, posY - 0, posX, 1);
                 SET_TILE(ptr, posY + 1, posX, 1);
+                MARK_VRAM_WRITTEN(ptr, BG_SCREEN_SIZE);
             }
         }
         sprite->x += speeds[sprite->sSide];
@@ -2063,7 +2094,7 @@ static void VBlankCB_ClockwiseWipe(void)
     REG_WINOUT = sTransitionData->WINOUT;
     REG_WIN0V = sTransitionData->WIN0V;
     REG_WIN0H = gScanlineEffectRegBuffers[1][0];
-    DmaSet(0, gScanlineEffectRegBuffers[1], &REG_WIN0H, B_TRANS_DMA_FLAGS);
+    B_TRANS_HBLANK_DMA(gScanlineEffectRegBuffers[1], &REG_WIN0H);
 }
 
 //---------------------
@@ -2092,6 +2123,9 @@ static bool8 Ripple_Init(struct Task *task)
 
     SetVBlankCallback(VBlankCB_Ripple);
     SetHBlankCallback(HBlankCB_Ripple);
+#ifdef PORTABLE
+    SetHBlankLineTables(gScanlineEffectRegBuffers[1], &REG_BG1VOFS, &REG_BG2VOFS, &REG_BG3VOFS);
+#endif
 
     EnableInterrupts(INTR_FLAG_HBLANK);
 
@@ -2233,7 +2267,7 @@ static void VBlankCB_Wave(void)
     REG_WININ = sTransitionData->WININ;
     REG_WINOUT = sTransitionData->WINOUT;
     REG_WIN0V = sTransitionData->WIN0V;
-    DmaSet(0, gScanlineEffectRegBuffers[1], &REG_WIN0H, B_TRANS_DMA_FLAGS);
+    B_TRANS_HBLANK_DMA(gScanlineEffectRegBuffers[1], &REG_WIN0H);
 }
 
 #undef tX
@@ -2343,6 +2377,9 @@ static bool8 Mugshot_SetGfx(struct Task *task)
     EnableInterrupts(INTR_FLAG_HBLANK);
 
     SetHBlankCallback(HBlankCB_Mugshots);
+#ifdef PORTABLE
+    SetHBlankLineTables(sTransitionData->mugshotsBG0HOFS, &REG_BG0HOFS, NULL, NULL);
+#endif
     task->tState++;
     return FALSE;
 }
@@ -2551,23 +2588,29 @@ static void VBlankCB_Mugshots(void)
 {
     DmaStop(0);
     VBlankCB_BattleTransition();
+#ifdef PORTABLE
+    UpdateMugshotsLineTable();
+#endif
     if (sTransitionData->VBlank_DMA != 0)
         DmaCopy16(3, gScanlineEffectRegBuffers[0], gScanlineEffectRegBuffers[1], DISPLAY_HEIGHT * 2);
     REG_BG0VOFS = sTransitionData->BG0VOFS;
     REG_WININ = sTransitionData->WININ;
     REG_WINOUT = sTransitionData->WINOUT;
     REG_WIN0V = sTransitionData->WIN0V;
-    DmaSet(0, gScanlineEffectRegBuffers[1], &REG_WIN0H, B_TRANS_DMA_FLAGS);
+    B_TRANS_HBLANK_DMA(gScanlineEffectRegBuffers[1], &REG_WIN0H);
 }
 
 static void VBlankCB_MugshotsFadeOut(void)
 {
     DmaStop(0);
     VBlankCB_BattleTransition();
+#ifdef PORTABLE
+    UpdateMugshotsLineTable();
+#endif
     if (sTransitionData->VBlank_DMA != 0)
         DmaCopy16(3, gScanlineEffectRegBuffers[0], gScanlineEffectRegBuffers[1], DISPLAY_HEIGHT * 2);
     REG_BLDCNT = sTransitionData->BLDCNT;
-    DmaSet(0, gScanlineEffectRegBuffers[1], &REG_BLDY, B_TRANS_DMA_FLAGS);
+    B_TRANS_HBLANK_DMA(gScanlineEffectRegBuffers[1], &REG_BLDY);
 }
 
 static void HBlankCB_Mugshots(void)
@@ -2750,6 +2793,9 @@ static bool8 Slice_Init(struct Task *task)
 
     SetVBlankCallback(VBlankCB_Slice);
     SetHBlankCallback(HBlankCB_Slice);
+#ifdef PORTABLE
+    SetHBlankLineTables(gScanlineEffectRegBuffers[1], &REG_BG1HOFS, &REG_BG2HOFS, &REG_BG3HOFS);
+#endif
 
     task->tState++;
     return TRUE;
@@ -2811,7 +2857,7 @@ static void VBlankCB_Slice(void)
     REG_WIN0V = sTransitionData->WIN0V;
     if (sTransitionData->VBlank_DMA)
         DmaCopy16(3, gScanlineEffectRegBuffers[0], gScanlineEffectRegBuffers[1], DISPLAY_HEIGHT * 4);
-    DmaSet(0, &gScanlineEffectRegBuffers[1][DISPLAY_HEIGHT], &REG_WIN0H, B_TRANS_DMA_FLAGS);
+    B_TRANS_HBLANK_DMA(&gScanlineEffectRegBuffers[1][DISPLAY_HEIGHT], &REG_WIN0H);
 }
 
 static void HBlankCB_Slice(void)
@@ -2874,6 +2920,9 @@ static bool8 ShredSplit_Init(struct Task *task)
 
     SetVBlankCallback(VBlankCB_Slice);
     SetHBlankCallback(HBlankCB_Slice);
+#ifdef PORTABLE
+    SetHBlankLineTables(gScanlineEffectRegBuffers[1], &REG_BG1HOFS, &REG_BG2HOFS, &REG_BG3HOFS);
+#endif
 
     task->tState++;
     return TRUE;
@@ -3565,7 +3614,7 @@ static void VBlankCB_Rayquaza(void)
     else
         dmaSrc = gScanlineEffectRegBuffers[0];
 
-    DmaSet(0, dmaSrc, &REG_BG0VOFS, B_TRANS_DMA_FLAGS);
+    B_TRANS_HBLANK_DMA(dmaSrc, &REG_BG0VOFS);
 }
 
 #undef tTimer
@@ -3610,6 +3659,9 @@ static bool8 WhiteBarsFade_Init(struct Task *task)
 
     EnableInterrupts(INTR_FLAG_HBLANK);
     SetHBlankCallback(HBlankCB_WhiteBarsFade);
+#ifdef PORTABLE
+    SetHBlankLineTables(gScanlineEffectRegBuffers[1], &REG_BLDY, NULL, NULL);
+#endif
     SetVBlankCallback(VBlankCB_WhiteBarsFade);
 
     task->tState++;
@@ -3657,6 +3709,9 @@ static bool8 WhiteBarsFade_BlendToBlack(struct Task *task)
     DmaStop(0);
     SetVBlankCallback(0);
     SetHBlankCallback(0);
+#ifdef PORTABLE
+    SetHBlankLineTables(NULL, NULL, NULL, NULL);
+#endif
 
     sTransitionData->WIN0H = DISPLAY_WIDTH;
     sTransitionData->BLDY = 0;
@@ -3689,7 +3744,7 @@ static void VBlankCB_WhiteBarsFade(void)
     REG_WIN0V = sTransitionData->WIN0V;
     if (sTransitionData->VBlank_DMA)
         DmaCopy16(3, gScanlineEffectRegBuffers[0], gScanlineEffectRegBuffers[1], DISPLAY_HEIGHT * 4);
-    DmaSet(0, &gScanlineEffectRegBuffers[1][DISPLAY_HEIGHT], &REG_WIN0H, B_TRANS_DMA_FLAGS);
+    B_TRANS_HBLANK_DMA(&gScanlineEffectRegBuffers[1][DISPLAY_HEIGHT], &REG_WIN0H);
 }
 
 static void VBlankCB_WhiteBarsFade_Blend(void)
@@ -3946,7 +4001,7 @@ static void VBlankCB_AngledWipes(void)
     REG_WINOUT = sTransitionData->WINOUT;
     REG_WIN0V = sTransitionData->WIN0V;
     REG_WIN0H = gScanlineEffectRegBuffers[1][0];
-    DmaSet(0, gScanlineEffectRegBuffers[1], &REG_WIN0H, B_TRANS_DMA_FLAGS);
+    B_TRANS_HBLANK_DMA(gScanlineEffectRegBuffers[1], &REG_WIN0H);
 }
 
 #undef tWipeId
@@ -4055,16 +4110,55 @@ static void InitTransitionData(void)
 
 static void VBlankCB_BattleTransition(void)
 {
+#ifdef PORTABLE
+    u8 i;
+#endif
+
     LoadOam();
     ProcessSpriteCopyRequests();
     TransferPlttBuffer();
+#ifdef PORTABLE
+    if (sTransitionData->hblankLineValues != NULL)
+    {
+        for (i = 0; i < ARRAY_COUNT(sTransitionData->hblankLineRegs); i++)
+        {
+            if (sTransitionData->hblankLineRegs[i] != NULL)
+                FrameRender_SetLineTable(i + 1, sTransitionData->hblankLineValues, sTransitionData->hblankLineRegs[i], 1, FALSE);
+        }
+    }
+#endif
+}
+
+#ifdef PORTABLE
+// Publishes what an HBlank callback that copies one value per line into up
+// to three registers writes. Like the callback, which runs after each line
+// is drawn, values[n] applies from line n + 1.
+static void SetHBlankLineTables(const u16 *values, vu16 *reg1, vu16 *reg2, vu16 *reg3)
+{
+    sTransitionData->hblankLineValues = values;
+    sTransitionData->hblankLineRegs[0] = reg1;
+    sTransitionData->hblankLineRegs[1] = reg2;
+    sTransitionData->hblankLineRegs[2] = reg3;
 }
 
+// The table HBlankCB_Mugshots produces this frame.
+static void UpdateMugshotsLineTable(void)
+{
+    u8 i;
+
+    for (i = 0; i < DISPLAY_HEIGHT; i++)
+        sTransitionData->mugshotsBG0HOFS[i] = i < DISPLAY_HEIGHT / 2 ? sTransitionData->BG0HOFS_Lower : sTransitionData->BG0HOFS_Upper;
+}
+#endif
+
+// The transitions write straight through these pointers, so they are marked
+// as written when they are handed out.
 static void GetBg0TilemapDst(u16 **tileset)
 {
     u16 charBase = REG_BG0CNT >> 2;
     charBase <<= 14;
     *tileset = (u16 *)(BG_VRAM + charBase);
+    MARK_VRAM_WRITTEN(*tileset, BG_CHAR_SIZE);
 }
 
 void GetBg0TilesDst(u16 **tilemap, u16 **tileset)
@@ -4077,6 +4171,8 @@ void GetBg0TilesDst(u16 **tilemap, u16 **tileset)
 
     *tilemap = (u16 *)(BG_VRAM + screenBase);
     *tileset = (u16 *)(BG_VRAM + charBase);
+    MARK_VRAM_WRITTEN(*tilemap, BG_SCREEN_SIZE);
+    MARK_VRAM_WRITTEN(*tileset, BG_CHAR_SIZE);
 }
 
 static void FadeScreenBlack(void)
@@ -4334,6 +4430,9 @@ static bool8 FrontierLogoWave_InitScanline(struct Task *task)
 
     SetVBlankCallback(VBlankCB_FrontierLogoWave);
     SetHBlankCallback(HBlankCB_FrontierLogoWave);
+#ifdef PORTABLE
+    SetHBlankLineTables(gScanlineEffectRegBuffers[1], &REG_BG0VOFS, NULL, NULL);
+#endif
     EnableInterrupts(INTR_FLAG_HBLANK);
 
     task->tState++;
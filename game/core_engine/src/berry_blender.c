@@ -3342,6 +3342,7 @@ static void UpdateProgressBar(u16 value, u16 limit)
         vram[11 + i] = PROGRESS_BAR_EMPTY_TOP;
         vram[43 + i] = PROGRESS_BAR_EMPTY_BOTTOM;
     }
+    MARK_VRAM_WRITTEN(&vram[11], (43 + 8 - 11) * sizeof(u16));
 }
 
 static u32 ArrowSpeedToRPM(u16 speed)
@@ -3370,6 +3371,7 @@ static void UpdateRPM(u16 speed)
     *((u16 *)(BG_SCREEN_ADDR(12) + 0x45C)) = digits[2] + RPM_DIGIT;
     *((u16 *)(BG_SCREEN_ADDR(12) + 0x460)) = digits[1] + RPM_DIGIT;
     *((u16 *)(BG_SCREEN_ADDR(12) + 0x462)) = digits[0] + RPM_DIGIT;
+    MARK_VRAM_WRITTEN(BG_SCREEN_ADDR(12) + 0x458, 0x462 + sizeof(u16) - 0x458);
 }
 
 // Passed a pointer to the bg x/y
@@ -154,6 +154,8 @@ static bool8 SetupClearSaveDataScreen(void)
 
         for (i = 0; i < 0x400; i++)
             ((u16 *)(BG_SCREEN_ADDR(30)))[i] = 0x0001;
+        MARK_VRAM_WRITTEN(VRAM + 0x20, 0x10 * sizeof(u16));
+        MARK_VRAM_WRITTEN(BG_SCREEN_ADDR(30), 0x400 * sizeof(u16));
         ResetTasks();
         ResetSpriteData();
         ResetBgsAndClearDma3BusyFlags(0);
@@ -465,6 +465,7 @@ static void LoadContestPaintingFrame(u8 contestWinnerId, bool8 isForArtist)
         // Re-set the entire top row to the first top frame part
         for (x = 0; x < 16; x++)
             VRAM_PICTURE_DATA(x + 7, 2) = (*gContestMonPixels)[2][7];
+        MARK_VRAM_WRITTEN(&VRAM_PICTURE_DATA(0, 0), 20 * 32 * sizeof(u16));
     }
     else if (contestWinnerId < MUSEUM_CONTEST_WINNERS_START)
     {
@@ -586,6 +587,7 @@ static void DoContestPaintingImageProcessing(u8 imageEffect)
     ApplyImageProcessingEffects(&gImageProcessingContext);
     ApplyImageProcessingQuantization(&gImageProcessingContext);
     ConvertImageProcessingToGBA(&gImageProcessingContext);
+    MARK_VRAM_WRITTEN(OBJ_VRAM0, gImageProcessingContext.canvasWidth * gImageProcessingContext.canvasHeight);
     LoadPalette(gContestPaintingMonPalette, OBJ_PLTT_ID(0), 16 * PLTT_SIZE_4BPP);
 }
 
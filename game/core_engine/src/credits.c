@@ -1297,6 +1297,7 @@ static void LoadTheEndScreen(u16 tileOffsetLoad, u16 tileOffsetWrite, u16 palOff
 
     for (i = 0; i < 32 * 32; i++)
         ((u16 *) (VRAM + tileOffsetWrite))[i] = baseTile + 1;
+    MARK_VRAM_WRITTEN(VRAM + tileOffsetWrite, 32 * 32 * sizeof(u16));
 }
 
 static u16 GetLetterMapTile(u8 baseTiles)
@@ -1324,6 +1325,7 @@ static void DrawLetterMapTiles(const u8 baseTiles[], u8 baseX, u8 baseY, u16 off
         for (x = 0; x < 3; x++)
             ((u16 *) (VRAM + offset + (baseY + y) * 64))[baseX + x] = tileOffset + GetLetterMapTile(baseTiles[y * 3 + x]);
     }
+    MARK_VRAM_WRITTEN(VRAM + offset + baseY * 64, 5 * 64);
 }
 
 static void DrawTheEnd(u16 offset, u16 palette)
@@ -1333,6 +1335,7 @@ static void DrawTheEnd(u16 offset, u16 palette)
 
     for (pos = 0; pos < 32 * 32; pos++)
         ((u16 *) (VRAM + offset))[pos] = baseTile + 1;
+    MARK_VRAM_WRITTEN(VRAM + offset, 32 * 32 * sizeof(u16));
 
     DrawLetterMapTiles(sTheEnd_LetterMap_T, 3, 7, offset, palette);
     DrawLetterMapTiles(sTheEnd_LetterMap_H, 7, 7, offset, palette);
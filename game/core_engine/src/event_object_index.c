@@ -0,0 +1,226 @@
+#include "global.h"
+#include "event_object_index.h"
+
+#ifdef PORTABLE
+
+// Both indexes are chained hash tables whose chains are threaded through
+// per-object "next" links, so no allocation is ever needed. Each object event
+// is linked into up to two coord chains (current and previous coords, which
+// DoesObjectCollideWithObjectAt checks both of) and one (localId, map) chain.
+
+#define COORD_BUCKET_COUNT 1024
+#define LOCAL_ID_BUCKET_COUNT 256
+
+#define COORDS_CURRENT  0
+#define COORDS_PREVIOUS 1
+
+// A coord chain node refers to one of an object event's two coords.
+#define COORD_NODE(objectEventId, which) ((objectEventId) * 2 + (which))
+#define COORD_NODE_ID(node) ((node) / 2)
+#define COORD_NODE_NONE 0xFFFF
+
+#define OBJECT_EVENT_ID_NONE 0xFF
+
+struct IndexedObjectEvent
+{
+    bool8 indexed;
+    u8 mapNum;
+    u8 mapGroup;
+    struct Coords16 coords[2];
+    u16 nextCoordNode[2];
+    u16 localId;
+    u8 nextLocalId;
+};
+
+static u16 sCoordBuckets[COORD_BUCKET_COUNT];
+static u8 sLocalIdBuckets[LOCAL_ID_BUCKET_COUNT];
+static struct IndexedObjectEvent sIndexedObjectEvents[OBJECT_EVENTS_COUNT];
+
+STATIC_ASSERT(OBJECT_EVENTS_COUNT < OBJECT_EVENT_ID_NONE, ObjectEventIndexIdsFitInU8);
+
+static u32 HashCoords(s16 x, s16 y)
+{
+    return ((u16)x * 0x9E37 + (u16)y * 0x79B9) & (COORD_BUCKET_COUNT - 1);
+}
+
+static u32 HashLocalIdAndMap(u16 localId, u8 mapNum, u8 mapGroup)
+{
+    return (localId * 0x1F + mapNum * 0x07 + mapGroup) & (LOCAL_ID_BUCKET_COUNT - 1);
+}
+
+static void LinkCoordNode(u16 node, s16 x, s16 y)
+{
+    u16 *head = &sCoordBuckets[HashCoords(x, y)];
+
+    sIndexedObjectEvents[COORD_NODE_ID(node)].nextCoordNode[node % 2] = *head;
+    *head = node;
+}
+
+static void UnlinkCoordNode(u16 node, s16 x, s16 y)
+{
+    u16 *link = &sCoordBuckets[HashCoords(x, y)];
+
+    while (*link != COORD_NODE_NONE)
+    {
+        if (*link == node)
+        {
+            *link = sIndexedObjectEvents[COORD_NODE_ID(node)].nextCoordNode[node % 2];
+            return;
+        }
+        link = &sIndexedObjectEvents[COORD_NODE_ID(*link)].nextCoordNode[*link % 2];
+    }
+}
+
+static void LinkLocalId(u8 objectEventId)
+{
+    struct IndexedObjectEvent *entry = &sIndexedObjectEvents[objectEventId];
+    u8 *head = &sLocalIdBuckets[HashLocalIdAndMap(entry->localId, entry->mapNum, entry->mapGroup)];
+
+    entry->nextLocalId = *head;
+    *head = objectEventId;
+}
+
+static void UnlinkLocalId(u8 objectEventId)
+{
+    struct IndexedObjectEvent *entry = &sIndexedObjectEvents[objectEventId];
+    u8 *link = &sLocalIdBuckets[HashLocalIdAndMap(entry->localId, entry->mapNum, entry->mapGroup)];
+
+    while (*link != OBJECT_EVENT_ID_NONE)
+    {
+        if (*link == objectEventId)
+        {
+            *link = entry->nextLocalId;
+            return;
+        }
+        link = &sIndexedObjectEvents[*link].nextLocalId;
+    }
+}
+
+static void RemoveFromIndex(u8 objectEventId)
+{
+    struct IndexedObjectEvent *entry = &sIndexedObjectEvents[objectEventId];
+
+    if (!entry->indexed)
+        return;
+
+    UnlinkCoordNode(COORD_NODE(objectEventId, COORDS_CURRENT), entry->coords[COORDS_CURRENT].x, entry->coords[COORDS_CURRENT].y);
+    UnlinkCoordNode(COORD_NODE(objectEventId, COORDS_PREVIOUS), entry->coords[COORDS_PREVIOUS].x, entry->coords[COORDS_PREVIOUS].y);
+    UnlinkLocalId(objectEventId);
+    entry->indexed = FALSE;
+}
+
+static void AddToIndex(u8 objectEventId)
+{
+    struct IndexedObjectEvent *entry = &sIndexedObjectEvents[objectEventId];
+    struct ObjectEvent *objectEvent = &gObjectEvents[objectEventId];
+
+    entry->indexed = TRUE;
+    entry->localId = objectEvent->localId;
+    entry->mapNum = objectEvent->mapNum;
+    entry->mapGroup = objectEvent->mapGroup;
+    entry->coords[COORDS_CURRENT] = objectEvent->currentCoords;
+    entry->coords[COORDS_PREVIOUS] = objectEvent->previousCoords;
+    LinkCoordNode(COORD_NODE(objectEventId, COORDS_CURRENT), objectEvent->currentCoords.x, objectEvent->currentCoords.y);
+    LinkCoordNode(COORD_NODE(objectEventId, COORDS_PREVIOUS), objectEvent->previousCoords.x, objectEvent->previousCoords.y);
+    LinkLocalId(objectEventId);
+}
+
+static bool8 IsIndexStale(u8 objectEventId)
+{
+    struct IndexedObjectEvent *entry = &sIndexedObjectEvents[objectEventId];
+    struct ObjectEvent *objectEvent = &gObjectEvents[objectEventId];
+
+    if (entry->indexed != objectEvent->active)
+        return TRUE;
+    if (!entry->indexed)
+        return FALSE;
+
+    return entry->coords[COORDS_CURRENT].x != objectEvent->currentCoords.x
+        || entry->coords[COORDS_CURRENT].y != objectEvent->currentCoords.y
+        || entry->coords[COORDS_PREVIOUS].x != objectEvent->previousCoords.x
+        || entry->coords[COORDS_PREVIOUS].y != objectEvent->previousCoords.y
+        || entry->localId != objectEvent->localId
+        || entry->mapNum != objectEvent->mapNum
+        || entry->mapGroup != objectEvent->mapGroup;
+}
+
+void ObjectEventIndex_Reset(void)
+{
+    u32 i;
+
+    for (i = 0; i < COORD_BUCKET_COUNT; i++)
+        sCoordBuckets[i] = COORD_NODE_NONE;
+    for (i = 0; i < LOCAL_ID_BUCKET_COUNT; i++)
+        sLocalIdBuckets[i] = OBJECT_EVENT_ID_NONE;
+    for (i = 0; i < OBJECT_EVENTS_COUNT; i++)
+    {
+        sIndexedObjectEvents[i].indexed = FALSE;
+        if (gObjectEvents[i].active)
+            AddToIndex(i);
+    }
+}
+
+void ObjectEventIndex_Update(u8 objectEventId)
+{
+    if (!IsIndexStale(objectEventId))
+        return;
+
+    RemoveFromIndex(objectEventId);
+    if (gObjectEvents[objectEventId].active)
+        AddToIndex(objectEventId);
+}
+
+void ObjectEventIndex_Sync(void)
+{
+    u32 i;
+
+    for (i = 0; i < OBJECT_EVENTS_COUNT; i++)
+        ObjectEventIndex_Update(i);
+}
+
+// Fills objectEventIds (which must hold OBJECT_EVENTS_COUNT ids) with the active
+// object events at (x, y), lowest id first to match a linear scan of gObjectEvents.
+u8 ObjectEventIndex_GetIdsAtCoords(s16 x, s16 y, bool8 includePrevious, u8 *objectEventIds)
+{
+    u16 node;
+    u8 objectEventId;
+    u8 count = 0;
+    s32 i;
+
+    for (node = sCoordBuckets[HashCoords(x, y)]; node != COORD_NODE_NONE; node = sIndexedObjectEvents[COORD_NODE_ID(node)].nextCoordNode[node % 2])
+    {
+        objectEventId = COORD_NODE_ID(node);
+        if (node % 2 == COORDS_PREVIOUS && !includePrevious)
+            continue;
+        if (sIndexedObjectEvents[objectEventId].coords[node % 2].x != x
+         || sIndexedObjectEvents[objectEventId].coords[node % 2].y != y)
+            continue;
+
+        // Insert in id order, skipping objects already found by their other coords.
+        for (i = count - 1; i >= 0 && objectEventIds[i] > objectEventId; i--)
+            ;
+        if (i >= 0 && objectEventIds[i] == objectEventId)
+            continue;
+        memmove(&objectEventIds[i + 2], &objectEventIds[i + 1], count - (i + 1));
+        objectEventIds[i + 1] = objectEventId;
+        count++;
+    }
+    return count;
+}
+
+u8 ObjectEventIndex_GetIdByLocalIdAndMap(u16 localId, u8 mapNum, u8 mapGroup)
+{
+    u8 objectEventId;
+    u8 found = OBJECT_EVENTS_COUNT;
+    struct IndexedObjectEvent *entry;
+
+    for (objectEventId = sLocalIdBuckets[HashLocalIdAndMap(localId, mapNum, mapGroup)]; objectEventId != OBJECT_EVENT_ID_NONE; objectEventId = entry->nextLocalId)
+    {
+        entry = &sIndexedObjectEvents[objectEventId];
+        if (entry->localId == localId && entry->mapNum == mapNum && entry->mapGroup == mapGroup && objectEventId < found)
+            found = objectEventId;
+    }
+    return found;
+}
+
+#endif // PORTABLE
@@ -4,6 +4,7 @@
 #include "berry.h"
 #include "decoration.h"
 #include "event_data.h"
+#include "event_object_index.h"
 #include "event_object_movement.h"
 #include "event_scripts.h"
 #include "faraway_island.h"
@@ -1168,6 +1169,14 @@ static const u8 sPlayerDirectionToCopyDirection[][4] = {
 
 #include "data/object_events/movement_action_func_tables.h"
 
+#ifdef PORTABLE
+static void UpdateObjectEventIndex(struct ObjectEvent *objectEvent)
+{
+    if (objectEvent >= gObjectEvents && objectEvent < &gObjectEvents[OBJECT_EVENTS_COUNT])
+        ObjectEventIndex_Update(objectEvent - gObjectEvents);
+}
+#endif
+
 static void ClearObjectEvent(struct ObjectEvent *objectEvent)
 {
     *objectEvent = (struct ObjectEvent){};
@@ -1175,6 +1184,9 @@ static void ClearObjectEvent(struct ObjectEvent *objectEvent)
     objectEvent->mapNum = MAP_NUM(UNDEFINED);
     objectEvent->mapGroup = MAP_GROUP(UNDEFINED);
     objectEvent->movementActionId = MOVEMENT_ACTION_NONE;
+#ifdef PORTABLE
+    UpdateObjectEventIndex(objectEvent);
+#endif
 }
 
 static void ClearAllObjectEvents(void)
@@ -1183,6 +1195,9 @@ static void ClearAllObjectEvents(void)
 
     for (i = 0; i < OBJECT_EVENTS_COUNT; i++)
         ClearObjectEvent(&gObjectEvents[i]);
+#ifdef PORTABLE
+    ObjectEventIndex_Reset();
+#endif
 }
 
 void ResetObjectEvents(void)
@@ -1239,6 +1254,13 @@ bool8 TryGetObjectEventIdByLocalIdAndMap(u8 localId, u8 mapNum, u8 mapGroupId, u
 
 u8 GetObjectEventIdByXY(s16 x, s16 y)
 {
+#ifdef PORTABLE
+    u8 objectEventIds[OBJECT_EVENTS_COUNT];
+
+    if (ObjectEventIndex_GetIdsAtCoords(x, y, FALSE, objectEventIds) != 0)
+        return objectEventIds[0];
+    return OBJECT_EVENTS_COUNT;
+#else
     u8 i;
     for (i = 0; i < OBJECT_EVENTS_COUNT; i++)
     {
@@ -1247,10 +1269,14 @@ u8 GetObjectEventIdByXY(s16 x, s16 y)
     }
 
     return i;
+#endif
 }
 
 static u8 GetObjectEventIdByLocalIdAndMapInternal(u8 localId, u8 mapNum, u8 mapGroupId)
 {
+#ifdef PORTABLE
+    return ObjectEventIndex_GetIdByLocalIdAndMap(localId, mapNum, mapGroupId);
+#else
     u8 i;
     for (i = 0; i < OBJECT_EVENTS_COUNT; i++)
     {
@@ -1259,6 +1285,7 @@ static u8 GetObjectEventIdByLocalIdAndMapInternal(u8 localId, u8 mapNum, u8 mapG
     }
 
     return OBJECT_EVENTS_COUNT;
+#endif
 }
 
 static u8 GetObjectEventIdByLocalId(u8 localId)
@@ -1316,6 +1343,9 @@ static u8 InitObjectEventStateFromTemplate(const struct ObjectEventTemplate *tem
         if (objectEvent->rangeY == 0)
             objectEvent->rangeY++;
     }
+#ifdef PORTABLE
+    ObjectEventIndex_Update(objectEventId);
+#endif
     return objectEventId;
 }
 
@@ -1351,6 +1381,12 @@ static bool8 GetAvailableObjectEventId(u16 localId, u8 mapNum, u8 mapGroup, u8 *
 // If no slots are available, or if the object is already
 // loaded, returns TRUE.
 {
+#ifdef PORTABLE
+    if (ObjectEventIndex_GetIdByLocalIdAndMap(localId, mapNum, mapGroup) != OBJECT_EVENTS_COUNT)
+        return TRUE;
+    *objectEventId = GetFirstInactiveObjectEventId();
+    return *objectEventId == OBJECT_EVENTS_COUNT;
+#else
     u8 i = 0;
 
     for (i = 0; i < OBJECT_EVENTS_COUNT && gObjectEvents[i].active; i++)
@@ -1367,11 +1403,15 @@ static bool8 GetAvailableObjectEventId(u16 localId, u8 mapNum, u8 mapGroup, u8 *
             return TRUE;
     }
     return FALSE;
+#endif
 }
 
 static void RemoveObjectEvent(struct ObjectEvent *objectEvent)
 {
     objectEvent->active = FALSE;
+#ifdef PORTABLE
+    UpdateObjectEventIndex(objectEvent);
+#endif
     RemoveObjectEventInternal(objectEvent);
 }
 
@@ -1442,6 +1482,9 @@ static u8 TrySetupObjectEventSprite(const struct ObjectEventTemplate *objectEven
     if (spriteId == MAX_SPRITES)
     {
         gObjectEvents[objectEventId].active = FALSE;
+#ifdef PORTABLE
+        ObjectEventIndex_Update(objectEventId);
+#endif
         return OBJECT_EVENTS_COUNT;
     }
 
@@ -2101,6 +2144,9 @@ static void UNUSED IncrementObjectEventCoords(struct ObjectEvent *objectEvent, s
     objectEvent->previousCoords.y = objectEvent->currentCoords.y;
     objectEvent->currentCoords.x += x;
     objectEvent->currentCoords.y += y;
+#ifdef PORTABLE
+    UpdateObjectEventIndex(objectEvent);
+#endif
 }
 
 void ShiftObjectEventCoords(struct ObjectEvent *objectEvent, s16 x, s16 y)
@@ -2109,6 +2155,9 @@ void ShiftObjectEventCoords(struct ObjectEvent *objectEvent, s16 x, s16 y)
     objectEvent->previousCoords.y = objectEvent->currentCoords.y;
     objectEvent->currentCoords.x = x;
     objectEvent->currentCoords.y = y;
+#ifdef PORTABLE
+    UpdateObjectEventIndex(objectEvent);
+#endif
 }
 
 static void SetObjectEventCoords(struct ObjectEvent *objectEvent, s16 x, s16 y)
@@ -2117,6 +2166,9 @@ static void SetObjectEventCoords(struct ObjectEvent *objectEvent, s16 x, s16 y)
     objectEvent->previousCoords.y = y;
     objectEvent->currentCoords.x = x;
     objectEvent->currentCoords.y = y;
+#ifdef PORTABLE
+    UpdateObjectEventIndex(objectEvent);
+#endif
 }
 
 void MoveObjectEventToMapCoords(struct ObjectEvent *objectEvent, s16 x, s16 y)
@@ -2175,13 +2227,26 @@ void UpdateObjectEventCoordsForCameraUpdate(void)
                 gObjectEvents[i].previousCoords.y -= dy;
             }
         }
+#ifdef PORTABLE
+        ObjectEventIndex_Sync();
+#endif
     }
 }
 
 u8 GetObjectEventIdByPosition(u16 x, u16 y, u8 elevation)
 {
     u8 i;
+#ifdef PORTABLE
+    u8 objectEventIds[OBJECT_EVENTS_COUNT];
+    u8 count = ObjectEventIndex_GetIdsAtCoords(x, y, FALSE, objectEventIds);
 
+    for (i = 0; i < count; i++)
+    {
+        if (ObjectEventDoesElevationMatch(&gObjectEvents[objectEventIds[i]], elevation))
+            return objectEventIds[i];
+    }
+    return OBJECT_EVENTS_COUNT;
+#else
     for (i = 0; i < OBJECT_EVENTS_COUNT; i++)
     {
         if (gObjectEvents[i].active)
@@ -2193,6 +2258,7 @@ u8 GetObjectEventIdByPosition(u16 x, u16 y, u8 elevation)
         }
     }
     return OBJECT_EVENTS_COUNT;
+#endif
 }
 
 static bool8 ObjectEventDoesElevationMatch(struct ObjectEvent *objectEvent, u8 elevation)
@@ -4714,7 +4780,18 @@ static bool8 DoesObjectCollideWithObjectAt(struct ObjectEvent *objectEvent, s16
 {
     u8 i;
     struct ObjectEvent *curObject;
+#ifdef PORTABLE
+    u8 objectEventIds[OBJECT_EVENTS_COUNT];
+    u8 count = ObjectEventIndex_GetIdsAtCoords(x, y, TRUE, objectEventIds);
 
+    for (i = 0; i < count; i++)
+    {
+        curObject = &gObjectEvents[objectEventIds[i]];
+        if (curObject != objectEvent && AreElevationsCompatible(objectEvent->currentElevation, curObject->currentElevation))
+            return TRUE;
+    }
+    return FALSE;
+#else
     for (i = 0; i < OBJECT_EVENTS_COUNT; i++)
     {
         curObject = &gObjectEvents[i];
@@ -4728,6 +4805,7 @@ static bool8 DoesObjectCollideWithObjectAt(struct ObjectEvent *objectEvent, s16
         }
     }
     return FALSE;
+#endif
 }
 
 bool8 IsBerryTreeSparkling(u8 localId, u8 mapNum, u8 mapGroup)
@@ -1,10 +1,15 @@
+#ifdef PORTABLE
+#include <stdlib.h>
+#endif
 #include "global.h"
 #include "berry.h"
 #include "bike.h"
+#include "bg.h"
 #include "field_camera.h"
 #include "field_player_avatar.h"
 #include "fieldmap.h"
 #include "event_object_movement.h"
+#include "frame_render.h"
 #include "gpu_regs.h"
 #include "menu.h"
 #include "overworld.h"
@@ -32,6 +37,14 @@ static void DrawWholeMapViewInternal(int, int, const struct MapLayout *);
 static void DrawMetatileAt(const struct MapLayout *, u16, int, int);
 static void DrawMetatile(s32, const u16 *, u16);
 static void CameraPanningCB_PanAhead(void);
+#ifdef PORTABLE
+static const u16 *GetMetatileTilesAt(const struct MapLayout *, int, int);
+static void DrawMetatileToBuffers(s32, const u16 *, u16 *, u16 *, u16 *, u32, u32);
+static void FieldMapView_Build(void);
+static void FieldMapView_FlushDirty(void);
+static void FieldMapView_DrawMetatile(s32, const u16 *, int, int);
+static void FieldMapView_Publish(void);
+#endif
 
 static struct FieldCameraOffset sFieldCameraOffset;
 static s16 sHorizontalCameraPan;
@@ -43,6 +56,41 @@ COMMON_DATA struct CameraObject gFieldCamera = {0};
 COMMON_DATA u16 gTotalCameraPixelOffsetY = 0;
 COMMON_DATA u16 gTotalCameraPixelOffsetX = 0;
 
+#ifdef PORTABLE
+// While the frame renderer runs, BG1-3 of the field are drawn from a view of
+// the whole of gBackupMapLayout, drawn once into tilemaps of its own, rather
+// than from the 32x32 BG tilemap ring buffer. Stepping through the map then
+// only redraws the metatiles that changed, and the ring buffer's slices are
+// skipped. The ring buffer is brought up to date again whenever another
+// screen takes over the VBlank callback, since that screen draws from VRAM.
+struct FieldMapView
+{
+    u16 *tilemaps[3]; // BG1, BG2, BG3
+    u32 width;        // in tiles
+    u32 height;       // in tiles
+    const struct MapLayout *layout;
+    u16 mapWidth;  // gBackupMapLayout dimensions the view was built for
+    u16 mapHeight;
+};
+
+// Metatiles beyond the edges of gBackupMapLayout that are also drawn into the
+// map view, as the ring buffer shows border metatiles there.
+#define FIELD_MAP_VIEW_MARGIN 8
+
+// Metatiles changed with MapGridSetMetatileIdAt are queued here and redrawn
+// the next time the map view would have been redrawn on hardware. If more than
+// this many change at once, the whole view is rebuilt instead.
+#define FIELD_MAP_VIEW_MAX_DIRTY 256
+
+static struct FieldMapView sFieldMapView;
+static bool8 sFieldMapViewEnabled;
+static u16 sFieldMapViewDirty[FIELD_MAP_VIEW_MAX_DIRTY][2];
+static u16 sFieldMapViewDirtyCount;
+static bool8 sFieldMapViewNeedsRebuild;
+static bool8 sFieldMapViewShown;  // published to the renderer since the last sync
+static bool8 sBgTilemapsOutdated; // ring buffer redraws were skipped
+#endif
+
 static void ResetCameraOffset(struct FieldCameraOffset *cameraOffset)
 {
     cameraOffset->xTileOffset = 0;
@@ -83,6 +131,9 @@ void FieldUpdateBgTilemapScroll(void)
     SetGpuReg(REG_OFFSET_BG2VOFS, r4);
     SetGpuReg(REG_OFFSET_BG3HOFS, r5);
     SetGpuReg(REG_OFFSET_BG3VOFS, r4);
+#ifdef PORTABLE
+    FieldMapView_Publish();
+#endif
 }
 
 void GetCameraOffsetWithPan(s16 *x, s16 *y)
@@ -93,8 +144,22 @@ void GetCameraOffsetWithPan(s16 *x, s16 *y)
 
 void DrawWholeMapView(void)
 {
+#ifdef PORTABLE
+    if (sFieldMapViewEnabled)
+    {
+        if (sFieldMapView.layout != gMapHeader.mapLayout
+         || sFieldMapView.mapWidth != gBackupMapLayout.width
+         || sFieldMapView.mapHeight != gBackupMapLayout.height)
+            FieldMapView_Build();
+        else
+            FieldMapView_FlushDirty();
+    }
+#endif
     DrawWholeMapViewInternal(gSaveBlock1Ptr->pos.x, gSaveBlock1Ptr->pos.y, gMapHeader.mapLayout);
     sFieldCameraOffset.copyBGToVRAM = TRUE;
+#ifdef PORTABLE
+    sBgTilemapsOutdated = FALSE;
+#endif
 }
 
 static void DrawWholeMapViewInternal(int x, int y, const struct MapLayout *mapLayout)
@@ -124,6 +189,20 @@ static void RedrawMapSlicesForCameraUpdate(struct FieldCameraOffset *cameraOffse
 {
     const struct MapLayout *mapLayout = gMapHeader.mapLayout;
 
+#ifdef PORTABLE
+    // The map view already holds every metatile, so scrolling only flushes
+    // changed ones. Moving through a map connection swaps the backup layout,
+    // however.
+    if (sFieldMapViewShown)
+    {
+        if (gCamera.active)
+            FieldMapView_Build();
+        else
+            FieldMapView_FlushDirty();
+        sBgTilemapsOutdated = TRUE;
+        return;
+    }
+#endif
     if (x > 0)
         RedrawMapSliceWest(cameraOffset, mapLayout);
     if (x < 0)
@@ -205,6 +284,15 @@ void CurrentMapDrawMetatileAt(int x, int y)
 {
     int offset = MapPosToBgTilemapOffset(&sFieldCameraOffset, x, y);
 
+#ifdef PORTABLE
+    if (sFieldMapViewEnabled)
+        FieldMapView_DrawMetatile(MapGridGetMetatileLayerTypeAt(x, y), GetMetatileTilesAt(gMapHeader.mapLayout, x, y), x, y);
+    if (sFieldMapViewShown)
+    {
+        sBgTilemapsOutdated = TRUE;
+        return;
+    }
+#endif
     if (offset >= 0)
     {
         DrawMetatileAt(gMapHeader.mapLayout, offset, x, y);
@@ -216,6 +304,15 @@ void DrawDoorMetatileAt(int x, int y, u16 *tiles)
 {
     int offset = MapPosToBgTilemapOffset(&sFieldCameraOffset, x, y);
 
+#ifdef PORTABLE
+    if (sFieldMapViewEnabled)
+        FieldMapView_DrawMetatile(METATILE_LAYER_TYPE_COVERED, tiles, x, y);
+    if (sFieldMapViewShown)
+    {
+        sBgTilemapsOutdated = TRUE;
+        return;
+    }
+#endif
     if (offset >= 0)
     {
         DrawMetatile(METATILE_LAYER_TYPE_COVERED, tiles, offset);
@@ -307,6 +404,90 @@ static void DrawMetatile(s32 metatileLayerType, const u16 *tiles, u16 offset)
     ScheduleBgCopyTilemapToVram(3);
 }
 
+#ifdef PORTABLE
+static const u16 *GetMetatileTilesAt(const struct MapLayout *mapLayout, int x, int y)
+{
+    u16 metatileId = MapGridGetMetatileIdAt(x, y);
+    const u16 *metatiles;
+
+    if (metatileId > NUM_METATILES_TOTAL)
+        metatileId = 0;
+    if (metatileId < NUM_METATILES_IN_PRIMARY)
+        metatiles = mapLayout->primaryTileset->metatiles;
+    else
+    {
+        metatiles = mapLayout->secondaryTileset->metatiles;
+        metatileId -= NUM_METATILES_IN_PRIMARY;
+    }
+    return metatiles + metatileId * NUM_TILES_PER_METATILE;
+}
+
+// Draws the 2x2 tiles of each metatile layer into tilemaps that are `stride` tiles wide.
+static void DrawMetatileToBuffers(s32 metatileLayerType, const u16 *tiles, u16 *bg1, u16 *bg2, u16 *bg3, u32 offset, u32 stride)
+{
+    switch (metatileLayerType)
+    {
+    case METATILE_LAYER_TYPE_SPLIT:
+        // Draw metatile's bottom layer to the bottom background layer.
+        bg3[offset] = tiles[0];
+        bg3[offset + 1] = tiles[1];
+        bg3[offset + stride] = tiles[2];
+        bg3[offset + stride + 1] = tiles[3];
+
+        // Draw transparent tiles to the middle background layer.
+        bg2[offset] = 0;
+        bg2[offset + 1] = 0;
+        bg2[offset + stride] = 0;
+        bg2[offset + stride + 1] = 0;
+
+        // Draw metatile's top layer to the top background layer.
+        bg1[offset] = tiles[4];
+        bg1[offset + 1] = tiles[5];
+        bg1[offset + stride] = tiles[6];
+        bg1[offset + stride + 1] = tiles[7];
+        break;
+    case METATILE_LAYER_TYPE_COVERED:
+        // Draw metatile's bottom layer to the bottom background layer.
+        bg3[offset] = tiles[0];
+        bg3[offset + 1] = tiles[1];
+        bg3[offset + stride] = tiles[2];
+        bg3[offset + stride + 1] = tiles[3];
+
+        // Draw metatile's top layer to the middle background layer.
+        bg2[offset] = tiles[4];
+        bg2[offset + 1] = tiles[5];
+        bg2[offset + stride] = tiles[6];
+        bg2[offset + stride + 1] = tiles[7];
+
+        // Draw transparent tiles to the top background layer.
+        bg1[offset] = 0;
+        bg1[offset + 1] = 0;
+        bg1[offset + stride] = 0;
+        bg1[offset + stride + 1] = 0;
+        break;
+    case METATILE_LAYER_TYPE_NORMAL:
+        // Draw garbage to the bottom background layer.
+        bg3[offset] = 0x3014;
+        bg3[offset + 1] = 0x3014;
+        bg3[offset + stride] = 0x3014;
+        bg3[offset + stride + 1] = 0x3014;
+
+        // Draw metatile's bottom layer to the middle background layer.
+        bg2[offset] = tiles[0];
+        bg2[offset + 1] = tiles[1];
+        bg2[offset + stride] = tiles[2];
+        bg2[offset + stride + 1] = tiles[3];
+
+        // Draw metatile's top layer to the top background layer, which covers object event sprites.
+        bg1[offset] = tiles[4];
+        bg1[offset + 1] = tiles[5];
+        bg1[offset + stride] = tiles[6];
+        bg1[offset + stride + 1] = tiles[7];
+        break;
+    }
+}
+#endif
+
 static s32 MapPosToBgTilemapOffset(struct FieldCameraOffset *cameraOffset, s32 x, s32 y)
 {
     x -= gSaveBlock1Ptr->pos.x;
@@ -503,3 +684,180 @@ static void CameraPanningCB_PanAhead(void)
         }
     }
 }
+
+#ifdef PORTABLE
+void FieldMapView_SetEnabled(bool8 enabled)
+{
+    if (sFieldMapViewEnabled == enabled)
+        return;
+    if (!enabled)
+    {
+        FieldMapView_SyncBgTilemaps();
+        FieldMapView_Free();
+    }
+    sFieldMapViewEnabled = enabled;
+}
+
+void FieldMapView_Free(void)
+{
+    u32 i;
+
+    for (i = 0; i < ARRAY_COUNT(sFieldMapView.tilemaps); i++)
+    {
+        free(sFieldMapView.tilemaps[i]);
+        sFieldMapView.tilemaps[i] = NULL;
+    }
+    sFieldMapView.layout = NULL;
+    sFieldMapView.width = 0;
+    sFieldMapView.height = 0;
+    sFieldMapViewDirtyCount = 0;
+    sFieldMapViewNeedsRebuild = FALSE;
+    // Only called along with freeing the ring buffer.
+    sFieldMapViewShown = FALSE;
+    sBgTilemapsOutdated = FALSE;
+}
+
+// Draws every metatile of gBackupMapLayout, plus a margin of border
+// metatiles, into the map view's tilemaps.
+static void FieldMapView_Build(void)
+{
+    u32 i, width, height;
+    int x, y;
+
+    width = (gBackupMapLayout.width + FIELD_MAP_VIEW_MARGIN * 2) * 2;
+    height = (gBackupMapLayout.height + FIELD_MAP_VIEW_MARGIN * 2) * 2;
+    if (width != sFieldMapView.width || height != sFieldMapView.height)
+    {
+        for (i = 0; i < ARRAY_COUNT(sFieldMapView.tilemaps); i++)
+        {
+            free(sFieldMapView.tilemaps[i]);
+            sFieldMapView.tilemaps[i] = calloc(width * height, sizeof(u16));
+        }
+        sFieldMapView.width = width;
+        sFieldMapView.height = height;
+    }
+
+    sFieldMapView.layout = gMapHeader.mapLayout;
+    sFieldMapView.mapWidth = gBackupMapLayout.width;
+    sFieldMapView.mapHeight = gBackupMapLayout.height;
+    sFieldMapViewDirtyCount = 0;
+    sFieldMapViewNeedsRebuild = FALSE;
+
+    for (y = -FIELD_MAP_VIEW_MARGIN; y < gBackupMapLayout.height + FIELD_MAP_VIEW_MARGIN; y++)
+    {
+        for (x = -FIELD_MAP_VIEW_MARGIN; x < gBackupMapLayout.width + FIELD_MAP_VIEW_MARGIN; x++)
+            FieldMapView_DrawMetatile(MapGridGetMetatileLayerTypeAt(x, y), GetMetatileTilesAt(gMapHeader.mapLayout, x, y), x, y);
+    }
+}
+
+// Called when gBackupMapLayout is refilled wholesale, e.g. on map load.
+void FieldMapView_InvalidateAll(void)
+{
+    sFieldMapViewNeedsRebuild = TRUE;
+}
+
+// Called whenever a metatile in gBackupMapLayout changes. As on hardware, the
+// change becomes visible the next time that part of the map is redrawn.
+void FieldMapView_InvalidateMetatileAt(int x, int y)
+{
+    if (!sFieldMapViewEnabled || sFieldMapView.layout == NULL || sFieldMapViewNeedsRebuild)
+        return;
+
+    if (sFieldMapViewDirtyCount >= FIELD_MAP_VIEW_MAX_DIRTY)
+    {
+        sFieldMapViewNeedsRebuild = TRUE;
+        return;
+    }
+    sFieldMapViewDirty[sFieldMapViewDirtyCount][0] = x;
+    sFieldMapViewDirty[sFieldMapViewDirtyCount][1] = y;
+    sFieldMapViewDirtyCount++;
+}
+
+static void FieldMapView_FlushDirty(void)
+{
+    u32 i;
+    int x, y;
+
+    if (sFieldMapView.layout == NULL || sFieldMapViewNeedsRebuild)
+    {
+        FieldMapView_Build();
+        return;
+    }
+
+    for (i = 0; i < sFieldMapViewDirtyCount; i++)
+    {
+        x = sFieldMapViewDirty[i][0];
+        y = sFieldMapViewDirty[i][1];
+        FieldMapView_DrawMetatile(MapGridGetMetatileLayerTypeAt(x, y), GetMetatileTilesAt(gMapHeader.mapLayout, x, y), x, y);
+    }
+    sFieldMapViewDirtyCount = 0;
+}
+
+static void FieldMapView_DrawMetatile(s32 metatileLayerType, const u16 *tiles, int x, int y)
+{
+    u32 offset;
+
+    x += FIELD_MAP_VIEW_MARGIN;
+    y += FIELD_MAP_VIEW_MARGIN;
+    if (x < 0 || y < 0 || x * 2 >= sFieldMapView.width || y * 2 >= sFieldMapView.height)
+        return;
+
+    offset = y * 2 * sFieldMapView.width + x * 2;
+    DrawMetatileToBuffers(metatileLayerType, tiles,
+                          sFieldMapView.tilemaps[0], sFieldMapView.tilemaps[1], sFieldMapView.tilemaps[2],
+                          offset, sFieldMapView.width);
+}
+
+// Called from the field's VBlank callback once BG1-3 are scrolled. Hands the
+// map view to the renderer for the frame, at the pixel the ring buffer's
+// scroll shows in the top-left corner.
+static void FieldMapView_Publish(void)
+{
+    s32 x, y;
+
+    if (!sFieldMapViewEnabled
+     || gOverworldTilemapBuffer_Bg1 == NULL
+     || GetBgTilemapBuffer(1) != gOverworldTilemapBuffer_Bg1
+     || GetBgTilemapBuffer(2) != gOverworldTilemapBuffer_Bg2
+     || GetBgTilemapBuffer(3) != gOverworldTilemapBuffer_Bg3)
+        return;
+    if (sFieldMapView.layout == NULL || sFieldMapViewNeedsRebuild)
+        FieldMapView_Build();
+
+    // The ring buffer's tile at xTileOffset, yTileOffset holds the top-left
+    // of the metatile at the camera's position.
+    x = (gSaveBlock1Ptr->pos.x + FIELD_MAP_VIEW_MARGIN) * 16
+      + (s8)(sFieldCameraOffset.xPixelOffset - sFieldCameraOffset.xTileOffset * 8) + sHorizontalCameraPan;
+    y = (gSaveBlock1Ptr->pos.y + FIELD_MAP_VIEW_MARGIN) * 16
+      + (s8)(sFieldCameraOffset.yPixelOffset - sFieldCameraOffset.yTileOffset * 8) + sVerticalCameraPan + 8;
+
+    FrameRender_SetBgView(1, sFieldMapView.tilemaps[0], sFieldMapView.width, sFieldMapView.height, x, y);
+    FrameRender_SetBgView(2, sFieldMapView.tilemaps[1], sFieldMapView.width, sFieldMapView.height, x, y);
+    FrameRender_SetBgView(3, sFieldMapView.tilemaps[2], sFieldMapView.width, sFieldMapView.height, x, y);
+    sFieldMapViewShown = TRUE;
+}
+
+// Called whenever the VBlank callback changes, as only the field's publishes
+// the map view. Redraws the ring buffer if it missed any redraws, so that
+// screens drawing BG1-3 from VRAM, like battle transitions, show the field as
+// it is now.
+void FieldMapView_SyncBgTilemaps(void)
+{
+    sFieldMapViewShown = FALSE;
+    if (!sBgTilemapsOutdated)
+        return;
+    sBgTilemapsOutdated = FALSE;
+
+    // A screen that has already taken over BG1-3 doesn't need them.
+    if (gOverworldTilemapBuffer_Bg1 == NULL
+     || GetBgTilemapBuffer(1) != gOverworldTilemapBuffer_Bg1
+     || GetBgTilemapBuffer(2) != gOverworldTilemapBuffer_Bg2
+     || GetBgTilemapBuffer(3) != gOverworldTilemapBuffer_Bg3)
+        return;
+
+    DrawWholeMapViewInternal(gSaveBlock1Ptr->pos.x, gSaveBlock1Ptr->pos.y, gMapHeader.mapLayout);
+    CopyBgTilemapBufferToVram(1);
+    CopyBgTilemapBufferToVram(2);
+    CopyBgTilemapBufferToVram(3);
+}
+#endif // PORTABLE
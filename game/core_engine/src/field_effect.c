@@ -2735,6 +2735,7 @@ static void LoadFieldMoveOutdoorStreaksTilemap(u16 offs)
     u16 i;
     u16 *dest;
     dest = (u16 *)(VRAM + ARRAY_COUNT(sFieldMoveStreaksOutdoors_Tilemap) + offs);
+    MARK_VRAM_WRITTEN(dest, sizeof(sFieldMoveStreaksOutdoors_Tilemap));
     for (i = 0; i < ARRAY_COUNT(sFieldMoveStreaksOutdoors_Tilemap); i++, dest++)
     {
         *dest = sFieldMoveStreaksOutdoors_Tilemap[i] | 0xF000;
@@ -2878,6 +2879,7 @@ static bool8 SlideIndoorBannerOnscreen(struct Task *task)
         dstOffs = (32 - dstOffs) & 0x1f;
         srcOffs = (32 - task->tBgOffset) & 0x1f;
         dest = (u16 *)(VRAM + 0x140 + (u16)task->data[12]);
+        MARK_VRAM_WRITTEN(dest, 10 * 32 * sizeof(u16));
         for (i = 0; i < 10; i++)
         {
             dest[dstOffs + i * 32] = sFieldMoveStreaksIndoors_Tilemap[srcOffs + i * 32];
@@ -2905,6 +2907,7 @@ static bool8 SlideIndoorBannerOffscreen(struct Task *task)
     {
         dstOffs = (task->tBgHoriz >> 3) & 0x1f;
         dest = (u16 *)(VRAM + 0x140 + (u16)task->data[12]);
+        MARK_VRAM_WRITTEN(dest, 10 * 32 * sizeof(u16));
         for (i = 0; i < 10; i++)
         {
             dest[dstOffs + i * 32] = 0xf000;
@@ -3107,6 +3110,8 @@ u8 FldEff_RayquazaSpotlight(void)
             *(u16 *)(BG_CHAR_ADDR(2) + (k + 1) * 32 + i * 4 + 2) = (sSpotlight_Gfx[k * 32 + i * 4 + 3] << 8) + sSpotlight_Gfx[k * 32 + i * 4 + 2];
         }
     }
+    MARK_VRAM_WRITTEN(BG_SCREEN_ADDR(31) + 3 * 32 * sizeof(u16), 12 * 32 * sizeof(u16));
+    MARK_VRAM_WRITTEN(BG_CHAR_ADDR(2) + 32, 90 * 32);
     return spriteId;
 }
 
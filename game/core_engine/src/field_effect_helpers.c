@@ -1524,6 +1524,7 @@ void UpdateRayquazaSpotlightEffect(struct Sprite *sprite)
                         ((u16 *)(BG_SCREEN_ADDR(31)))[i * 32 + j] = 0xBFF4 + i * 6 + j + 1;
                     }
                 }
+                MARK_VRAM_WRITTEN(BG_SCREEN_ADDR(31), 3 * 32 * sizeof(u16));
             }
             if (sprite->sTimer > 311)
             {
@@ -1610,6 +1611,7 @@ void UpdateRayquazaSpotlightEffect(struct Sprite *sprite)
                     ((u16 *)(BG_SCREEN_ADDR(31)))[i * 32 + j] = 0;
                 }
             }
+            MARK_VRAM_WRITTEN(BG_SCREEN_ADDR(31), 15 * 32 * sizeof(u16));
             SetGpuReg(REG_OFFSET_BG0VOFS, 0);
             FieldEffectStop(sprite, FLDEFF_RAYQUAZA_SPOTLIGHT);
             break;
@@ -1,3 +1,8 @@
+#ifdef PORTABLE
+#include <stdlib.h>
+#include <time.h>
+#endif
+
 #include "global.h"
 #include "constants/songs.h"
 #include "constants/weather.h"
@@ -6,6 +11,7 @@
 #include "event_object_movement.h"
 #include "field_weather.h"
 #include "main.h"
+#include "malloc.h"
 #include "menu.h"
 #include "palette.h"
 #include "random.h"
@@ -65,6 +71,18 @@ EWRAM_DATA static u8 ALIGNED(2) sFieldEffectPaletteColorMapTypes[32] = {0};
 
 static const u8 *sPaletteColorMapTypes;
 
+#ifdef PORTABLE
+// Color map steps baked into direct RGB555 -> RGB555 tables, indexed by
+// [is contrast map][colorMapIndex]. At 64K a table, all of them would take
+// 2.4M, but a weather only steps through a few maps unless it's a
+// thunderstorm, so each table is allocated and baked the first time its step
+// is applied.
+static u16 *sColorMapLuts[2][NUM_WEATHER_COLOR_MAPS];
+static bool8 sColorMapLutsBaked[2][NUM_WEATHER_COLOR_MAPS];
+
+bool8 gWeatherColorMapLuts = TRUE;
+#endif
+
 // The drought weather effect uses a precalculated color lookup table. Presumably this
 // is because the underlying color shift calculation is slow.
 static const u16 sDroughtWeatherColors[][0x1000] = {
@@ -279,6 +297,9 @@ static void BuildColorMaps(void)
     u16 baseBrightness;
     s16 diff;
 
+#ifdef PORTABLE
+    memset(sColorMapLutsBaked, 0, sizeof(sColorMapLutsBaked));
+#endif
     sPaletteColorMapTypes = sBasePaletteColorMapTypes;
     for (i = 0; i < 2; i++)
     {
@@ -456,6 +477,190 @@ static bool8 FadeInScreen_FogHorizontal(void)
 static void DoNothing(void)
 { }
 
+#ifdef PORTABLE
+
+// Returns NULL if the table can't be allocated.
+static const u16 *GetColorMapLut(bool8 contrast, u8 colorMapIndex)
+{
+    u16 *lut = sColorMapLuts[contrast][colorMapIndex];
+
+    if (lut == NULL)
+    {
+        lut = malloc(0x8000 * sizeof(*lut));
+        if (lut == NULL)
+            return NULL;
+        sColorMapLuts[contrast][colorMapIndex] = lut;
+    }
+
+    if (!sColorMapLutsBaked[contrast][colorMapIndex])
+    {
+        const u8 *colorMap = contrast ? gWeatherPtr->contrastColorMaps[colorMapIndex]
+                                      : gWeatherPtr->darkenedContrastColorMaps[colorMapIndex];
+        u32 color;
+
+        for (color = 0; color < 0x8000; color++)
+            lut[color] = RGB2(colorMap[color & 0x1F], colorMap[(color >> 5) & 0x1F], colorMap[(color >> 10) & 0x1F]);
+        sColorMapLutsBaked[contrast][colorMapIndex] = TRUE;
+    }
+    return lut;
+}
+
+// Returns FALSE, having changed nothing, if a table is missing.
+static bool8 ApplyColorMapLut(u8 startPalIndex, u8 numPalettes, u8 colorMapIndex)
+{
+    const u16 *luts[2];
+    u16 curPalIndex;
+    u16 palOffset;
+    u16 i;
+
+    luts[FALSE] = GetColorMapLut(FALSE, colorMapIndex);
+    luts[TRUE] = GetColorMapLut(TRUE, colorMapIndex);
+    if (luts[FALSE] == NULL || luts[TRUE] == NULL)
+        return FALSE;
+
+    for (curPalIndex = startPalIndex; curPalIndex < startPalIndex + numPalettes; curPalIndex++)
+    {
+        palOffset = PLTT_ID(curPalIndex);
+        if (sPaletteColorMapTypes[curPalIndex] == COLOR_MAP_NONE)
+        {
+            CpuFastCopy(&gPlttBufferUnfaded[palOffset], &gPlttBufferFaded[palOffset], PLTT_SIZE_4BPP);
+        }
+        else
+        {
+            const u16 *lut = luts[sPaletteColorMapTypes[curPalIndex] == COLOR_MAP_CONTRAST
+                               || curPalIndex - 16 == gWeatherPtr->contrastColorMapSpritePalIndex];
+
+            for (i = 0; i < 16; i++)
+                gPlttBufferFaded[palOffset + i] = lut[gPlttBufferUnfaded[palOffset + i] & 0x7FFF];
+        }
+    }
+    return TRUE;
+}
+
+// A blend toward a fixed color changes every frame of a fade, so it isn't
+// worth a full table. Instead the color map and the blend are folded into
+// one 32-entry table per channel, already shifted into place.
+struct BlendChannels
+{
+    u16 r[32];
+    u16 g[32];
+    u16 b[32];
+};
+
+static void BuildBlendChannel(u16 *dst, const u8 *colorMap, u8 blendCoeff, u8 blend, u8 shift)
+{
+    u8 i, value;
+
+    for (i = 0; i < 32; i++)
+    {
+        value = colorMap != NULL ? colorMap[i] : i;
+        value += ((blend - value) * blendCoeff) >> 4;
+        dst[i] = value << shift;
+    }
+}
+
+static void BuildBlendChannels(struct BlendChannels *channels, const u8 *colorMap, u8 blendCoeff, u16 blendColor)
+{
+    BuildBlendChannel(channels->r, colorMap, blendCoeff, blendColor & 0x1F, 0);
+    BuildBlendChannel(channels->g, colorMap, blendCoeff, (blendColor >> 5) & 0x1F, 5);
+    BuildBlendChannel(channels->b, colorMap, blendCoeff, (blendColor >> 10) & 0x1F, 10);
+}
+
+static inline u16 ApplyBlendChannels(const struct BlendChannels *channels, u16 color)
+{
+    return channels->r[color & 0x1F] | channels->g[(color >> 5) & 0x1F] | channels->b[(color >> 10) & 0x1F];
+}
+
+static void ApplyColorMapWithBlendLut(u8 startPalIndex, u8 numPalettes, u8 colorMapIndex, u8 blendCoeff, u16 blendColor)
+{
+    struct BlendChannels channels[2];
+    u16 curPalIndex;
+    u16 palOffset;
+    u16 i;
+
+    BuildBlendChannels(&channels[0], gWeatherPtr->darkenedContrastColorMaps[colorMapIndex], blendCoeff, blendColor);
+    BuildBlendChannels(&channels[1], gWeatherPtr->contrastColorMaps[colorMapIndex], blendCoeff, blendColor);
+    for (curPalIndex = startPalIndex; curPalIndex < startPalIndex + numPalettes; curPalIndex++)
+    {
+        palOffset = PLTT_ID(curPalIndex);
+        if (sPaletteColorMapTypes[curPalIndex] == COLOR_MAP_NONE)
+        {
+            BlendPalette(palOffset, 16, blendCoeff, blendColor);
+        }
+        else
+        {
+            const struct BlendChannels *blend = &channels[sPaletteColorMapTypes[curPalIndex] != COLOR_MAP_DARK_CONTRAST];
+
+            for (i = 0; i < 16; i++)
+                gPlttBufferFaded[palOffset + i] = ApplyBlendChannels(blend, gPlttBufferUnfaded[palOffset + i]);
+        }
+    }
+}
+
+// The drought tables are already a direct lookup, so only the blend changes.
+static void ApplyDroughtColorMapWithBlendLut(u8 colorMapIndex, u8 blendCoeff, u16 blendColor)
+{
+    struct BlendChannels channels;
+    u16 curPalIndex;
+    u16 palOffset;
+    u16 i;
+
+    BuildBlendChannels(&channels, NULL, blendCoeff, blendColor);
+    for (curPalIndex = 0; curPalIndex < 32; curPalIndex++)
+    {
+        palOffset = PLTT_ID(curPalIndex);
+        if (sPaletteColorMapTypes[curPalIndex] == COLOR_MAP_NONE)
+        {
+            BlendPalette(palOffset, 16, blendCoeff, blendColor);
+        }
+        else
+        {
+            for (i = 0; i < 16; i++)
+            {
+                u16 color = sDroughtWeatherColors[colorMapIndex][DROUGHT_COLOR_INDEX(gPlttBufferUnfaded[palOffset + i])];
+                gPlttBufferFaded[palOffset + i] = ApplyBlendChannels(&channels, color);
+            }
+        }
+    }
+}
+
+static void ApplyFogBlendLut(u8 blendCoeff, u16 blendColor)
+{
+    static const u8 sFogTargets[3] = {28, 31, 28};
+    u8 lightened[3][32];
+    struct BlendChannels channels;
+    u16 curPalIndex;
+    u16 palOffset;
+    u16 i;
+
+    for (i = 0; i < 32; i++)
+    {
+        lightened[0][i] = i + (((sFogTargets[0] - i) * 3) >> 2);
+        lightened[1][i] = i + (((sFogTargets[1] - i) * 3) >> 2);
+        lightened[2][i] = i + (((sFogTargets[2] - i) * 3) >> 2);
+    }
+    BuildBlendChannel(channels.r, lightened[0], blendCoeff, blendColor & 0x1F, 0);
+    BuildBlendChannel(channels.g, lightened[1], blendCoeff, (blendColor >> 5) & 0x1F, 5);
+    BuildBlendChannel(channels.b, lightened[2], blendCoeff, (blendColor >> 10) & 0x1F, 10);
+
+    BlendPalette(BG_PLTT_ID(0), 16 * 16, blendCoeff, blendColor);
+    for (curPalIndex = 16; curPalIndex < 32; curPalIndex++)
+    {
+        palOffset = PLTT_ID(curPalIndex);
+        if (LightenSpritePaletteInFog(curPalIndex))
+        {
+            for (i = 0; i < 16; i++)
+                gPlttBufferFaded[palOffset + i] = ApplyBlendChannels(&channels, gPlttBufferUnfaded[palOffset + i]);
+        }
+        else
+        {
+            BlendPalette(palOffset, 16, blendCoeff, blendColor);
+        }
+    }
+}
+
+#endif // PORTABLE
+
 static void ApplyColorMap(u8 startPalIndex, u8 numPalettes, s8 colorMapIndex)
 {
     u16 curPalIndex;
@@ -463,6 +668,10 @@ static void ApplyColorMap(u8 startPalIndex, u8 numPalettes, s8 colorMapIndex)
     u8 *colorMap;
     u16 i;
 
+#ifdef PORTABLE
+    if (gWeatherColorMapLuts && colorMapIndex > 0 && ApplyColorMapLut(startPalIndex, numPalettes, colorMapIndex - 1))
+        return;
+#endif
     if (colorMapIndex > 0)
     {
         colorMapIndex--;
@@ -547,6 +756,13 @@ static void ApplyColorMapWithBlend(u8 startPalIndex, u8 numPalettes, s8 colorMap
     u8 gBlend = color.g;
     u8 bBlend = color.b;
 
+#ifdef PORTABLE
+    if (gWeatherColorMapLuts)
+    {
+        ApplyColorMapWithBlendLut(startPalIndex, numPalettes, colorMapIndex - 1, blendCoeff, blendColor);
+        return;
+    }
+#endif
     palOffset = PLTT_ID(startPalIndex);
     numPalettes += startPalIndex;
     colorMapIndex--;
@@ -598,6 +814,13 @@ static void ApplyDroughtColorMapWithBlend(s8 colorMapIndex, u8 blendCoeff, u16 b
     u16 palOffset;
     u16 i;
 
+#ifdef PORTABLE
+    if (gWeatherColorMapLuts)
+    {
+        ApplyDroughtColorMapWithBlendLut(-colorMapIndex - 1, blendCoeff, blendColor);
+        return;
+    }
+#endif
     colorMapIndex = -colorMapIndex - 1;
     color = *(struct RGBColor *)&blendColor;
     rBlend = color.r;
@@ -651,6 +874,13 @@ static void ApplyFogBlend(u8 blendCoeff, u16 blendColor)
     u8 bBlend;
     u16 curPalIndex;
 
+#ifdef PORTABLE
+    if (gWeatherColorMapLuts)
+    {
+        ApplyFogBlendLut(blendCoeff, blendColor);
+        return;
+    }
+#endif
     BlendPalette(BG_PLTT_ID(0), 16 * 16, blendCoeff, blendColor);
     color = *(struct RGBColor *)&blendColor;
     rBlend = color.r;
@@ -1103,3 +1333,115 @@ void ResetPreservedPalettesInWeather(void)
 {
     sPaletteColorMapTypes = sBasePaletteColorMapTypes;
 }
+
+#ifdef PORTABLE
+
+static u64 GetTimeNs(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (u64)now.tv_sec * 1000000000 + now.tv_nsec;
+}
+
+// Runs one weather palette transition the way the field does it, frame by frame.
+static void RunColorMapTransition(u8 transition)
+{
+    s32 i;
+
+    switch (transition)
+    {
+    case 0: // Rain, snow and shade fade in, then a thunderstorm's lightning ramp
+        for (i = 1; i < 16; i++)
+            ApplyColorMapWithBlend(0, 32, 3, 16 - i, RGB_BLACK);
+        ApplyColorMap(0, 32, 3);
+        for (i = 3; i <= NUM_WEATHER_COLOR_MAPS; i++)
+            ApplyColorMap(0, 32, i);
+        for (i = NUM_WEATHER_COLOR_MAPS; i >= 3; i--)
+            ApplyColorMap(0, 32, i);
+        break;
+    case 1: // Drought fade in
+        for (i = 1; i < 16; i++)
+            ApplyDroughtColorMapWithBlend(-6, 16 - i, RGB_BLACK);
+        ApplyColorMap(0, 32, -6);
+        break;
+    case 2: // Horizontal fog fade in
+        for (i = 1; i <= 16; i++)
+            ApplyFogBlend(16 - i, RGB_WHITEALPHA);
+        break;
+    }
+}
+
+// Sets gWeather up the way the transitions find it in the field, with a
+// contrast sprite palette and the most sprite palettes fog can lighten, so
+// every branch of them runs.
+static void SetUpBenchmarkWeather(void)
+{
+    u8 i;
+
+    BuildColorMaps();
+    gWeatherPtr->contrastColorMapSpritePalIndex = 4;
+    gWeatherPtr->lightenedFogSpritePalsCount = 0;
+    for (i = 0; i < ARRAY_COUNT(gWeatherPtr->lightenedFogSpritePals); i++)
+        MarkFogSpritePalToLighten(16 + i * 3);
+}
+
+// Times each transition with and without the baked tables over a palette
+// buffer of pseudo-random colors, and checks both produce the same palettes.
+// It runs on a scratch copy of the weather state, so the field's is left as
+// it was.
+void WeatherColorMap_Benchmark(u32 iterations, struct WeatherColorMapBenchmark *result)
+{
+    u16 *saved = Alloc(PLTT_SIZE * 3);
+    u16 *scalarPltt = saved + PLTT_BUFFER_SIZE * 2;
+    struct Weather *savedWeather = Alloc(sizeof(gWeather));
+    const u8 *savedColorMapTypes = sPaletteColorMapTypes;
+    bool8 savedLuts = gWeatherColorMapLuts;
+    u32 seed = 0x1234;
+    u32 i, j;
+    u8 transition;
+    u64 start;
+
+    memcpy(saved, gPlttBufferUnfaded, PLTT_SIZE);
+    memcpy(saved + PLTT_BUFFER_SIZE, gPlttBufferFaded, PLTT_SIZE);
+    memcpy(savedWeather, &gWeather, sizeof(gWeather));
+    for (i = 0; i < PLTT_BUFFER_SIZE; i++)
+    {
+        seed = seed * 1103515245 + 24691;
+        gPlttBufferUnfaded[i] = (seed >> 16) & 0x7FFF;
+    }
+    SetUpBenchmarkWeather();
+
+    result->iterations = iterations;
+    result->resultsMatch = TRUE;
+    for (transition = 0; transition < 3; transition++)
+    {
+        gWeatherColorMapLuts = FALSE;
+        start = GetTimeNs();
+        for (j = 0; j < iterations; j++)
+            RunColorMapTransition(transition);
+        result->scalarNs[transition] = GetTimeNs() - start;
+        memcpy(scalarPltt, gPlttBufferFaded, PLTT_SIZE);
+
+        // Bake outside the timed loop, as the field only does it once.
+        gWeatherColorMapLuts = TRUE;
+        RunColorMapTransition(transition);
+        start = GetTimeNs();
+        for (j = 0; j < iterations; j++)
+            RunColorMapTransition(transition);
+        result->lutNs[transition] = GetTimeNs() - start;
+        if (memcmp(scalarPltt, gPlttBufferFaded, PLTT_SIZE) != 0)
+            result->resultsMatch = FALSE;
+    }
+
+    gWeatherColorMapLuts = savedLuts;
+    sPaletteColorMapTypes = savedColorMapTypes;
+    memcpy(&gWeather, savedWeather, sizeof(gWeather));
+    memset(sColorMapLutsBaked, 0, sizeof(sColorMapLutsBaked)); // baked from the scratch maps
+    memcpy(gPlttBufferUnfaded, saved, PLTT_SIZE);
+    memcpy(gPlttBufferFaded, saved + PLTT_BUFFER_SIZE, PLTT_SIZE);
+    Free(savedWeather);
+    Free(saved);
+}
+
+#endif // PORTABLE
@@ -1,6 +1,7 @@
 #include "global.h"
 #include "battle_pyramid.h"
 #include "bg.h"
+#include "field_camera.h"
 #include "fieldmap.h"
 #include "fldeff.h"
 #include "fldeff_misc.h"
@@ -89,12 +90,18 @@ void InitBattlePyramidMap(bool8 setPlayerPosition)
 {
     CpuFastFill16(MAPGRID_UNDEFINED, sBackupMapData, sizeof(sBackupMapData));
     GenerateBattlePyramidFloorLayout(sBackupMapData, setPlayerPosition);
+#ifdef PORTABLE
+    FieldMapView_InvalidateAll();
+#endif
 }
 
 void InitTrainerHillMap(void)
 {
     CpuFastFill16(MAPGRID_UNDEFINED, sBackupMapData, sizeof(sBackupMapData));
     GenerateTrainerHillFloorLayout(sBackupMapData);
+#ifdef PORTABLE
+    FieldMapView_InvalidateAll();
+#endif
 }
 
 static void InitMapLayoutData(struct MapHeader *mapHeader)
@@ -105,6 +112,9 @@ static void InitMapLayoutData(struct MapHeader *mapHeader)
     mapLayout = mapHeader->mapLayout;
     CpuFastFill16(MAPGRID_UNDEFINED, sBackupMapData, sizeof(sBackupMapData));
     gBackupMapLayout.map = sBackupMapData;
+#ifdef PORTABLE
+    FieldMapView_InvalidateAll();
+#endif
     width = mapLayout->width + MAP_OFFSET_W;
     gBackupMapLayout.width = width;
     height = mapLayout->height + MAP_OFFSET_H;
@@ -391,6 +401,9 @@ void MapGridSetMetatileIdAt(int x, int y, u16 metatile)
     {
         i = x + y * gBackupMapLayout.width;
         gBackupMapLayout.map[i] = (gBackupMapLayout.map[i] & MAPGRID_ELEVATION_MASK) | (metatile & ~MAPGRID_ELEVATION_MASK);
+#ifdef PORTABLE
+        FieldMapView_InvalidateMetatileAt(x, y);
+#endif
     }
 }
 
@@ -401,6 +414,9 @@ void MapGridSetMetatileEntryAt(int x, int y, u16 metatile)
     {
         i = x + gBackupMapLayout.width * y;
         gBackupMapLayout.map[i] = metatile;
+#ifdef PORTABLE
+        FieldMapView_InvalidateMetatileAt(x, y);
+#endif
     }
 }
 
@@ -0,0 +1,249 @@
+#ifdef PORTABLE
+#include <stdlib.h>
+#endif
+
+#include "global.h"
+#include "battle_tower.h"
+#include "frontier_party_gen.h"
+#include "pokemon.h"
+#include "random.h"
+#include "constants/battle_frontier_mons.h"
+#include "constants/battle_frontier_trainers.h"
+#include "constants/items.h"
+#include "constants/moves.h"
+
+#ifdef PORTABLE
+
+// Pools of the trainers in gFacilityTrainers, built on first use. They hold
+// the species and items of gFacilityTrainerMons, so they're dropped whenever
+// either table is switched for another facility's.
+static struct FrontierMonPool sTrainerPools[2][FRONTIER_TRAINERS_COUNT];
+static const struct BattleFrontierTrainer *sTrainerPoolsTrainers;
+static const struct FacilityMon *sTrainerPoolsMons;
+
+static bool8 IsMonAllowed(u16 monId, bool8 allowHighTier)
+{
+    // "High tier" Pokémon are only allowed on open level mode
+    return allowHighTier || monId <= FRONTIER_MONS_HIGH_TIER;
+}
+
+static bool8 AllocPool(struct FrontierMonPool *pool, u16 capacity)
+{
+    pool->count = 0;
+    pool->monIds = malloc(sizeof(*pool->monIds) * max(capacity, 1));
+    pool->species = malloc(sizeof(*pool->species) * max(capacity, 1));
+    pool->itemTableIds = malloc(sizeof(*pool->itemTableIds) * max(capacity, 1));
+    if (pool->monIds == NULL || pool->species == NULL || pool->itemTableIds == NULL)
+    {
+        FreeFrontierMonPool(pool);
+        return FALSE;
+    }
+    return TRUE;
+}
+
+static void AddToPool(struct FrontierMonPool *pool, u16 monId)
+{
+    const struct FacilityMon *mon = &gFacilityTrainerMons[monId];
+
+    pool->monIds[pool->count] = monId;
+    pool->species[pool->count] = mon->species;
+    if (gBattleFrontierHeldItems[mon->itemTableId] != ITEM_NONE)
+        pool->itemTableIds[pool->count] = mon->itemTableId;
+    else
+        pool->itemTableIds[pool->count] = FRONTIER_POOL_NO_ITEM;
+    pool->count++;
+}
+
+bool8 BuildFrontierMonPool(struct FrontierMonPool *pool, const u16 *monIds, u16 count, bool8 allowHighTier)
+{
+    u16 i;
+
+    if (!AllocPool(pool, count))
+        return FALSE;
+
+    for (i = 0; i < count; i++)
+    {
+        if (IsMonAllowed(monIds[i], allowHighTier))
+            AddToPool(pool, monIds[i]);
+    }
+    return TRUE;
+}
+
+// For the Factory, which draws from ranges of gFacilityTrainerMons rather
+// than from a trainer's set.
+bool8 BuildFrontierMonPoolFromRange(struct FrontierMonPool *pool, u16 firstMonId, u16 lastMonId, bool8 allowHighTier, u16 excludedSpecies)
+{
+    u16 monId;
+
+    if (!AllocPool(pool, lastMonId - firstMonId + 1))
+        return FALSE;
+
+    for (monId = firstMonId; monId <= lastMonId; monId++)
+    {
+        if (IsMonAllowed(monId, allowHighTier) && gFacilityTrainerMons[monId].species != excludedSpecies)
+            AddToPool(pool, monId);
+    }
+    return TRUE;
+}
+
+void FreeFrontierMonPool(struct FrontierMonPool *pool)
+{
+    free(pool->monIds);
+    free(pool->species);
+    free(pool->itemTableIds);
+    pool->monIds = NULL;
+    pool->species = NULL;
+    pool->itemTableIds = NULL;
+    pool->count = 0;
+}
+
+const struct FrontierMonPool *GetFrontierTrainerMonPool(u16 trainerId, bool8 allowHighTier)
+{
+    struct FrontierMonPool *pool;
+    const u16 *monSet;
+    u16 count;
+    s32 i, j;
+
+    if (trainerId >= FRONTIER_TRAINERS_COUNT)
+        return NULL;
+
+    if (sTrainerPoolsTrainers != gFacilityTrainers || sTrainerPoolsMons != gFacilityTrainerMons)
+    {
+        for (i = 0; i < 2; i++)
+        {
+            for (j = 0; j < FRONTIER_TRAINERS_COUNT; j++)
+                FreeFrontierMonPool(&sTrainerPools[i][j]);
+        }
+        sTrainerPoolsTrainers = gFacilityTrainers;
+        sTrainerPoolsMons = gFacilityTrainerMons;
+    }
+
+    pool = &sTrainerPools[allowHighTier ? 1 : 0][trainerId];
+    if (pool->monIds == NULL)
+    {
+        monSet = gFacilityTrainers[trainerId].monSet;
+        for (count = 0; monSet[count] != 0xFFFF; count++)
+            ;
+        if (!BuildFrontierMonPool(pool, monSet, count, allowHighTier))
+            return NULL;
+    }
+    return pool;
+}
+
+void ExcludeFrontierSpecies(struct FrontierPartyExclusions *exclusions, u16 species)
+{
+    exclusions->species[species / 32] |= 1u << (species % 32);
+}
+
+void ExcludeFrontierMon(struct FrontierPartyExclusions *exclusions, u16 monId)
+{
+    u8 itemTableId = gFacilityTrainerMons[monId].itemTableId;
+
+    ExcludeFrontierSpecies(exclusions, gFacilityTrainerMons[monId].species);
+    if (gBattleFrontierHeldItems[itemTableId] != ITEM_NONE)
+        exclusions->items[itemTableId / 32] |= 1u << (itemTableId % 32);
+}
+
+static bool8 IsPoolMonExcluded(const struct FrontierMonPool *pool, u16 i, const struct FrontierPartyExclusions *exclusions)
+{
+    u16 species = pool->species[i];
+    u8 itemTableId = pool->itemTableIds[i];
+
+    if (exclusions->species[species / 32] & (1u << (species % 32)))
+        return TRUE;
+    if (itemTableId != FRONTIER_POOL_NO_ITEM && (exclusions->items[itemTableId / 32] & (1u << (itemTableId % 32))))
+        return TRUE;
+    return FALSE;
+}
+
+// Draws count mons that clash neither with exclusions nor with each other,
+// adding each to exclusions. Every mon left eligible is equally likely, as
+// with the retry loops, but the RNG is called once per mon. Returns FALSE if
+// the pool ran out of eligible mons first.
+bool8 SampleFrontierMons(const struct FrontierMonPool *pool, struct FrontierPartyExclusions *exclusions, u16 *monIds, u8 count)
+{
+    u16 i, eligible, pick;
+    u8 n;
+
+    for (n = 0; n < count; n++)
+    {
+        eligible = 0;
+        for (i = 0; i < pool->count; i++)
+        {
+            if (!IsPoolMonExcluded(pool, i, exclusions))
+                eligible++;
+        }
+        if (eligible == 0)
+            return FALSE;
+
+        pick = Random() % eligible;
+        for (i = 0; i < pool->count; i++)
+        {
+            if (!IsPoolMonExcluded(pool, i, exclusions) && pick-- == 0)
+                break;
+        }
+
+        monIds[n] = pool->monIds[i];
+        ExcludeFrontierMon(exclusions, pool->monIds[i]);
+    }
+    return TRUE;
+}
+
+// Same mon as CreateMonWithEVSpreadNatureOTID followed by setting the moves,
+// friendship and held item one field at a time, but the encrypted fields are
+// all written with a single decrypt and the stats calculated once. Rental
+// mons (the Factory's) get Frustration in place of Return and 0 friendship,
+// the others 0 friendship only if they know Frustration.
+void CreateFacilityMon(struct Pokemon *mon, u16 monId, u8 level, u8 fixedIV, u32 otId, bool8 isRental)
+{
+    const struct FacilityMon *facilityMon = &gFacilityTrainerMons[monId];
+    struct OpenBoxPokemon open;
+    u32 personality;
+    u8 statCount = 0;
+    u16 evAmount;
+    u8 friendship = isRental ? 0 : MAX_FRIENDSHIP;
+    u8 mail = MAIL_NONE;
+    s32 i;
+
+    do
+    {
+        personality = Random32();
+    } while (facilityMon->nature != GetNatureFromPersonality(personality));
+
+    ZeroMonData(mon);
+    CreateBoxMon(&mon->box, facilityMon->species, level, fixedIV, TRUE, personality, OT_ID_PRESET, otId);
+    SetMonData(mon, MON_DATA_LEVEL, &level);
+    SetMonData(mon, MON_DATA_MAIL, &mail);
+
+    for (i = 0; i < NUM_STATS; i++)
+    {
+        if (facilityMon->evSpread & (1 << i))
+            statCount++;
+    }
+    evAmount = MAX_TOTAL_EVS / statCount;
+
+    OpenBoxMon(&open, &mon->box);
+    for (i = 0; i < NUM_STATS; i++)
+    {
+        if (facilityMon->evSpread & (1 << i))
+            SetOpenBoxMonData(&open, MON_DATA_HP_EV + i, &evAmount);
+    }
+    for (i = 0; i < MAX_MON_MOVES; i++)
+    {
+        u16 move = facilityMon->moves[i];
+
+        if (isRental && move == MOVE_RETURN)
+            move = MOVE_FRUSTRATION;
+        else if (!isRental && move == MOVE_FRUSTRATION)
+            friendship = 0;  // Frustration is more powerful the lower the pokemon's friendship is.
+        SetOpenBoxMonData(&open, MON_DATA_MOVE1 + i, &move);
+        SetOpenBoxMonData(&open, MON_DATA_PP1 + i, &gBattleMoves[move].pp);
+    }
+    SetOpenBoxMonData(&open, MON_DATA_FRIENDSHIP, &friendship);
+    SetOpenBoxMonData(&open, MON_DATA_HELD_ITEM, &gBattleFrontierHeldItems[facilityMon->itemTableId]);
+    CloseBoxMon(&open);
+
+    CalculateMonStats(mon);
+}
+
+#endif // PORTABLE
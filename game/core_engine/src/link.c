@@ -1133,6 +1133,7 @@ static void LinkTest_PrintNumChar(char val, u8 x, u8 y)
 
     vAddr = (u16 *)BG_SCREEN_ADDR(gLinkTestBGInfo.screenBaseBlock);
     vAddr[y * 32 + x] = (gLinkTestBGInfo.paletteNum << 12) | (val + 1 + gLinkTestBGInfo.baseChar);
+    MARK_VRAM_WRITTEN(&vAddr[y * 32 + x], sizeof(u16));
 }
 
 static void LinkTest_PrintChar(char val, u8 x, u8 y)
@@ -1141,6 +1142,7 @@ static void LinkTest_PrintChar(char val, u8 x, u8 y)
 
     vAddr = (u16 *)BG_SCREEN_ADDR(gLinkTestBGInfo.screenBaseBlock);
     vAddr[y * 32 + x] = (gLinkTestBGInfo.paletteNum << 12) | (val + gLinkTestBGInfo.baseChar);
+    MARK_VRAM_WRITTEN(&vAddr[y * 32 + x], sizeof(u16));
 }
 
 static void LinkTest_PrintHex(u32 num, u8 x, u8 y, u8 length)
@@ -1,3 +1,6 @@
+#ifdef PORTABLE
+#include <string.h>
+#endif
 #include "global.h"
 #include "menu.h"
 #include "list_menu.h"
@@ -87,6 +90,10 @@ static void ListMenuUpdateCursorObject(u8 taskId, u16 x, u16 y, u32 cursorObjId)
 static void ListMenuRemoveCursorObject(u8 taskId, u32 cursorObjId);
 static void SpriteCallback_ScrollIndicatorArrow(struct Sprite *sprite);
 static void SpriteCallback_RedArrowCursor(struct Sprite *sprite);
+#ifdef PORTABLE
+static void ListRowCache_Claim(struct ListMenu *list);
+static void ListRowCache_Clear(void);
+#endif
 
 // EWRAM vars
 static EWRAM_DATA struct {
@@ -311,6 +318,36 @@ static const u32 sOutlineCursor_Gfx[]   = INCBIN_U32("graphics/interface/outline
 static const u32 sArrowCursor_Gfx[]     = INCBIN_U32("graphics/interface/arrow_cursor.4bpp.lz");
 
 // code
+#ifdef PORTABLE
+// Rendered rows of the active scrolling list, kept as raw window pixel lines
+// in a ring indexed by item index. Scrolling shifts the window and only the
+// newly exposed rows are blitted back from here, so text is rendered once
+// per item however often it scrolls past.
+#define ROW_CACHE_SLOTS      32
+#define ROW_CACHE_MAX_WIDTH  (DISPLAY_WIDTH / 8)
+#define ROW_CACHE_MAX_HEIGHT 32
+
+struct ListRowCacheSlot
+{
+    u16 itemIndex;
+    bool8 valid;
+    u8 lines[ROW_CACHE_MAX_HEIGHT][ROW_CACHE_MAX_WIDTH * 4];
+};
+
+struct ListRowCache
+{
+    const struct ListMenuItem *items;
+    u8 windowId;
+    u8 rowHeight;
+    bool8 trusted;
+    struct ListRowCacheSlot slots[ROW_CACHE_SLOTS];
+};
+
+bool8 gListMenuRowCache = TRUE;
+
+static struct ListRowCache sListRowCache;
+#endif
+
 static void ListMenuDummyTask(u8 taskId)
 {
 
@@ -483,6 +520,10 @@ void DestroyListMenuTask(u8 listTaskId, u16 *scrollOffset, u16 *selectedRow)
     if (list->taskId != TASK_NONE)
         ListMenuRemoveCursorObject(list->taskId, list->template.cursorKind - CURSOR_OBJECT_START);
 
+#ifdef PORTABLE
+    if (sListRowCache.items == list->template.items && sListRowCache.windowId == list->template.windowId)
+        sListRowCache.items = NULL;
+#endif
     DestroyTask(listTaskId);
 }
 
@@ -490,6 +531,10 @@ void RedrawListMenu(u8 listTaskId)
 {
     struct ListMenu *list = (void *) gTasks[listTaskId].data;
 
+#ifdef PORTABLE
+    // Callers redraw after the items changed.
+    ListRowCache_Clear();
+#endif
     FillWindowPixelBuffer(list->template.windowId, PIXEL_FILL(list->template.fillValue));
     ListMenuPrintEntries(list, list->scrollOffset, 0, list->template.maxShowed);
     ListMenuDrawCursor(list);
@@ -504,6 +549,9 @@ void ChangeListMenuPals(u8 listTaskId, u8 cursorPal, u8 fillValue, u8 cursorShad
     list->template.cursorPal = cursorPal;
     list->template.fillValue = fillValue;
     list->template.cursorShadowPal = cursorShadowPal;
+#ifdef PORTABLE
+    ListRowCache_Clear();
+#endif
 }
 
 // unused
@@ -588,6 +636,9 @@ static u8 ListMenuInitInternal(struct ListMenuTemplate *listMenuTemplate, u16 sc
     if (list->template.totalItems < list->template.maxShowed)
         list->template.maxShowed = list->template.totalItems;
 
+#ifdef PORTABLE
+    ListRowCache_Claim(list);
+#endif
     FillWindowPixelBuffer(list->template.windowId, PIXEL_FILL(list->template.fillValue));
     ListMenuPrintEntries(list, list->scrollOffset, 0, list->template.maxShowed);
     ListMenuDrawCursor(list);
@@ -625,11 +676,97 @@ static void ListMenuPrint(struct ListMenu *list, const u8 *str, u8 x, u8 y)
     }
 }
 
+#ifdef PORTABLE
+static void ListRowCache_Claim(struct ListMenu *list)
+{
+    sListRowCache.items = list->template.items;
+    sListRowCache.windowId = list->template.windowId;
+    sListRowCache.rowHeight = GetFontAttribute(list->template.fontId, FONTATTR_MAX_LETTER_HEIGHT) + list->template.itemVerticalPadding;
+    // An itemPrintFunc may draw state that changes while the list is open;
+    // such lists opt in through ListMenuEnableRowCache.
+    sListRowCache.trusted = (list->template.itemPrintFunc == NULL);
+    ListRowCache_Clear();
+}
+
+static void ListRowCache_Clear(void)
+{
+    u32 i;
+
+    for (i = 0; i < ROW_CACHE_SLOTS; i++)
+        sListRowCache.slots[i].valid = FALSE;
+}
+
+void ListMenuEnableRowCache(u8 listTaskId)
+{
+    struct ListMenu *list = (void *) gTasks[listTaskId].data;
+
+    if (sListRowCache.items == list->template.items && sListRowCache.windowId == list->template.windowId)
+        sListRowCache.trusted = TRUE;
+}
+
+static bool8 ListRowCache_IsActive(struct ListMenu *list, u8 rowHeight)
+{
+    return gListMenuRowCache
+        && sListRowCache.trusted
+        && sListRowCache.items == list->template.items
+        && sListRowCache.windowId == list->template.windowId
+        && sListRowCache.rowHeight == rowHeight
+        && rowHeight <= ROW_CACHE_MAX_HEIGHT
+        && list->template.totalItems > list->template.maxShowed
+        && GetWindowAttribute(list->template.windowId, WINDOW_WIDTH) <= ROW_CACHE_MAX_WIDTH;
+}
+
+// Copies a row's pixel lines between the window's 4bpp tile buffer and a
+// cache slot.
+static void ListRowCache_CopyLines(struct ListMenu *list, struct ListRowCacheSlot *slot, u8 y, bool8 toWindow)
+{
+    u8 *tileData = GetWindowTileData(list->template.windowId);
+    u32 widthTiles = GetWindowAttribute(list->template.windowId, WINDOW_WIDTH);
+    u32 windowHeight = GetWindowAttribute(list->template.windowId, WINDOW_HEIGHT) * 8;
+    u32 line, tileX;
+
+    for (line = 0; line < sListRowCache.rowHeight && y + line < windowHeight; line++)
+    {
+        u8 *pixels = tileData + ((y + line) / 8) * widthTiles * TILE_SIZE_4BPP + ((y + line) % 8) * 4;
+
+        for (tileX = 0; tileX < widthTiles; tileX++, pixels += TILE_SIZE_4BPP)
+        {
+            if (toWindow)
+                memcpy(pixels, &slot->lines[line][tileX * 4], 4);
+            else
+                memcpy(&slot->lines[line][tileX * 4], pixels, 4);
+        }
+    }
+}
+
+static bool8 ListRowCache_Restore(struct ListMenu *list, u16 itemIndex, u8 y)
+{
+    struct ListRowCacheSlot *slot = &sListRowCache.slots[itemIndex % ROW_CACHE_SLOTS];
+
+    if (!slot->valid || slot->itemIndex != itemIndex)
+        return FALSE;
+    ListRowCache_CopyLines(list, slot, y, TRUE);
+    return TRUE;
+}
+
+static void ListRowCache_Store(struct ListMenu *list, u16 itemIndex, u8 y)
+{
+    struct ListRowCacheSlot *slot = &sListRowCache.slots[itemIndex % ROW_CACHE_SLOTS];
+
+    ListRowCache_CopyLines(list, slot, y, FALSE);
+    slot->itemIndex = itemIndex;
+    slot->valid = TRUE;
+}
+#endif
+
 static void ListMenuPrintEntries(struct ListMenu *list, u16 startIndex, u16 yOffset, u16 count)
 {
     s32 i;
     u8 x, y;
     u8 yMultiplier = GetFontAttribute(list->template.fontId, FONTATTR_MAX_LETTER_HEIGHT) + list->template.itemVerticalPadding;
+#ifdef PORTABLE
+    bool8 useRowCache = ListRowCache_IsActive(list, yMultiplier);
+#endif
 
     for (i = 0; i < count; i++)
     {
@@ -639,10 +776,21 @@ static void ListMenuPrintEntries(struct ListMenu *list, u16 startIndex, u16 yOff
             x = list->template.header_X;
 
         y = (yOffset + i) * yMultiplier + list->template.upText_Y;
+#ifdef PORTABLE
+        if (useRowCache && ListRowCache_Restore(list, startIndex, y))
+        {
+            startIndex++;
+            continue;
+        }
+#endif
         if (list->template.itemPrintFunc != NULL)
             list->template.itemPrintFunc(list->template.windowId, list->template.items[startIndex].id, y);
 
         ListMenuPrint(list, list->template.items[startIndex].name, x, y);
+#ifdef PORTABLE
+        if (useRowCache)
+            ListRowCache_Store(list, startIndex, y);
+#endif
         startIndex++;
     }
 }
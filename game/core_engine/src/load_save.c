@@ -1,6 +1,7 @@
 #include "global.h"
 #include "malloc.h"
 #include "berry_powder.h"
+#include "event_object_index.h"
 #include "item.h"
 #include "load_save.h"
 #include "main.h"
@@ -191,6 +192,9 @@ void LoadObjectEvents(void)
 
     for (i = 0; i < OBJECT_EVENTS_COUNT; i++)
         gObjectEvents[i] = gSaveBlock1Ptr->objectEvents[i];
+#ifdef PORTABLE
+    ObjectEventIndex_Reset();
+#endif
 }
 
 void CopyPartyAndObjectsToSave(void)
@@ -12,14 +12,22 @@
 #include "play_time.h"
 #include "random.h"
 #include "dma3.h"
+#include "field_camera.h"
+#include "frame_render.h"
 #include "gba/flash_internal.h"
 #include "load_save.h"
 #include "gpu_regs.h"
 #include "agb_flash.h"
 #include "sound.h"
 #include "battle.h"
+#include "battle_ai_script_commands.h"
+#include "battle_anim_profiler.h"
 #include "battle_controllers.h"
+#include "battle_replay.h"
+#include "battle_sim.h"
+#include "script_profiler.h"
 #include "text.h"
+#include "tileset_anims.h"
 #include "intro.h"
 #include "main.h"
 #include "trainer_hill.h"
@@ -102,6 +110,9 @@ void AgbMain()
     EnableVCountIntrAtLine150();
     InitRFU();
     RtcInit();
+#ifdef PORTABLE
+    FlashFile_InitFromEnv();
+#endif
     CheckForFlashMemory();
     InitMainCallbacks();
     InitMapMusic();
@@ -112,6 +123,19 @@ void AgbMain()
     ResetBgs();
     SetDefaultFontsPointer();
     InitHeap(gHeap, HEAP_SIZE);
+#ifdef PORTABLE
+    BattleAI_InitFromEnv();
+    BattleReplay_InitFromEnv();
+    BattleSim_InitFromEnv();
+    BattleAnimProfiler_InitFromEnv();
+    ScriptProfiler_InitFromEnv();
+    StringWidthCache_InitFromEnv();
+    FrameRender_InitFromEnv();
+    // Animated tiles can only stay out of VRAM while the renderer draws them.
+    TilesetAnims_SetZeroCopy(FrameRender_IsRunning());
+    // Likewise the field's BG1-3 can be drawn from the whole map.
+    FieldMapView_SetEnabled(FrameRender_IsRunning());
+#endif
 
     gSoftResetDisabled = FALSE;
 
@@ -313,6 +337,12 @@ void InitIntrHandlers(void)
 
 void SetVBlankCallback(IntrCallback callback)
 {
+#ifdef PORTABLE
+    // Leaving the field's VBlank, so put its BGs back in VRAM for whatever
+    // draws next.
+    if (callback != gMain.vblankCallback)
+        FieldMapView_SyncBgTilemaps();
+#endif
     gMain.vblankCallback = callback;
 }
 
@@ -349,6 +379,9 @@ static void VBlankIntr(void)
     if (gTrainerHillVBlankCounter && *gTrainerHillVBlankCounter < 0xFFFFFFFF)
         (*gTrainerHillVBlankCounter)++;
 
+#ifdef PORTABLE
+    FrameRender_ClearLineTables();
+#endif
     if (gMain.vblankCallback)
         gMain.vblankCallback();
 
@@ -356,6 +389,9 @@ static void VBlankIntr(void)
 
     CopyBufferedValuesToGpuRegs();
     ProcessDma3Requests();
+#ifdef PORTABLE
+    FrameRender_SubmitFrame();
+#endif
 
     gPcmDmaCounter = gSoundInfo.pcmDmaCounter;
 
@@ -7,6 +7,7 @@
 #include "cable_club.h"
 #include "clock.h"
 #include "event_data.h"
+#include "event_object_index.h"
 #include "event_object_movement.h"
 #include "event_scripts.h"
 #include "field_camera.h"
@@ -1420,6 +1421,9 @@ void CleanupOverworldWindowsAndTilemaps(void)
     TRY_FREE_AND_SET_NULL(gOverworldTilemapBuffer_Bg3);
     TRY_FREE_AND_SET_NULL(gOverworldTilemapBuffer_Bg2);
     TRY_FREE_AND_SET_NULL(gOverworldTilemapBuffer_Bg1);
+#ifdef PORTABLE
+    FieldMapView_Free();
+#endif
 }
 
 static void ResetSafariZoneFlag_(void)
@@ -1464,6 +1468,9 @@ void CB1_Overworld(void)
 
 static void OverworldBasic(void)
 {
+#ifdef PORTABLE
+    ObjectEventIndex_Sync();
+#endif
     ScriptContext_RunScript();
     RunTasks();
     AnimateSprites();
@@ -2924,6 +2931,9 @@ void ClearLinkPlayerObjectEvents(void)
 static void ZeroObjectEvent(struct ObjectEvent *objEvent)
 {
     memset(objEvent, 0, sizeof(struct ObjectEvent));
+#ifdef PORTABLE
+    ObjectEventIndex_Update(objEvent - gObjectEvents);
+#endif
 }
 
 // Note: Emerald reuses the direction and range variables during Link mode
@@ -2964,6 +2974,9 @@ static void InitLinkPlayerObjectEventPos(struct ObjectEvent *objEvent, s16 x, s1
     SetSpritePosToMapCoords(x, y, &objEvent->initialCoords.x, &objEvent->initialCoords.y);
     objEvent->initialCoords.x += 8;
     ObjectEventUpdateElevation(objEvent);
+#ifdef PORTABLE
+    ObjectEventIndex_Update(objEvent - gObjectEvents);
+#endif
 }
 
 static void UNUSED SetLinkPlayerObjectRange(u8 linkPlayerId, u8 dir)
@@ -2985,6 +2998,9 @@ static void UNUSED DestroyLinkPlayerObject(u8 linkPlayerId)
         DestroySprite(&gSprites[objEvent->spriteId]);
     linkPlayerObjEvent->active = 0;
     objEvent->active = 0;
+#ifdef PORTABLE
+    ObjectEventIndex_Update(objEventId);
+#endif
 }
 
 // Returns the spriteId corresponding to this player.
@@ -2790,23 +2790,16 @@ void CreateEnemyEventMon(void)
 static u16 CalculateBoxMonChecksum(struct BoxPokemon *boxMon)
 {
     u16 checksum = 0;
-    union PokemonSubstruct *substruct0 = GetSubstruct(boxMon, boxMon->personality, 0);
-    union PokemonSubstruct *substruct1 = GetSubstruct(boxMon, boxMon->personality, 1);
-    union PokemonSubstruct *substruct2 = GetSubstruct(boxMon, boxMon->personality, 2);
-    union PokemonSubstruct *substruct3 = GetSubstruct(boxMon, boxMon->personality, 3);
-    s32 i;
-
-    for (i = 0; i < (s32)ARRAY_COUNT(substruct0->raw); i++)
-        checksum += substruct0->raw[i];
-
-    for (i = 0; i < (s32)ARRAY_COUNT(substruct1->raw); i++)
-        checksum += substruct1->raw[i];
-
-    for (i = 0; i < (s32)ARRAY_COUNT(substruct2->raw); i++)
-        checksum += substruct2->raw[i];
+    union PokemonSubstruct *substructs = boxMon->secure.substructs;
+    s32 i, j;
 
-    for (i = 0; i < (s32)ARRAY_COUNT(substruct3->raw); i++)
-        checksum += substruct3->raw[i];
+    // The checksum is a plain sum over all four substructs, so their order
+    // (which depends on the personality) doesn't matter here.
+    for (i = 0; i < (s32)ARRAY_COUNT(boxMon->secure.substructs); i++)
+    {
+        for (j = 0; j < (s32)ARRAY_COUNT(substructs[i].raw); j++)
+            checksum += substructs[i].raw[j];
+    }
 
     return checksum;
 }
@@ -2822,24 +2815,37 @@ static u16 CalculateBoxMonChecksum(struct BoxPokemon *boxMon)
 
 void CalculateMonStats(struct Pokemon *mon)
 {
+    struct OpenBoxPokemon open;
     s32 oldMaxHP = GetMonData(mon, MON_DATA_MAX_HP, NULL);
     s32 currentHP = GetMonData(mon, MON_DATA_HP, NULL);
-    s32 hpIV = GetMonData(mon, MON_DATA_HP_IV, NULL);
-    s32 hpEV = GetMonData(mon, MON_DATA_HP_EV, NULL);
-    s32 attackIV = GetMonData(mon, MON_DATA_ATK_IV, NULL);
-    s32 attackEV = GetMonData(mon, MON_DATA_ATK_EV, NULL);
-    s32 defenseIV = GetMonData(mon, MON_DATA_DEF_IV, NULL);
-    s32 defenseEV = GetMonData(mon, MON_DATA_DEF_EV, NULL);
-    s32 speedIV = GetMonData(mon, MON_DATA_SPEED_IV, NULL);
-    s32 speedEV = GetMonData(mon, MON_DATA_SPEED_EV, NULL);
-    s32 spAttackIV = GetMonData(mon, MON_DATA_SPATK_IV, NULL);
-    s32 spAttackEV = GetMonData(mon, MON_DATA_SPATK_EV, NULL);
-    s32 spDefenseIV = GetMonData(mon, MON_DATA_SPDEF_IV, NULL);
-    s32 spDefenseEV = GetMonData(mon, MON_DATA_SPDEF_EV, NULL);
-    u16 species = GetMonData(mon, MON_DATA_SPECIES, NULL);
-    s32 level = GetLevelFromMonExp(mon);
+    s32 hpIV, hpEV;
+    s32 attackIV, attackEV;
+    s32 defenseIV, defenseEV;
+    s32 speedIV, speedEV;
+    s32 spAttackIV, spAttackEV;
+    s32 spDefenseIV, spDefenseEV;
+    u16 species;
+    s32 level;
     s32 newMaxHP;
 
+    // Read all of the encrypted fields with a single decrypt.
+    OpenBoxMon(&open, &mon->box);
+    hpIV = GetOpenBoxMonData(&open, MON_DATA_HP_IV, NULL);
+    hpEV = GetOpenBoxMonData(&open, MON_DATA_HP_EV, NULL);
+    attackIV = GetOpenBoxMonData(&open, MON_DATA_ATK_IV, NULL);
+    attackEV = GetOpenBoxMonData(&open, MON_DATA_ATK_EV, NULL);
+    defenseIV = GetOpenBoxMonData(&open, MON_DATA_DEF_IV, NULL);
+    defenseEV = GetOpenBoxMonData(&open, MON_DATA_DEF_EV, NULL);
+    speedIV = GetOpenBoxMonData(&open, MON_DATA_SPEED_IV, NULL);
+    speedEV = GetOpenBoxMonData(&open, MON_DATA_SPEED_EV, NULL);
+    spAttackIV = GetOpenBoxMonData(&open, MON_DATA_SPATK_IV, NULL);
+    spAttackEV = GetOpenBoxMonData(&open, MON_DATA_SPATK_EV, NULL);
+    spDefenseIV = GetOpenBoxMonData(&open, MON_DATA_SPDEF_IV, NULL);
+    spDefenseEV = GetOpenBoxMonData(&open, MON_DATA_SPDEF_EV, NULL);
+    species = GetOpenBoxMonData(&open, MON_DATA_SPECIES, NULL);
+    level = GetLevelFromOpenBoxMonExp(&open);
+    CloseBoxMon(&open);
+
     SetMonData(mon, MON_DATA_LEVEL, &level);
 
     if (species == SPECIES_SHEDINJA)
@@ -2904,20 +2910,25 @@ void BoxMonToMon(const struct BoxPokemon *src, struct Pokemon *dest)
 
 u8 GetLevelFromMonExp(struct Pokemon *mon)
 {
-    u16 species = GetMonData(mon, MON_DATA_SPECIES, NULL);
-    u32 exp = GetMonData(mon, MON_DATA_EXP, NULL);
-    s32 level = 1;
+    return GetLevelFromBoxMonExp(&mon->box);
+}
 
-    while (level <= MAX_LEVEL && gExperienceTables[gSpeciesInfo[species].growthRate][level] <= exp)
-        level++;
+u8 GetLevelFromBoxMonExp(struct BoxPokemon *boxMon)
+{
+    struct OpenBoxPokemon open;
+    u8 level;
 
-    return level - 1;
+    OpenBoxMon(&open, boxMon);
+    level = GetLevelFromOpenBoxMonExp(&open);
+    CloseBoxMon(&open);
+
+    return level;
 }
 
-u8 GetLevelFromBoxMonExp(struct BoxPokemon *boxMon)
+u8 GetLevelFromOpenBoxMonExp(struct OpenBoxPokemon *open)
 {
-    u16 species = GetBoxMonData(boxMon, MON_DATA_SPECIES, NULL);
-    u32 exp = GetBoxMonData(boxMon, MON_DATA_EXP, NULL);
+    u16 species = GetOpenBoxMonData(open, MON_DATA_SPECIES, NULL);
+    u32 exp = GetOpenBoxMonData(open, MON_DATA_EXP, NULL);
     s32 level = 1;
 
     while (level <= MAX_LEVEL && gExperienceTables[gSpeciesInfo[species].growthRate][level] <= exp)
@@ -3531,21 +3542,17 @@ void SetMultiuseSpriteTemplateToTrainerFront(u16 trainerPicId, u8 battlerPositio
 static void EncryptBoxMon(struct BoxPokemon *boxMon)
 {
     u32 i;
+    u32 key = boxMon->personality ^ boxMon->otId;
     for (i = 0; i < ARRAY_COUNT(boxMon->secure.raw); i++)
-    {
-        boxMon->secure.raw[i] ^= boxMon->personality;
-        boxMon->secure.raw[i] ^= boxMon->otId;
-    }
+        boxMon->secure.raw[i] ^= key;
 }
 
 static void DecryptBoxMon(struct BoxPokemon *boxMon)
 {
     u32 i;
+    u32 key = boxMon->otId ^ boxMon->personality;
     for (i = 0; i < ARRAY_COUNT(boxMon->secure.raw); i++)
-    {
-        boxMon->secure.raw[i] ^= boxMon->otId;
-        boxMon->secure.raw[i] ^= boxMon->personality;
-    }
+        boxMon->secure.raw[i] ^= key;
 }
 
 #define SUBSTRUCT_CASE(n, v1, v2, v3, v4)                               \
@@ -3710,30 +3717,38 @@ u32 GetMonData2(struct Pokemon *mon, s32 field) __attribute__((alias("GetMonData
  * number of arguments. */
 u32 GetBoxMonData3(struct BoxPokemon *boxMon, s32 field, u8 *data)
 {
-    s32 i;
-    u32 retVal = 0;
-    struct PokemonSubstruct0 *substruct0 = NULL;
-    struct PokemonSubstruct1 *substruct1 = NULL;
-    struct PokemonSubstruct2 *substruct2 = NULL;
-    struct PokemonSubstruct3 *substruct3 = NULL;
+    struct OpenBoxPokemon open = {0};
+    u32 retVal;
 
     // Any field greater than MON_DATA_ENCRYPT_SEPARATOR is encrypted and must be treated as such
     if (field > MON_DATA_ENCRYPT_SEPARATOR)
     {
-        substruct0 = &(GetSubstruct(boxMon, boxMon->personality, 0)->type0);
-        substruct1 = &(GetSubstruct(boxMon, boxMon->personality, 1)->type1);
-        substruct2 = &(GetSubstruct(boxMon, boxMon->personality, 2)->type2);
-        substruct3 = &(GetSubstruct(boxMon, boxMon->personality, 3)->type3);
+        OpenBoxMon(&open, boxMon);
+        retVal = GetOpenBoxMonData(&open, field, data);
+        CloseBoxMon(&open);
+    }
+    else
+    {
+        open.boxMon = boxMon;
+        retVal = GetOpenBoxMonData(&open, field, data);
+    }
+
+    return retVal;
+}
 
-        DecryptBoxMon(boxMon);
+u32 GetBoxMonData2(struct BoxPokemon *boxMon, s32 field) __attribute__((alias("GetBoxMonData3")));
 
-        if (CalculateBoxMonChecksum(boxMon) != boxMon->checksum)
-        {
-            boxMon->isBadEgg = TRUE;
-            boxMon->isEgg = TRUE;
-            substruct3->isEgg = TRUE;
-        }
-    }
+// Reads a field of a mon opened with OpenBoxMon. Unencrypted fields can also be
+// read from an OpenBoxPokemon that only has its boxMon set.
+u32 GetOpenBoxMonData(struct OpenBoxPokemon *open, s32 field, u8 *data)
+{
+    s32 i;
+    u32 retVal = 0;
+    struct BoxPokemon *boxMon = open->boxMon;
+    struct PokemonSubstruct0 *substruct0 = open->substruct0;
+    struct PokemonSubstruct1 *substruct1 = open->substruct1;
+    struct PokemonSubstruct2 *substruct2 = open->substruct2;
+    struct PokemonSubstruct3 *substruct3 = open->substruct3;
 
     switch (field)
     {
@@ -4058,14 +4073,9 @@ u32 GetBoxMonData3(struct BoxPokemon *boxMon, s32 field, u8 *data)
         break;
     }
 
-    if (field > MON_DATA_ENCRYPT_SEPARATOR)
-        EncryptBoxMon(boxMon);
-
     return retVal;
 }
 
-u32 GetBoxMonData2(struct BoxPokemon *boxMon, s32 field) __attribute__((alias("GetBoxMonData3")));
-
 #define SET8(lhs) (lhs) = *data
 #define SET16(lhs) (lhs) = data[0] + (data[1] << 8)
 #define SET32(lhs) (lhs) = data[0] + (data[1] << 8) + (data[2] << 16) + (data[3] << 24)
@@ -4116,30 +4126,38 @@ void SetMonData(struct Pokemon *mon, s32 field, const void *dataArg)
 
 void SetBoxMonData(struct BoxPokemon *boxMon, s32 field, const void *dataArg)
 {
-    const u8 *data = dataArg;
-
-    struct PokemonSubstruct0 *substruct0 = NULL;
-    struct PokemonSubstruct1 *substruct1 = NULL;
-    struct PokemonSubstruct2 *substruct2 = NULL;
-    struct PokemonSubstruct3 *substruct3 = NULL;
+    struct OpenBoxPokemon open = {0};
 
     if (field > MON_DATA_ENCRYPT_SEPARATOR)
     {
-        substruct0 = &(GetSubstruct(boxMon, boxMon->personality, 0)->type0);
-        substruct1 = &(GetSubstruct(boxMon, boxMon->personality, 1)->type1);
-        substruct2 = &(GetSubstruct(boxMon, boxMon->personality, 2)->type2);
-        substruct3 = &(GetSubstruct(boxMon, boxMon->personality, 3)->type3);
+        OpenBoxMon(&open, boxMon);
+        SetOpenBoxMonData(&open, field, dataArg);
+        CloseBoxMon(&open);
+    }
+    else
+    {
+        open.boxMon = boxMon;
+        SetOpenBoxMonData(&open, field, dataArg);
+    }
+}
 
-        DecryptBoxMon(boxMon);
+// Writes a field of a mon opened with OpenBoxMon. Writes to encrypted fields
+// of a bad egg are dropped, and the personality and OT ID must not be changed
+// while the mon is open since they are its encryption key.
+void SetOpenBoxMonData(struct OpenBoxPokemon *open, s32 field, const void *dataArg)
+{
+    const u8 *data = dataArg;
+    struct BoxPokemon *boxMon = open->boxMon;
+    struct PokemonSubstruct0 *substruct0 = open->substruct0;
+    struct PokemonSubstruct1 *substruct1 = open->substruct1;
+    struct PokemonSubstruct2 *substruct2 = open->substruct2;
+    struct PokemonSubstruct3 *substruct3 = open->substruct3;
 
-        if (CalculateBoxMonChecksum(boxMon) != boxMon->checksum)
-        {
-            boxMon->isBadEgg = TRUE;
-            boxMon->isEgg = TRUE;
-            substruct3->isEgg = TRUE;
-            EncryptBoxMon(boxMon);
+    if (field > MON_DATA_ENCRYPT_SEPARATOR)
+    {
+        if (open->isBadEgg)
             return;
-        }
+        open->modified = TRUE;
     }
 
     switch (field)
@@ -4377,14 +4395,43 @@ void SetBoxMonData(struct BoxPokemon *boxMon, s32 field, const void *dataArg)
     default:
         break;
     }
+}
 
-    if (field > MON_DATA_ENCRYPT_SEPARATOR)
+// Decrypts boxMon once so that any number of its fields can be accessed through
+// open, either with Get/SetOpenBoxMonData or directly through the substruct
+// pointers. Every OpenBoxMon must be paired with a CloseBoxMon before boxMon is
+// used in any other way.
+void OpenBoxMon(struct OpenBoxPokemon *open, struct BoxPokemon *boxMon)
+{
+    open->boxMon = boxMon;
+    open->substruct0 = &(GetSubstruct(boxMon, boxMon->personality, 0)->type0);
+    open->substruct1 = &(GetSubstruct(boxMon, boxMon->personality, 1)->type1);
+    open->substruct2 = &(GetSubstruct(boxMon, boxMon->personality, 2)->type2);
+    open->substruct3 = &(GetSubstruct(boxMon, boxMon->personality, 3)->type3);
+    open->isBadEgg = FALSE;
+    open->modified = FALSE;
+
+    DecryptBoxMon(boxMon);
+
+    if (CalculateBoxMonChecksum(boxMon) != boxMon->checksum)
     {
-        boxMon->checksum = CalculateBoxMonChecksum(boxMon);
-        EncryptBoxMon(boxMon);
+        boxMon->isBadEgg = TRUE;
+        boxMon->isEgg = TRUE;
+        open->substruct3->isEgg = TRUE;
+        open->isBadEgg = TRUE;
     }
 }
 
+// Re-encrypts a mon opened with OpenBoxMon, updating its checksum first if any
+// encrypted field was written.
+void CloseBoxMon(struct OpenBoxPokemon *open)
+{
+    if (open->modified)
+        open->boxMon->checksum = CalculateBoxMonChecksum(open->boxMon);
+    EncryptBoxMon(open->boxMon);
+    open->modified = FALSE;
+}
+
 void CopyMon(void *dest, void *src, size_t size)
 {
     memcpy(dest, src, size);
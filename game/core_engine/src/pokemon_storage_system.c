@@ -6886,27 +6886,31 @@ static void SetDisplayMonData(void *pokemon, u8 mode)
     else if (mode == MODE_BOX)
     {
         struct BoxPokemon *boxMon = (struct BoxPokemon *)pokemon;
+        struct OpenBoxPokemon open;
 
-        sStorage->displayMonSpecies = GetBoxMonData(pokemon, MON_DATA_SPECIES_OR_EGG);
+        // This runs every time the cursor moves, so decrypt the mon only once.
+        OpenBoxMon(&open, boxMon);
+        sStorage->displayMonSpecies = GetOpenBoxMonData(&open, MON_DATA_SPECIES_OR_EGG, NULL);
         if (sStorage->displayMonSpecies != SPECIES_NONE)
         {
-            u32 otId = GetBoxMonData(boxMon, MON_DATA_OT_ID);
-            sanityIsBadEgg = GetBoxMonData(boxMon, MON_DATA_SANITY_IS_BAD_EGG);
+            u32 otId = GetOpenBoxMonData(&open, MON_DATA_OT_ID, NULL);
+            sanityIsBadEgg = GetOpenBoxMonData(&open, MON_DATA_SANITY_IS_BAD_EGG, NULL);
             if (sanityIsBadEgg)
                 sStorage->displayMonIsEgg = TRUE;
             else
-                sStorage->displayMonIsEgg = GetBoxMonData(boxMon, MON_DATA_IS_EGG);
+                sStorage->displayMonIsEgg = GetOpenBoxMonData(&open, MON_DATA_IS_EGG, NULL);
 
 
-            GetBoxMonData(boxMon, MON_DATA_NICKNAME, sStorage->displayMonName);
+            GetOpenBoxMonData(&open, MON_DATA_NICKNAME, sStorage->displayMonName);
             StringGet_Nickname(sStorage->displayMonName);
-            sStorage->displayMonLevel = GetLevelFromBoxMonExp(boxMon);
-            sStorage->displayMonMarkings = GetBoxMonData(boxMon, MON_DATA_MARKINGS);
-            sStorage->displayMonPersonality = GetBoxMonData(boxMon, MON_DATA_PERSONALITY);
+            sStorage->displayMonLevel = GetLevelFromOpenBoxMonExp(&open);
+            sStorage->displayMonMarkings = GetOpenBoxMonData(&open, MON_DATA_MARKINGS, NULL);
+            sStorage->displayMonPersonality = GetOpenBoxMonData(&open, MON_DATA_PERSONALITY, NULL);
             sStorage->displayMonPalette = GetMonSpritePalFromSpeciesAndPersonality(sStorage->displayMonSpecies, otId, sStorage->displayMonPersonality);
             gender = GetGenderFromSpeciesAndPersonality(sStorage->displayMonSpecies, sStorage->displayMonPersonality);
-            sStorage->displayMonItemId = GetBoxMonData(boxMon, MON_DATA_HELD_ITEM);
+            sStorage->displayMonItemId = GetOpenBoxMonData(&open, MON_DATA_HELD_ITEM, NULL);
         }
+        CloseBoxMon(&open);
     }
     else
     {
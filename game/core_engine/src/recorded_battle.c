@@ -2,6 +2,7 @@
 #include "battle.h"
 #include "battle_anim.h"
 #include "battle_controllers.h"
+#include "battle_replay.h"
 #include "recorded_battle.h"
 #include "main.h"
 #include "pokemon.h"
@@ -95,6 +96,9 @@ EWRAM_DATA static u8 sBattleOutcome = 0;
 
 static u8 sRecordMixFriendLanguage;
 static u8 sApprenticeLanguage;
+#ifdef PORTABLE
+static bool8 sPaused;
+#endif
 
 static u8 GetNextRecordedDataByte(u8 *, u8 *, u8 *);
 static bool32 CopyRecordedBattleFromSave(struct RecordedBattleSave *);
@@ -188,6 +192,13 @@ void RecordedBattle_SetTrainerInfo(void)
 
 void RecordedBattle_SetBattlerAction(u8 battlerId, u8 action)
 {
+#ifdef PORTABLE
+    if (sPaused)
+        return;
+    if (sRecordMode != B_RECORD_MODE_PLAYBACK)
+        BattleReplay_RecordAction(battlerId, action);
+#endif
+
     if (sBattlerRecordSizes[battlerId] < BATTLER_RECORD_SIZE && sRecordMode != B_RECORD_MODE_PLAYBACK)
         sBattleRecords[battlerId][sBattlerRecordSizes[battlerId]++] = action;
 }
@@ -196,6 +207,13 @@ void RecordedBattle_ClearBattlerAction(u8 battlerId, u8 bytesToClear)
 {
     s32 i;
 
+#ifdef PORTABLE
+    if (sPaused)
+        return;
+    if (sRecordMode != B_RECORD_MODE_PLAYBACK)
+        BattleReplay_ClearActions(battlerId, bytesToClear);
+#endif
+
     for (i = 0; i < bytesToClear; i++)
     {
         sBattlerRecordSizes[battlerId]--;
@@ -205,6 +223,15 @@ void RecordedBattle_ClearBattlerAction(u8 battlerId, u8 bytesToClear)
     }
 }
 
+#ifdef PORTABLE
+// Actions chosen while paused aren't recorded, or cleared, such as the ones
+// in the battles the lookahead AI plays out on a copy of the battle.
+void RecordedBattle_SetPaused(bool8 paused)
+{
+    sPaused = paused;
+}
+#endif
+
 u8 RecordedBattle_GetBattlerAction(u8 battlerId)
 {
     // Trying to read past array or invalid action byte, battle is over.
@@ -295,7 +295,15 @@ static u8 HandleReplaceSectorAndVerify(u16 sectorId, const struct SaveSectorLoca
 {
     u8 status = SAVE_STATUS_OK;
 
+#ifdef PORTABLE
+    // HandleReplaceSector programs the sector a byte at a time. Stage all of
+    // it and commit it to the save file once.
+    FlashFile_BeginBatch();
     HandleReplaceSector(sectorId - 1, locations);
+    gDamagedSaveSectors |= FlashFile_EndBatch();
+#else
+    HandleReplaceSector(sectorId - 1, locations);
+#endif
 
     if (gDamagedSaveSectors)
     {
@@ -672,6 +680,37 @@ static bool8 ReadFlashSector(u8 sectorId, struct SaveSector *sector)
     return TRUE;
 }
 
+#ifdef PORTABLE
+typedef u32 ChecksumVector __attribute__((vector_size(16)));
+
+// Same sum as below, but four words at a time. Each lane wraps independently,
+// which gives the same 32-bit total as adding the words one by one.
+static u16 CalculateChecksum(void *data, u16 size)
+{
+    u32 i;
+    u32 numWords = size / 4;
+    u32 checksum = 0;
+    const u8 *src = data;
+    ChecksumVector sums = {0};
+    ChecksumVector words;
+    u32 word;
+
+    for (i = 0; i + 4 <= numWords; i += 4)
+    {
+        memcpy(&words, src + i * 4, sizeof(words));
+        sums += words;
+    }
+
+    checksum = sums[0] + sums[1] + sums[2] + sums[3];
+    for (; i < numWords; i++)
+    {
+        memcpy(&word, src + i * 4, sizeof(word));
+        checksum += word;
+    }
+
+    return ((checksum >> 16) + checksum);
+}
+#else
 static u16 CalculateChecksum(void *data, u16 size)
 {
     u16 i;
@@ -685,6 +724,7 @@ static u16 CalculateChecksum(void *data, u16 size)
 
     return ((checksum >> 16) + checksum);
 }
+#endif // PORTABLE
 
 static void UpdateSaveAddresses(void)
 {
@@ -713,6 +753,10 @@ u8 HandleSavingData(u8 saveType)
 
     gTrainerHillVBlankCounter = NULL;
     UpdateSaveAddresses();
+#ifdef PORTABLE
+    // Stage every sector this save writes and commit them to the save file at once.
+    FlashFile_BeginBatch();
+#endif
     switch (saveType)
     {
     case SAVE_HALL_OF_FAME_ERASE_BEFORE:
@@ -759,6 +803,11 @@ u8 HandleSavingData(u8 saveType)
         WriteSaveSectorOrSlot(FULL_SAVE_SLOT, gRamSaveSectorLocations);
         break;
     }
+#ifdef PORTABLE
+    // Sectors that didn't reach the save file are damaged, as if the write
+    // had failed on the chip.
+    gDamagedSaveSectors |= FlashFile_EndBatch();
+#endif
     gTrainerHillVBlankCounter = backupVar;
     return 0;
 }
@@ -848,6 +897,10 @@ bool8 WriteSaveBlock1Sector(void)
 {
     u8 finished = FALSE;
     u16 sectorId = ++gIncrementalSectorId; // Because WriteSaveBlock2 will have been called prior, this will be SECTOR_ID_SAVEBLOCK1_START
+#ifdef PORTABLE
+    // Commit the sector and the next one's signature byte together.
+    FlashFile_BeginBatch();
+#endif
     if (sectorId <= SECTOR_ID_SAVEBLOCK1_END)
     {
         // Write a single sector of SaveBlock1
@@ -862,6 +915,9 @@ bool8 WriteSaveBlock1Sector(void)
         WriteSectorSignatureByte(sectorId, gRamSaveSectorLocations);
         finished = TRUE;
     }
+#ifdef PORTABLE
+    gDamagedSaveSectors |= FlashFile_EndBatch();
+#endif
 
     if (gDamagedSaveSectors)
         DoSaveFailedScreen(SAVE_LINK);
@@ -12,6 +12,9 @@
 #include "save.h"
 #include "starter_choose.h"
 #include "gba/flash_internal.h"
+#ifdef PORTABLE
+#include "agb_flash.h"
+#endif
 #include "text_window.h"
 #include "constants/rgb.h"
 
@@ -379,10 +382,18 @@ static bool8 WipeSector(u16 sector)
     // Attempt to wipe sector with an arbitrary attempt limit of 130
     for (i = 0; failed && i < 130; i++)
     {
+#ifdef PORTABLE
+        // Write the wiped sector to the save file once, not once per byte.
+        FlashFile_BeginBatch();
+#endif
         for (j = 0; j < SECTOR_SIZE; j++)
             ProgramFlashByte(sector, j, 0);
 
+#ifdef PORTABLE
+        failed = FlashFile_EndBatch() != 0 || VerifySectorWipe(sector);
+#else
         failed = VerifySectorWipe(sector);
+#endif
     }
 
     return failed;
@@ -1,6 +1,7 @@
 #include "global.h"
 #include "battle.h"
 #include "data.h"
+#include "frame_render.h"
 #include "task.h"
 #include "trig.h"
 #include "scanline_effect.h"
@@ -22,6 +23,9 @@ void ScanlineEffect_Stop(void)
 {
     gScanlineEffect.state = 0;
     DmaStop(0);
+#ifdef PORTABLE
+    FrameRender_ClearLineTable(FRAME_LINE_TABLE_HBLANK_DMA);
+#endif
     if (gScanlineEffect.waveTaskId != TASK_NONE)
     {
         DestroyTask(gScanlineEffect.waveTaskId);
@@ -88,6 +92,15 @@ void ScanlineEffect_InitHBlankDmaTransfer(void)
         // The HBlank DMA transfers do not occurr during VBlank, so the transfer
         // will begin on the HBlank after the first scanline
         DmaSet(0, gScanlineEffect.dmaSrcBuffers[gScanlineEffect.srcBuffer], gScanlineEffect.dmaDest, gScanlineEffect.dmaControl);
+#ifdef PORTABLE
+        // Also hand the renderer the values the DMA transfers from the second
+        // scanline on.
+        FrameRender_SetLineTable(FRAME_LINE_TABLE_HBLANK_DMA,
+                                 gScanlineEffect.dmaSrcBuffers[gScanlineEffect.srcBuffer],
+                                 gScanlineEffect.dmaDest,
+                                 1,
+                                 (gScanlineEffect.dmaControl & (DMA_32BIT << 16)) != 0);
+#endif
         // Manually set the reg for the first scanline
         gScanlineEffect.setFirstScanlineReg();
         // Swap current buffer
@@ -39,6 +39,7 @@
 #include "script_menu.h"
 #include "script_movement.h"
 #include "script_pokemon_util.h"
+#include "script_profiler.h"
 #include "shop.h"
 #include "slot_machine.h"
 #include "sound.h"
@@ -119,7 +120,8 @@ bool8 ScrCmd_special(struct ScriptContext *ctx)
 {
     u16 index = ScriptReadHalfword(ctx);
 
-    gSpecials[index]();
+    gSpecials[ScriptProfiler_BeginSpecial(index)]();
+    ScriptProfiler_EndSpecial();
     return FALSE;
 }
 
@@ -127,7 +129,8 @@ bool8 ScrCmd_specialvar(struct ScriptContext *ctx)
 {
     u16 *var = GetVarPointer(ScriptReadHalfword(ctx));
 
-    *var = gSpecials[ScriptReadHalfword(ctx)]();
+    *var = gSpecials[ScriptProfiler_BeginSpecial(ScriptReadHalfword(ctx))]();
+    ScriptProfiler_EndSpecial();
     return FALSE;
 }
 
@@ -141,6 +144,7 @@ bool8 ScrCmd_callnative(struct ScriptContext *ctx)
 
 bool8 ScrCmd_waitstate(struct ScriptContext *ctx)
 {
+    ScriptProfiler_BeginStall(ctx, SCRIPT_STALL_WAITSTATE);
     ScriptContext_Stop();
     return TRUE;
 }
@@ -1024,6 +1028,7 @@ bool8 ScrCmd_waitmovement(struct ScriptContext *ctx)
         sMovingNpcId = localId;
     sMovingNpcMapGroup = gSaveBlock1Ptr->location.mapGroup;
     sMovingNpcMapNum = gSaveBlock1Ptr->location.mapNum;
+    ScriptProfiler_BeginStall(ctx, SCRIPT_STALL_WAITMOVEMENT);
     SetupNativeScript(ctx, WaitForMovementFinish);
     return TRUE;
 }
@@ -1040,6 +1045,7 @@ bool8 ScrCmd_waitmovementat(struct ScriptContext *ctx)
     mapNum = ScriptReadByte(ctx);
     sMovingNpcMapGroup = mapGroup;
     sMovingNpcMapNum = mapNum;
+    ScriptProfiler_BeginStall(ctx, SCRIPT_STALL_WAITMOVEMENT);
     SetupNativeScript(ctx, WaitForMovementFinish);
     return TRUE;
 }
@@ -1,5 +1,10 @@
+#ifdef PORTABLE
+#include <string.h>
+#endif
 #include "global.h"
 #include "script.h"
+#include "script_profiler.h"
+#include "script_vm.h"
 #include "event_data.h"
 #include "mystery_gift.h"
 #include "util.h"
@@ -89,6 +94,11 @@ bool8 RunScriptCommand(struct ScriptContext *ctx)
         ctx->mode = SCRIPT_MODE_BYTECODE;
         // fallthrough
     case SCRIPT_MODE_BYTECODE:
+#ifdef PORTABLE
+    {
+        const struct ScriptInsn *insn = NULL;
+        bool8 useVM = gScriptVM && ctx->cmdTable == gScriptCmdTable;
+#endif
         while (1)
         {
             u8 cmdCode;
@@ -106,6 +116,23 @@ bool8 RunScriptCommand(struct ScriptContext *ctx)
                     asm("svc 2"); // HALT
             }
 
+#ifdef PORTABLE
+            // Follow the decoded stream while the script runs straight on or
+            // takes a jump it has taken before.
+            if (useVM)
+            {
+                insn = ScriptVM_Next(ctx, insn);
+                if (insn != NULL)
+                {
+                    ScriptProfiler_Command(ctx, insn->pc, insn->opcode);
+                    ctx->scriptPtr = insn->pc + 1;
+                    if (insn->func(ctx) == TRUE)
+                        return TRUE;
+                    continue;
+                }
+            }
+#endif
+
             cmdCode = *(ctx->scriptPtr);
             ctx->scriptPtr++;
             func = &ctx->cmdTable[cmdCode];
@@ -115,10 +142,14 @@ bool8 RunScriptCommand(struct ScriptContext *ctx)
                 ctx->mode = SCRIPT_MODE_STOPPED;
                 return FALSE;
             }
+            ScriptProfiler_Command(ctx, ctx->scriptPtr - 1, cmdCode);
 
             if ((*func)(ctx) == TRUE)
                 return TRUE;
         }
+#ifdef PORTABLE
+    }
+#endif
     }
 
     return TRUE;
@@ -163,6 +194,26 @@ void ScriptReturn(struct ScriptContext *ctx)
     ctx->scriptPtr = ScriptPop(ctx);
 }
 
+#ifdef PORTABLE
+// Operands are unaligned little-endian, like the host.
+u16 ScriptReadHalfword(struct ScriptContext *ctx)
+{
+    u16 value;
+
+    memcpy(&value, ctx->scriptPtr, sizeof(value));
+    ctx->scriptPtr += sizeof(value);
+    return value;
+}
+
+u32 ScriptReadWord(struct ScriptContext *ctx)
+{
+    u32 value;
+
+    memcpy(&value, ctx->scriptPtr, sizeof(value));
+    ctx->scriptPtr += sizeof(value);
+    return value;
+}
+#else
 u16 ScriptReadHalfword(struct ScriptContext *ctx)
 {
     u16 value = *(ctx->scriptPtr++);
@@ -178,6 +229,7 @@ u32 ScriptReadWord(struct ScriptContext *ctx)
     u32 value3 = *(ctx->scriptPtr++);
     return (((((value3 << 8) + value2) << 8) + value1) << 8) + value0;
 }
+#endif
 
 void LockPlayerFieldControls(void)
 {
@@ -209,6 +261,7 @@ bool8 ScriptContext_IsEnabled(void)
 // Re-initializes the global script context to zero.
 void ScriptContext_Init(void)
 {
+    ScriptProfiler_EndScript();
     InitScriptContext(&sGlobalScriptContext, gScriptCmdTable, gScriptCmdTableEnd);
     sGlobalScriptContextStatus = CONTEXT_SHUTDOWN;
 }
@@ -227,12 +280,16 @@ bool8 ScriptContext_RunScript(void)
 
     LockPlayerFieldControls();
 
+    ScriptProfiler_BeginRun();
     if (!RunScriptCommand(&sGlobalScriptContext))
     {
+        ScriptProfiler_EndRun();
+        ScriptProfiler_EndScript();
         sGlobalScriptContextStatus = CONTEXT_SHUTDOWN;
         UnlockPlayerFieldControls();
         return FALSE;
     }
+    ScriptProfiler_EndRun();
 
     return TRUE;
 }
@@ -242,6 +299,7 @@ void ScriptContext_SetupScript(const u8 *ptr)
 {
     InitScriptContext(&sGlobalScriptContext, gScriptCmdTable, gScriptCmdTableEnd);
     SetupBytecodeScript(&sGlobalScriptContext, ptr);
+    ScriptProfiler_BeginScript(ptr);
     LockPlayerFieldControls();
     sGlobalScriptContextStatus = CONTEXT_RUNNING;
 }
@@ -266,7 +324,9 @@ void RunScriptImmediately(const u8 *ptr)
 {
     InitScriptContext(&sImmediateScriptContext, gScriptCmdTable, gScriptCmdTableEnd);
     SetupBytecodeScript(&sImmediateScriptContext, ptr);
+    ScriptProfiler_BeginImmediate(ptr);
     while (RunScriptCommand(&sImmediateScriptContext) == TRUE);
+    ScriptProfiler_EndImmediate();
 }
 
 u8 *MapHeaderGetScriptTable(u8 tag)
@@ -0,0 +1,467 @@
+#ifdef PORTABLE
+#define _GNU_SOURCE
+#include <dlfcn.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#endif
+
+#include "global.h"
+#include "main.h"
+#include "script.h"
+#include "script_profiler.h"
+
+#ifdef PORTABLE
+
+// While enabled, every event script is measured from the point it is set up
+// (ScriptContext_SetupScript or RunScriptImmediately) until it ends. Each one
+// records frames taken, commands run and host time spent in RunScriptCommand.
+// The time is inclusive, so it counts immediate scripts and specials called
+// from inside it. Specials are timed per index. Each opcode run is counted.
+// A waitstate or waitmovement that holds the script for at least the stall
+// threshold is logged with the command's location. Scripts and specials are
+// named by symbol, or by module+offset, which resolves against the build's
+// symbol map.
+
+#define MAX_PROFILED_SCRIPTS  2048 // power of two
+#define MAX_PROFILED_SPECIALS 1024
+#define MAX_LOGGED_STALLS     256
+
+struct ScriptProfile
+{
+    const u8 *script;
+    u32 runs;
+    u32 frames;
+    u32 commands;
+    u32 stallFrames;
+    u64 totalNs;
+    u64 maxRunNs;
+};
+
+struct SpecialProfile
+{
+    const void *func;
+    u32 calls;
+    u64 totalNs;
+    u64 maxNs;
+    const u8 *maxScript; // script that made the longest call
+};
+
+struct ScriptStall
+{
+    const u8 *script;
+    const u8 *pc;
+    u8 kind;
+    u32 frames;
+};
+
+extern u16 (*const gSpecials[])(void);
+
+static const char *const sStallKindNames[SCRIPT_STALL_KIND_COUNT] =
+{
+    [SCRIPT_STALL_WAITSTATE]    = "waitstate",
+    [SCRIPT_STALL_WAITMOVEMENT] = "waitmovement",
+};
+
+static bool8 sEnabled;
+static const char *sReportPath;
+static u32 sReportTop = SCRIPT_PROFILE_DEFAULT_TOP;
+static u32 sStallThreshold = SCRIPT_PROFILE_DEFAULT_STALL_FRAMES;
+static struct ScriptProfile sScripts[MAX_PROFILED_SCRIPTS];
+static struct SpecialProfile sSpecials[MAX_PROFILED_SPECIALS];
+static u32 sOpcodeCounts[256];
+static struct ScriptStall sStalls[MAX_LOGGED_STALLS];
+static u32 sNumStalls; // total logged; the log keeps the latest
+
+// The global context's script, and the one currently running commands
+static struct ScriptProfile *sGlobal;
+static struct ScriptProfile *sActive;
+static u32 sGlobalStartFrame;
+static u64 sGlobalRunNs;
+static u64 sRunStart;
+
+static bool8 sInImmediate;
+static struct ScriptProfile *sSavedActive;
+static u64 sImmediateStart;
+
+static bool8 sInSpecial;
+static u16 sSpecialIndex;
+static u64 sSpecialStart;
+
+static const u8 *sLastPc;
+static struct ScriptContext *sStallCtx;
+static const u8 *sStallPc;
+static u8 sStallKind;
+static u32 sStallStartFrame;
+
+static u64 GetTimeNs(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (u64)now.tv_sec * 1000000000 + now.tv_nsec;
+}
+
+static struct ScriptProfile *GetScriptProfile(const u8 *script)
+{
+    u32 hash = (u32)((uintptr_t)script * 0x9E3779B1);
+    u32 i, slot;
+
+    for (i = 0; i < MAX_PROFILED_SCRIPTS; i++)
+    {
+        slot = (hash + i) & (MAX_PROFILED_SCRIPTS - 1);
+        if (sScripts[slot].script == script)
+            return &sScripts[slot];
+        if (sScripts[slot].script == NULL)
+        {
+            sScripts[slot].script = script;
+            return &sScripts[slot];
+        }
+    }
+    return NULL;
+}
+
+static void EndStall(void)
+{
+    u32 frames;
+
+    if (sStallCtx == NULL)
+        return;
+
+    frames = gMain.vblankCounter1 - sStallStartFrame;
+    if (sGlobal != NULL)
+        sGlobal->stallFrames += frames;
+    if (frames >= sStallThreshold)
+    {
+        struct ScriptStall *stall = &sStalls[sNumStalls++ % MAX_LOGGED_STALLS];
+
+        stall->script = sGlobal != NULL ? sGlobal->script : NULL;
+        stall->pc = sStallPc;
+        stall->kind = sStallKind;
+        stall->frames = frames;
+    }
+    sStallCtx = NULL;
+}
+
+void ScriptProfiler_Enable(bool8 enable)
+{
+    if (!enable)
+        ScriptProfiler_EndScript();
+    sEnabled = enable;
+}
+
+void ScriptProfiler_Reset(void)
+{
+    sGlobal = NULL;
+    sActive = NULL;
+    sInImmediate = FALSE;
+    sInSpecial = FALSE;
+    sStallCtx = NULL;
+    sNumStalls = 0;
+    memset(sScripts, 0, sizeof(sScripts));
+    memset(sSpecials, 0, sizeof(sSpecials));
+    memset(sOpcodeCounts, 0, sizeof(sOpcodeCounts));
+}
+
+void ScriptProfiler_SetStallThreshold(u32 frames)
+{
+    sStallThreshold = frames;
+}
+
+void ScriptProfiler_BeginScript(const u8 *script)
+{
+    if (!sEnabled)
+        return;
+
+    ScriptProfiler_EndScript();
+    sGlobal = GetScriptProfile(script);
+    if (sGlobal == NULL)
+        return;
+    sGlobal->runs++;
+    sGlobalStartFrame = gMain.vblankCounter1;
+    sGlobalRunNs = 0;
+    if (sInImmediate)
+        sSavedActive = sGlobal;
+    else
+        sActive = sGlobal;
+}
+
+void ScriptProfiler_EndScript(void)
+{
+    if (sGlobal == NULL)
+        return;
+
+    EndStall();
+    sGlobal->frames += gMain.vblankCounter1 - sGlobalStartFrame;
+    sGlobal->maxRunNs = max(sGlobal->maxRunNs, sGlobalRunNs);
+    if (sInImmediate && sSavedActive == sGlobal)
+        sSavedActive = NULL;
+    else if (sActive == sGlobal)
+        sActive = NULL;
+    sGlobal = NULL;
+}
+
+// Around each frame's RunScriptCommand on the global context
+void ScriptProfiler_BeginRun(void)
+{
+    if (sGlobal != NULL)
+        sRunStart = GetTimeNs();
+}
+
+void ScriptProfiler_EndRun(void)
+{
+    u64 ns;
+
+    if (sGlobal == NULL)
+        return;
+
+    ns = GetTimeNs() - sRunStart;
+    sGlobal->totalNs += ns;
+    sGlobalRunNs += ns;
+}
+
+// Immediate scripts can run from inside a global script's command, so the
+// global one picks up their commands again when they finish.
+void ScriptProfiler_BeginImmediate(const u8 *script)
+{
+    struct ScriptProfile *profile;
+
+    if (!sEnabled || sInImmediate)
+        return;
+
+    profile = GetScriptProfile(script);
+    if (profile == NULL)
+        return;
+    profile->runs++;
+    sInImmediate = TRUE;
+    sSavedActive = sActive;
+    sActive = profile;
+    sImmediateStart = GetTimeNs();
+}
+
+void ScriptProfiler_EndImmediate(void)
+{
+    u64 ns;
+
+    if (!sInImmediate)
+        return;
+
+    ns = GetTimeNs() - sImmediateStart;
+    sActive->totalNs += ns;
+    sActive->maxRunNs = max(sActive->maxRunNs, ns);
+    sActive = sSavedActive;
+    sInImmediate = FALSE;
+}
+
+void ScriptProfiler_Command(struct ScriptContext *ctx, const u8 *pc, u8 opcode)
+{
+    if (!sEnabled)
+        return;
+
+    // The script moving on is what ends a wait.
+    if (ctx == sStallCtx)
+        EndStall();
+    sLastPc = pc;
+    sOpcodeCounts[opcode]++;
+    if (sActive != NULL)
+        sActive->commands++;
+}
+
+u16 ScriptProfiler_BeginSpecial(u16 index)
+{
+    if (!sEnabled || index >= MAX_PROFILED_SPECIALS)
+        return index;
+
+    sSpecials[index].func = gSpecials[index];
+    sInSpecial = TRUE;
+    sSpecialIndex = index;
+    sSpecialStart = GetTimeNs();
+    return index;
+}
+
+void ScriptProfiler_EndSpecial(void)
+{
+    struct SpecialProfile *special;
+    u64 ns;
+
+    if (!sInSpecial)
+        return;
+
+    sInSpecial = FALSE;
+    ns = GetTimeNs() - sSpecialStart;
+    special = &sSpecials[sSpecialIndex];
+    special->calls++;
+    special->totalNs += ns;
+    if (ns > special->maxNs)
+    {
+        special->maxNs = ns;
+        special->maxScript = sActive != NULL ? sActive->script : NULL;
+    }
+}
+
+void ScriptProfiler_BeginStall(struct ScriptContext *ctx, u8 kind)
+{
+    if (!sEnabled || sGlobal == NULL)
+        return;
+
+    sStallCtx = ctx;
+    sStallPc = sLastPc;
+    sStallKind = kind;
+    sStallStartFrame = gMain.vblankCounter1;
+}
+
+// Names a script location or special: its symbol plus offset when the
+// dynamic linker knows it, otherwise module+offset, which addr2line or the
+// symbol map can resolve.
+static void GetSymbolName(const void *addr, char *dst, size_t size)
+{
+#if defined(__linux__) || defined(__APPLE__)
+    Dl_info info;
+
+    if (addr != NULL && dladdr(addr, &info) != 0)
+    {
+        if (info.dli_sname != NULL && info.dli_saddr == addr)
+            snprintf(dst, size, "%s", info.dli_sname);
+        else if (info.dli_sname != NULL)
+            snprintf(dst, size, "%s+0x%lx", info.dli_sname, (unsigned long)((uintptr_t)addr - (uintptr_t)info.dli_saddr));
+        else
+            snprintf(dst, size, "%s+0x%lx", info.dli_fname, (unsigned long)((uintptr_t)addr - (uintptr_t)info.dli_fbase));
+        return;
+    }
+#endif
+    snprintf(dst, size, "%p", addr);
+}
+
+static int CompareScriptTime(const void *a, const void *b)
+{
+    const struct ScriptProfile *x = *(const struct ScriptProfile *const *)a;
+    const struct ScriptProfile *y = *(const struct ScriptProfile *const *)b;
+
+    return (x->totalNs < y->totalNs) - (x->totalNs > y->totalNs);
+}
+
+static int CompareSpecialTime(const void *a, const void *b)
+{
+    const struct SpecialProfile *x = &sSpecials[*(const u16 *)a];
+    const struct SpecialProfile *y = &sSpecials[*(const u16 *)b];
+
+    return (x->totalNs < y->totalNs) - (x->totalNs > y->totalNs);
+}
+
+static int CompareOpcodeCount(const void *a, const void *b)
+{
+    u32 x = sOpcodeCounts[*(const u8 *)a];
+    u32 y = sOpcodeCounts[*(const u8 *)b];
+
+    return (x < y) - (x > y);
+}
+
+bool8 ScriptProfiler_WriteReport(const char *path, u32 topCount)
+{
+    static const struct ScriptProfile *scripts[MAX_PROFILED_SCRIPTS];
+    static u16 specials[MAX_PROFILED_SPECIALS];
+    u8 opcodes[256];
+    char name[256], where[256];
+    u32 numScripts = 0, numSpecials = 0, numOpcodes = 0;
+    u32 i, first;
+    FILE *file;
+
+    for (i = 0; i < MAX_PROFILED_SCRIPTS; i++)
+    {
+        if (sScripts[i].script != NULL && sScripts[i].runs != 0)
+            scripts[numScripts++] = &sScripts[i];
+    }
+    for (i = 0; i < MAX_PROFILED_SPECIALS; i++)
+    {
+        if (sSpecials[i].calls != 0)
+            specials[numSpecials++] = i;
+    }
+    for (i = 0; i < ARRAY_COUNT(sOpcodeCounts); i++)
+    {
+        if (sOpcodeCounts[i] != 0)
+            opcodes[numOpcodes++] = i;
+    }
+    qsort(scripts, numScripts, sizeof(scripts[0]), CompareScriptTime);
+    qsort(specials, numSpecials, sizeof(specials[0]), CompareSpecialTime);
+    qsort(opcodes, numOpcodes, sizeof(opcodes[0]), CompareOpcodeCount);
+
+    file = fopen(path, "w");
+    if (file == NULL)
+        return FALSE;
+
+    fprintf(file, "Top scripts by host time (%u profiled)\n", numScripts);
+    fprintf(file, "%-48s %6s %8s %9s %12s %12s %8s\n", "script", "runs", "frames", "commands", "total_us", "max_run_us", "stalled");
+    for (i = 0; i < numScripts && i < topCount; i++)
+    {
+        GetSymbolName(scripts[i]->script, name, sizeof(name));
+        fprintf(file, "%-48s %6u %8u %9u %12llu %12llu %8u\n",
+                name, scripts[i]->runs, scripts[i]->frames, scripts[i]->commands,
+                (unsigned long long)(scripts[i]->totalNs / 1000), (unsigned long long)(scripts[i]->maxRunNs / 1000),
+                scripts[i]->stallFrames);
+    }
+
+    fprintf(file, "\nTop specials by host time (%u called)\n", numSpecials);
+    fprintf(file, "%-40s %5s %7s %12s %10s  %s\n", "special", "index", "calls", "total_us", "max_us", "slowest_from");
+    for (i = 0; i < numSpecials && i < topCount; i++)
+    {
+        const struct SpecialProfile *special = &sSpecials[specials[i]];
+
+        GetSymbolName(special->func, name, sizeof(name));
+        GetSymbolName(special->maxScript, where, sizeof(where));
+        fprintf(file, "%-40s %5u %7u %12llu %10llu  %s\n",
+                name, specials[i], special->calls,
+                (unsigned long long)(special->totalNs / 1000), (unsigned long long)(special->maxNs / 1000), where);
+    }
+
+    fprintf(file, "\nOpcode counts\n");
+    for (i = 0; i < numOpcodes; i++)
+        fprintf(file, "0x%02x %10u\n", opcodes[i], sOpcodeCounts[opcodes[i]]);
+
+    fprintf(file, "\nStalls of %u frames or more (%u)\n", sStallThreshold, sNumStalls);
+    first = sNumStalls > MAX_LOGGED_STALLS ? sNumStalls - MAX_LOGGED_STALLS : 0;
+    for (i = first; i < sNumStalls; i++)
+    {
+        const struct ScriptStall *stall = &sStalls[i % MAX_LOGGED_STALLS];
+
+        GetSymbolName(stall->script, name, sizeof(name));
+        GetSymbolName(stall->pc, where, sizeof(where));
+        fprintf(file, "%-12s %6u frames  %s at %s\n", sStallKindNames[stall->kind], stall->frames, name, where);
+    }
+
+    return fclose(file) == 0;
+}
+
+static void WriteReportAtExit(void)
+{
+    ScriptProfiler_EndScript();
+    if (!ScriptProfiler_WriteReport(sReportPath, sReportTop))
+        fprintf(stderr, "Failed to write the script profile to %s\n", sReportPath);
+}
+
+// Called once at startup. EMERALD_SCRIPT_PROFILE turns the profiler on for
+// the whole run and names the file the report is written to when the game
+// exits. EMERALD_SCRIPT_PROFILE_TOP sets how many scripts and specials it
+// lists, and EMERALD_SCRIPT_STALL_FRAMES how long a wait has to be to be
+// logged.
+void ScriptProfiler_InitFromEnv(void)
+{
+    const char *value;
+
+    sReportPath = getenv("EMERALD_SCRIPT_PROFILE");
+    if (sReportPath == NULL || sReportPath[0] == '\0')
+        return;
+
+    value = getenv("EMERALD_SCRIPT_PROFILE_TOP");
+    if (value != NULL && value[0] != '\0')
+        sReportTop = strtoul(value, NULL, 10);
+    value = getenv("EMERALD_SCRIPT_STALL_FRAMES");
+    if (value != NULL && value[0] != '\0')
+        ScriptProfiler_SetStallThreshold(strtoul(value, NULL, 10));
+
+    ScriptProfiler_Reset();
+    ScriptProfiler_Enable(TRUE);
+    atexit(WriteReportAtExit);
+}
+
+#endif // PORTABLE
@@ -0,0 +1,548 @@
+#ifdef PORTABLE
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#endif
+
+#include "global.h"
+#include "script.h"
+#include "script_vm.h"
+
+#ifdef PORTABLE
+
+// The event scripts assembled into script_data never change, so each
+// command is decoded once: its handler is resolved from the command table,
+// the target of a goto, call or std script jump is read from its operands,
+// and it is linked to the command that follows it. RunScriptCommand then
+// follows those links instead of fetching, bounds-checking and indexing the
+// table for every command, and only goes back to the cache on a jump it
+// hasn't taken before. Scripts anywhere else (RAM scripts, buffers built at
+// runtime) are left to the byte interpreter.
+
+#define SCRIPT_OPERANDS_VARIABLE 0xFF
+#define SCRIPT_INSN_CHUNK        1024
+#define SCRIPT_MAX_RUN           256
+
+struct ScriptInsnChunk
+{
+    struct ScriptInsnChunk *prev;
+    u32 used;
+    struct ScriptInsn insns[SCRIPT_INSN_CHUNK];
+};
+
+bool8 gScriptVM = TRUE;
+
+// The linker's bounds of the section. It is writable ("aw") so that the
+// scripts can be assembled next to data, but nothing writes to it.
+extern const u8 __start_script_data[] __attribute__((weak));
+extern const u8 __stop_script_data[] __attribute__((weak));
+
+extern const u8 *gStdScripts[];
+extern const u8 *gStdScripts_End[];
+
+// Operand bytes after each opcode, from asm/macros/event.inc.
+static const u8 sScriptOperandLengths[] =
+{
+    [0x00] = 0, // nop
+    [0x01] = 0, // nop1
+    [0x02] = 0, // end
+    [0x03] = 0, // return
+    [0x04] = 4, // call
+    [0x05] = 4, // goto
+    [0x06] = 5, // goto_if
+    [0x07] = 5, // call_if
+    [0x08] = 1, // gotostd
+    [0x09] = 1, // callstd
+    [0x0a] = 2, // gotostd_if
+    [0x0b] = 2, // callstd_if
+    [0x0c] = 0, // returnram
+    [0x0d] = 0, // endram
+    [0x0e] = 1, // setmysteryeventstatus
+    [0x0f] = 5, // loadword
+    [0x10] = 2, // loadbyte
+    [0x11] = 5, // setptr
+    [0x12] = 5, // loadbytefromptr
+    [0x13] = 5, // setptrbyte
+    [0x14] = 2, // copylocal
+    [0x15] = 8, // copybyte
+    [0x16] = 4, // setvar
+    [0x17] = 4, // addvar
+    [0x18] = 4, // subvar
+    [0x19] = 4, // copyvar
+    [0x1a] = 4, // setorcopyvar
+    [0x1b] = 2, // compare_local_to_local
+    [0x1c] = 2, // compare_local_to_value
+    [0x1d] = 5, // compare_local_to_ptr
+    [0x1e] = 5, // compare_ptr_to_local
+    [0x1f] = 5, // compare_ptr_to_value
+    [0x20] = 8, // compare_ptr_to_ptr
+    [0x21] = 4, // compare_var_to_value
+    [0x22] = 4, // compare_var_to_var
+    [0x23] = 4, // callnative
+    [0x24] = 4, // gotonative
+    [0x25] = 2, // special
+    [0x26] = 4, // specialvar
+    [0x27] = 0, // waitstate
+    [0x28] = 2, // delay
+    [0x29] = 2, // setflag
+    [0x2a] = 2, // clearflag
+    [0x2b] = 2, // checkflag
+    [0x2c] = 4, // initclock
+    [0x2d] = 0, // dotimebasedevents
+    [0x2e] = 0, // gettime
+    [0x2f] = 2, // playse
+    [0x30] = 0, // waitse
+    [0x31] = 2, // playfanfare
+    [0x32] = 0, // waitfanfare
+    [0x33] = 3, // playbgm
+    [0x34] = 2, // savebgm
+    [0x35] = 0, // fadedefaultbgm
+    [0x36] = 2, // fadenewbgm
+    [0x37] = 1, // fadeoutbgm
+    [0x38] = 1, // fadeinbgm
+    [0x39] = 7, // warp
+    [0x3a] = 7, // warpsilent
+    [0x3b] = 7, // warpdoor
+    [0x3c] = 2, // warphole
+    [0x3d] = 7, // warpteleport
+    [0x3e] = 7, // setwarp
+    [0x3f] = 7, // setdynamicwarp
+    [0x40] = 7, // setdivewarp
+    [0x41] = 7, // setholewarp
+    [0x42] = 4, // getplayerxy
+    [0x43] = 0, // getpartysize
+    [0x44] = 4, // additem
+    [0x45] = 4, // removeitem
+    [0x46] = 4, // checkitemspace
+    [0x47] = 4, // checkitem
+    [0x48] = 2, // checkitemtype
+    [0x49] = 4, // addpcitem
+    [0x4a] = 4, // checkpcitem
+    [0x4b] = 2, // adddecoration
+    [0x4c] = 2, // removedecoration
+    [0x4d] = 2, // checkdecor
+    [0x4e] = 2, // checkdecorspace
+    [0x4f] = 6, // applymovement
+    [0x50] = 8, // applymovement
+    [0x51] = 2, // waitmovement
+    [0x52] = 4, // waitmovement
+    [0x53] = 2, // removeobject
+    [0x54] = 4, // removeobject
+    [0x55] = 2, // addobject
+    [0x56] = 4, // addobject
+    [0x57] = 6, // setobjectxy
+    [0x58] = 4, // showobjectat
+    [0x59] = 4, // hideobjectat
+    [0x5a] = 0, // faceplayer
+    [0x5b] = 3, // turnobject
+    [0x5c] = SCRIPT_OPERANDS_VARIABLE, // trainerbattle
+    [0x5d] = 0, // dotrainerbattle
+    [0x5e] = 0, // gotopostbattlescript
+    [0x5f] = 0, // gotobeatenscript
+    [0x60] = 2, // checktrainerflag
+    [0x61] = 2, // settrainerflag
+    [0x62] = 2, // cleartrainerflag
+    [0x63] = 6, // setobjectxyperm
+    [0x64] = 2, // copyobjectxytoperm
+    [0x65] = 3, // setobjectmovementtype
+    [0x66] = 0, // waitmessage
+    [0x67] = 4, // message
+    [0x68] = 0, // closemessage
+    [0x69] = 0, // lockall
+    [0x6a] = 0, // lock
+    [0x6b] = 0, // releaseall
+    [0x6c] = 0, // release
+    [0x6d] = 0, // waitbuttonpress
+    [0x6e] = 2, // yesnobox
+    [0x6f] = 4, // multichoice
+    [0x70] = 5, // multichoicedefault
+    [0x71] = 5, // multichoicegrid
+    [0x72] = 0, // drawbox
+    [0x73] = 4, // erasebox
+    [0x74] = 4, // drawboxtext
+    [0x75] = 4, // showmonpic
+    [0x76] = 0, // hidemonpic
+    [0x77] = 1, // showcontestpainting
+    [0x78] = 4, // braillemessage
+    [0x79] = 14, // givemon
+    [0x7a] = 2, // giveegg
+    [0x7b] = 4, // setmonmove
+    [0x7c] = 2, // checkpartymove
+    [0x7d] = 3, // bufferspeciesname
+    [0x7e] = 1, // bufferleadmonspeciesname
+    [0x7f] = 3, // bufferpartymonnick
+    [0x80] = 3, // bufferitemname
+    [0x81] = 3, // bufferdecorationname
+    [0x82] = 3, // buffermovename
+    [0x83] = 3, // buffernumberstring
+    [0x84] = 3, // bufferstdstring
+    [0x85] = 5, // bufferstring
+    [0x86] = 4, // pokemart
+    [0x87] = 4, // pokemartdecoration
+    [0x88] = 4, // pokemartdecoration2
+    [0x89] = 2, // playslotmachine
+    [0x8a] = 3, // setberrytree
+    [0x8b] = 0, // choosecontestmon
+    [0x8c] = 0, // startcontest
+    [0x8d] = 0, // showcontestresults
+    [0x8e] = 0, // contestlinktransfer
+    [0x8f] = 2, // random
+    [0x90] = 5, // addmoney
+    [0x91] = 5, // removemoney
+    [0x92] = 5, // checkmoney
+    [0x93] = 3, // showmoneybox
+    [0x94] = 2, // hidemoneybox
+    [0x95] = 3, // updatemoneybox
+    [0x96] = 2, // getpokenewsactive
+    [0x97] = 1, // fadescreen
+    [0x98] = 2, // fadescreenspeed
+    [0x99] = 2, // setflashlevel
+    [0x9a] = 1, // animateflash
+    [0x9b] = 4, // messageautoscroll
+    [0x9c] = 2, // dofieldeffect
+    [0x9d] = 3, // setfieldeffectargument
+    [0x9e] = 2, // waitfieldeffect
+    [0x9f] = 2, // setrespawn
+    [0xa0] = 0, // checkplayergender
+    [0xa1] = 4, // playmoncry
+    [0xa2] = 8, // setmetatile
+    [0xa3] = 0, // resetweather
+    [0xa4] = 2, // setweather
+    [0xa5] = 0, // doweather
+    [0xa6] = 1, // setstepcallback
+    [0xa7] = 2, // setmaplayoutindex
+    [0xa8] = 5, // setobjectsubpriority
+    [0xa9] = 4, // resetobjectsubpriority
+    [0xaa] = 8, // createvobject
+    [0xab] = 2, // turnvobject
+    [0xac] = 4, // opendoor
+    [0xad] = 4, // closedoor
+    [0xae] = 0, // waitdooranim
+    [0xaf] = 4, // setdooropen
+    [0xb0] = 4, // setdoorclosed
+    [0xb1] = 7, // addelevmenuitem
+    [0xb2] = 0, // showelevmenu
+    [0xb3] = 2, // checkcoins
+    [0xb4] = 2, // addcoins
+    [0xb5] = 2, // removecoins
+    [0xb6] = 5, // setwildbattle
+    [0xb7] = 0, // dowildbattle
+    [0xb8] = 4, // setvaddress
+    [0xb9] = 4, // vgoto
+    [0xba] = 4, // vcall
+    [0xbb] = 5, // vgoto_if
+    [0xbc] = 5, // vcall_if
+    [0xbd] = 4, // vmessage
+    [0xbe] = 4, // vbuffermessage
+    [0xbf] = 5, // vbufferstring
+    [0xc0] = 2, // showcoinsbox
+    [0xc1] = 2, // hidecoinsbox
+    [0xc2] = 2, // updatecoinsbox
+    [0xc3] = 1, // incrementgamestat
+    [0xc4] = 7, // setescapewarp
+    [0xc5] = 0, // waitmoncry
+    [0xc6] = 3, // bufferboxname
+    [0xc7] = 1, // textcolor
+    [0xc8] = 4, // loadhelp
+    [0xc9] = 0, // unloadhelp
+    [0xca] = 0, // signmsg
+    [0xcb] = 0, // normalmsg
+    [0xcc] = 5, // comparehiddenvar
+    [0xcd] = 2, // setmodernfatefulencounter
+    [0xce] = 2, // checkmodernfatefulencounter
+    [0xcf] = 0, // trywondercardscript
+    [0xd0] = 2, // setworldmapflag
+    [0xd1] = 7, // warpspinenter
+    [0xd2] = 3, // setmonmetlocation
+    [0xd3] = 2, // moverotatingtileobjects
+    [0xd4] = 0, // turnrotatingtileobjects
+    [0xd5] = 2, // initrotatingtilepuzzle
+    [0xd6] = 0, // freerotatingtilepuzzle
+    [0xd7] = 7, // warpmossdeepgym
+    [0xd8] = 0, // selectapproachingtrainer
+    [0xd9] = 0, // lockfortrainer
+    [0xda] = 0, // closebraillemessage
+    [0xdb] = 4, // messageinstant
+    [0xdc] = 1, // fadescreenswapbuffers
+    [0xdd] = 3, // buffertrainerclassname
+    [0xde] = 3, // buffertrainername
+    [0xdf] = 4, // pokenavcall
+    [0xe0] = 7, // warpwhitefade
+    [0xe1] = 3, // buffercontestname
+    [0xe2] = 5, // bufferitemnameplural
+};
+
+static struct ScriptInsnChunk *sInsnChunks;
+static const struct ScriptInsn **sInsnMap;
+static u32 sInsnMapSize; // power of two
+static u32 sInsnMapCount;
+static struct ScriptVMStats sScriptVMStats;
+
+static bool8 IsImmutable(const u8 *start, u32 size)
+{
+    uintptr_t addr = (uintptr_t)start;
+
+    if (addr < (uintptr_t)__start_script_data || addr + size > (uintptr_t)__stop_script_data)
+        return FALSE;
+
+    // RAM scripts are rewritten whenever a new one is received.
+    if (gSaveBlock1Ptr != NULL)
+    {
+        uintptr_t ramScript = (uintptr_t)&gSaveBlock1Ptr->ramScript;
+
+        if (addr < ramScript + sizeof(gSaveBlock1Ptr->ramScript) && addr + size > ramScript)
+            return FALSE;
+    }
+    return TRUE;
+}
+
+static u32 HashPc(const u8 *pc)
+{
+    return ((uintptr_t)pc * 0x9E3779B1u) >> 7;
+}
+
+static const struct ScriptInsn *FindInsn(const u8 *pc)
+{
+    u32 i;
+
+    if (sInsnMapSize == 0)
+        return NULL;
+
+    for (i = HashPc(pc) & (sInsnMapSize - 1); sInsnMap[i] != NULL; i = (i + 1) & (sInsnMapSize - 1))
+    {
+        if (sInsnMap[i]->pc == pc)
+            return sInsnMap[i];
+    }
+    return NULL;
+}
+
+static void InsertInsnMap(const struct ScriptInsn *insn)
+{
+    u32 i;
+
+    for (i = HashPc(insn->pc) & (sInsnMapSize - 1); sInsnMap[i] != NULL; i = (i + 1) & (sInsnMapSize - 1))
+        ;
+    sInsnMap[i] = insn;
+}
+
+static bool8 AddInsn(const struct ScriptInsn *insn)
+{
+    if (sInsnMapCount + 1 > sInsnMapSize / 2)
+    {
+        const struct ScriptInsn **oldMap = sInsnMap;
+        u32 oldSize = sInsnMapSize;
+        u32 i;
+
+        sInsnMapSize = oldSize != 0 ? oldSize * 2 : 4096;
+        sInsnMap = calloc(sInsnMapSize, sizeof(*sInsnMap));
+        if (sInsnMap == NULL)
+        {
+            sInsnMap = oldMap;
+            sInsnMapSize = oldSize;
+            return FALSE;
+        }
+        for (i = 0; i < oldSize; i++)
+        {
+            if (oldMap[i] != NULL)
+                InsertInsnMap(oldMap[i]);
+        }
+        free(oldMap);
+    }
+
+    InsertInsnMap(insn);
+    sInsnMapCount++;
+    return TRUE;
+}
+
+static struct ScriptInsn *AllocInsn(void)
+{
+    if (sInsnChunks == NULL || sInsnChunks->used == SCRIPT_INSN_CHUNK)
+    {
+        struct ScriptInsnChunk *chunk = malloc(sizeof(*chunk));
+
+        if (chunk == NULL)
+            return NULL;
+        chunk->prev = sInsnChunks;
+        chunk->used = 0;
+        sInsnChunks = chunk;
+    }
+    return &sInsnChunks->insns[sInsnChunks->used++];
+}
+
+static bool8 EndsRun(u8 opcode)
+{
+    switch (opcode)
+    {
+    case 0x02: // end
+    case 0x03: // return
+    case 0x05: // goto
+    case 0x08: // gotostd
+    case 0x0c: // returnram
+    case 0x0d: // endram
+    case 0x24: // gotonative
+    case 0x5e: // gotopostbattlescript
+    case 0x5f: // gotobeatenscript
+    case 0xb9: // vgoto
+        return TRUE;
+    }
+    return FALSE;
+}
+
+static const u8 *GetStdScript(u8 index)
+{
+    const u8 **ptr = &gStdScripts[index];
+
+    if (ptr < gStdScripts_End)
+        return *ptr;
+    return NULL;
+}
+
+// Reads the script a goto, call or std script jump at pc goes to, the way its
+// handler does. Returns NULL for any other command.
+static const u8 *ReadJumpTarget(const u8 *pc)
+{
+    u32 word;
+
+    switch (pc[0])
+    {
+    case 0x04: // call
+    case 0x05: // goto
+        memcpy(&word, &pc[1], sizeof(word));
+        return (const u8 *)(uintptr_t)word;
+    case 0x06: // goto_if
+    case 0x07: // call_if
+        memcpy(&word, &pc[2], sizeof(word));
+        return (const u8 *)(uintptr_t)word;
+    case 0x08: // gotostd
+    case 0x09: // callstd
+        return GetStdScript(pc[1]);
+    case 0x0a: // gotostd_if
+    case 0x0b: // callstd_if
+        return GetStdScript(pc[2]);
+    }
+    return NULL;
+}
+
+// Decodes the straight-line run of commands starting at pc, stopping at a
+// command that never falls through or at one decoded earlier.
+static const struct ScriptInsn *DecodeRun(struct ScriptContext *ctx, const u8 *pc)
+{
+    struct ScriptInsn *first = NULL;
+    struct ScriptInsn *prev = NULL;
+    u32 count;
+
+    for (count = 0; count < SCRIPT_MAX_RUN; count++)
+    {
+        struct ScriptInsn *insn;
+        u8 opcode, length;
+
+        if (count != 0)
+        {
+            const struct ScriptInsn *existing = FindInsn(pc);
+            if (existing != NULL)
+            {
+                prev->next = existing;
+                break;
+            }
+        }
+
+        if (!IsImmutable(pc, 1))
+            break;
+        opcode = *pc;
+        if (opcode >= ARRAY_COUNT(sScriptOperandLengths) || &ctx->cmdTable[opcode] >= ctx->cmdTableEnd)
+            break;
+        length = sScriptOperandLengths[opcode];
+        if (length != SCRIPT_OPERANDS_VARIABLE && !IsImmutable(pc, 1 + length))
+            break;
+
+        insn = AllocInsn();
+        if (insn == NULL)
+            break;
+        insn->pc = pc;
+        insn->func = ctx->cmdTable[opcode];
+        insn->next = NULL;
+        insn->target = length != SCRIPT_OPERANDS_VARIABLE ? ReadJumpTarget(pc) : NULL;
+        insn->branch = insn->target != NULL ? FindInsn(insn->target) : NULL;
+        insn->opcode = opcode;
+        if (!AddInsn(insn))
+        {
+            sInsnChunks->used--;
+            break;
+        }
+        sScriptVMStats.decodedInsns++;
+
+        if (prev != NULL)
+            prev->next = insn;
+        else
+            first = insn;
+        prev = insn;
+
+        if (length == SCRIPT_OPERANDS_VARIABLE || EndsRun(opcode))
+            break;
+        pc += 1 + length;
+    }
+
+    return first;
+}
+
+// Returns the decoded command at pc, decoding it first if needed, or NULL if
+// it has to go through the byte interpreter.
+const struct ScriptInsn *ScriptVM_Lookup(struct ScriptContext *ctx, const u8 *pc)
+{
+    const struct ScriptInsn *insn;
+
+    sScriptVMStats.lookups++;
+    insn = FindInsn(pc);
+    if (insn == NULL)
+        insn = DecodeRun(ctx, pc);
+    if (insn == NULL)
+        sScriptVMStats.interpreted++;
+    return insn;
+}
+
+// Returns the decoded command to run after insn, which has just run and left
+// ctx->scriptPtr wherever it continues, or NULL if that has to go through the
+// byte interpreter. insn may be NULL, for the first command.
+const struct ScriptInsn *ScriptVM_Next(struct ScriptContext *ctx, const struct ScriptInsn *insn)
+{
+    struct ScriptInsn *jumped;
+
+    if (insn == NULL)
+        return ScriptVM_Lookup(ctx, ctx->scriptPtr);
+    if (insn->next != NULL && insn->next->pc == ctx->scriptPtr)
+        return insn->next;
+    if (insn->target == NULL || insn->target != ctx->scriptPtr)
+        return ScriptVM_Lookup(ctx, ctx->scriptPtr);
+
+    // The jump was taken. The first time, find what it lands on and keep it.
+    if (insn->branch == NULL)
+    {
+        jumped = (struct ScriptInsn *)insn;
+        jumped->branch = ScriptVM_Lookup(ctx, ctx->scriptPtr);
+        return jumped->branch;
+    }
+    sScriptVMStats.resolvedJumps++;
+    return insn->branch;
+}
+
+void ScriptVM_Reset(void)
+{
+    while (sInsnChunks != NULL)
+    {
+        struct ScriptInsnChunk *prev = sInsnChunks->prev;
+        free(sInsnChunks);
+        sInsnChunks = prev;
+    }
+    free(sInsnMap);
+    sInsnMap = NULL;
+    sInsnMapSize = 0;
+    sInsnMapCount = 0;
+    memset(&sScriptVMStats, 0, sizeof(sScriptVMStats));
+}
+
+void ScriptVM_GetStats(struct ScriptVMStats *stats)
+{
+    *stats = sScriptVMStats;
+}
+
+#endif // PORTABLE
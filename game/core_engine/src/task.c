@@ -3,6 +3,25 @@
 
 COMMON_DATA struct Task gTasks[NUM_TASKS] = {0};
 
+#ifdef PORTABLE
+void (*gTaskFuncWrapper)(u8 taskId);
+
+#define TASK_MASK_WORDS     ((NUM_TASKS + 31) / 32)
+#define NUM_TASK_PRIORITIES 256
+
+// Indexes over the task list so CreateTask doesn't scan gTasks. They mirror
+// the linked list exactly: slots are still handed out lowest first, and a
+// new task still goes after every task of the same or lower priority value.
+// All of them are valid zero-initialised, before the first ResetTasks.
+static u32 sUsedTaskMask[TASK_MASK_WORDS];
+static u32 sPriorityMask[NUM_TASK_PRIORITIES / 32];
+static u8 sPriorityTail[NUM_TASK_PRIORITIES];
+static u8 sHeadTask;
+static u8 sActiveTaskCount;
+
+static u8 AllocTaskSlot(void);
+#endif
+
 static void InsertTask(u8 newTaskId);
 static u8 FindFirstActiveTask(void);
 
@@ -22,8 +41,120 @@ void ResetTasks(void)
 
     gTasks[0].prev = HEAD_SENTINEL;
     gTasks[NUM_TASKS - 1].next = TAIL_SENTINEL;
+
+#ifdef PORTABLE
+    memset(sUsedTaskMask, 0, sizeof(sUsedTaskMask));
+    memset(sPriorityMask, 0, sizeof(sPriorityMask));
+    sActiveTaskCount = 0;
+#endif
+}
+
+#ifdef PORTABLE
+static u8 AllocTaskSlot(void)
+{
+    u32 word;
+
+    for (word = 0; word < TASK_MASK_WORDS; word++)
+    {
+        if (sUsedTaskMask[word] != 0xFFFFFFFF)
+        {
+            u32 i = word * 32 + __builtin_ctz(~sUsedTaskMask[word]);
+            if (i >= NUM_TASKS)
+                break;
+            sUsedTaskMask[word] |= 1u << (i % 32);
+            return i;
+        }
+    }
+
+    return NUM_TASKS;
+}
+
+u8 CreateTask(TaskFunc func, u8 priority)
+{
+    u8 i = AllocTaskSlot();
+
+    if (i != NUM_TASKS)
+    {
+        gTasks[i].func = func;
+        gTasks[i].priority = priority;
+        InsertTask(i);
+        memset(gTasks[i].data, 0, sizeof(gTasks[i].data));
+        gTasks[i].isActive = TRUE;
+        sActiveTaskCount++;
+        return i;
+    }
+
+    return 0;
+}
+
+// Returns the last task whose priority value is at most priority, or
+// NUM_TASKS if the new task belongs at the head.
+static u8 FindInsertAfterTask(u8 priority)
+{
+    s32 word = priority / 32;
+    u32 bits = sPriorityMask[word] & (0xFFFFFFFF >> (31 - priority % 32));
+
+    while (bits == 0)
+    {
+        if (--word < 0)
+            return NUM_TASKS;
+        bits = sPriorityMask[word];
+    }
+
+    return sPriorityTail[word * 32 + 31 - __builtin_clz(bits)];
 }
 
+static void InsertTask(u8 newTaskId)
+{
+    u8 priority = gTasks[newTaskId].priority;
+    u8 taskId;
+
+    if (sActiveTaskCount == 0)
+    {
+        // The new task is the only task.
+        gTasks[newTaskId].prev = HEAD_SENTINEL;
+        gTasks[newTaskId].next = TAIL_SENTINEL;
+        sHeadTask = newTaskId;
+    }
+    else if ((taskId = FindInsertAfterTask(priority)) == NUM_TASKS)
+    {
+        gTasks[newTaskId].prev = HEAD_SENTINEL;
+        gTasks[newTaskId].next = sHeadTask;
+        gTasks[sHeadTask].prev = newTaskId;
+        sHeadTask = newTaskId;
+    }
+    else
+    {
+        gTasks[newTaskId].prev = taskId;
+        gTasks[newTaskId].next = gTasks[taskId].next;
+        if (gTasks[taskId].next != TAIL_SENTINEL)
+            gTasks[gTasks[taskId].next].prev = newTaskId;
+        gTasks[taskId].next = newTaskId;
+    }
+
+    sPriorityTail[priority] = newTaskId;
+    sPriorityMask[priority / 32] |= 1u << (priority % 32);
+}
+
+static void RemoveTaskFromIndexes(u8 taskId)
+{
+    u8 priority = gTasks[taskId].priority;
+    u8 prev = gTasks[taskId].prev;
+
+    sUsedTaskMask[taskId / 32] &= ~(1u << (taskId % 32));
+    sActiveTaskCount--;
+    if (prev == HEAD_SENTINEL && gTasks[taskId].next != TAIL_SENTINEL)
+        sHeadTask = gTasks[taskId].next;
+
+    if (sPriorityTail[priority] == taskId)
+    {
+        if (prev != HEAD_SENTINEL && gTasks[prev].priority == priority)
+            sPriorityTail[priority] = prev;
+        else
+            sPriorityMask[priority / 32] &= ~(1u << (priority % 32));
+    }
+}
+#else
 u8 CreateTask(TaskFunc func, u8 priority)
 {
     u8 i;
@@ -80,12 +211,16 @@ static void InsertTask(u8 newTaskId)
         taskId = gTasks[taskId].next;
     }
 }
+#endif // PORTABLE
 
 void DestroyTask(u8 taskId)
 {
     if (gTasks[taskId].isActive)
     {
         gTasks[taskId].isActive = FALSE;
+#ifdef PORTABLE
+        RemoveTaskFromIndexes(taskId);
+#endif
 
         if (gTasks[taskId].prev == HEAD_SENTINEL)
         {
@@ -115,7 +250,14 @@ void RunTasks(void)
     {
         do
         {
+#ifdef PORTABLE
+            if (gTaskFuncWrapper != NULL)
+                gTaskFuncWrapper(taskId);
+            else
+                gTasks[taskId].func(taskId);
+#else
             gTasks[taskId].func(taskId);
+#endif
             taskId = gTasks[taskId].next;
         } while (taskId != TAIL_SENTINEL);
     }
@@ -125,9 +267,15 @@ static u8 FindFirstActiveTask(void)
 {
     u8 taskId;
 
+#ifdef PORTABLE
+    if (sActiveTaskCount == 0)
+        return NUM_TASKS;
+    taskId = sHeadTask;
+#else
     for (taskId = 0; taskId < NUM_TASKS; taskId++)
         if (gTasks[taskId].isActive == TRUE && gTasks[taskId].prev == HEAD_SENTINEL)
             break;
+#endif
 
     return taskId;
 }
@@ -6,6 +6,8 @@
 #include "task.h"
 #include "battle_transition.h"
 #include "fieldmap.h"
+#include "frame_render.h"
+#include "main.h"
 
 static EWRAM_DATA struct {
     const u16 *src;
@@ -21,6 +23,17 @@ static u16 sSecondaryTilesetAnimCounterMax;
 static void (*sPrimaryTilesetAnimCallback)(u16);
 static void (*sSecondaryTilesetAnimCallback)(u16);
 
+#ifdef PORTABLE
+// Zero-copy mode: rather than copying each new animation frame into VRAM,
+// the frames stay resident where they are and sAnimTileSources points each
+// animated BG tile at its current frame, for the renderer to read in place
+// of VRAM. A frame change only updates pointers. AgbMain turns it on when
+// the frame renderer is running, as nothing else reads the pointers.
+static bool8 sTilesetAnimsZeroCopy;
+static const u16 *sAnimTileSources[NUM_TILES_TOTAL];
+static u32 sAnimTileSourcesVersion;
+#endif
+
 static void _InitPrimaryTilesetAnimation(void);
 static void _InitSecondaryTilesetAnimation(void);
 static void TilesetAnim_General(u16);
@@ -550,8 +563,51 @@ static void ResetTilesetAnimBuffer(void)
     CpuFill32(0, sTilesetDMA3TransferBuffer, sizeof sTilesetDMA3TransferBuffer);
 }
 
+#ifdef PORTABLE
+static void ClearAnimTileSources(u16 firstTile, u16 numTiles)
+{
+    memset(&sAnimTileSources[firstTile], 0, numTiles * sizeof(sAnimTileSources[0]));
+    sAnimTileSourcesVersion++;
+}
+
+static bool8 TrySetAnimTileSources(const u16 *src, u16 *dest, u16 size)
+{
+    uintptr_t firstTile = ((uintptr_t)dest - BG_VRAM) / TILE_SIZE_4BPP;
+    u16 i;
+
+    if ((uintptr_t)dest < BG_VRAM || firstTile + size / TILE_SIZE_4BPP > NUM_TILES_TOTAL)
+        return FALSE;
+
+    for (i = 0; i < size / TILE_SIZE_4BPP; i++)
+        sAnimTileSources[firstTile + i] = &src[i * TILE_SIZE_4BPP / sizeof(u16)];
+    sAnimTileSourcesVersion++;
+    return TRUE;
+}
+
+void TilesetAnims_SetZeroCopy(bool8 enabled)
+{
+    u16 i;
+
+    if (!enabled && sTilesetAnimsZeroCopy)
+    {
+        // Put the current frames into VRAM, where the copying path expects them.
+        for (i = 0; i < NUM_TILES_TOTAL; i++)
+        {
+            if (sAnimTileSources[i] != NULL)
+                CpuCopy16(sAnimTileSources[i], (void *)(BG_VRAM + TILE_OFFSET_4BPP(i)), TILE_SIZE_4BPP);
+        }
+        ClearAnimTileSources(0, NUM_TILES_TOTAL);
+    }
+    sTilesetAnimsZeroCopy = enabled;
+}
+#endif
+
 static void AppendTilesetAnimToBuffer(const u16 *src, u16 *dest, u16 size)
 {
+#ifdef PORTABLE
+    if (sTilesetAnimsZeroCopy && TrySetAnimTileSources(src, dest, size))
+        return;
+#endif
     if (sTilesetDMA3TransferBufferSize < 20)
     {
         sTilesetDMA3TransferBuffer[sTilesetDMA3TransferBufferSize].src = src;
@@ -565,6 +621,12 @@ void TransferTilesetAnimsBuffer(void)
 {
     int i;
 
+#ifdef PORTABLE
+    // Only from the field's VBlank callback, so other screens reusing these
+    // char blocks are drawn from VRAM.
+    if (sTilesetAnimsZeroCopy)
+        FrameRender_SetBgTileSources(sAnimTileSources, sAnimTileSourcesVersion);
+#endif
     for (i = 0; i < sTilesetDMA3TransferBufferSize; i ++)
         DmaCopy16(3, sTilesetDMA3TransferBuffer[i].src, sTilesetDMA3TransferBuffer[i].dest, sTilesetDMA3TransferBuffer[i].size);
 
@@ -602,6 +664,9 @@ static void _InitPrimaryTilesetAnimation(void)
     sPrimaryTilesetAnimCounter = 0;
     sPrimaryTilesetAnimCounterMax = 0;
     sPrimaryTilesetAnimCallback = NULL;
+#ifdef PORTABLE
+    ClearAnimTileSources(0, NUM_TILES_IN_PRIMARY);
+#endif
     if (gMapHeader.mapLayout->primaryTileset && gMapHeader.mapLayout->primaryTileset->callback)
         gMapHeader.mapLayout->primaryTileset->callback();
 }
@@ -611,6 +676,9 @@ static void _InitSecondaryTilesetAnimation(void)
     sSecondaryTilesetAnimCounter = 0;
     sSecondaryTilesetAnimCounterMax = 0;
     sSecondaryTilesetAnimCallback = NULL;
+#ifdef PORTABLE
+    ClearAnimTileSources(NUM_TILES_IN_PRIMARY, NUM_TILES_TOTAL - NUM_TILES_IN_PRIMARY);
+#endif
     if (gMapHeader.mapLayout->secondaryTileset && gMapHeader.mapLayout->secondaryTileset->callback)
         gMapHeader.mapLayout->secondaryTileset->callback();
 }
@@ -61,6 +61,10 @@ static bool8 IsAbilityAllowingEncounter(u8 level);
 
 EWRAM_DATA static u8 sWildEncountersDisabled = 0;
 EWRAM_DATA static u32 sFeebasRngValue = 0;
+#ifdef PORTABLE
+static u16 sCachedHeaderMap; // (mapGroup << 8 | mapNum) + 1, or 0 if nothing is cached
+static u16 sCachedHeaderId;
+#endif
 
 #include "data/wild_encounters.h"
 
@@ -302,6 +306,47 @@ static u8 ChooseWildMonLevel(const struct WildPokemon *wildPokemon)
     return min + rand;
 }
 
+#ifdef PORTABLE
+// Maps a (mapGroup, mapNum) pair to the index of its first entry in
+// gWildMonHeaders using the table generated alongside it, instead of
+// scanning every header on each step.
+static u16 GetWildMonHeaderIdByMap(u8 mapGroup, u8 mapNum)
+{
+    u32 map = (mapGroup << 8) | mapNum;
+
+    if (map >= ARRAY_COUNT(gWildMonHeadersIdByMap) || gWildMonHeadersIdByMap[map] == 0)
+        return HEADER_NONE;
+
+    return gWildMonHeadersIdByMap[map] - 1;
+}
+
+static u16 GetCurrentMapWildMonHeaderId(void)
+{
+    u16 headerId;
+    u16 map = ((gSaveBlock1Ptr->location.mapGroup << 8) | gSaveBlock1Ptr->location.mapNum) + 1;
+
+    // The header id only changes with the map, so remember it for the last one looked up.
+    if (sCachedHeaderMap != map)
+    {
+        sCachedHeaderId = GetWildMonHeaderIdByMap(gSaveBlock1Ptr->location.mapGroup, gSaveBlock1Ptr->location.mapNum);
+        sCachedHeaderMap = map;
+    }
+
+    headerId = sCachedHeaderId;
+    if (headerId != HEADER_NONE
+     && gSaveBlock1Ptr->location.mapGroup == MAP_GROUP(ALTERING_CAVE)
+     && gSaveBlock1Ptr->location.mapNum == MAP_NUM(ALTERING_CAVE))
+    {
+        u16 alteringCaveId = VarGet(VAR_ALTERING_CAVE_WILD_SET);
+        if (alteringCaveId >= NUM_ALTERING_CAVE_TABLES)
+            alteringCaveId = 0;
+
+        headerId += alteringCaveId;
+    }
+
+    return headerId;
+}
+#else
 static u16 GetCurrentMapWildMonHeaderId(void)
 {
     u16 i;
@@ -331,6 +376,7 @@ static u16 GetCurrentMapWildMonHeaderId(void)
 
     return HEADER_NONE;
 }
+#endif // PORTABLE
 
 static u8 PickWildMonNature(void)
 {
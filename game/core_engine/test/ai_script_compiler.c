@@ -0,0 +1,266 @@
+// Checks the dispatch aiscr2c generates for the battle AI scripts against the
+// interpreter loop in battle_ai_script_commands.c, over the assembled
+// scripts. The command handlers are stand-ins: each one checks that it was
+// called on its own opcode and then, from a seeded random sequence, takes its
+// jump, carries on, or sends gAIScriptPtr to a script the compiled code
+// doesn't expect. Both runs have to call the same handlers at the same
+// addresses and finish in the same state. This covers every path through the
+// scripts; the real handlers are checked against the interpreter on recorded
+// battles by check-ai-scripts, see test_rules.mk.
+//
+// Usage: ai_script_compiler SCRIPTS_BIN
+//
+// SCRIPTS_BIN is the script_data section of the scripts' object before it's
+// linked, so each .4byte label holds the label's offset in the section.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "gba/types.h"
+#include "gba/defines.h"
+
+#define AI_ACTION_DONE (1 << 0)
+
+#define AI_STACK_SIZE 8
+#define MAX_STEPS 4096
+#define SEEDS_PER_SCRIPT 2048
+
+typedef void (*BattleAICmdFunc)(void);
+
+struct AIRun
+{
+    const u8 *trace[MAX_STEPS];
+    u32 steps;
+    const u8 *scriptPtr;
+    const u8 *stack[AI_STACK_SIZE];
+    u8 stackSize;
+    u8 aiAction;
+};
+
+struct AI_ThinkingStruct
+{
+    u8 aiAction;
+};
+
+static u8 *sScripts;
+// Only the first entry is read by the generated code, to find the scripts.
+static const u8 *gBattleAI_ScriptsTable[1];
+static u32 sScriptsSize;
+static const u8 *gAIScriptPtr;
+static struct AI_ThinkingStruct sAI;
+static BattleAICmdFunc sBattleAICmdTable[256];
+static struct AIRun *sRun;
+static u32 sRngValue;
+static u32 sHandovers;
+
+#define AI_THINKING_STRUCT (&sAI)
+
+static void BattleAI_ContinueInInterpreter(void);
+
+#include "data/battle_ai_scripts.h"
+
+#define NUM_SCRIPTS (sizeof(sCompiledBattleAIScripts) / sizeof(sCompiledBattleAIScripts[0]))
+
+static u32 NextRandom(void)
+{
+    sRngValue = 1103515245 * sRngValue + 24691;
+    return sRngValue >> 16;
+}
+
+static const u8 *ReadScriptPtr(const u8 *ptr)
+{
+    u32 offset = ptr[0] | (ptr[1] << 8) | (ptr[2] << 16) | ((u32)ptr[3] << 24);
+
+    if (offset >= sScriptsSize)
+    {
+        fprintf(stderr, "Pointer at 0x%X leaves the scripts\n", (u32)(ptr - sScripts));
+        exit(1);
+    }
+    return sScripts + offset;
+}
+
+static void RunCommand(const char *name, u8 opcode, u8 size, bool8 jumps)
+{
+    struct AIRun *run = sRun;
+    u32 roll;
+
+    if (*gAIScriptPtr != opcode)
+    {
+        fprintf(stderr, "%s ran on opcode 0x%02X at 0x%X\n", name, *gAIScriptPtr, (u32)(gAIScriptPtr - sScripts));
+        exit(1);
+    }
+
+    // The compiled code jumps without calling Cmd_goto.
+    if (strcmp(name, "Cmd_goto") == 0)
+    {
+        gAIScriptPtr = ReadScriptPtr(gAIScriptPtr + 1);
+        return;
+    }
+
+    // Random jumps can loop forever, so both runs stop at the same step.
+    run->trace[run->steps++] = gAIScriptPtr;
+    if (run->steps == MAX_STEPS)
+    {
+        sAI.aiAction |= AI_ACTION_DONE;
+        return;
+    }
+
+    if (strcmp(name, "Cmd_call") == 0)
+    {
+        if (run->stackSize == AI_STACK_SIZE)
+        {
+            sAI.aiAction |= AI_ACTION_DONE;
+            return;
+        }
+        run->stack[run->stackSize++] = gAIScriptPtr + size;
+        gAIScriptPtr = ReadScriptPtr(gAIScriptPtr + 1);
+    }
+    else if (strcmp(name, "Cmd_end") == 0)
+    {
+        if (run->stackSize != 0)
+            gAIScriptPtr = run->stack[--run->stackSize];
+        else
+            sAI.aiAction |= AI_ACTION_DONE;
+    }
+    else if (strcmp(name, "Cmd_flee") == 0 || strcmp(name, "Cmd_watch") == 0)
+    {
+        sAI.aiAction |= AI_ACTION_DONE;
+    }
+    else
+    {
+        roll = NextRandom() % 16;
+        if (roll == 0)
+            gAIScriptPtr = ReadScriptPtr(sScripts + 4 * (NextRandom() % NUM_SCRIPTS));
+        else if (jumps && roll < 8)
+            gAIScriptPtr = ReadScriptPtr(gAIScriptPtr + size - 4);
+        else
+            gAIScriptPtr += size;
+    }
+}
+
+#define X(handler, opcode, size, jumps) static void handler(void) { RunCommand(#handler, opcode, size, jumps); }
+AI_SCRIPT_COMMANDS(X)
+#undef X
+
+static void BattleAI_ContinueInInterpreter(void)
+{
+    sHandovers++;
+    while (!(AI_THINKING_STRUCT->aiAction & AI_ACTION_DONE))
+    {
+        if (sBattleAICmdTable[*gAIScriptPtr] == NULL)
+        {
+            fprintf(stderr, "No command 0x%02X at 0x%X\n", *gAIScriptPtr, (u32)(gAIScriptPtr - sScripts));
+            exit(1);
+        }
+        sBattleAICmdTable[*gAIScriptPtr]();
+    }
+}
+
+// Starts a run with a few return addresses already on the stack, which
+// the scripts can leave behind for the next move.
+static void StartRun(struct AIRun *run, u32 script, u32 seed)
+{
+    u32 i;
+
+    memset(run, 0, sizeof(*run));
+    sRun = run;
+    sRngValue = seed;
+    sAI.aiAction = 0;
+    run->stackSize = NextRandom() % 3;
+    for (i = 0; i < run->stackSize; i++)
+        run->stack[i] = ReadScriptPtr(sScripts + 4 * (NextRandom() % NUM_SCRIPTS));
+    gAIScriptPtr = ReadScriptPtr(sScripts + 4 * script);
+}
+
+static void FinishRun(struct AIRun *run)
+{
+    run->scriptPtr = gAIScriptPtr;
+    run->aiAction = sAI.aiAction;
+}
+
+static void RunInterpreted(struct AIRun *run, u32 script, u32 seed)
+{
+    u32 handovers = sHandovers;
+
+    StartRun(run, script, seed);
+    BattleAI_ContinueInInterpreter();
+    sHandovers = handovers;
+    FinishRun(run);
+}
+
+// The same as BattleAI_DoCompiledAIProcessing does for one move.
+static void RunCompiled(struct AIRun *run, u32 script, u32 seed)
+{
+    StartRun(run, script, seed);
+    sCompiledBattleAIScripts[script]();
+    if (!(AI_THINKING_STRUCT->aiAction & AI_ACTION_DONE))
+        BattleAI_ContinueInInterpreter();
+    FinishRun(run);
+}
+
+static bool8 RunsMatch(const struct AIRun *a, const struct AIRun *b)
+{
+    return a->steps == b->steps
+        && memcmp(a->trace, b->trace, sizeof(a->trace[0]) * a->steps) == 0
+        && a->scriptPtr == b->scriptPtr
+        && a->stackSize == b->stackSize
+        && memcmp(a->stack, b->stack, sizeof(a->stack[0]) * a->stackSize) == 0
+        && a->aiAction == b->aiAction;
+}
+
+static void LoadScripts(const char *path)
+{
+    FILE *fp = fopen(path, "rb");
+    long size;
+
+    if (fp == NULL || fseek(fp, 0, SEEK_END) != 0 || (size = ftell(fp)) <= 0)
+    {
+        fprintf(stderr, "Failed to read %s\n", path);
+        exit(1);
+    }
+    rewind(fp);
+    sScriptsSize = size;
+    sScripts = malloc(size);
+    if (sScripts == NULL || fread(sScripts, 1, size, fp) != (size_t)size)
+    {
+        fprintf(stderr, "Failed to read %s\n", path);
+        exit(1);
+    }
+    fclose(fp);
+    gBattleAI_ScriptsTable[0] = ReadScriptPtr(sScripts);
+}
+
+int main(int argc, char **argv)
+{
+    static struct AIRun sInterpreted, sCompiled;
+    u32 script, seed, runs = 0;
+
+    if (argc != 2)
+    {
+        fprintf(stderr, "Usage: %s SCRIPTS_BIN\n", argv[0]);
+        return 1;
+    }
+    LoadScripts(argv[1]);
+
+#define X(handler, opcode, size, jumps) sBattleAICmdTable[opcode] = handler;
+    AI_SCRIPT_COMMANDS(X)
+#undef X
+
+    for (script = 0; script < NUM_SCRIPTS; script++)
+    {
+        for (seed = 0; seed < SEEDS_PER_SCRIPT; seed++)
+        {
+            RunInterpreted(&sInterpreted, script, seed);
+            RunCompiled(&sCompiled, script, seed);
+            if (!RunsMatch(&sInterpreted, &sCompiled))
+            {
+                fprintf(stderr, "Script %u, seed %u: the compiled run differs after %u and %u steps\n",
+                        script, seed, sInterpreted.steps, sCompiled.steps);
+                return 1;
+            }
+            runs++;
+        }
+    }
+    printf("%u runs matched, %u handed over to the interpreter\n", runs, sHandovers);
+    return 0;
+}
@@ -0,0 +1,332 @@
+// Checks the batched Battle Dome matchup scoring in battle_dome.c against the
+// per-match GetTypeEffectivenessPoints loops it replaces.
+//
+// NPC-only tournaments are generated from a range of seeds the way the
+// results tree does, once with each scoring, and the frontier data and the
+// RNG have to come out the same. Each tournament is then replayed with a new
+// mon for one of its trainers, which changes the parties without changing
+// the trainers, and again with the player and the Frontier Brain in two of
+// its slots and the player losing in a random round, which changes the
+// trainers. Both times the batched table has to be rebuilt, and the results
+// and the RNG have to match the loops'. For some of the tournaments, the
+// points of every pairing of scored trainers in the table are also checked
+// against the loops, after the tournament is generated and after the new
+// mon. DomeEval_Benchmark is run last, to check that it finds the two
+// scorings agree and leaves the frontier data and the RNG alone.
+//
+// battle_dome.c, pokemon.c (for the species and move data) and battle_main.c
+// (for the type chart) are built into this file, and the functions they call
+// are stand-ins. Only what the checks reach is linked, so only that needs
+// one. GetWinningMove's damage and type checks are stand-ins too; both
+// scorings call them the same way.
+//
+// Usage: dome_matchups
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "battle_dome.c"
+#undef CALC_STAT
+#include "pokemon.c"
+#include "battle_main.c"
+#include "constants/battle_frontier_mons.h"
+#include "data/battle_frontier/battle_frontier_trainer_mons.h"
+#include "data/battle_frontier/battle_frontier_trainers.h"
+#include "data/battle_frontier/battle_frontier_mons.h"
+
+#define NUM_TOURNAMENTS        2000
+#define POINTS_CHECK_INTERVAL  10
+#define NUM_BENCHMARK_TOURNAMENTS 100
+
+const u32 gBitTable[32] =
+{
+    1 << 0,  1 << 1,  1 << 2,  1 << 3,  1 << 4,  1 << 5,  1 << 6,  1 << 7,
+    1 << 8,  1 << 9,  1 << 10, 1 << 11, 1 << 12, 1 << 13, 1 << 14, 1 << 15,
+    1 << 16, 1 << 17, 1 << 18, 1 << 19, 1 << 20, 1 << 21, 1 << 22, 1 << 23,
+    1 << 24, 1 << 25, 1 << 26, 1 << 27, 1 << 28, 1 << 29, 1 << 30, 1u << 31,
+};
+const struct Trainer gTrainers[TRAINERS_COUNT];
+// GetWinningMove copies the winning move's name
+const u8 gMoveNames[MOVES_COUNT][MOVE_NAME_LENGTH + 1] = {[0 ... MOVES_COUNT - 1] = _("")};
+u8 gStringVar1[0x100];
+u8 gStringVar2[0x100];
+// DecideRoundWinners reads DOME_TRAINERS[0xFF] for a trainer whose opponent
+// is out, which on the GBA lands further on in EWRAM, so there's room for it.
+static union
+{
+    struct SaveBlock2 block;
+    u8 ewram[sizeof(struct SaveBlock2) + 0x1000];
+} sSaveBlock2;
+struct SaveBlock2 *gSaveBlock2Ptr = &sSaveBlock2.block;
+const struct BattleFrontierTrainer *gFacilityTrainers;
+const struct FacilityMon *gFacilityTrainerMons;
+
+u32 gRngValue;
+
+// random.c's
+u16 Random(void)
+{
+    gRngValue = ISO_RANDOMIZE1(gRngValue);
+    return gRngValue >> 16;
+}
+
+void *Alloc(u32 size) { return malloc(size); }
+void *AllocZeroed(u32 size) { return calloc(1, size); }
+void Free(void *pointer) { free(pointer); }
+u8 AI_TypeCalc(u16 move, u16 targetSpecies, u8 targetAbility) { return 0; }
+u16 GetFrontierBrainMonMove(u8 monId, u8 moveSlotId) { return MOVE_NONE; }
+
+u8 *StringCopy(u8 *dest, const u8 *src)
+{
+    while (*src != EOS)
+        *dest++ = *src++;
+    *dest = EOS;
+    return dest;
+}
+
+// battle_tower.c's, for the Frontier's own trainers
+u8 SetFacilityPtrsGetLevel(void)
+{
+    gFacilityTrainers = gBattleFrontierTrainers;
+    gFacilityTrainerMons = gBattleFrontierMons;
+    return FRONTIER_MAX_LEVEL_50;
+}
+
+u16 GetRandomFrontierMonFromSet(u16 trainerId)
+{
+    u8 level = SetFacilityPtrsGetLevel();
+    const u16 *monSet = gFacilityTrainers[trainerId].monSet;
+    u8 numMons = 0;
+    u32 monId;
+
+    while (monSet[numMons] != 0xFFFF)
+        numMons++;
+
+    do
+    {
+        monId = monSet[Random() % numMons];
+    } while (level == FRONTIER_MAX_LEVEL_50 && monId > FRONTIER_MONS_HIGH_TIER);
+
+    return monId;
+}
+
+static struct BattleFrontier sScalarFrontier;
+static u32 sScalarRngValue;
+static u32 sMatchupsChecked;
+static u8 sLossRound;
+
+static void SaveScalarResults(void)
+{
+    memcpy(&sScalarFrontier, &gSaveBlock2Ptr->frontier, sizeof(sScalarFrontier));
+    sScalarRngValue = gRngValue;
+}
+
+static void CompareResults(u32 tournament, const char *what)
+{
+    if (memcmp(&sScalarFrontier, &gSaveBlock2Ptr->frontier, sizeof(sScalarFrontier)) != 0 || gRngValue != sScalarRngValue)
+    {
+        fprintf(stderr, "Tournament %u: %s differs\n", tournament, what);
+        exit(1);
+    }
+}
+
+static void GenerateTournament(u32 seed)
+{
+    memset(&gSaveBlock2Ptr->frontier, 0, sizeof(gSaveBlock2Ptr->frontier));
+    gSaveBlock2Ptr->frontier.challengeStatus = CHALLENGE_STATUS_SAVING;
+    gRngValue = seed;
+    InitRandomTourneyTreeResults();
+}
+
+static void ClearResults(void)
+{
+    int i;
+
+    for (i = 0; i < DOME_TOURNAMENT_TRAINERS_COUNT; i++)
+    {
+        DOME_TRAINERS[i].isEliminated = FALSE;
+        DOME_TRAINERS[i].eliminatedAt = 0;
+        DOME_TRAINERS[i].forfeited = FALSE;
+    }
+}
+
+static void PlayNPCTournament(void)
+{
+    int round;
+
+    for (round = 0; round < DOME_ROUNDS_COUNT; round++)
+        DecideRoundWinners(round);
+}
+
+// The rounds of a tournament the player is in, as ResolveDomeRoundWinners
+// plays them: the player beats each opponent until sLossRound, then the NPCs
+// play out the rest.
+static void PlayPlayerTournament(void)
+{
+    int round, opponent;
+
+    for (round = 0; round < DOME_ROUNDS_COUNT; round++)
+    {
+        if (round < sLossRound)
+        {
+            opponent = TournamentIdOfOpponent(round, TRAINER_PLAYER);
+            if (opponent != 0xFF)
+            {
+                DOME_TRAINERS[opponent].isEliminated = TRUE;
+                DOME_TRAINERS[opponent].eliminatedAt = round;
+            }
+        }
+        else if (round == sLossRound)
+        {
+            DOME_TRAINERS[TrainerIdToTournamentId(TRAINER_PLAYER)].isEliminated = TRUE;
+            DOME_TRAINERS[TrainerIdToTournamentId(TRAINER_PLAYER)].eliminatedAt = round;
+        }
+        DecideRoundWinners(round);
+    }
+}
+
+// Plays the tournament from the same start with each scoring.
+static void PlayBothWays(u32 tournament, const char *what, void (*play)(void))
+{
+    struct BattleFrontier frontier;
+    u32 rngValue = gRngValue;
+
+    memcpy(&frontier, &gSaveBlock2Ptr->frontier, sizeof(frontier));
+    gDomeBatchedMatchups = FALSE;
+    play();
+    SaveScalarResults();
+    memcpy(&gSaveBlock2Ptr->frontier, &frontier, sizeof(frontier));
+    gRngValue = rngValue;
+    gDomeBatchedMatchups = TRUE;
+    play();
+    CompareResults(tournament, what);
+}
+
+// Gives one of the trainers another mon from their set and clears the results.
+static void SetUpNewMonTournament(u32 seed)
+{
+    u8 slot = seed % DOME_TOURNAMENT_TRAINERS_COUNT;
+    u8 monId = (seed >> 4) % FRONTIER_PARTY_SIZE;
+    u16 oldMonId = DOME_MONS[slot][monId];
+
+    do
+    {
+        DOME_MONS[slot][monId] = GetRandomFrontierMonFromSet(DOME_TRAINERS[slot].trainerId);
+    } while (DOME_MONS[slot][monId] == oldMonId);
+    ClearResults();
+}
+
+// Seats the player and the Frontier Brain, whose slots hold species rather
+// than facility mons, and clears the results.
+static void SetUpPlayerTournament(u32 seed)
+{
+    u8 playerSlot = seed % DOME_TOURNAMENT_TRAINERS_COUNT;
+    u8 brainSlot = (playerSlot + 1 + (seed >> 4) % (DOME_TOURNAMENT_TRAINERS_COUNT - 1)) % DOME_TOURNAMENT_TRAINERS_COUNT;
+    int i;
+
+    DOME_TRAINERS[playerSlot].trainerId = TRAINER_PLAYER;
+    DOME_TRAINERS[brainSlot].trainerId = TRAINER_FRONTIER_BRAIN;
+    for (i = 0; i < FRONTIER_PARTY_SIZE; i++)
+    {
+        DOME_MONS[playerSlot][i] = SPECIES_BULBASAUR + (seed + i) % (NUM_SPECIES - 1);
+        DOME_MONS[brainSlot][i] = SPECIES_BULBASAUR + (seed * 7 + i) % (NUM_SPECIES - 1);
+    }
+    ClearResults();
+    sLossRound = (seed >> 8) % (DOME_ROUNDS_COUNT + 1);
+}
+
+// DecideRoundWinners' loops for one side of a match, without the random part
+static s32 CalcScalarPoints(int tournamentId1, int tournamentId2)
+{
+    int monId1, monId2, moveSlot, species;
+    s32 points = 0;
+
+    for (monId1 = 0; monId1 < FRONTIER_PARTY_SIZE; monId1++)
+    {
+        for (moveSlot = 0; moveSlot < MAX_MON_MOVES; moveSlot++)
+        {
+            for (monId2 = 0; monId2 < FRONTIER_PARTY_SIZE; monId2++)
+            {
+                points += GetTypeEffectivenessPoints(gFacilityTrainerMons[DOME_MONS[tournamentId1][monId1]].moves[moveSlot],
+                                                     gFacilityTrainerMons[DOME_MONS[tournamentId2][monId2]].species, EFFECTIVENESS_MODE_AI_VS_AI);
+            }
+        }
+        species = gFacilityTrainerMons[DOME_MONS[tournamentId1][monId1]].species;
+        points += ( gSpeciesInfo[species].baseHP
+                  + gSpeciesInfo[species].baseAttack
+                  + gSpeciesInfo[species].baseDefense
+                  + gSpeciesInfo[species].baseSpeed
+                  + gSpeciesInfo[species].baseSpAttack
+                  + gSpeciesInfo[species].baseSpDefense) / 10;
+    }
+    return points;
+}
+
+static void CheckMatchupPoints(u32 tournament)
+{
+    int i, j;
+
+    BuildDomeMatchups();
+    for (i = 0; i < DOME_TOURNAMENT_TRAINERS_COUNT; i++)
+    {
+        for (j = 0; j < DOME_TOURNAMENT_TRAINERS_COUNT; j++)
+        {
+            s32 points = CalcScalarPoints(i, j);
+
+            sMatchupsChecked++;
+            if (sDomeMatchups.points[i][j] != points)
+            {
+                fprintf(stderr, "Tournament %u: trainer %u scores %d against trainer %u, not %d\n",
+                        tournament, DOME_TRAINERS[i].trainerId, sDomeMatchups.points[i][j], DOME_TRAINERS[j].trainerId, points);
+                exit(1);
+            }
+        }
+    }
+}
+
+int main(void)
+{
+    struct BattleFrontier frontier;
+    struct DomeEvalBenchmark benchmark;
+    u32 tournament, seed, rngValue;
+
+    for (tournament = 0; tournament < NUM_TOURNAMENTS; tournament++)
+    {
+        seed = ISO_RANDOMIZE2(tournament);
+
+        gDomeBatchedMatchups = FALSE;
+        GenerateTournament(seed);
+        SaveScalarResults();
+        gDomeBatchedMatchups = TRUE;
+        GenerateTournament(seed);
+        CompareResults(tournament, "NPC-only tournament");
+
+        if (tournament % POINTS_CHECK_INTERVAL == 0)
+            CheckMatchupPoints(tournament);
+
+        SetUpNewMonTournament(seed);
+        if (tournament % POINTS_CHECK_INTERVAL == 0)
+            CheckMatchupPoints(tournament);
+        PlayBothWays(tournament, "tournament with a new mon", PlayNPCTournament);
+        SetUpPlayerTournament(seed);
+        PlayBothWays(tournament, "tournament with the player", PlayPlayerTournament);
+    }
+
+    memcpy(&frontier, &gSaveBlock2Ptr->frontier, sizeof(frontier));
+    rngValue = gRngValue;
+    DomeEval_Benchmark(0, NUM_BENCHMARK_TOURNAMENTS, &benchmark);
+    if (!benchmark.resultsMatch)
+    {
+        fprintf(stderr, "DomeEval_Benchmark's tallies differ\n");
+        return 1;
+    }
+    if (memcmp(&frontier, &gSaveBlock2Ptr->frontier, sizeof(frontier)) != 0 || gRngValue != rngValue)
+    {
+        fprintf(stderr, "DomeEval_Benchmark changed the frontier data or the RNG\n");
+        return 1;
+    }
+
+    printf("%u tournaments and %u matchups matched\n", NUM_TOURNAMENTS * 3, sMatchupsChecked);
+    return 0;
+}
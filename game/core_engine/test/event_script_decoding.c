@@ -0,0 +1,127 @@
+// Checks that the event scripts are decoded by script_vm.c rather than left
+// to the byte interpreter. The script_data section of event_scripts.o is
+// built into this file's own script_data section, where the decoder finds it
+// through the linker's bounds. EventScript_WhiteOut has to decode to at
+// least one command, and its decoded run has to follow the script byte for
+// byte: each command's opcode and handler, and the command after its
+// operands. Copies of it on the heap and in the save block's RAM script have
+// to be left to the byte interpreter. A goto built in script_data checks that
+// a taken jump goes straight to its decoded target the second time.
+//
+// script_vm.c is built into this file; the command handlers are stand-ins.
+//
+// Usage: event_script_decoding
+//
+// SCRIPTS_BIN is the path of the section and WHITE_OUT_OFFSET the offset of
+// EventScript_WhiteOut in it, both set by test_rules.mk. Built without PIE,
+// like the game, so script pointers fit in a script's 4-byte operands.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "script_vm.c"
+
+struct SaveBlock1 *gSaveBlock1Ptr;
+const u8 *gStdScripts[1];
+const u8 *gStdScripts_End[1];
+
+__asm__(".section script_data, \"aw\"\n"
+        "sEventScripts:\n"
+        ".incbin \"" SCRIPTS_BIN "\"\n"
+        ".previous");
+extern const u8 sEventScripts[] __asm__("sEventScripts");
+
+// goto to the end after it, filled in at runtime
+static u8 sJumpScript[] __attribute__((section("script_data"))) = {0x05, 0, 0, 0, 0, 0x02};
+
+static struct SaveBlock1 sSaveBlock1;
+static ScrCmdFunc sCmdTable[ARRAY_COUNT(sScriptOperandLengths)];
+
+static bool8 StandIn(struct ScriptContext *ctx)
+{
+    return FALSE;
+}
+
+static void Fail(const char *message)
+{
+    fprintf(stderr, "%s\n", message);
+    exit(1);
+}
+
+// Returns how many commands the decoded run starting at script holds.
+static u32 CheckRun(struct ScriptContext *ctx, const u8 *script)
+{
+    const struct ScriptInsn *insn = ScriptVM_Lookup(ctx, script);
+    const u8 *pc = script;
+    u32 count = 0;
+
+    for (; insn != NULL && insn->pc == pc; insn = insn->next)
+    {
+        if (insn->opcode != *pc || insn->func != sCmdTable[*pc])
+        {
+            fprintf(stderr, "Command at 0x%X decoded as 0x%02X\n", (u32)(pc - sEventScripts), insn->opcode);
+            exit(1);
+        }
+        count++;
+        if (sScriptOperandLengths[*pc] == SCRIPT_OPERANDS_VARIABLE)
+            break;
+        pc += 1 + sScriptOperandLengths[*pc];
+    }
+    if (insn != NULL && insn->pc != pc)
+    {
+        fprintf(stderr, "Command after 0x%X linked to 0x%X\n", (u32)(pc - sEventScripts), (u32)(insn->pc - sEventScripts));
+        exit(1);
+    }
+    return count;
+}
+
+int main(void)
+{
+    struct ScriptContext ctx = {0};
+    struct ScriptVMStats stats;
+    const u8 *script = sEventScripts + WHITE_OUT_OFFSET;
+    const struct ScriptInsn *insn, *jumped;
+    u8 *copy;
+    u32 count, target, i;
+
+    gSaveBlock1Ptr = &sSaveBlock1;
+    for (i = 0; i < ARRAY_COUNT(sCmdTable); i++)
+        sCmdTable[i] = StandIn;
+    ctx.cmdTable = sCmdTable;
+    ctx.cmdTableEnd = sCmdTable + ARRAY_COUNT(sCmdTable);
+
+    count = CheckRun(&ctx, script);
+    if (count == 0)
+        Fail("EventScript_WhiteOut wasn't decoded");
+    ScriptVM_GetStats(&stats);
+    if (stats.interpreted != 0)
+        Fail("EventScript_WhiteOut was left to the interpreter");
+
+    copy = malloc(16);
+    memcpy(copy, script, 16);
+    if (ScriptVM_Lookup(&ctx, copy) != NULL)
+        Fail("A copy of EventScript_WhiteOut on the heap was decoded");
+    free(copy);
+    memcpy(sSaveBlock1.ramScript.data.script, script, 16);
+    if (ScriptVM_Lookup(&ctx, sSaveBlock1.ramScript.data.script) != NULL)
+        Fail("A copy of EventScript_WhiteOut in the RAM script was decoded");
+
+    if ((uintptr_t)sJumpScript > 0xFFFFFFFF)
+        Fail("script_data is out of reach of 4-byte script pointers");
+    target = (uintptr_t)&sJumpScript[5];
+    memcpy(&sJumpScript[1], &target, sizeof(target));
+    insn = ScriptVM_Lookup(&ctx, sJumpScript);
+    if (insn == NULL || insn->target != &sJumpScript[5])
+        Fail("The goto's target wasn't read from its operand");
+    ctx.scriptPtr = insn->target;
+    jumped = ScriptVM_Next(&ctx, insn);
+    if (jumped == NULL || jumped->pc != insn->target || ScriptVM_Next(&ctx, insn) != jumped)
+        Fail("The goto didn't go to its decoded target");
+    ScriptVM_GetStats(&stats);
+    if (stats.resolvedJumps != 1)
+        Fail("The goto looked its target up again");
+
+    printf("EventScript_WhiteOut decoded to %u commands\n", count);
+    return 0;
+}
@@ -0,0 +1,268 @@
+// Checks frontier_party_gen.c against the Battle Tower code it replaces.
+//
+// CreateFacilityMon has to build, byte for byte, the mon that
+// CreateMonWithEVSpreadNatureOTID followed by the move, friendship and held
+// item writes of FillTrainerParty (or, for rentals, of
+// FillFactoryFrontierTrainerParty) builds, and leave the RNG in the same
+// state. Every Frontier mon is built both ways, as a trainer's and as a
+// rental, at a few levels, IVs and OT ids.
+//
+// SampleFrontierMons has to make every mon that FillTrainerParty's retry
+// loop could pick next equally likely. For every Frontier trainer, in both
+// level modes and with parties of 0 to 2 mons so far, the RNG is made to
+// return each value below the number of eligible mons in turn, and the mons
+// drawn have to be exactly the entries of the trainer's set that pass
+// FillTrainerParty's tier, species and held item checks.
+//
+// pokemon.c, battle_tower.c and frontier_party_gen.c are built into this
+// file, and the functions they call are stand-ins. Only what the checks
+// reach is linked, so only that needs one.
+//
+// Usage: frontier_mons
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pokemon.c"
+#include "battle_tower.c"
+#include "frontier_party_gen.c"
+
+#define NUM_SAMPLE_ROUNDS 4
+
+const u32 gBitTable[32] =
+{
+    1 << 0,  1 << 1,  1 << 2,  1 << 3,  1 << 4,  1 << 5,  1 << 6,  1 << 7,
+    1 << 8,  1 << 9,  1 << 10, 1 << 11, 1 << 12, 1 << 13, 1 << 14, 1 << 15,
+    1 << 16, 1 << 17, 1 << 18, 1 << 19, 1 << 20, 1 << 21, 1 << 22, 1 << 23,
+    1 << 24, 1 << 25, 1 << 26, 1 << 27, 1 << 28, 1 << 29, 1 << 30, 1u << 31,
+};
+const u8 gSpeciesNames[NUM_SPECIES][POKEMON_NAME_LENGTH + 1];
+const u8 gText_BadEgg[] = _("BAD EGG");
+const u8 gText_EggNickname[] = _("EGG");
+const u8 gGameVersion = VERSION_EMERALD;
+const u8 gGameLanguage = GAME_LANGUAGE;
+u32 gBattleTypeFlags;
+struct BattleScripting gBattleScripting;
+static struct SaveBlock2 sSaveBlock2 = {.playerName = _("PLAYER")};
+struct SaveBlock2 *gSaveBlock2Ptr = &sSaveBlock2;
+
+u32 gRngValue;
+static s32 sForcedRandom = -1;
+
+// random.c's, except that a check can fix what it returns.
+u16 Random(void)
+{
+    if (sForcedRandom >= 0)
+        return sForcedRandom;
+    gRngValue = ISO_RANDOMIZE1(gRngValue);
+    return gRngValue >> 16;
+}
+
+u8 GetCurrentRegionMapSectionId(void) { return 0; }
+
+u8 *StringCopy(u8 *dest, const u8 *src)
+{
+    while (*src != EOS)
+        *dest++ = *src++;
+    *dest = EOS;
+    return dest;
+}
+
+u16 StringLength(const u8 *str)
+{
+    u16 length = 0;
+
+    while (str[length] != EOS)
+        length++;
+    return length;
+}
+
+static struct Pokemon sParty[MAX_FRONTIER_PARTY_SIZE];
+static u32 sMonsChecked;
+static u32 sDrawsChecked;
+
+// The mon creation of FillTrainerParty and FillFactoryFrontierTrainerParty
+// before CreateFacilityMon.
+static void CreateFacilityMonOriginal(struct Pokemon *mon, u16 monId, u8 level, u8 fixedIV, u32 otId, bool8 isRental)
+{
+    u8 friendship;
+    s32 j;
+
+    CreateMonWithEVSpreadNatureOTID(mon,
+                                    gFacilityTrainerMons[monId].species,
+                                    level,
+                                    gFacilityTrainerMons[monId].nature,
+                                    fixedIV,
+                                    gFacilityTrainerMons[monId].evSpread,
+                                    otId);
+
+    friendship = isRental ? 0 : MAX_FRIENDSHIP;
+    for (j = 0; j < MAX_MON_MOVES; j++)
+    {
+        if (isRental)
+        {
+            // SetMonMoveAvoidReturn
+            u16 move = gFacilityTrainerMons[monId].moves[j];
+            if (move == MOVE_RETURN)
+                move = MOVE_FRUSTRATION;
+            SetMonMoveSlot(mon, move, j);
+        }
+        else
+        {
+            SetMonMoveSlot(mon, gFacilityTrainerMons[monId].moves[j], j);
+            if (gFacilityTrainerMons[monId].moves[j] == MOVE_FRUSTRATION)
+                friendship = 0;
+        }
+    }
+
+    SetMonData(mon, MON_DATA_FRIENDSHIP, &friendship);
+    SetMonData(mon, MON_DATA_HELD_ITEM, &gBattleFrontierHeldItems[gFacilityTrainerMons[monId].itemTableId]);
+}
+
+static void CheckCreateFacilityMon(u16 monId, u8 level, u8 fixedIV, u32 otId, bool8 isRental)
+{
+    struct Pokemon original, mon;
+    u32 rngValue = gRngValue, originalRngValue;
+
+    memset(&original, 0xAA, sizeof(original));
+    memset(&mon, 0x55, sizeof(mon));
+    CreateFacilityMonOriginal(&original, monId, level, fixedIV, otId, isRental);
+    originalRngValue = gRngValue;
+    gRngValue = rngValue;
+    CreateFacilityMon(&mon, monId, level, fixedIV, otId, isRental);
+
+    sMonsChecked++;
+    if (memcmp(&original, &mon, sizeof(mon)) != 0 || gRngValue != originalRngValue)
+    {
+        fprintf(stderr, "Mon %u at level %u with IVs %u, OT id 0x%08X%s differs\n",
+                monId, level, fixedIV, otId, isRental ? " as a rental" : "");
+        exit(1);
+    }
+}
+
+static void CheckMonCreation(void)
+{
+    static const u8 levels[] = {FRONTIER_MIN_LEVEL_OPEN, FRONTIER_MAX_LEVEL_50, FRONTIER_MAX_LEVEL_OPEN};
+    u16 monId;
+    u8 i;
+
+    for (monId = 0; monId < NUM_FRONTIER_MONS; monId++)
+    {
+        for (i = 0; i < ARRAY_COUNT(levels); i++)
+        {
+            CheckCreateFacilityMon(monId, levels[i], Random() % (MAX_PER_STAT_IVS + 1), Random32(), FALSE);
+            CheckCreateFacilityMon(monId, levels[i], Random() % (MAX_PER_STAT_IVS + 1), Random32(), TRUE);
+        }
+        CheckCreateFacilityMon(monId, 1 + Random() % MAX_LEVEL, MAX_PER_STAT_IVS, Random32(), FALSE);
+    }
+}
+
+// Whether FillTrainerParty's retry loop would take monId as the next of
+// partySize mons.
+static bool8 CanTakeMon(u16 monId, bool8 allowHighTier, u8 partySize)
+{
+    u8 j;
+
+    if (!allowHighTier && monId > FRONTIER_MONS_HIGH_TIER)
+        return FALSE;
+
+    for (j = 0; j < partySize; j++)
+    {
+        if (GetMonData(&sParty[j], MON_DATA_SPECIES, NULL) == gFacilityTrainerMons[monId].species)
+            return FALSE;
+    }
+    for (j = 0; j < partySize; j++)
+    {
+        if (GetMonData(&sParty[j], MON_DATA_HELD_ITEM, NULL) != ITEM_NONE
+         && GetMonData(&sParty[j], MON_DATA_HELD_ITEM, NULL) == gBattleFrontierHeldItems[gFacilityTrainerMons[monId].itemTableId])
+            return FALSE;
+    }
+    return TRUE;
+}
+
+static int CompareMonIds(const void *a, const void *b)
+{
+    return *(const u16 *)a - *(const u16 *)b;
+}
+
+static void CheckDraws(u16 trainerId, bool8 allowHighTier)
+{
+    const u16 *monSet = gFacilityTrainers[trainerId].monSet;
+    const struct FrontierMonPool *pool = GetFrontierTrainerMonPool(trainerId, allowHighTier);
+    struct FrontierPartyExclusions exclusions, drawExclusions;
+    u16 expected[NUM_FRONTIER_MONS], drawn[NUM_FRONTIER_MONS];
+    u16 eligible, i, monId;
+    u8 partySize, round;
+
+    if (pool == NULL)
+    {
+        fprintf(stderr, "Trainer %u has no pool\n", trainerId);
+        exit(1);
+    }
+
+    for (round = 0; round < NUM_SAMPLE_ROUNDS; round++)
+    {
+        memset(&exclusions, 0, sizeof(exclusions));
+        for (partySize = 0; partySize < FRONTIER_PARTY_SIZE; partySize++)
+        {
+            eligible = 0;
+            for (i = 0; monSet[i] != 0xFFFF; i++)
+            {
+                if (CanTakeMon(monSet[i], allowHighTier, partySize))
+                    expected[eligible++] = monSet[i];
+            }
+
+            for (i = 0; i < eligible; i++)
+            {
+                drawExclusions = exclusions;
+                sForcedRandom = i;
+                if (!SampleFrontierMons(pool, &drawExclusions, &drawn[i], 1))
+                    break;
+            }
+            sForcedRandom = -1;
+            drawExclusions = exclusions;
+            if (i != eligible || (eligible == 0 && SampleFrontierMons(pool, &drawExclusions, drawn, 1)))
+            {
+                fprintf(stderr, "Trainer %u%s with %u mons: %u eligible mons, but the pool disagrees\n",
+                        trainerId, allowHighTier ? " in open level" : "", partySize, eligible);
+                exit(1);
+            }
+
+            sDrawsChecked += eligible;
+            qsort(expected, eligible, sizeof(expected[0]), CompareMonIds);
+            qsort(drawn, eligible, sizeof(drawn[0]), CompareMonIds);
+            if (memcmp(expected, drawn, eligible * sizeof(expected[0])) != 0)
+            {
+                fprintf(stderr, "Trainer %u%s with %u mons: the pool draws different mons\n",
+                        trainerId, allowHighTier ? " in open level" : "", partySize);
+                exit(1);
+            }
+            if (eligible == 0)
+                break;
+
+            monId = expected[Random() % eligible];
+            CreateFacilityMonOriginal(&sParty[partySize], monId, FRONTIER_MAX_LEVEL_50, 0, 0, FALSE);
+            ExcludeFrontierMon(&exclusions, monId);
+        }
+    }
+}
+
+int main(void)
+{
+    u16 trainerId;
+
+    gFacilityTrainers = gBattleFrontierTrainers;
+    gFacilityTrainerMons = gBattleFrontierMons;
+    gRngValue = 1;
+
+    CheckMonCreation();
+    for (trainerId = 0; trainerId < FRONTIER_TRAINERS_COUNT; trainerId++)
+    {
+        CheckDraws(trainerId, FALSE);
+        CheckDraws(trainerId, TRUE);
+    }
+
+    printf("%u mons and %u draws matched\n", sMonsChecked, sDrawsChecked);
+    return 0;
+}
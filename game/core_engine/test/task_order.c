@@ -0,0 +1,309 @@
+// Checks the indexed task list in task.c against the linear scans it
+// replaces. A copy of the original CreateTask, InsertTask, DestroyTask and
+// RunTasks runs on a second task array, and both are given the same random
+// creates, destroys and resets, some of them from inside running tasks. The
+// slots handed out, the order tasks run in and every task's links have to
+// match after each step.
+//
+// task.c is built into this file; the original code is copied below it.
+//
+// Usage: task_order
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "task.c"
+
+#define NUM_FRAMES      200000
+#define MAX_RUN_LOG     256
+
+static struct Task sRefTasks[NUM_TASKS];
+
+static u32 sRngState = 1;
+static bool8 sRunningRef;
+static u8 sRunLog[2][MAX_RUN_LOG];
+static u32 sRunLogCount[2];
+static u32 sSteps;
+
+static u32 Rand(void)
+{
+    sRngState ^= sRngState << 13;
+    sRngState ^= sRngState >> 17;
+    sRngState ^= sRngState << 5;
+    return sRngState;
+}
+
+static u8 RandPriority(void)
+{
+    // Mostly a few close priorities, so that ties are common, with the odd
+    // one from the whole range.
+    if (Rand() % 8 == 0)
+        return Rand() % 256;
+    return Rand() % 5;
+}
+
+// The original task.c, on sRefTasks.
+
+static void RefResetTasks(void)
+{
+    u8 i;
+
+    for (i = 0; i < NUM_TASKS; i++)
+    {
+        sRefTasks[i].isActive = FALSE;
+        sRefTasks[i].func = TaskDummy;
+        sRefTasks[i].prev = i;
+        sRefTasks[i].next = i + 1;
+        sRefTasks[i].priority = -1;
+        memset(sRefTasks[i].data, 0, sizeof(sRefTasks[i].data));
+    }
+
+    sRefTasks[0].prev = HEAD_SENTINEL;
+    sRefTasks[NUM_TASKS - 1].next = TAIL_SENTINEL;
+}
+
+static u8 RefFindFirstActiveTask(void)
+{
+    u8 taskId;
+
+    for (taskId = 0; taskId < NUM_TASKS; taskId++)
+        if (sRefTasks[taskId].isActive == TRUE && sRefTasks[taskId].prev == HEAD_SENTINEL)
+            break;
+
+    return taskId;
+}
+
+static void RefInsertTask(u8 newTaskId)
+{
+    u8 taskId = RefFindFirstActiveTask();
+
+    if (taskId == NUM_TASKS)
+    {
+        sRefTasks[newTaskId].prev = HEAD_SENTINEL;
+        sRefTasks[newTaskId].next = TAIL_SENTINEL;
+        return;
+    }
+
+    while (1)
+    {
+        if (sRefTasks[newTaskId].priority < sRefTasks[taskId].priority)
+        {
+            sRefTasks[newTaskId].prev = sRefTasks[taskId].prev;
+            sRefTasks[newTaskId].next = taskId;
+            if (sRefTasks[taskId].prev != HEAD_SENTINEL)
+                sRefTasks[sRefTasks[taskId].prev].next = newTaskId;
+            sRefTasks[taskId].prev = newTaskId;
+            return;
+        }
+        if (sRefTasks[taskId].next == TAIL_SENTINEL)
+        {
+            sRefTasks[newTaskId].prev = taskId;
+            sRefTasks[newTaskId].next = sRefTasks[taskId].next;
+            sRefTasks[taskId].next = newTaskId;
+            return;
+        }
+        taskId = sRefTasks[taskId].next;
+    }
+}
+
+static u8 RefCreateTask(TaskFunc func, u8 priority)
+{
+    u8 i;
+
+    for (i = 0; i < NUM_TASKS; i++)
+    {
+        if (!sRefTasks[i].isActive)
+        {
+            sRefTasks[i].func = func;
+            sRefTasks[i].priority = priority;
+            RefInsertTask(i);
+            memset(sRefTasks[i].data, 0, sizeof(sRefTasks[i].data));
+            sRefTasks[i].isActive = TRUE;
+            return i;
+        }
+    }
+
+    return 0;
+}
+
+static void RefDestroyTask(u8 taskId)
+{
+    if (sRefTasks[taskId].isActive)
+    {
+        sRefTasks[taskId].isActive = FALSE;
+
+        if (sRefTasks[taskId].prev == HEAD_SENTINEL)
+        {
+            if (sRefTasks[taskId].next != TAIL_SENTINEL)
+                sRefTasks[sRefTasks[taskId].next].prev = HEAD_SENTINEL;
+        }
+        else
+        {
+            if (sRefTasks[taskId].next == TAIL_SENTINEL)
+            {
+                sRefTasks[sRefTasks[taskId].prev].next = TAIL_SENTINEL;
+            }
+            else
+            {
+                sRefTasks[sRefTasks[taskId].prev].next = sRefTasks[taskId].next;
+                sRefTasks[sRefTasks[taskId].next].prev = sRefTasks[taskId].prev;
+            }
+        }
+    }
+}
+
+static void RefRunTasks(void)
+{
+    u8 taskId = RefFindFirstActiveTask();
+
+    if (taskId != NUM_TASKS)
+    {
+        do
+        {
+            sRefTasks[taskId].func(taskId);
+            taskId = sRefTasks[taskId].next;
+        } while (taskId != TAIL_SENTINEL);
+    }
+}
+
+// The test.
+
+static void CompareTasks(const char *step)
+{
+    u8 i;
+
+    sSteps++;
+    for (i = 0; i < NUM_TASKS; i++)
+    {
+        if (gTasks[i].isActive != sRefTasks[i].isActive
+         || gTasks[i].prev != sRefTasks[i].prev
+         || gTasks[i].next != sRefTasks[i].next
+         || gTasks[i].priority != sRefTasks[i].priority
+         || gTasks[i].func != sRefTasks[i].func)
+        {
+            fprintf(stderr, "Step %u (%s): task %u has active %u, prev %u, next %u, priority %u; "
+                            "the original has active %u, prev %u, next %u, priority %u\n",
+                    sSteps, step, i,
+                    gTasks[i].isActive, gTasks[i].prev, gTasks[i].next, gTasks[i].priority,
+                    sRefTasks[i].isActive, sRefTasks[i].prev, sRefTasks[i].next, sRefTasks[i].priority);
+            exit(1);
+        }
+    }
+}
+
+static void CompareIds(const char *step, u8 taskId, u8 refTaskId)
+{
+    if (taskId != refTaskId)
+    {
+        fprintf(stderr, "Step %u (%s): got task %u, the original got %u\n", sSteps, step, taskId, refTaskId);
+        exit(1);
+    }
+}
+
+// Both lists are given the same operations, so the random numbers each one
+// draws stay in step for as long as they agree.
+static u8 DoCreateTask(TaskFunc func, u8 priority)
+{
+    return sRunningRef ? RefCreateTask(func, priority) : CreateTask(func, priority);
+}
+
+static void DoDestroyTask(u8 taskId)
+{
+    if (sRunningRef)
+        RefDestroyTask(taskId);
+    else
+        DestroyTask(taskId);
+}
+
+static void Task_Random(u8 taskId)
+{
+    u32 *count = &sRunLogCount[sRunningRef];
+
+    if (*count < MAX_RUN_LOG)
+        sRunLog[sRunningRef][*count] = taskId;
+    if (++*count > MAX_RUN_LOG)
+        return;
+
+    switch (Rand() % 8)
+    {
+    case 0:
+        DoCreateTask(Task_Random, RandPriority());
+        break;
+    case 1:
+        DoDestroyTask(taskId);
+        break;
+    case 2:
+        DoDestroyTask(Rand() % NUM_TASKS);
+        break;
+    case 3:
+        DoDestroyTask(taskId);
+        DoCreateTask(Task_Random, RandPriority());
+        break;
+    }
+}
+
+static void RunBoth(void)
+{
+    u32 state = sRngState;
+
+    sRunLogCount[FALSE] = sRunLogCount[TRUE] = 0;
+    sRunningRef = TRUE;
+    RefRunTasks();
+    sRngState = state;
+    sRunningRef = FALSE;
+    RunTasks();
+
+    if (sRunLogCount[FALSE] != sRunLogCount[TRUE]
+     || memcmp(sRunLog[FALSE], sRunLog[TRUE], min(sRunLogCount[TRUE], MAX_RUN_LOG)) != 0)
+    {
+        fprintf(stderr, "Step %u: tasks ran in a different order\n", sSteps + 1);
+        exit(1);
+    }
+    CompareTasks("RunTasks");
+}
+
+int main(void)
+{
+    u32 frame, i, ops;
+    u8 priority;
+
+    // Both lists are usable zero-initialised, before the first reset.
+    priority = RandPriority();
+    CompareIds("CreateTask", CreateTask(Task_Random, priority), RefCreateTask(Task_Random, priority));
+    CompareTasks("CreateTask");
+
+    for (frame = 0; frame < NUM_FRAMES; frame++)
+    {
+        if (Rand() % 1000 == 0)
+        {
+            ResetTasks();
+            RefResetTasks();
+            CompareTasks("ResetTasks");
+        }
+
+        ops = Rand() % 6;
+        for (i = 0; i < ops; i++)
+        {
+            if (Rand() % 2 == 0)
+            {
+                priority = RandPriority();
+                CompareIds("CreateTask", CreateTask(Task_Random, priority), RefCreateTask(Task_Random, priority));
+                CompareTasks("CreateTask");
+            }
+            else
+            {
+                u8 taskId = Rand() % NUM_TASKS;
+
+                DestroyTask(taskId);
+                RefDestroyTask(taskId);
+                CompareTasks("DestroyTask");
+            }
+        }
+
+        RunBoth();
+    }
+
+    printf("%u steps over %u frames matched\n", sSteps, NUM_FRAMES);
+    return 0;
+}
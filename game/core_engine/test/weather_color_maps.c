@@ -0,0 +1,194 @@
+// Checks the weather color maps baked into lookup tables in field_weather.c
+// against the per-channel code they replace. Every RGB555 color, with and
+// without the unused top bit, goes through every color map step, blend
+// coefficient and fade color the field uses, through both paths, and the
+// faded palettes have to match after each call. Fog is run with no sprite
+// palettes to lighten as well as with the most it can have.
+// WeatherColorMap_Benchmark is run last, to check it leaves the field's
+// weather state alone.
+//
+// field_weather.c is built into this file; the functions it calls that
+// don't touch palettes are stand-ins.
+//
+// Usage: weather_color_maps
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "field_weather.c"
+
+u16 ALIGNED(4) gPlttBufferUnfaded[PLTT_BUFFER_SIZE];
+u16 ALIGNED(4) gPlttBufferFaded[PLTT_BUFFER_SIZE];
+struct PaletteFadeControl gPaletteFade;
+struct Task gTasks[NUM_TASKS];
+const s16 gSineTable[320];
+
+#define WEATHER_STAND_INS(name) \
+    void name##_InitVars(void) {} \
+    void name##_Main(void) {} \
+    void name##_InitAll(void) {} \
+    bool8 name##_Finish(void) { return FALSE; }
+
+WEATHER_STAND_INS(Clouds)
+WEATHER_STAND_INS(Sunny)
+WEATHER_STAND_INS(Rain)
+WEATHER_STAND_INS(Snow)
+WEATHER_STAND_INS(Thunderstorm)
+WEATHER_STAND_INS(FogHorizontal)
+WEATHER_STAND_INS(Ash)
+WEATHER_STAND_INS(Sandstorm)
+WEATHER_STAND_INS(FogDiagonal)
+WEATHER_STAND_INS(Shade)
+WEATHER_STAND_INS(Drought)
+WEATHER_STAND_INS(Bubbles)
+void Downpour_InitVars(void) {}
+void Downpour_InitAll(void) {}
+
+#undef CpuSet
+#undef CpuFastSet
+
+void CpuSet(const void *src, void *dest, u32 control)
+{
+    u32 count = control & 0x1FFFFF;
+    u32 size = (control & CPU_SET_32BIT) ? 4 : 2;
+    u32 i;
+
+    for (i = 0; i < count; i++)
+        memcpy((u8 *)dest + i * size, (control & CPU_SET_SRC_FIXED) ? src : (const u8 *)src + i * size, size);
+}
+
+void CpuFastSet(const void *src, void *dest, u32 control)
+{
+    CpuSet(src, dest, CPU_SET_32BIT | (control & (CPU_FAST_SET_SRC_FIXED | 0x1FFFFF)));
+}
+
+// The same as util.c's
+void BlendPalette(u16 palOffset, u16 numEntries, u8 coeff, u16 blendColor)
+{
+    u16 i;
+
+    for (i = 0; i < numEntries; i++)
+    {
+        u16 index = i + palOffset;
+        struct PlttData *data1 = (struct PlttData *)&gPlttBufferUnfaded[index];
+        s8 r = data1->r;
+        s8 g = data1->g;
+        s8 b = data1->b;
+        struct PlttData *data2 = (struct PlttData *)&blendColor;
+        gPlttBufferFaded[index] = RGB(r + (((data2->r - r) * coeff) >> 4),
+                                      g + (((data2->g - g) * coeff) >> 4),
+                                      b + (((data2->b - b) * coeff) >> 4));
+    }
+}
+
+void *Alloc(u32 size) { return malloc(size); }
+void Free(void *pointer) { free(pointer); }
+u8 AllocSpritePalette(u16 tag) { return 0; }
+bool8 BeginNormalPaletteFade(u32 selectedPalettes, s8 delay, u8 startY, u8 targetY, u16 blendColor) { return FALSE; }
+u8 CreateTask(TaskFunc func, u8 priority) { return 0; }
+bool8 FuncIsActiveTask(TaskFunc func) { return FALSE; }
+bool8 IsSpecialSEPlaying(void) { return FALSE; }
+void FrameRender_MarkVramWritten(uintptr_t dest, u32 size) {}
+void LoadPalette(const void *src, u16 offset, u16 size) {}
+void PlaySE(u16 songNum) {}
+void SetGpuReg(u8 regOffset, u16 value) {}
+
+static const u16 sBlendColors[] = {RGB_BLACK, RGB_WHITEALPHA, RGB(10, 20, 5)};
+
+static u16 sScalarPltt[PLTT_BUFFER_SIZE];
+static u32 sCalls;
+
+// Runs a call both ways and compares the palettes.
+#define CHECK(call, fmt, ...)                                                        \
+    do                                                                               \
+    {                                                                                \
+        gWeatherColorMapLuts = FALSE;                                                \
+        call;                                                                        \
+        memcpy(sScalarPltt, gPlttBufferFaded, PLTT_SIZE);                            \
+        gWeatherColorMapLuts = TRUE;                                                 \
+        call;                                                                        \
+        sCalls++;                                                                    \
+        if (memcmp(sScalarPltt, gPlttBufferFaded, PLTT_SIZE) != 0)                   \
+        {                                                                            \
+            fprintf(stderr, "Colors 0x%04X-0x%04X: " fmt " differs\n",               \
+                    gPlttBufferUnfaded[0], gPlttBufferUnfaded[PLTT_BUFFER_SIZE - 1], \
+                    __VA_ARGS__);                                                    \
+            exit(1);                                                                 \
+        }                                                                            \
+    } while (0)
+
+static void CheckColors(void)
+{
+    s32 colorMap;
+    u8 coeff, color;
+
+    for (colorMap = -6; colorMap <= NUM_WEATHER_COLOR_MAPS; colorMap++)
+        CHECK(ApplyColorMap(0, 32, colorMap), "color map %d", colorMap);
+
+    for (color = 0; color < ARRAY_COUNT(sBlendColors); color++)
+    {
+        for (coeff = 0; coeff <= 16; coeff++)
+        {
+            for (colorMap = 1; colorMap <= NUM_WEATHER_COLOR_MAPS; colorMap++)
+                CHECK(ApplyColorMapWithBlend(0, 32, colorMap, coeff, sBlendColors[color]),
+                      "color map %d blended %u toward 0x%04X", colorMap, coeff, sBlendColors[color]);
+            for (colorMap = -1; colorMap >= -6; colorMap--)
+                CHECK(ApplyDroughtColorMapWithBlend(colorMap, coeff, sBlendColors[color]),
+                      "drought map %d blended %u toward 0x%04X", colorMap, coeff, sBlendColors[color]);
+        }
+    }
+}
+
+static void CheckFog(void)
+{
+    u8 coeff, color;
+
+    for (color = 0; color < ARRAY_COUNT(sBlendColors); color++)
+    {
+        for (coeff = 0; coeff <= 16; coeff++)
+            CHECK(ApplyFogBlend(coeff, sBlendColors[color]),
+                  "fog with %u lightened palettes blended %u toward 0x%04X",
+                  gWeatherPtr->lightenedFogSpritePalsCount, coeff, sBlendColors[color]);
+    }
+}
+
+int main(void)
+{
+    struct WeatherColorMapBenchmark benchmark;
+    struct Weather weather;
+    u32 first, i;
+    u8 topBit;
+
+    SetUpBenchmarkWeather();
+    for (topBit = 0; topBit < 2; topBit++)
+    {
+        for (first = 0; first < 0x8000; first += PLTT_BUFFER_SIZE)
+        {
+            for (i = 0; i < PLTT_BUFFER_SIZE; i++)
+                gPlttBufferUnfaded[i] = (first + i) | (topBit << 15);
+
+            CheckColors();
+            CheckFog();
+            gWeatherPtr->lightenedFogSpritePalsCount = 0;
+            CheckFog();
+            SetUpBenchmarkWeather();
+        }
+    }
+
+    memcpy(&weather, &gWeather, sizeof(gWeather));
+    WeatherColorMap_Benchmark(1, &benchmark);
+    if (!benchmark.resultsMatch)
+    {
+        fprintf(stderr, "WeatherColorMap_Benchmark's palettes differ\n");
+        return 1;
+    }
+    if (memcmp(&weather, &gWeather, sizeof(gWeather)) != 0)
+    {
+        fprintf(stderr, "WeatherColorMap_Benchmark changed the weather state\n");
+        return 1;
+    }
+
+    printf("%u calls matched\n", sCalls);
+    return 0;
+}
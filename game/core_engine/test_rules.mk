@@ -0,0 +1,108 @@
+# Differential tests for the PORTABLE changes, built for the host and run with
+# `make check`. Each one runs the new code and the code it replaces on the
+# same inputs; see the files in test/ for what they compare.
+
+TEST_SUBDIR = test
+TEST_BUILDDIR = $(OBJ_DIR)/$(TEST_SUBDIR)
+TEST_CFLAGS := -O2 -std=gnu11 -Wall -iquote include -iquote $(C_SUBDIR) -DMODERN=1
+# For tests built around a file of the game: its PORTABLE build, with
+# INCBINs expanded the way the game's are.
+TEST_GAME_CFLAGS := $(TEST_CFLAGS) -iquote sdl2gflib/include -DPORTABLE -fno-strict-aliasing -Wno-pointer-sign
+
+.PHONY: check
+check: check-ai-scripts check-weather-luts check-script-vm check-task-order check-frontier-mons check-dome-matchups check-replays
+
+# The compiled AI scripts against the interpreter. ai_script_compiler checks
+# the generated dispatch over every path through the script data from
+# battle_ai_scripts_check.o, with stand-in handlers. The recorded battles in
+# test/replays then run the real handlers both ways: with EMERALD_AI_SCRIPTS
+# set to differential, the host game (HOST_GAME, see check-replays) fails a
+# replay whose compiled scripts left a different score or state than the
+# interpreter.
+$(TEST_BUILDDIR)/battle_ai_scripts.bin: $(DATA_ASM_BUILDDIR)/battle_ai_scripts_check.o
+	@mkdir -p $(@D)
+	$(OBJCOPY) -O binary -j script_data $< $@
+
+$(TEST_BUILDDIR)/ai_script_compiler$(EXE): $(TEST_SUBDIR)/ai_script_compiler.c $(DATA_SRC_SUBDIR)/battle_ai_scripts.h
+	@mkdir -p $(@D)
+	$(CC) $(TEST_CFLAGS) -o $@ $<
+
+.PHONY: check-ai-scripts
+check-ai-scripts: $(TEST_BUILDDIR)/ai_script_compiler$(EXE) $(TEST_BUILDDIR)/battle_ai_scripts.bin
+	$(TEST_BUILDDIR)/ai_script_compiler$(EXE) $(TEST_BUILDDIR)/battle_ai_scripts.bin
+	@test -n "$(HOST_GAME)" || { echo "check-ai-scripts: set HOST_GAME to the host build of the game" >&2; exit 1; }
+	EMERALD_AI_SCRIPTS=differential EMERALD_VERIFY_REPLAYS=$$(echo $(REPLAYS) | tr ' ' ':') $(HOST_GAME)
+
+# The weather color map lookup tables against the per-channel code, over
+# field_weather.c.
+$(TEST_BUILDDIR)/weather_color_maps$(EXE): $(TEST_SUBDIR)/weather_color_maps.c $(C_SUBDIR)/field_weather.c graphics/weather/fog.gbapal $(AUTO_GEN_TARGETS)
+	@mkdir -p $(@D)
+	$(CC) -E $(TEST_GAME_CFLAGS) $< | $(PREPROC) -i $< charmap.txt | $(CC) $(TEST_GAME_CFLAGS) -x c -o $@ -
+
+.PHONY: check-weather-luts
+check-weather-luts: $(TEST_BUILDDIR)/weather_color_maps$(EXE)
+	$(TEST_BUILDDIR)/weather_color_maps$(EXE)
+
+# The event script decoder, on the script data from event_scripts.o. The
+# test is built without PIE so that script pointers fit in 4 bytes.
+$(TEST_BUILDDIR)/event_scripts.bin: $(DATA_ASM_BUILDDIR)/event_scripts.o
+	@mkdir -p $(@D)
+	$(OBJCOPY) -O binary -j script_data $< $@
+
+WHITE_OUT_OFFSET = 0x$(shell $(PREFIX)nm $(DATA_ASM_BUILDDIR)/event_scripts.o | sed -n 's/^\([0-9a-fA-F]*\) . EventScript_WhiteOut$$/\1/p')
+
+$(TEST_BUILDDIR)/event_script_decoding$(EXE): $(TEST_SUBDIR)/event_script_decoding.c $(C_SUBDIR)/script_vm.c $(TEST_BUILDDIR)/event_scripts.bin $(AUTO_GEN_TARGETS)
+	@mkdir -p $(@D)
+	$(CC) -E $(TEST_GAME_CFLAGS) -DSCRIPTS_BIN='"$(TEST_BUILDDIR)/event_scripts.bin"' -DWHITE_OUT_OFFSET=$(WHITE_OUT_OFFSET) $< | $(PREPROC) -i $< charmap.txt | $(CC) $(TEST_GAME_CFLAGS) -no-pie -x c -o $@ -
+
+.PHONY: check-script-vm
+check-script-vm: $(TEST_BUILDDIR)/event_script_decoding$(EXE)
+	$(TEST_BUILDDIR)/event_script_decoding$(EXE)
+
+# The indexed task list against the original linear scans, over task.c.
+$(TEST_BUILDDIR)/task_order$(EXE): $(TEST_SUBDIR)/task_order.c $(C_SUBDIR)/task.c $(AUTO_GEN_TARGETS)
+	@mkdir -p $(@D)
+	$(CC) -E $(TEST_GAME_CFLAGS) $< | $(PREPROC) -i $< charmap.txt | $(CC) $(TEST_GAME_CFLAGS) -x c -o $@ -
+
+.PHONY: check-task-order
+check-task-order: $(TEST_BUILDDIR)/task_order$(EXE)
+	$(TEST_BUILDDIR)/task_order$(EXE)
+
+# CreateFacilityMon and the Frontier mon pools against the Battle Tower's
+# party code, over pokemon.c, battle_tower.c and frontier_party_gen.c. The
+# test only links what its checks reach, so it needs few stand-ins.
+$(TEST_BUILDDIR)/frontier_mons$(EXE): $(TEST_SUBDIR)/frontier_mons.c $(C_SUBDIR)/pokemon.c $(C_SUBDIR)/battle_tower.c $(C_SUBDIR)/frontier_party_gen.c $(SPINDAGFXDIR)/spot_0.1bpp $(SPINDAGFXDIR)/spot_1.1bpp $(SPINDAGFXDIR)/spot_2.1bpp $(SPINDAGFXDIR)/spot_3.1bpp $(AUTO_GEN_TARGETS)
+	@mkdir -p $(@D)
+	$(CC) -E $(TEST_GAME_CFLAGS) $< | $(PREPROC) -i $< charmap.txt | $(CC) $(TEST_GAME_CFLAGS) -ffunction-sections -fdata-sections -Wl,--gc-sections -x c -o $@ -
+
+.PHONY: check-frontier-mons
+check-frontier-mons: $(TEST_BUILDDIR)/frontier_mons$(EXE)
+	$(TEST_BUILDDIR)/frontier_mons$(EXE)
+
+# The batched Dome matchup scoring against DecideRoundWinners' loops, over
+# battle_dome.c, pokemon.c and battle_main.c. Like frontier_mons, it only
+# links what its checks reach.
+$(TEST_BUILDDIR)/dome_matchups$(EXE): $(TEST_SUBDIR)/dome_matchups.c $(C_SUBDIR)/battle_dome.c $(C_SUBDIR)/pokemon.c $(C_SUBDIR)/battle_main.c $(SPINDAGFXDIR)/spot_0.1bpp $(SPINDAGFXDIR)/spot_1.1bpp $(SPINDAGFXDIR)/spot_2.1bpp $(SPINDAGFXDIR)/spot_3.1bpp $(AUTO_GEN_TARGETS)
+	@mkdir -p $(@D)
+	$(CC) -E $(TEST_GAME_CFLAGS) $< | $(PREPROC) -i $< charmap.txt | $(CC) $(TEST_GAME_CFLAGS) -ffunction-sections -fdata-sections -Wl,--gc-sections -x c -o $@ -
+
+.PHONY: check-dome-matchups
+check-dome-matchups: $(TEST_BUILDDIR)/dome_matchups$(EXE)
+	$(TEST_BUILDDIR)/dome_matchups$(EXE)
+
+# test/replays holds battles recorded with BattleReplay. They need the whole
+# battle engine, so the host build of the game, which this makefile doesn't
+# build, checks them: HOST_GAME names it. Started with EMERALD_VERIFY_REPLAYS
+# set to a ':'-separated list of replays, it replays each one, reports how
+# many battles a second it got through and exits with 0 if they all still
+# play out the same. With EMERALD_CHECK_BATTLE_SIM set to one of them, it
+# runs that battle from many seeds in process and across workers, and exits
+# with 0 if both summaries match.
+REPLAYS := $(wildcard $(TEST_SUBDIR)/replays/*.ebrp)
+HOST_GAME ?=
+
+.PHONY: check-replays
+check-replays:
+	@test -n "$(HOST_GAME)" || { echo "check-replays: set HOST_GAME to the host build of the game" >&2; exit 1; }
+	EMERALD_VERIFY_REPLAYS=$$(echo $(REPLAYS) | tr ' ' ':') $(HOST_GAME)
+	EMERALD_CHECK_BATTLE_SIM=$(firstword $(REPLAYS)) $(HOST_GAME)
@@ -0,0 +1,990 @@
+// aiscr2c - translates the battle AI scripts into C
+//
+// Usage: aiscr2c MACROS_INC COMMANDS_C SCRIPTS_S OUTPUT_H [CHECK_INC]
+//
+// MACROS_INC is asm/macros/battle_ai_script.inc, COMMANDS_C is
+// src/battle_ai_script_commands.c, whose sBattleAICmdTable names the handler
+// for each opcode, and SCRIPTS_S is battle_ai_scripts.s after cpp, or "-" to
+// read it from stdin. Every command becomes a direct call to its handler,
+// with gAIScriptPtr at the command's bytes in the assembled scripts,
+// followed by the jumps it can make:
+//
+//   if_hp_less_than AI_USER, 50, Label   ->  AI_RUN(0x1A4, Cmd_if_hp_less_than);
+//                                            if (AI_JUMPED(0x2C0))
+//                                                goto Label;
+//                                            AI_EXPECT(0x1AB);
+//
+// The handlers still read their operands from the script data, as they do
+// in the interpreter, so what's translated is the dispatch: no opcode fetch
+// or table lookup, and the jumps are C gotos. goto becomes a C goto and call
+// a C call. Wherever a handler
+// leaves gAIScriptPtr somewhere the script doesn't jump, the interpreter
+// takes over from there. Each entry of the script table (and each call
+// target) is emitted as one function holding every command reachable from
+// it, and the table itself as sCompiledBattleAIScripts.
+//
+// The offsets are counted from the script table, and found at run time from
+// where its first entry points, so the width of the table's pointers doesn't
+// matter as long as the scripts after it are laid out as counted. CHECK_INC holds assembler
+// checks that every label is where aiscr2c counted it; it's assembled after
+// the scripts, so a layout aiscr2c got wrong stops the build.
+
+#include <ctype.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define FATAL_ERROR(format, ...)            \
+do                                          \
+{                                           \
+    fprintf(stderr, format, ##__VA_ARGS__); \
+    exit(1);                                \
+} while (0)
+
+#define MAX_NAME_LENGTH 128
+#define MAX_PARAMS 8
+#define MAX_ARG_LENGTH 256
+#define MAX_LINE_LENGTH 1024
+#define MAX_EXPANSION_DEPTH 8
+#define NUM_OPCODES 256
+
+struct Operand
+{
+    int width; // 1, 2 or 4 bytes
+    int param; // index into the macro's params
+};
+
+struct Macro
+{
+    char name[MAX_NAME_LENGTH];
+    int numParams;
+    char params[MAX_PARAMS][MAX_NAME_LENGTH];
+    int numLines;
+    char **lines;
+    // Set for macros that emit a command directly.
+    bool isCommand;
+    int opcode;
+    int numOperands;
+    struct Operand operands[MAX_PARAMS];
+};
+
+enum
+{
+    ITEM_COMMAND,
+    ITEM_DATA,
+};
+
+struct Item
+{
+    int type;
+    int line;
+    int offset; // bytes from the script table, which comes first
+    int size;
+    // ITEM_COMMAND
+    const struct Macro *command;
+    int numArgs;
+    char args[MAX_PARAMS][MAX_ARG_LENGTH];
+    // ITEM_DATA
+    int width;
+    char value[MAX_ARG_LENGTH];
+};
+
+struct Label
+{
+    char name[MAX_NAME_LENGTH];
+    int item;
+    int offset;
+};
+
+static struct Macro *sMacros;
+static int sNumMacros;
+
+static struct Item *sItems;
+static int sNumItems;
+static int sItemCapacity;
+
+static struct Label *sLabels;
+static int sNumLabels;
+static int sLabelCapacity;
+
+static int sSize;
+
+// The interpreter's handler for each opcode, from sBattleAICmdTable.
+static char *sHandlers[NUM_OPCODES];
+
+static const char *sScriptPath;
+
+static void *Realloc(void *ptr, size_t size)
+{
+    ptr = realloc(ptr, size);
+    if (ptr == NULL)
+        FATAL_ERROR("Out of memory.\n");
+    return ptr;
+}
+
+static char *Strdup(const char *str)
+{
+    char *copy = Realloc(NULL, strlen(str) + 1);
+    strcpy(copy, str);
+    return copy;
+}
+
+static char *Trim(char *str)
+{
+    char *end;
+
+    while (isspace((unsigned char)*str))
+        str++;
+    end = str + strlen(str);
+    while (end > str && isspace((unsigned char)end[-1]))
+        end--;
+    *end = '\0';
+    return str;
+}
+
+// Strips "@" comments and, since the scripts go through cpp, "//" comments.
+static void StripComment(char *line)
+{
+    char *comment = strchr(line, '@');
+
+    if (comment != NULL)
+        *comment = '\0';
+    comment = strstr(line, "//");
+    if (comment != NULL)
+        *comment = '\0';
+}
+
+static bool IsIdentifierChar(char c)
+{
+    return isalnum((unsigned char)c) || c == '_';
+}
+
+static bool IsIdentifier(const char *str)
+{
+    if (!isalpha((unsigned char)*str) && *str != '_')
+        return false;
+    while (*str != '\0')
+    {
+        if (!IsIdentifierChar(*str))
+            return false;
+        str++;
+    }
+    return true;
+}
+
+// Splits "a, (b | c), d" on the commas outside of parentheses.
+static int SplitArgs(const char *file, int lineNum, char *str, char args[][MAX_ARG_LENGTH])
+{
+    int numArgs = 0;
+    int depth = 0;
+    char *start = str;
+
+    str = Trim(str);
+    if (*str == '\0')
+        return 0;
+
+    for (start = str;; str++)
+    {
+        if (*str == '(')
+            depth++;
+        else if (*str == ')')
+            depth--;
+
+        if ((*str == ',' && depth == 0) || *str == '\0')
+        {
+            bool last = (*str == '\0');
+            char *arg;
+
+            *str = '\0';
+            arg = Trim(start);
+            if (numArgs == MAX_PARAMS)
+                FATAL_ERROR("%s:%d: too many arguments\n", file, lineNum);
+            if (strlen(arg) >= MAX_ARG_LENGTH)
+                FATAL_ERROR("%s:%d: argument too long\n", file, lineNum);
+            strcpy(args[numArgs++], arg);
+            if (last)
+                break;
+            start = str + 1;
+        }
+    }
+    return numArgs;
+}
+
+// Splits "name rest" into the first word and the rest of the line.
+static char *SplitWord(char *line, char **rest)
+{
+    char *word = line;
+
+    while (*line != '\0' && !isspace((unsigned char)*line))
+        line++;
+    if (*line != '\0')
+        *line++ = '\0';
+    *rest = line;
+    return word;
+}
+
+static const struct Macro *FindMacro(const char *name)
+{
+    int i;
+
+    for (i = 0; i < sNumMacros; i++)
+    {
+        if (strcmp(sMacros[i].name, name) == 0)
+            return &sMacros[i];
+    }
+    return NULL;
+}
+
+static int FindParam(const struct Macro *macro, const char *name)
+{
+    int i;
+
+    for (i = 0; i < macro->numParams; i++)
+    {
+        if (strcmp(macro->params[i], name) == 0)
+            return i;
+    }
+    return -1;
+}
+
+static int GetDirectiveWidth(const char *directive)
+{
+    if (strcmp(directive, ".byte") == 0)
+        return 1;
+    if (strcmp(directive, ".2byte") == 0)
+        return 2;
+    if (strcmp(directive, ".4byte") == 0)
+        return 4;
+    return 0;
+}
+
+static FILE *OpenFile(const char *path, const char *mode)
+{
+    FILE *fp = fopen(path, mode);
+
+    if (fp == NULL)
+        FATAL_ERROR("Failed to open \"%s\".\n", path);
+    return fp;
+}
+
+static void ReadMacros(const char *path)
+{
+    FILE *fp = OpenFile(path, "r");
+    char buffer[MAX_LINE_LENGTH];
+    struct Macro *macro = NULL;
+    int lineNum = 0;
+
+    while (fgets(buffer, sizeof(buffer), fp) != NULL)
+    {
+        char *line, *word, *rest;
+
+        lineNum++;
+        StripComment(buffer);
+        line = Trim(buffer);
+        if (*line == '\0')
+            continue;
+
+        word = SplitWord(line, &rest);
+        if (strcmp(word, ".macro") == 0)
+        {
+            char params[MAX_PARAMS][MAX_ARG_LENGTH];
+            char *name;
+            int i;
+
+            if (macro != NULL)
+                FATAL_ERROR("%s:%d: nested .macro\n", path, lineNum);
+
+            sMacros = Realloc(sMacros, sizeof(*sMacros) * (sNumMacros + 1));
+            macro = &sMacros[sNumMacros++];
+            memset(macro, 0, sizeof(*macro));
+
+            name = SplitWord(Trim(rest), &rest);
+            snprintf(macro->name, sizeof(macro->name), "%s", name);
+            macro->numParams = SplitArgs(path, lineNum, rest, params);
+            for (i = 0; i < macro->numParams; i++)
+            {
+                char *colon = strchr(params[i], ':');
+                if (colon != NULL)
+                    *colon = '\0';
+                if (strlen(params[i]) >= sizeof(macro->params[i]))
+                    FATAL_ERROR("%s:%d: parameter name too long\n", path, lineNum);
+                strcpy(macro->params[i], params[i]);
+            }
+        }
+        else if (strcmp(word, ".endm") == 0)
+        {
+            if (macro == NULL)
+                FATAL_ERROR("%s:%d: .endm without .macro\n", path, lineNum);
+            macro = NULL;
+        }
+        else if (macro != NULL)
+        {
+            int width = GetDirectiveWidth(word);
+            char joined[MAX_LINE_LENGTH];
+
+            // Stored as "name args", the same shape as a script line.
+            rest = Trim(rest);
+            snprintf(joined, sizeof(joined), "%s %s", word, rest);
+            macro->lines = Realloc(macro->lines, sizeof(*macro->lines) * (macro->numLines + 1));
+            macro->lines[macro->numLines++] = Strdup(joined);
+
+            // A command macro is the opcode byte followed by its operands.
+            if (width == 1 && macro->numLines == 1 && rest[0] != '\\')
+            {
+                macro->isCommand = true;
+                macro->opcode = strtol(rest, NULL, 0);
+            }
+            else if (macro->isCommand)
+            {
+                int param = (rest[0] == '\\') ? FindParam(macro, rest + 1) : -1;
+
+                if (width == 0 || param < 0)
+                    FATAL_ERROR("%s:%d: unexpected line in command macro %s\n", path, lineNum, macro->name);
+                macro->operands[macro->numOperands].width = width;
+                macro->operands[macro->numOperands].param = param;
+                macro->numOperands++;
+            }
+        }
+    }
+
+    if (macro != NULL)
+        FATAL_ERROR("%s: missing .endm for %s\n", path, macro->name);
+    fclose(fp);
+}
+
+// Reads the handler names out of sBattleAICmdTable, in opcode order.
+static void ReadHandlers(const char *path)
+{
+    FILE *fp = OpenFile(path, "r");
+    char buffer[MAX_LINE_LENGTH];
+    bool inTable = false;
+    int lineNum = 0;
+    int opcode = 0;
+
+    while (fgets(buffer, sizeof(buffer), fp) != NULL)
+    {
+        char *line;
+        char *end;
+
+        lineNum++;
+        if (!inTable)
+        {
+            inTable = (strstr(buffer, "sBattleAICmdTable[] =") != NULL);
+            continue;
+        }
+
+        StripComment(buffer);
+        line = Trim(buffer);
+        if (*line == '{' || *line == '\0')
+            continue;
+        if (*line == '}')
+            break;
+
+        end = strchr(line, ',');
+        if (end != NULL)
+            *end = '\0';
+        line = Trim(line);
+        if (!IsIdentifier(line))
+            FATAL_ERROR("%s:%d: expected a handler in sBattleAICmdTable\n", path, lineNum);
+        if (opcode == NUM_OPCODES)
+            FATAL_ERROR("%s:%d: sBattleAICmdTable has more than %d entries\n", path, lineNum, NUM_OPCODES);
+        sHandlers[opcode++] = Strdup(line);
+    }
+
+    if (opcode == 0)
+        FATAL_ERROR("%s: no sBattleAICmdTable\n", path);
+    fclose(fp);
+}
+
+static const char *GetHandler(const struct Macro *command)
+{
+    if (command->opcode < 0 || command->opcode >= NUM_OPCODES || sHandlers[command->opcode] == NULL)
+        FATAL_ERROR("sBattleAICmdTable has no handler for %s (0x%02X)\n", command->name, command->opcode);
+    return sHandlers[command->opcode];
+}
+
+static struct Item *NewItem(int type, int lineNum, int size)
+{
+    struct Item *item;
+
+    if (sNumItems == sItemCapacity)
+    {
+        sItemCapacity = sItemCapacity ? sItemCapacity * 2 : 1024;
+        sItems = Realloc(sItems, sizeof(*sItems) * sItemCapacity);
+    }
+    item = &sItems[sNumItems++];
+    memset(item, 0, sizeof(*item));
+    item->type = type;
+    item->line = lineNum;
+    item->offset = sSize;
+    item->size = size;
+    sSize += size;
+    return item;
+}
+
+// Replaces each \param in str with the matching argument.
+static void SubstituteParams(const struct Macro *macro, char args[][MAX_ARG_LENGTH], const char *str, char *out, size_t outSize)
+{
+    size_t length = 0;
+
+    while (*str != '\0')
+    {
+        const char *piece = str;
+        size_t pieceLength = 1;
+
+        if (*str == '\\')
+        {
+            char name[MAX_NAME_LENGTH];
+            size_t nameLength = 0;
+            int param;
+
+            str++;
+            while (IsIdentifierChar(*str) && nameLength < sizeof(name) - 1)
+                name[nameLength++] = *str++;
+            name[nameLength] = '\0';
+            param = FindParam(macro, name);
+            if (param < 0)
+                FATAL_ERROR("Unknown parameter \\%s in macro %s\n", name, macro->name);
+            piece = args[param];
+            pieceLength = strlen(piece);
+        }
+        else
+        {
+            str++;
+        }
+
+        if (length + pieceLength >= outSize)
+            FATAL_ERROR("Macro expansion too long in %s\n", macro->name);
+        memcpy(out + length, piece, pieceLength);
+        length += pieceLength;
+    }
+    out[length] = '\0';
+}
+
+static void ExpandMacro(const struct Macro *macro, char args[][MAX_ARG_LENGTH], int numArgs, int lineNum, int depth)
+{
+    int i;
+
+    if (numArgs != macro->numParams)
+        FATAL_ERROR("%s:%d: %s takes %d arguments, got %d\n", sScriptPath, lineNum, macro->name, macro->numParams, numArgs);
+    if (depth > MAX_EXPANSION_DEPTH)
+        FATAL_ERROR("%s:%d: %s expands too deeply\n", sScriptPath, lineNum, macro->name);
+
+    if (macro->isCommand)
+    {
+        int size = 1;
+        struct Item *item;
+
+        for (i = 0; i < macro->numOperands; i++)
+            size += macro->operands[i].width;
+        item = NewItem(ITEM_COMMAND, lineNum, size);
+
+        item->command = macro;
+        item->numArgs = numArgs;
+        for (i = 0; i < numArgs; i++)
+            strcpy(item->args[i], args[i]);
+        return;
+    }
+
+    for (i = 0; i < macro->numLines; i++)
+    {
+        char line[MAX_LINE_LENGTH];
+        char innerArgs[MAX_PARAMS][MAX_ARG_LENGTH];
+        const struct Macro *inner;
+        char *name, *rest;
+
+        SubstituteParams(macro, args, macro->lines[i], line, sizeof(line));
+        name = SplitWord(line, &rest);
+        inner = FindMacro(name);
+        if (inner == NULL)
+            FATAL_ERROR("%s:%d: %s uses %s, which is not a script macro\n", sScriptPath, lineNum, macro->name, name);
+        ExpandMacro(inner, innerArgs, SplitArgs(sScriptPath, lineNum, rest, innerArgs), lineNum, depth + 1);
+    }
+}
+
+static void AddLabel(const char *name, int lineNum)
+{
+    int i;
+
+    for (i = 0; i < sNumLabels; i++)
+    {
+        if (strcmp(sLabels[i].name, name) == 0)
+            FATAL_ERROR("%s:%d: label %s is already defined\n", sScriptPath, lineNum, name);
+    }
+    if (sNumLabels == sLabelCapacity)
+    {
+        sLabelCapacity = sLabelCapacity ? sLabelCapacity * 2 : 256;
+        sLabels = Realloc(sLabels, sizeof(*sLabels) * sLabelCapacity);
+    }
+    snprintf(sLabels[sNumLabels].name, sizeof(sLabels[sNumLabels].name), "%s", name);
+    sLabels[sNumLabels].item = sNumItems;
+    sLabels[sNumLabels].offset = sSize;
+    sNumLabels++;
+}
+
+// Reads the scripts after cpp, which has picked the BUGFIX branches the
+// assembler sees. "-" reads them from stdin.
+static void ReadScripts(const char *path)
+{
+    FILE *fp = (strcmp(path, "-") == 0) ? stdin : OpenFile(path, "r");
+    static char sFirstFile[MAX_LINE_LENGTH];
+    char buffer[MAX_LINE_LENGTH];
+    int lineNum = 0;
+
+    sScriptPath = path;
+    while (fgets(buffer, sizeof(buffer), fp) != NULL)
+    {
+        char *line, *word, *rest;
+        char args[MAX_PARAMS][MAX_ARG_LENGTH];
+        const struct Macro *macro;
+        int width;
+
+        lineNum++;
+        if (buffer[0] == '#')
+        {
+            // cpp's line markers, '# 12 "file"'. The first one names the scripts.
+            char file[MAX_LINE_LENGTH];
+            int markerLine;
+
+            if (sscanf(buffer, "# %d \"%[^\"]\"", &markerLine, file) == 2)
+            {
+                lineNum = markerLine - 1;
+                if (sFirstFile[0] == '\0')
+                {
+                    strcpy(sFirstFile, file);
+                    sScriptPath = sFirstFile;
+                }
+            }
+            continue;
+        }
+
+        StripComment(buffer);
+        line = Trim(buffer);
+        if (*line == '\0')
+            continue;
+
+        // Labels, "Name:" or "Name::".
+        if (IsIdentifierChar(*buffer))
+        {
+            char *colon = strchr(line, ':');
+
+            if (colon == NULL)
+                FATAL_ERROR("%s:%d: expected a label\n", path, lineNum);
+            *colon = '\0';
+            if (!IsIdentifier(line) || *Trim(colon + 1 + (colon[1] == ':')) != '\0')
+                FATAL_ERROR("%s:%d: malformed label\n", path, lineNum);
+            AddLabel(line, lineNum);
+            continue;
+        }
+
+        word = SplitWord(line, &rest);
+        width = GetDirectiveWidth(word);
+        if (width != 0)
+        {
+            int numArgs = SplitArgs(path, lineNum, rest, args);
+            int i;
+
+            for (i = 0; i < numArgs; i++)
+            {
+                struct Item *item = NewItem(ITEM_DATA, lineNum, width);
+                item->width = width;
+                strcpy(item->value, args[i]);
+            }
+            continue;
+        }
+        if (word[0] == '.')
+        {
+            // .include and .global don't move anything, and an .align before
+            // the first item only aligns the section. Anything else could put
+            // bytes between the items that the offsets don't count.
+            if (sNumItems != 0 && strcmp(word, ".include") != 0 && strcmp(word, ".global") != 0)
+                FATAL_ERROR("%s:%d: %s after the first script changes the layout\n", path, lineNum, word);
+            continue;
+        }
+
+        macro = FindMacro(word);
+        if (macro == NULL)
+            FATAL_ERROR("%s:%d: unknown script command %s\n", path, lineNum, word);
+        ExpandMacro(macro, args, SplitArgs(path, lineNum, rest, args), lineNum, 0);
+    }
+    if (fp != stdin)
+        fclose(fp);
+}
+
+static const struct Label *FindLabel(const char *name)
+{
+    int i;
+
+    for (i = 0; i < sNumLabels; i++)
+    {
+        if (strcmp(sLabels[i].name, name) == 0)
+            return &sLabels[i];
+    }
+    return NULL;
+}
+
+static bool IsCodeLabel(const struct Label *label)
+{
+    return label != NULL && label->item < sNumItems && sItems[label->item].type == ITEM_COMMAND;
+}
+
+static bool IsDataLabel(const struct Label *label)
+{
+    return label != NULL && label->item < sNumItems && sItems[label->item].type == ITEM_DATA;
+}
+
+static int GetCodeLabelItem(const char *name, int lineNum)
+{
+    const struct Label *label = FindLabel(name);
+
+    if (!IsCodeLabel(label))
+        FATAL_ERROR("%s:%d: %s is not a script label\n", sScriptPath, lineNum, name);
+    return label->item;
+}
+
+static bool IsCommand(const struct Item *item, const char *name)
+{
+    return item->type == ITEM_COMMAND && strcmp(item->command->name, name) == 0;
+}
+
+// Commands after which the script doesn't continue with the next command.
+static bool EndsBlock(const struct Item *item)
+{
+    return IsCommand(item, "goto") || IsCommand(item, "end")
+        || IsCommand(item, "flee") || IsCommand(item, "watch");
+}
+
+// The operand of a conditional command that holds its jump target, or -1.
+static int GetBranchOperand(const struct Item *item)
+{
+    const struct Macro *command = item->command;
+    int i;
+
+    for (i = 0; i < command->numOperands; i++)
+    {
+        const struct Operand *operand = &command->operands[i];
+        if (operand->width == 4 && IsCodeLabel(FindLabel(item->args[operand->param])))
+        {
+            if (i != command->numOperands - 1)
+                FATAL_ERROR("%s:%d: %s jumps from an operand other than the last\n", sScriptPath, item->line, command->name);
+            return i;
+        }
+    }
+    return -1;
+}
+
+static bool IsJumpTarget(int itemId)
+{
+    int i;
+
+    for (i = 0; i < sNumLabels; i++)
+    {
+        if (sLabels[i].item == itemId)
+            return true;
+    }
+    return false;
+}
+
+static const char *GetItemLabel(int itemId)
+{
+    int i;
+
+    for (i = 0; i < sNumLabels; i++)
+    {
+        if (sLabels[i].item == itemId)
+            return sLabels[i].name;
+    }
+    return NULL;
+}
+
+static int GetJumpTarget(const struct Item *item)
+{
+    int operand;
+
+    if (IsCommand(item, "goto"))
+        return GetCodeLabelItem(item->args[0], item->line);
+    if (IsCommand(item, "call") || IsCommand(item, "end"))
+        return -1;
+    operand = GetBranchOperand(item);
+    if (operand < 0)
+        return -1;
+    return GetCodeLabelItem(item->args[item->command->operands[operand].param], item->line);
+}
+
+// Marks every command reachable from entry. jumpTargets gets the ones that
+// are jumped to, which need a C label.
+static void MarkReachable(int entry, bool *reachable, bool *jumpTargets)
+{
+    int *stack = Realloc(NULL, sizeof(*stack) * (sNumItems + 1));
+    int stackSize = 0;
+
+    memset(reachable, 0, sizeof(*reachable) * sNumItems);
+    memset(jumpTargets, 0, sizeof(*jumpTargets) * sNumItems);
+    stack[stackSize++] = entry;
+
+    while (stackSize != 0)
+    {
+        int itemId = stack[--stackSize];
+
+        while (!reachable[itemId])
+        {
+            const struct Item *item = &sItems[itemId];
+            int target;
+
+            if (item->type != ITEM_COMMAND)
+                FATAL_ERROR("%s:%d: script runs into data\n", sScriptPath, item->line);
+            reachable[itemId] = true;
+
+            target = GetJumpTarget(item);
+            if (target >= 0)
+            {
+                jumpTargets[target] = true;
+                if (!reachable[target])
+                    stack[stackSize++] = target;
+            }
+            if (EndsBlock(item))
+                break;
+            if (++itemId == sNumItems)
+                FATAL_ERROR("%s:%d: script runs past the end of the file\n", sScriptPath, item->line);
+        }
+    }
+    free(stack);
+}
+
+static void EmitCommand(FILE *fp, const struct Item *item)
+{
+    const struct Macro *command = item->command;
+    int target = GetJumpTarget(item);
+    int next = item->offset + item->size;
+
+    if (strncmp(command->name, "nop_", 4) == 0)
+        FATAL_ERROR("%s:%d: %s never finishes in the interpreter\n", sScriptPath, item->line, command->name);
+
+    // Cmd_goto only moves gAIScriptPtr, which the target sets again.
+    if (IsCommand(item, "goto"))
+    {
+        fprintf(fp, "    goto %s;\n", GetItemLabel(target));
+        return;
+    }
+
+    fprintf(fp, "    AI_RUN(0x%X, %s);\n", item->offset, GetHandler(command));
+    if (IsCommand(item, "call"))
+    {
+        const struct Label *callee = FindLabel(item->args[0]);
+
+        fprintf(fp, "    AI_EXPECT(0x%X);\n", callee->offset);
+        fprintf(fp, "    AIScript_%s();\n", callee->name);
+        fputs("    if (AI_THINKING_STRUCT->aiAction & AI_ACTION_DONE)\n        return;\n", fp);
+    }
+    else if (EndsBlock(item))
+    {
+        // end returns to the caller, which checks where the handler went.
+        fputs("    return;\n", fp);
+        return;
+    }
+    else if (target >= 0)
+    {
+        fprintf(fp, "    if (AI_JUMPED(0x%X))\n        goto %s;\n", sItems[target].offset, GetItemLabel(target));
+    }
+    fprintf(fp, "    AI_EXPECT(0x%X);\n", next);
+}
+
+static void EmitFunction(FILE *fp, const char *name, bool *reachable, bool *jumpTargets)
+{
+    int entry = FindLabel(name)->item;
+    int i;
+
+    MarkReachable(entry, reachable, jumpTargets);
+
+    fprintf(fp, "static void AIScript_%s(void)\n{\n", name);
+
+    // The commands are emitted in file order, so a script that jumps back
+    // to commands above it has to start with a jump to its entry.
+    for (i = 0; i < entry; i++)
+    {
+        if (reachable[i])
+        {
+            jumpTargets[entry] = true;
+            fprintf(fp, "    goto %s;\n", GetItemLabel(entry));
+            break;
+        }
+    }
+
+    for (i = 0; i < sNumItems; i++)
+    {
+        if (!reachable[i])
+            continue;
+        if (jumpTargets[i])
+            fprintf(fp, "%s:\n", GetItemLabel(i));
+        EmitCommand(fp, &sItems[i]);
+    }
+    fputs("}\n\n", fp);
+}
+
+// Function entries: the targets of the script table and of call commands.
+static bool IsEntry(const char *name)
+{
+    int i;
+
+    for (i = 0; i < sNumItems; i++)
+    {
+        const struct Item *item = &sItems[i];
+
+        if (item->type == ITEM_DATA && item->width == 4 && strcmp(item->value, name) == 0)
+            return true;
+        if (IsCommand(item, "call") && strcmp(item->args[0], name) == 0)
+            return true;
+    }
+    return false;
+}
+
+// Whether any use of the command jumps, for AI_SCRIPT_COMMANDS.
+static bool CommandJumps(const struct Macro *command)
+{
+    int i;
+
+    for (i = 0; i < sNumItems; i++)
+    {
+        if (sItems[i].type == ITEM_COMMAND && sItems[i].command == command && GetJumpTarget(&sItems[i]) >= 0)
+            return true;
+    }
+    return false;
+}
+
+static bool CommandUsed(const struct Macro *command)
+{
+    int i;
+
+    for (i = 0; i < sNumItems; i++)
+    {
+        if (sItems[i].type == ITEM_COMMAND && sItems[i].command == command)
+            return true;
+    }
+    return false;
+}
+
+static void EmitCommandList(FILE *fp)
+{
+    int i;
+
+    fputs("// The commands the scripts use, as X(handler, opcode, size, jumps).\n", fp);
+    fputs("#define AI_SCRIPT_COMMANDS(X)", fp);
+    for (i = 0; i < sNumMacros; i++)
+    {
+        const struct Macro *command = &sMacros[i];
+        int size = 1;
+        int j;
+
+        if (!command->isCommand || !CommandUsed(command))
+            continue;
+        for (j = 0; j < command->numOperands; j++)
+            size += command->operands[j].width;
+        fprintf(fp, " \\\n    X(%s, 0x%02X, %d, %s)", GetHandler(command), command->opcode, size, CommandJumps(command) ? "TRUE" : "FALSE");
+    }
+    fputs("\n\n", fp);
+
+    fputs("#define AI_DECLARE_HANDLER(handler, opcode, size, jumps) static void handler(void);\n", fp);
+    fputs("AI_SCRIPT_COMMANDS(AI_DECLARE_HANDLER)\n", fp);
+    fputs("#undef AI_DECLARE_HANDLER\n\n", fp);
+}
+
+static void WriteCheck(const char *path, const char *scriptPath, const struct Label *table)
+{
+    FILE *fp = OpenFile(path, "w");
+    int i;
+
+    fprintf(fp, "/* DO NOT MODIFY THIS FILE! It is auto-generated from %s */\n\n", scriptPath);
+    for (i = 0; i < sNumLabels; i++)
+    {
+        fprintf(fp, "\t.if (%s - %s) != 0x%X\n", sLabels[i].name, table->name, sLabels[i].offset);
+        fprintf(fp, "\t.error \"aiscr2c counted %s at 0x%X\"\n\t.endif\n", sLabels[i].name, sLabels[i].offset);
+    }
+    fprintf(fp, "\t.if (. - %s) != 0x%X\n", table->name, sSize);
+    fprintf(fp, "\t.error \"aiscr2c counted the scripts as 0x%X bytes\"\n\t.endif\n", sSize);
+
+    if (fclose(fp) != 0)
+        FATAL_ERROR("Failed to write \"%s\".\n", path);
+}
+
+static void WriteOutput(const char *path, const char *scriptPath, const char *checkPath)
+{
+    FILE *fp = OpenFile(path, "w");
+    bool *reachable = Realloc(NULL, sizeof(*reachable) * sNumItems);
+    bool *jumpTargets = Realloc(NULL, sizeof(*jumpTargets) * sNumItems);
+    const struct Label *table = NULL;
+    const struct Label *first;
+    int i;
+
+    for (i = 0; i < sNumLabels; i++)
+    {
+        if (IsDataLabel(&sLabels[i]) && sItems[sLabels[i].item].width == 4)
+        {
+            if (table != NULL)
+                FATAL_ERROR("%s: more than one script table\n", scriptPath);
+            table = &sLabels[i];
+        }
+    }
+    if (table == NULL)
+        FATAL_ERROR("%s: no script table\n", scriptPath);
+    if (table->offset != 0)
+        FATAL_ERROR("%s: the script table has to come first\n", scriptPath);
+
+    fprintf(fp, "//\n// DO NOT MODIFY THIS FILE! It is auto-generated from %s\n//\n\n", scriptPath);
+    fputs("#ifndef GUARD_DATA_BATTLE_AI_SCRIPTS_H\n#define GUARD_DATA_BATTLE_AI_SCRIPTS_H\n\n", fp);
+
+    // Counted from the first script rather than the table, whose entries are
+    // wider than the 4 bytes aiscr2c counts on a 64-bit host.
+    first = FindLabel(sItems[table->item].value);
+    if (first == NULL || !IsCodeLabel(first))
+        FATAL_ERROR("%s:%d: %s is not a script label\n", scriptPath, sItems[table->item].line, sItems[table->item].value);
+    fprintf(fp, "#define AI_SCRIPT_AT(offset) (%s[0] + (offset) - 0x%X)\n", table->name, first->offset);
+    fputs("#define AI_RUN(offset, handler) do { gAIScriptPtr = AI_SCRIPT_AT(offset); handler(); } while (0)\n", fp);
+    fputs("#define AI_JUMPED(offset) (gAIScriptPtr == AI_SCRIPT_AT(offset))\n", fp);
+    fputs("#define AI_EXPECT(offset) do { if (!AI_JUMPED(offset)) { BattleAI_ContinueInInterpreter(); return; } } while (0)\n\n", fp);
+
+    EmitCommandList(fp);
+
+    for (i = 0; i < sNumLabels; i++)
+    {
+        if (IsCodeLabel(&sLabels[i]) && IsEntry(sLabels[i].name))
+            fprintf(fp, "static void AIScript_%s(void);\n", sLabels[i].name);
+    }
+    fputs("\n", fp);
+
+    for (i = 0; i < sNumLabels; i++)
+    {
+        if (IsCodeLabel(&sLabels[i]) && IsEntry(sLabels[i].name))
+            EmitFunction(fp, sLabels[i].name, reachable, jumpTargets);
+    }
+
+    fputs("static void (*const sCompiledBattleAIScripts[])(void) =\n{\n", fp);
+    for (i = table->item; i < sNumItems && sItems[i].type == ITEM_DATA && (i == table->item || !IsJumpTarget(i)); i++)
+    {
+        if (!IsCodeLabel(FindLabel(sItems[i].value)))
+            FATAL_ERROR("%s:%d: %s is not a script label\n", scriptPath, sItems[i].line, sItems[i].value);
+        fprintf(fp, "    AIScript_%s,\n", sItems[i].value);
+    }
+    fputs("};\n\n#endif // GUARD_DATA_BATTLE_AI_SCRIPTS_H\n", fp);
+
+    free(reachable);
+    free(jumpTargets);
+    if (fclose(fp) != 0)
+        FATAL_ERROR("Failed to write \"%s\".\n", path);
+
+    if (checkPath != NULL)
+        WriteCheck(checkPath, scriptPath, table);
+}
+
+int main(int argc, char **argv)
+{
+    if (argc != 5 && argc != 6)
+        FATAL_ERROR("Usage: %s MACROS_INC COMMANDS_C SCRIPTS_S OUTPUT_H [CHECK_INC]\n", argv[0]);
+
+    ReadMacros(argv[1]);
+    ReadHandlers(argv[2]);
+    ReadScripts(argv[3]);
+    WriteOutput(argv[4], sScriptPath, argc == 6 ? argv[5] : NULL);
+    return 0;
+}
@@ -25,7 +25,7 @@ gBattleAI_ScriptsTable::
 	.4byte AI_DoubleBattle 	        @ AI_SCRIPT_DOUBLE_BATTLE
 	.4byte AI_HPAware               @ AI_SCRIPT_HP_AWARE
 	.4byte AI_TrySunnyDayStart      @ AI_SCRIPT_TRY_SUNNY_DAY_START
-	.4byte AI_Ret
+	.4byte AI_Ret                   @ AI_SCRIPT_LOOKAHEAD, handled in C
 	.4byte AI_Ret
 	.4byte AI_Ret
 	.4byte AI_Ret